@@ -0,0 +1,121 @@
+/*
+ * AnalysisService.h - shared worker threads for visualization analysis
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_ANALYSIS_SERVICE_H
+#define LMMS_ANALYSIS_SERVICE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "LmmsSemaphore.h"
+#include "LocklessRingBuffer.h"
+#include "SampleFrame.h"
+#include "lmms_export.h"
+
+class QThread;
+
+namespace lmms
+{
+
+/**
+	Runs the analysis behind effect displays (spectra, peaks, ...) outside of
+	the audio thread.
+
+	The audio thread only copies its frames into the ring buffer of a Task,
+	which wakes one of a fixed number of low priority workers. The worker then
+	calls Task::analyze() to consume the data. A task is never analyzed by two
+	workers at the same time, and the number of threads doesn't depend on how
+	many displays are open.
+*/
+class LMMS_EXPORT AnalysisService
+{
+public:
+	//! Upper limit for the number of workers
+	static constexpr int MaxWorkers = 2;
+
+	class LMMS_EXPORT Task
+	{
+	public:
+		//! \p capacity is the number of frames which can be queued for analysis
+		explicit Task(std::size_t capacity);
+		virtual ~Task() = default;
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+
+		//! Queue frames for analysis, to be called from the audio thread.
+		//! Frames which don't fit into the buffer are dropped.
+		void write(const SampleFrame* buffer, fpp_t frames);
+
+	protected:
+		//! Called by a worker after frames have been written or wake() was called
+		virtual void analyze(LocklessRingBufferReader<SampleFrame>& reader) = 0;
+
+		//! Have analyze() called without writing frames, e.g. to clear the results
+		void wake();
+
+		std::size_t capacity() const { return m_buffer.capacity(); }
+		std::size_t free() const { return m_buffer.free(); }
+
+	private:
+		LocklessRingBuffer<SampleFrame> m_buffer;
+		LocklessRingBufferReader<SampleFrame> m_reader;
+		std::atomic<bool> m_pending;
+		bool m_running;
+
+		friend class AnalysisService;
+	} ;
+
+	AnalysisService();
+	~AnalysisService();
+
+	//! Make \p task known to the workers
+	void add(Task* task);
+	//! Forget \p task, waiting for a running analysis of it to finish.
+	//! Must be called before the task object is destroyed.
+	void remove(Task* task);
+
+	int workerCount() const
+	{
+		return static_cast<int>(m_workers.size());
+	}
+
+private:
+	void run();
+	Task* takePendingTask();
+
+	std::vector<QThread*> m_workers;
+	std::vector<Task*> m_tasks;
+	std::mutex m_tasksMutex;
+	std::condition_variable m_taskFinished;
+	Semaphore m_wakeUp;
+	std::atomic<bool> m_quit;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_ANALYSIS_SERVICE_H
@@ -30,6 +30,8 @@
 #include <QThread>
 #include <samplerate.h>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -38,6 +40,7 @@
 #include "LocklessList.h"
 #include "FifoBuffer.h"
 #include "AudioEngineProfiler.h"
+#include "OverloadManager.h"
 #include "PlayHandle.h"
 
 
@@ -46,12 +49,16 @@ namespace lmms
 
 class AudioDevice;
 class MidiClient;
+class MidiPort;
 class AudioPort;
 class AudioEngineWorkerThread;
 
 
 const fpp_t MINIMUM_BUFFER_SIZE = 32;
 const fpp_t DEFAULT_BUFFER_SIZE = 256;
+//! Upper limit for the frames effects process per call, the period size is
+//! capped to this. Instruments still size their buffers to the period.
+const fpp_t MAXIMUM_BLOCK_SIZE = DEFAULT_BUFFER_SIZE;
 
 const int BYTES_PER_SAMPLE = sizeof( sample_t );
 const int BYTES_PER_INT_SAMPLE = sizeof( int_sample_t );
@@ -180,6 +187,11 @@ public:
 
 	void removeAudioPort(AudioPort * port);
 
+	const std::vector<AudioPort*>& audioPorts() const
+	{
+		return m_audioPorts;
+	}
+
 
 	// MIDI-client-stuff
 	inline const QString & midiClientName() const
@@ -192,6 +204,37 @@ public:
 		return m_midiClient;
 	}
 
+	//! Time in microseconds used by MidiPort for timestamping input events
+	static std::int64_t midiInputTime();
+
+	//! Let the audio thread pass the queued input events of \p port to its
+	//! event processor at the beginning of the next period
+	void queueMidiInput( MidiPort* port );
+
+	//! Forget about the queued input events of a port which is being destroyed
+	void dequeueMidiInput( MidiPort* port );
+
+	/*! Returns the offset in the current period of a MIDI input event which
+	    was received at \p time. Events are delayed by one period and keep
+	    their distance to each other, so their latency doesn't depend on when
+	    they arrived relative to the rendering of a period. */
+	f_cnt_t midiInputOffset( std::int64_t time );
+
+	//! Time between the arrival of MIDI input events and their position in the
+	//! rendered audio, in microseconds. The spread is the jitter of the input.
+	struct MidiInputLatency
+	{
+		int events;
+		int minimum;
+		int maximum;
+	};
+
+	//! Start recording midiInputLatency() from scratch, e.g. for a loopback
+	//! benchmark. Nothing is recorded while no measurement is running.
+	void startMidiInputLatencyMeasurement();
+	void stopMidiInputLatencyMeasurement();
+	MidiInputLatency midiInputLatency() const;
+
 
 	// play-handle stuff
 	bool addPlayHandle( PlayHandle* handle );
@@ -228,6 +271,14 @@ public:
 		return m_profiler.detailLoad(type);
 	}
 
+	OverloadManager& overloadManager()
+	{
+		return m_overloadManager;
+	}
+
+	//! (Re-)read the flight recorder settings from ConfigManager
+	void loadFlightRecorderSettings();
+
 	const qualitySettings & currentQualitySettings() const
 	{
 		return m_qualitySettings;
@@ -354,6 +405,8 @@ private:
 
 	void handleMetronome();
 
+	void processMidiInput();
+
 	void clearInternal();
 
 	bool m_renderOnly;
@@ -379,6 +432,7 @@ private:
 	PlayHandleList m_playHandles;
 	// place where new playhandles are added temporarily
 	LocklessList<PlayHandle *> m_newPlayHandles;
+	int m_newPlayHandleCount;
 	ConstPlayHandleList m_playHandlesToRemove;
 
 
@@ -396,11 +450,22 @@ private:
 	MidiClient * m_midiClient;
 	QString m_midiClientName;
 
+	// ports with queued input events
+	LocklessList<MidiPort *> m_midiInputPorts;
+	// time span of the input events processed in the current period
+	std::int64_t m_midiInputBegin;
+	std::int64_t m_midiInputEnd;
+	std::atomic<bool> m_measureMidiInputLatency;
+	std::atomic<int> m_midiInputEvents;
+	std::atomic<int> m_midiInputMinLatency;
+	std::atomic<int> m_midiInputMaxLatency;
+
 	// FIFO stuff
 	Fifo * m_fifo;
 	fifoWriter * m_fifoWriter;
 
 	AudioEngineProfiler m_profiler;
+	OverloadManager m_overloadManager;
 
 	bool m_metronomeActive;
 
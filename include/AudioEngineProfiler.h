@@ -27,26 +27,52 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <QFile>
 
 #include "lmms_basics.h"
+#include "lmms_export.h"
+#include "LocklessRingBuffer.h"
 #include "MicroTimer.h"
 
 namespace lmms
 {
 
-class AudioEngineProfiler
+class LMMS_EXPORT AudioEngineProfiler
 {
+	using Clock = std::chrono::steady_clock;
+
 public:
 	AudioEngineProfiler();
-	~AudioEngineProfiler() = default;
+	~AudioEngineProfiler();
+
+	//! Counters of the engine which are stored in the flight recorder for every period
+	struct PeriodCounters
+	{
+		int jobs;             //!< number of jobs processed by the worker threads
+		int workerBusy;       //!< time spent processing jobs, summed over all threads, in microseconds
+		int workers;          //!< number of threads processing jobs, including the audio thread
+		int playHandles;
+		int newPlayHandles;
+		bool realtime;        //!< false while exporting, where missed deadlines are expected
+	};
 
-	void startPeriod()
+	//! \param lockWait time in microseconds the audio thread had to wait for the engine lock
+	void startPeriod(int lockWait = 0)
 	{
 		m_periodTimer.reset();
+		m_periodStart = Clock::now();
+		m_lockWait = lockWait;
 	}
 
-	void finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod );
+	void finishPeriod(sample_rate_t sampleRate, fpp_t framesPerPeriod, const PeriodCounters& counters);
 
 	int cpuLoad() const
 	{
@@ -89,6 +115,109 @@ public:
 		const AudioEngineProfiler::DetailType m_type;
 	};
 
+	//! Kinds of objects whose processing time can be measured individually
+	enum class SourceType : std::uint8_t
+	{
+		Period,       //!< a whole period, source is always nullptr
+		Instrument,   //!< play handles of a track, source is the track's AudioPort
+		Effect,       //!< source is the Effect
+		MixerChannel  //!< source is the MixerChannel, mixing its inputs only, the effects are measured separately
+	};
+
+	//! A single measurement, written by the audio threads
+	struct SourceEvent
+	{
+		const void* source;
+		std::int64_t start;        //!< microseconds since the profiler was created
+		std::uint32_t duration;    //!< microseconds
+		SourceType type;
+		std::uint8_t thread;       //!< AudioEngineWorkerThread::currentThread() of the measuring thread
+	};
+
+	//! Aggregated load of a single source, as seen by the collector thread
+	struct SourceStatistics
+	{
+		const void* source;
+		SourceType type;
+		float load;         //!< averaged percentage of the period length
+		int peak;           //!< longest run in microseconds during the last second
+		int callsPerPeriod;
+	};
+
+	//! Measures the processing time of a single source, if source profiling is enabled
+	class SourceProbe
+	{
+	public:
+		SourceProbe(AudioEngineProfiler& profiler, SourceType type, const void* source)
+			: m_profiler(profiler.sourceProfiling() ? &profiler : nullptr)
+			, m_source(source)
+			, m_type(type)
+		{
+			if (m_profiler) { m_start = Clock::now(); }
+		}
+		~SourceProbe()
+		{
+			stop();
+		}
+
+		//! Record the time until now, instead of when the probe is destroyed
+		void stop()
+		{
+			if (m_profiler) { m_profiler->recordSource(m_type, m_source, m_start); }
+			m_profiler = nullptr;
+		}
+		SourceProbe& operator=(const SourceProbe&) = delete;
+		SourceProbe(const SourceProbe&) = delete;
+		SourceProbe(SourceProbe&&) = delete;
+
+	private:
+		AudioEngineProfiler* m_profiler;
+		const void* m_source;
+		const SourceType m_type;
+		Clock::time_point m_start;
+	};
+
+	//! Enable or disable the per source measurements. Must not be called from the audio threads.
+	void setSourceProfiling(bool enabled);
+	bool sourceProfiling() const { return m_sourceProfiling.load(std::memory_order_acquire); }
+
+	//! Returns a snapshot of the per source statistics
+	std::vector<SourceStatistics> sourceStatistics() const;
+
+	//! Forget everything measured for \p source, which is being destroyed, so a new
+	//! object at the same address starts without its statistics
+	void removeSource(const void* source);
+
+	//! Start collecting every single event for exporting it as trace later on
+	void startTrace();
+	//! Stop collecting events and return everything that has been collected since startTrace()
+	std::vector<SourceEvent> stopTrace();
+	bool isTracing() const { return m_tracing.load(std::memory_order_relaxed); }
+
+	//! Number of events which were lost because the collector could not keep up
+	int lostEvents() const { return m_lostEvents.load(std::memory_order_relaxed); }
+
+	/**
+		The flight recorder keeps the timings of the last periods and dumps them
+		into a new CSV file in \p directory whenever a period exceeds its budget.
+		An empty directory disables the dumps, the recording itself is always on.
+	*/
+	void setFlightRecorderDirectory(const QString& directory);
+
+	//! Length of the history written by the flight recorder
+	static constexpr auto FlightRecorderLength = std::chrono::seconds(10);
+	//! Minimum time between two flight recorder dumps
+	static constexpr auto FlightRecorderDumpInterval = std::chrono::seconds(10);
+	//! Number of dumps kept in the flight recorder directory
+	static constexpr int FlightRecorderMaxDumps = 20;
+
+	//! Number of event rings, the events of worker threads with a higher index are lost
+	static constexpr std::size_t MaxThreads = 32;
+	//! Capacity of each per thread event ring
+	static constexpr std::size_t EventsPerThread = 4096;
+	//! Maximum number of events kept while tracing, about 100 MB
+	static constexpr std::size_t MaxTraceEvents = 4 * 1024 * 1024;
+
 private:
 	void startDetail(const DetailType type) { m_detailTimer[static_cast<std::size_t>(type)].reset(); }
 	void finishDetail(const DetailType type)
@@ -96,10 +225,79 @@ private:
 		m_detailTime[static_cast<std::size_t>(type)] = m_detailTimer[static_cast<std::size_t>(type)].elapsed();
 	}
 
+	void recordSource(SourceType type, const void* source, Clock::time_point start);
+	void pushEvent(const SourceEvent& event);
+
+	struct PeriodRecord
+	{
+		std::int64_t start;   //!< microseconds since the profiler was created
+		std::uint32_t elapsed;
+		std::uint32_t budget;
+		std::uint32_t lockWait;
+		std::array<std::uint32_t, DetailCount> detail;
+		std::uint32_t workerBusy;
+		std::uint16_t jobs;
+		std::uint16_t workers;
+		std::uint16_t playHandles;
+		std::uint16_t newPlayHandles;
+		bool realtime;
+	};
+
+	void allocateRings();
+	void collect();
+	void collectorLoop();
+	void dumpFlightRecorder();
+
+	struct Accumulator
+	{
+		SourceType type;
+		std::int64_t time;
+		int peak;
+		int calls;
+	};
+
 	MicroTimer m_periodTimer;
 	std::atomic<float> m_cpuLoad;
 	QFile m_outputFile;
 
+	const Clock::time_point m_epoch;
+	Clock::time_point m_periodStart;
+	int m_lockWait;
+	std::atomic<std::uint64_t> m_periodLength;  //!< microseconds
+
+	LocklessRingBuffer<PeriodRecord> m_periodRing;
+	LocklessRingBufferReader<PeriodRecord> m_periodReader;
+
+	// One single producer ring per AudioEngineWorkerThread index, allocated before source
+	// profiling gets enabled for the first time and never released until
+	// destruction
+	std::array<std::unique_ptr<LocklessRingBuffer<SourceEvent>>, MaxThreads> m_rings;
+	std::array<std::unique_ptr<LocklessRingBufferReader<SourceEvent>>, MaxThreads> m_readers;
+	std::atomic<bool> m_sourceProfiling;
+	std::atomic<bool> m_tracing;
+	std::atomic<int> m_lostEvents;
+
+	// Everything below is owned by the collector thread
+	std::thread m_collector;
+	std::mutex m_collectorMutex;
+	std::condition_variable m_collectorCondition;
+	bool m_collectorQuit;
+	std::unordered_map<const void*, Accumulator> m_accumulators;
+	int m_collectedPeriods;
+	int m_collectorRuns;
+	std::vector<PeriodRecord> m_flightRecorder;  //!< circular buffer
+	std::size_t m_flightRecorderPos;
+	QString m_flightRecorderDirectory;
+	bool m_dumpPending;
+	Clock::time_point m_lastDump;
+
+	// Guards m_statistics, m_trace and m_removedSources
+	mutable std::mutex m_statisticsMutex;
+	std::unordered_map<const void*, SourceStatistics> m_statistics;
+	std::vector<SourceEvent> m_trace;
+	//! Sources destroyed since the last collection, their last events may still be in the rings
+	std::vector<const void*> m_removedSources;
+
 	// Use arrays to avoid dynamic allocations in realtime code
 	std::array<MicroTimer, DetailCount> m_detailTimer;
 	std::array<int, DetailCount> m_detailTime{0};
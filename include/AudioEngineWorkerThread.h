@@ -29,6 +29,8 @@
 
 #include <atomic>
 
+#include "lmms_export.h"
+
 class QWaitCondition;
 
 namespace lmms
@@ -37,7 +39,7 @@ namespace lmms
 class AudioEngine;
 class ThreadableJob;
 
-class AudioEngineWorkerThread : public QThread
+class LMMS_EXPORT AudioEngineWorkerThread : public QThread
 {
 	Q_OBJECT
 public:
@@ -52,11 +54,17 @@ public:
 		} ;
 
 		static constexpr size_t JOB_QUEUE_SIZE = 8192;
+		//! Number of threads which can have jobs bound to them, see ThreadableJob::affinity()
+		static constexpr int MAX_AFFINE_THREADS = 64;
+		static constexpr size_t AFFINE_QUEUE_SIZE = 64;
 
 		JobQueue() :
 			m_items(),
 			m_writeIndex( 0 ),
+			m_readIndex( 0 ),
+			m_itemsQueued( 0 ),
 			m_itemsDone( 0 ),
+			m_affineJobs( 0 ),
 			m_opMode( OperationMode::Static )
 		{
 			std::fill(m_items, m_items + JOB_QUEUE_SIZE, nullptr);
@@ -66,13 +74,55 @@ public:
 
 		void addJob( ThreadableJob * _job );
 
+		//! Process jobs until the queue is done. In dynamic mode this also
+		//! waits for jobs which other threads add while processing theirs.
 		void run();
+		//! Process one job which is ready, returns false if there is none
+		bool runOne();
 		void wait();
 
 	private:
+		//! Slots are reserved by incrementing the write index before the job is
+		//! stored, so a reader may have to wait a moment for its job
+		struct Queue
+		{
+			std::atomic<ThreadableJob*>* items;
+			std::atomic_int& writeIndex;
+			std::atomic_int& readIndex;
+			size_t size;
+		};
+
+		struct AffineQueue
+		{
+			std::atomic<ThreadableJob*> items[AFFINE_QUEUE_SIZE] = {};
+			std::atomic_int writeIndex{0};
+			std::atomic_int readIndex{0};
+		};
+
+		static bool push( Queue queue, ThreadableJob * job );
+		static ThreadableJob * take( Queue queue );
+		ThreadableJob * take();
+
+		Queue globalQueue()
+		{
+			return { m_items, m_writeIndex, m_readIndex, JOB_QUEUE_SIZE };
+		}
+
+		Queue affineQueue( int thread )
+		{
+			auto& queue = m_affineQueues[thread % MAX_AFFINE_THREADS];
+			return { queue.items, queue.writeIndex, queue.readIndex, AFFINE_QUEUE_SIZE };
+		}
+
 		std::atomic<ThreadableJob*> m_items[JOB_QUEUE_SIZE];
 		std::atomic_int m_writeIndex;
+		std::atomic_int m_readIndex;
+		// the queue is done when all queued jobs are done; as jobs queue their
+		// successors before they finish, this also holds in dynamic mode
+		std::atomic_int m_itemsQueued;
 		std::atomic_int m_itemsDone;
+		AffineQueue m_affineQueues[MAX_AFFINE_THREADS];
+		std::atomic_int m_affineJobs;
 		OperationMode m_opMode;
 	} ;
 
@@ -82,6 +132,22 @@ public:
 
 	virtual void quit();
 
+	//! Pin the thread to the given CPU core once it runs, if supported
+	void setCore( int core )
+	{
+		m_core = core;
+	}
+
+	//! Returns the index of the calling thread among the threads processing
+	//! jobs: 0 for the audio engine thread, 1 and above for worker threads
+	static int currentThread()
+	{
+		return s_currentThread;
+	}
+
+	//! Returns the number of threads processing jobs, including the audio engine thread
+	static int threadCount();
+
 	static void resetJobQueue( JobQueue::OperationMode _opMode =
 													JobQueue::OperationMode::Static )
 	{
@@ -108,6 +174,24 @@ public:
 
 	static void startAndWaitForJobs();
 
+	//! Process \p count jobs in parallel and return once all of them are done.
+	//! Meant to be called from within a running job, e.g. to split an effect
+	//! into independent parts. The calling thread takes part in the processing.
+	static void processInParallel(ThreadableJob* const* jobs, std::size_t count);
+
+	//! Returns the number of jobs processed since the last call and resets the counter
+	static int takeJobCount()
+	{
+		return s_jobCount.exchange(0, std::memory_order_relaxed);
+	}
+
+	//! Returns the time in microseconds all threads spent processing jobs since the
+	//! last call and resets the counter
+	static int takeBusyTime()
+	{
+		return s_busyTime.exchange(0, std::memory_order_relaxed);
+	}
+
 
 private:
 	void run() override;
@@ -116,7 +200,13 @@ private:
 	static QWaitCondition * queueReadyWaitCond;
 	static QList<AudioEngineWorkerThread *> workerThreads;
 
+	static std::atomic_int s_jobCount;
+	static std::atomic_int s_busyTime;
+	static thread_local int s_currentThread;
+
 	volatile bool m_quit;
+	int m_index;
+	int m_core;
 } ;
 
 } // namespace lmms
@@ -29,6 +29,7 @@
 #include <QString>
 #include <QMutex>
 
+#include "CompensationDelay.h"
 #include "PlayHandle.h"
 
 namespace lmms
@@ -37,10 +38,20 @@ namespace lmms
 class EffectChain;
 class FloatModel;
 class BoolModel;
+class Plugin;
 
 class AudioPort : public ThreadableJob
 {
 public:
+	//! Interface for processing the buffers of all play handles of a port
+	//! together, right before they are mixed into the port's buffer
+	class BatchProcessor
+	{
+	public:
+		virtual ~BatchProcessor() = default;
+		virtual void processBatch( const PlayHandleList& playHandles ) = 0;
+	};
+
 	AudioPort( const QString & _name, bool _has_effect_chain = true,
 		FloatModel * volumeModel = nullptr, FloatModel * panningModel = nullptr,
 		BoolModel * mutedModel = nullptr );
@@ -83,10 +94,7 @@ public:
 		return m_effects.get();
 	}
 
-	void setNextMixerChannel( const mix_ch_t _chnl )
-	{
-		m_nextMixerChannel = _chnl;
-	}
+	void setNextMixerChannel( const mix_ch_t _chnl );
 
 
 	const QString & name() const
@@ -109,6 +117,25 @@ public:
 	void addPlayHandle( PlayHandle * handle );
 	void removePlayHandle( PlayHandle * handle );
 
+	void setBatchProcessor( BatchProcessor* processor )
+	{
+		m_batchProcessor = processor;
+	}
+
+	//! Set the plugin producing the audio of this port, so its latency
+	//! is taken into account by the delay compensation. Locks the audio
+	//! engine, so the old source can be deleted once this returns.
+	void setSource( const Plugin* source );
+
+	//! Return the latency of the source and the effects of this port
+	f_cnt_t latency() const;
+
+	//! Delay which aligns this port with the other inputs of its mixer channel
+	CompensationDelay& compensation()
+	{
+		return m_compensation;
+	}
+
 private:
 	volatile bool m_bufferUsage;
 
@@ -125,6 +152,13 @@ private:
 	PlayHandleList m_playHandles;
 	QMutex m_playHandleLock;
 
+	BatchProcessor* m_batchProcessor;
+
+	const Plugin* m_source;
+	// latency of the source as of the last period, to notice changes
+	f_cnt_t m_sourceLatency;
+	CompensationDelay m_compensation;
+
 	FloatModel * m_volumeModel;
 	FloatModel * m_panningModel;
 	BoolModel * m_mutedModel;
@@ -35,16 +35,21 @@
 #define __USE_XOPEN
 #endif
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <type_traits>
 
 #include "lmms_basics.h"
 #include "lmms_constants.h"
 #include "interpolation.h"
+#include "SampleFrame.h"
 
 namespace lmms
 {
 
 template<ch_cnt_t CHANNELS=DEFAULT_CHANNELS> class BasicFilters;
+template<int VOICES> class BiQuadBatch;
 
 template<ch_cnt_t CHANNELS>
 class LinkwitzRiley
@@ -155,6 +160,8 @@ public:
 	}
 	virtual ~BiQuad() = default;
 	
+	using Coeffs = std::array<float, 5>;
+
 	inline void setCoeffs( float a1, float a2, float b0, float b1, float b2 )
 	{
 		m_a1 = a1;
@@ -163,6 +170,14 @@ public:
 		m_b1 = b1;
 		m_b2 = b2;
 	}
+	inline void setCoeffs( const Coeffs& c )
+	{
+		setCoeffs( c[0], c[1], c[2], c[3], c[4] );
+	}
+	inline Coeffs coeffs() const
+	{
+		return { m_a1, m_a2, m_b0, m_b1, m_b2 };
+	}
 	inline void clearHistory()
 	{
 		for( int i = 0; i < CHANNELS; ++i )
@@ -179,11 +194,37 @@ public:
 		m_z2[ch] = m_b2 * in - m_a2 * out;
 		return out;
 	}
+	//! Filter interleaved frames while moving the coefficients linearly
+	//! towards \p target, which are set exactly at the end
+	template<class Frame>
+	inline void processRamped( Frame* buf, fpp_t frames, const Coeffs& target )
+	{
+		const float step = 1.0f / frames;
+		const float da1 = ( target[0] - m_a1 ) * step;
+		const float da2 = ( target[1] - m_a2 ) * step;
+		const float db0 = ( target[2] - m_b0 ) * step;
+		const float db1 = ( target[3] - m_b1 ) * step;
+		const float db2 = ( target[4] - m_b2 ) * step;
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			m_a1 += da1;
+			m_a2 += da2;
+			m_b0 += db0;
+			m_b1 += db1;
+			m_b2 += db2;
+			for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+			{
+				buf[f][ch] = update( buf[f][ch], ch );
+			}
+		}
+		setCoeffs( target );
+	}
 private:
 	float m_a1, m_a2, m_b0, m_b1, m_b2;
 	float m_z1 [CHANNELS], m_z2 [CHANNELS];
 	
 	friend class BasicFilters<CHANNELS>; // needed for subfilter stuff in BasicFilters
+	template<int> friend class BiQuadBatch;
 };
 using StereoBiQuad = BiQuad<2>;
 
@@ -262,6 +303,13 @@ public:
 
 	inline void setFilterType( const FilterType _idx )
 	{
+		if( _idx != m_typeIndex )
+		{
+			// the biquad coefficients may be stale, don't interpolate from them
+			m_biQuadValid = false;
+			m_typeIndex = _idx;
+		}
+
 		m_doubleFilter = _idx == FilterType::DoubleLowPass || _idx == FilterType::DoubleMoog;
 		if( !m_doubleFilter )
 		{
@@ -284,6 +332,8 @@ public:
 	}
 
 	inline BasicFilters( const sample_rate_t _sample_rate ) :
+		m_typeIndex( FilterType::LowPass ),
+		m_biQuadValid( false ),
 		m_doubleFilter( false ),
 		m_sampleRate( (float) _sample_rate ),
 		m_sampleRatio( 1.0f / m_sampleRate ),
@@ -340,369 +390,492 @@ public:
 
 	inline sample_t update( sample_t _in0, ch_cnt_t _chnl )
 	{
-		sample_t out = 0.0f;
+		return dispatch([this, _in0, _chnl](auto type)
+		{
+			constexpr auto T = decltype(type)::value;
+			const sample_t out = updateSingle<T>( _in0, _chnl );
+			return m_doubleFilter ? m_subFilter->template updateSingle<T>( out, _chnl ) : out;
+		});
+	}
+
+	//! Number of frames between two coefficient updates in the modulated processBlock()
+	static constexpr fpp_t ControlInterval = 16;
+
+	//! Filter a whole buffer with the current coefficients, resolving the filter
+	//! type once per call instead of once per sample
+	inline void processBlock( SampleFrame* _buf, const fpp_t _frames )
+	{
+		dispatch([this, _buf, _frames](auto type)
+		{
+			constexpr auto T = decltype(type)::value;
+			processFrames<T>( _buf, _frames );
+			if( m_doubleFilter )
+			{
+				m_subFilter->template processFrames<T>( _buf, _frames );
+			}
+		});
+	}
+
+	/*! \brief Filter a whole buffer while modulating cutoff and resonance
+	 *
+	 * Only every ControlInterval-th entry of \p _freq and \p _q is evaluated.
+	 * Biquad coefficients are interpolated linearly between these control
+	 * points, all other filter types are updated in steps.
+	 */
+	inline void processBlock( SampleFrame* _buf, const fpp_t _frames, const float* _freq, const float* _q )
+	{
+		dispatch([&](auto type)
+		{
+			constexpr auto T = decltype(type)::value;
+			for( fpp_t offset = 0; offset < _frames; offset += ControlInterval )
+			{
+				const fpp_t frames = std::min<fpp_t>( ControlInterval, _frames - offset );
+				SampleFrame* buf = _buf + offset;
+
+				if constexpr( isBiQuad( T ) )
+				{
+					const bool ramp = m_biQuadValid;
+					const auto from = m_biQuad.coeffs();
+					calcFilterCoeffs( _freq[offset], _q[offset] );
+					if( ramp )
+					{
+						const auto to = m_biQuad.coeffs();
+						m_biQuad.setCoeffs( from );
+						m_biQuad.processRamped( buf, frames, to );
+						if( m_doubleFilter )
+						{
+							m_subFilter->m_biQuad.setCoeffs( from );
+							m_subFilter->m_biQuad.processRamped( buf, frames, to );
+						}
+						continue;
+					}
+				}
+				else
+				{
+					calcFilterCoeffs( _freq[offset], _q[offset] );
+				}
+
+				processFrames<T>( buf, frames );
+				if( m_doubleFilter )
+				{
+					m_subFilter->template processFrames<T>( buf, frames );
+				}
+			}
+		});
+	}
+
+	//! Returns whether the given type is implemented by a single biquad
+	static constexpr bool isBiQuad( const FilterType _type )
+	{
+		return _type == FilterType::LowPass ||
+			_type == FilterType::HiPass ||
+			_type == FilterType::BandPass_CSG ||
+			_type == FilterType::BandPass_CZPG ||
+			_type == FilterType::Notch ||
+			_type == FilterType::AllPass;
+	}
+
+private:
+	template<FilterType T>
+	using Type = std::integral_constant<FilterType, T>;
+
+	//! Call \p _f with the current filter type as a compile time constant
+	template<class F>
+	inline auto dispatch( F&& _f )
+	{
 		switch( m_type )
 		{
-			case FilterType::Moog:
+			case FilterType::HiPass: return _f( Type<FilterType::HiPass>{} );
+			case FilterType::BandPass_CSG: return _f( Type<FilterType::BandPass_CSG>{} );
+			case FilterType::BandPass_CZPG: return _f( Type<FilterType::BandPass_CZPG>{} );
+			case FilterType::Notch: return _f( Type<FilterType::Notch>{} );
+			case FilterType::AllPass: return _f( Type<FilterType::AllPass>{} );
+			case FilterType::Moog: return _f( Type<FilterType::Moog>{} );
+			case FilterType::Lowpass_RC12: return _f( Type<FilterType::Lowpass_RC12>{} );
+			case FilterType::Bandpass_RC12: return _f( Type<FilterType::Bandpass_RC12>{} );
+			case FilterType::Highpass_RC12: return _f( Type<FilterType::Highpass_RC12>{} );
+			case FilterType::Lowpass_RC24: return _f( Type<FilterType::Lowpass_RC24>{} );
+			case FilterType::Bandpass_RC24: return _f( Type<FilterType::Bandpass_RC24>{} );
+			case FilterType::Highpass_RC24: return _f( Type<FilterType::Highpass_RC24>{} );
+			case FilterType::Formantfilter: return _f( Type<FilterType::Formantfilter>{} );
+			case FilterType::Lowpass_SV: return _f( Type<FilterType::Lowpass_SV>{} );
+			case FilterType::Bandpass_SV: return _f( Type<FilterType::Bandpass_SV>{} );
+			case FilterType::Highpass_SV: return _f( Type<FilterType::Highpass_SV>{} );
+			case FilterType::Notch_SV: return _f( Type<FilterType::Notch_SV>{} );
+			case FilterType::FastFormant: return _f( Type<FilterType::FastFormant>{} );
+			case FilterType::Tripole: return _f( Type<FilterType::Tripole>{} );
+			// the double filters are mapped to LowPass and Moog in setFilterType()
+			default: return _f( Type<FilterType::LowPass>{} );
+		}
+	}
+
+	//! Filter all channels of the given frames, the channel loop is kept
+	//! innermost so that the compiler can process both channels in parallel
+	template<FilterType T>
+	inline void processFrames( SampleFrame* _buf, const fpp_t _frames )
+	{
+		static_assert( CHANNELS == DEFAULT_CHANNELS, "block processing requires stereo frames" );
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
 			{
-				sample_t x = _in0 - m_r*m_y4[_chnl];
+				_buf[f][ch] = updateSingle<T>( _buf[f][ch], ch );
+			}
+		}
+	}
 
-				// four cascaded onepole filters
-				// (bilinear transform)
+	template<FilterType T>
+	inline sample_t updateSingle( sample_t _in0, ch_cnt_t _chnl )
+	{
+		if constexpr( T == FilterType::Moog )
+		{
+			sample_t x = _in0 - m_r*m_y4[_chnl];
+
+			// four cascaded onepole filters
+			// (bilinear transform)
+			m_y1[_chnl] = std::clamp((x + m_oldx[_chnl]) * m_p
+						- m_k * m_y1[_chnl], -10.0f,
+							10.0f);
+			m_y2[_chnl] = std::clamp((m_y1[_chnl] + m_oldy1[_chnl]) * m_p
+						- m_k * m_y2[_chnl], -10.0f,
+							10.0f);
+			m_y3[_chnl] = std::clamp((m_y2[_chnl] + m_oldy2[_chnl]) * m_p
+						- m_k * m_y3[_chnl], -10.0f,
+							10.0f );
+			m_y4[_chnl] = std::clamp((m_y3[_chnl] + m_oldy3[_chnl]) * m_p
+						- m_k * m_y4[_chnl], -10.0f,
+							10.0f);
+
+			m_oldx[_chnl] = x;
+			m_oldy1[_chnl] = m_y1[_chnl];
+			m_oldy2[_chnl] = m_y2[_chnl];
+			m_oldy3[_chnl] = m_y3[_chnl];
+			return m_y4[_chnl] - m_y4[_chnl] * m_y4[_chnl] *
+					m_y4[_chnl] * ( 1.0f / 6.0f );
+		}
+		
+		// 3x onepole filters with 4x oversampling and interpolation of oversampled signal:
+		// input signal is linear-interpolated after oversampling, output signal is averaged from oversampled outputs
+		else if constexpr( T == FilterType::Tripole )
+		{
+			sample_t out = 0.0f;
+			float ip = 0.0f;
+			for( int i = 0; i < 4; ++i )
+			{
+				ip += 0.25f;
+				sample_t x = linearInterpolate( m_last[_chnl], _in0, ip ) - m_r * m_y3[_chnl];
+				
 				m_y1[_chnl] = std::clamp((x + m_oldx[_chnl]) * m_p
-							- m_k * m_y1[_chnl], -10.0f,
-								10.0f);
+						- m_k * m_y1[_chnl], -10.0f,
+							10.0f);
 				m_y2[_chnl] = std::clamp((m_y1[_chnl] + m_oldy1[_chnl]) * m_p
 							- m_k * m_y2[_chnl], -10.0f,
 								10.0f);
 				m_y3[_chnl] = std::clamp((m_y2[_chnl] + m_oldy2[_chnl]) * m_p
 							- m_k * m_y3[_chnl], -10.0f,
-								10.0f );
-				m_y4[_chnl] = std::clamp((m_y3[_chnl] + m_oldy3[_chnl]) * m_p
-							- m_k * m_y4[_chnl], -10.0f,
 								10.0f);
-
 				m_oldx[_chnl] = x;
 				m_oldy1[_chnl] = m_y1[_chnl];
 				m_oldy2[_chnl] = m_y2[_chnl];
-				m_oldy3[_chnl] = m_y3[_chnl];
-				out = m_y4[_chnl] - m_y4[_chnl] * m_y4[_chnl] *
-						m_y4[_chnl] * ( 1.0f / 6.0f );
-				break;
-			}
-			
-			// 3x onepole filters with 4x oversampling and interpolation of oversampled signal:
-			// input signal is linear-interpolated after oversampling, output signal is averaged from oversampled outputs
-			case FilterType::Tripole:
-			{
-				float ip = 0.0f;
-				for( int i = 0; i < 4; ++i )
-				{
-					ip += 0.25f;
-					sample_t x = linearInterpolate( m_last[_chnl], _in0, ip ) - m_r * m_y3[_chnl];
-					
-					m_y1[_chnl] = std::clamp((x + m_oldx[_chnl]) * m_p
-							- m_k * m_y1[_chnl], -10.0f,
-								10.0f);
-					m_y2[_chnl] = std::clamp((m_y1[_chnl] + m_oldy1[_chnl]) * m_p
-								- m_k * m_y2[_chnl], -10.0f,
-									10.0f);
-					m_y3[_chnl] = std::clamp((m_y2[_chnl] + m_oldy2[_chnl]) * m_p
-								- m_k * m_y3[_chnl], -10.0f,
-									10.0f);
-					m_oldx[_chnl] = x;
-					m_oldy1[_chnl] = m_y1[_chnl];
-					m_oldy2[_chnl] = m_y2[_chnl];
-					
-					out += ( m_y3[_chnl] - m_y3[_chnl] * m_y3[_chnl] * m_y3[_chnl] * ( 1.0f / 6.0f ) );
-				}
-				out *= 0.25f;
-				m_last[_chnl] = _in0;
-				return out;
+				
+				out += ( m_y3[_chnl] - m_y3[_chnl] * m_y3[_chnl] * m_y3[_chnl] * ( 1.0f / 6.0f ) );
 			}
+			out *= 0.25f;
+			m_last[_chnl] = _in0;
+			return out;
+		}
+		
+		// 4-pole state-variant lowpass filter, adapted from Nekobee source code
+		// and extended to other SV filter types
+		// /* Hal Chamberlin's state variable filter */
+		
+		else if constexpr( T == FilterType::Lowpass_SV || T == FilterType::Bandpass_SV )
+		{
+			float highpass;
 			
-			// 4-pole state-variant lowpass filter, adapted from Nekobee source code
-			// and extended to other SV filter types
-			// /* Hal Chamberlin's state variable filter */
-			
-			case FilterType::Lowpass_SV:
-			case FilterType::Bandpass_SV:
+			for( int i = 0; i < 2; ++i ) // 2x oversample
 			{
-				float highpass;
-				
-				for( int i = 0; i < 2; ++i ) // 2x oversample
-				{
-					m_delay2[_chnl] = m_delay2[_chnl] + m_svf1 * m_delay1[_chnl];				/* delay2/4 = lowpass output */
-					highpass = _in0 - m_delay2[_chnl] - m_svq * m_delay1[_chnl];
-					m_delay1[_chnl] = m_svf1 * highpass + m_delay1[_chnl];           			/* delay1/3 = bandpass output */
-
-					m_delay4[_chnl] = m_delay4[_chnl] + m_svf2 * m_delay3[_chnl];
-					highpass = m_delay2[_chnl] - m_delay4[_chnl] - m_svq * m_delay3[_chnl];
-					m_delay3[_chnl] = m_svf2 * highpass + m_delay3[_chnl];
-				}
+				m_delay2[_chnl] = m_delay2[_chnl] + m_svf1 * m_delay1[_chnl];				/* delay2/4 = lowpass output */
+				highpass = _in0 - m_delay2[_chnl] - m_svq * m_delay1[_chnl];
+				m_delay1[_chnl] = m_svf1 * highpass + m_delay1[_chnl];           			/* delay1/3 = bandpass output */
 
-				/* mix filter output into output buffer */
-				return m_type == FilterType::Lowpass_SV 
-					? m_delay4[_chnl]
-					: m_delay3[_chnl];
+				m_delay4[_chnl] = m_delay4[_chnl] + m_svf2 * m_delay3[_chnl];
+				highpass = m_delay2[_chnl] - m_delay4[_chnl] - m_svq * m_delay3[_chnl];
+				m_delay3[_chnl] = m_svf2 * highpass + m_delay3[_chnl];
 			}
-			
-			case FilterType::Highpass_SV:
-			{
-				float hp;
-				for( int i = 0; i < 2; ++i ) // 2x oversample
-				{				
-					m_delay2[_chnl] = m_delay2[_chnl] + m_svf1 * m_delay1[_chnl];
-					hp = _in0 - m_delay2[_chnl] - m_svq * m_delay1[_chnl];
-					m_delay1[_chnl] = m_svf1 * hp + m_delay1[_chnl];
-				}
-				
-				return hp;
+
+			/* mix filter output into output buffer */
+			return T == FilterType::Lowpass_SV 
+				? m_delay4[_chnl]
+				: m_delay3[_chnl];
+		}
+		
+		else if constexpr( T == FilterType::Highpass_SV )
+		{
+			float hp;
+			for( int i = 0; i < 2; ++i ) // 2x oversample
+			{				
+				m_delay2[_chnl] = m_delay2[_chnl] + m_svf1 * m_delay1[_chnl];
+				hp = _in0 - m_delay2[_chnl] - m_svq * m_delay1[_chnl];
+				m_delay1[_chnl] = m_svf1 * hp + m_delay1[_chnl];
 			}
 			
-			case FilterType::Notch_SV:
+			return hp;
+		}
+		
+		else if constexpr( T == FilterType::Notch_SV )
+		{
+			float hp1;
+			for( int i = 0; i < 2; ++i ) // 2x oversample
 			{
-				float hp1;
-				for( int i = 0; i < 2; ++i ) // 2x oversample
-				{
-					m_delay2[_chnl] = m_delay2[_chnl] + m_svf1 * m_delay1[_chnl];				/* delay2/4 = lowpass output */
-					hp1 = _in0 - m_delay2[_chnl] - m_svq * m_delay1[_chnl];
-					m_delay1[_chnl] = m_svf1 * hp1 + m_delay1[_chnl];           			/* delay1/3 = bandpass output */
-
-					m_delay4[_chnl] = m_delay4[_chnl] + m_svf2 * m_delay3[_chnl];
-					float hp2 = m_delay2[_chnl] - m_delay4[_chnl] - m_svq * m_delay3[_chnl];
-					m_delay3[_chnl] = m_svf2 * hp2 + m_delay3[_chnl];
-				}
+				m_delay2[_chnl] = m_delay2[_chnl] + m_svf1 * m_delay1[_chnl];				/* delay2/4 = lowpass output */
+				hp1 = _in0 - m_delay2[_chnl] - m_svq * m_delay1[_chnl];
+				m_delay1[_chnl] = m_svf1 * hp1 + m_delay1[_chnl];           			/* delay1/3 = bandpass output */
 
-				/* mix filter output into output buffer */
-				return m_delay4[_chnl] + hp1;
+				m_delay4[_chnl] = m_delay4[_chnl] + m_svf2 * m_delay3[_chnl];
+				float hp2 = m_delay2[_chnl] - m_delay4[_chnl] - m_svq * m_delay3[_chnl];
+				m_delay3[_chnl] = m_svf2 * hp2 + m_delay3[_chnl];
 			}
 
+			/* mix filter output into output buffer */
+			return m_delay4[_chnl] + hp1;
+		}
+
 
-			// 4-times oversampled simulation of an active RC-Bandpass,-Lowpass,-Highpass-
-			// Filter-Network as it was used in nearly all modern analog synthesizers. This
-			// can be driven up to self-oscillation (BTW: do not remove the limits!!!).
-			// (C) 1998 ... 2009 S.Fendt. Released under the GPL v2.0  or any later version.
+		// 4-times oversampled simulation of an active RC-Bandpass,-Lowpass,-Highpass-
+		// Filter-Network as it was used in nearly all modern analog synthesizers. This
+		// can be driven up to self-oscillation (BTW: do not remove the limits!!!).
+		// (C) 1998 ... 2009 S.Fendt. Released under the GPL v2.0  or any later version.
 
-			case FilterType::Lowpass_RC12:
+		else if constexpr( T == FilterType::Lowpass_RC12 )
+		{
+			sample_t lp = 0.0f;
+			for( int n = 4; n != 0; --n )
 			{
-				sample_t lp = 0.0f;
-				for( int n = 4; n != 0; --n )
-				{
-					sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					lp = in * m_rcb + m_rclp0[_chnl] * m_rca;
-					lp = std::clamp(lp, -1.0f, 1.0f);
+				lp = in * m_rcb + m_rclp0[_chnl] * m_rca;
+				lp = std::clamp(lp, -1.0f, 1.0f);
 
-					sample_t hp = m_rcc * (m_rchp0[_chnl] + in - m_rclast0[_chnl]);
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				sample_t hp = m_rcc * (m_rchp0[_chnl] + in - m_rclast0[_chnl]);
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					sample_t bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				sample_t bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_rclast0[_chnl] = in;
-					m_rclp0[_chnl] = lp;
-					m_rchp0[_chnl] = hp;
-					m_rcbp0[_chnl] = bp;
-				}
-				return lp;
+				m_rclast0[_chnl] = in;
+				m_rclp0[_chnl] = lp;
+				m_rchp0[_chnl] = hp;
+				m_rcbp0[_chnl] = bp;
 			}
-			case FilterType::Highpass_RC12:
-			case FilterType::Bandpass_RC12:
+			return lp;
+		}
+		else if constexpr( T == FilterType::Highpass_RC12 || T == FilterType::Bandpass_RC12 )
+		{
+			sample_t hp, bp;
+			for( int n = 4; n != 0; --n )
 			{
-				sample_t hp, bp;
-				for( int n = 4; n != 0; --n )
-				{
-					sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_rcc * ( m_rchp0[_chnl] + in - m_rclast0[_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_rcc * ( m_rchp0[_chnl] + in - m_rclast0[_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_rclast0[_chnl] = in;
-					m_rchp0[_chnl] = hp;
-					m_rcbp0[_chnl] = bp;
-				}
-				return m_type == FilterType::Highpass_RC12 ? hp : bp;
+				m_rclast0[_chnl] = in;
+				m_rchp0[_chnl] = hp;
+				m_rcbp0[_chnl] = bp;
 			}
+			return T == FilterType::Highpass_RC12 ? hp : bp;
+		}
 
-			case FilterType::Lowpass_RC24:
+		else if constexpr( T == FilterType::Lowpass_RC24 )
+		{
+			sample_t lp;
+			for( int n = 4; n != 0; --n )
 			{
-				sample_t lp;
-				for( int n = 4; n != 0; --n )
-				{
-					// first stage is as for the 12dB case...
-					sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				// first stage is as for the 12dB case...
+				sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					lp = in * m_rcb + m_rclp0[_chnl] * m_rca;
-					lp = std::clamp(lp, -1.0f, 1.0f);
+				lp = in * m_rcb + m_rclp0[_chnl] * m_rca;
+				lp = std::clamp(lp, -1.0f, 1.0f);
 
-					sample_t hp = m_rcc * ( m_rchp0[_chnl] + in - m_rclast0[_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				sample_t hp = m_rcc * ( m_rchp0[_chnl] + in - m_rclast0[_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					sample_t bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				sample_t bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_rclast0[_chnl] = in;
-					m_rclp0[_chnl] = lp;
-					m_rcbp0[_chnl] = bp;
-					m_rchp0[_chnl] = hp;
+				m_rclast0[_chnl] = in;
+				m_rclp0[_chnl] = lp;
+				m_rcbp0[_chnl] = bp;
+				m_rchp0[_chnl] = hp;
 
-					// second stage gets the output of the first stage as input...
-					in = lp + m_rcbp1[_chnl] * m_rcq;
-					in = std::clamp(in, -1.0f, 1.0f );
+				// second stage gets the output of the first stage as input...
+				in = lp + m_rcbp1[_chnl] * m_rcq;
+				in = std::clamp(in, -1.0f, 1.0f );
 
-					lp = in * m_rcb + m_rclp1[_chnl] * m_rca;
-					lp = std::clamp(lp, -1.0f, 1.0f);
+				lp = in * m_rcb + m_rclp1[_chnl] * m_rca;
+				lp = std::clamp(lp, -1.0f, 1.0f);
 
-					hp = m_rcc * ( m_rchp1[_chnl] + in - m_rclast1[_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_rcc * ( m_rchp1[_chnl] + in - m_rclast1[_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_rcb + m_rcbp1[_chnl] * m_rca;
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_rcb + m_rcbp1[_chnl] * m_rca;
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_rclast1[_chnl] = in;
-					m_rclp1[_chnl] = lp;
-					m_rcbp1[_chnl] = bp;
-					m_rchp1[_chnl] = hp;
-				}
-				return lp;
+				m_rclast1[_chnl] = in;
+				m_rclp1[_chnl] = lp;
+				m_rcbp1[_chnl] = bp;
+				m_rchp1[_chnl] = hp;
 			}
-			case FilterType::Highpass_RC24:
-			case FilterType::Bandpass_RC24:
+			return lp;
+		}
+		else if constexpr( T == FilterType::Highpass_RC24 || T == FilterType::Bandpass_RC24 )
+		{
+			sample_t hp, bp;
+			for( int n = 4; n != 0; --n )
 			{
-				sample_t hp, bp;
-				for( int n = 4; n != 0; --n )
-				{
-					// first stage is as for the 12dB case...
-					sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				// first stage is as for the 12dB case...
+				sample_t in = _in0 + m_rcbp0[_chnl] * m_rcq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_rcc * ( m_rchp0[_chnl] + in - m_rclast0[_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_rcc * ( m_rchp0[_chnl] + in - m_rclast0[_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_rcb + m_rcbp0[_chnl] * m_rca;
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_rclast0[_chnl] = in;
-					m_rchp0[_chnl] = hp;
-					m_rcbp0[_chnl] = bp;
+				m_rclast0[_chnl] = in;
+				m_rchp0[_chnl] = hp;
+				m_rcbp0[_chnl] = bp;
 
-					// second stage gets the output of the first stage as input...
-					in = m_type == FilterType::Highpass_RC24
-						? hp + m_rcbp1[_chnl] * m_rcq
-						: bp + m_rcbp1[_chnl] * m_rcq;
+				// second stage gets the output of the first stage as input...
+				in = T == FilterType::Highpass_RC24
+					? hp + m_rcbp1[_chnl] * m_rcq
+					: bp + m_rcbp1[_chnl] * m_rcq;
 
-					in = std::clamp(in, -1.0f, 1.0f);
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_rcc * ( m_rchp1[_chnl] + in - m_rclast1[_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_rcc * ( m_rchp1[_chnl] + in - m_rclast1[_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_rcb + m_rcbp1[_chnl] * m_rca;
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_rcb + m_rcbp1[_chnl] * m_rca;
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_rclast1[_chnl] = in;
-					m_rchp1[_chnl] = hp;
-					m_rcbp1[_chnl] = bp;
-				}
-				return m_type == FilterType::Highpass_RC24 ? hp : bp;
+				m_rclast1[_chnl] = in;
+				m_rchp1[_chnl] = hp;
+				m_rcbp1[_chnl] = bp;
 			}
+			return T == FilterType::Highpass_RC24 ? hp : bp;
+		}
 
-			case FilterType::Formantfilter:
-			case FilterType::FastFormant:
-			{
-				if (std::abs(_in0) < 1.0e-10f && std::abs(m_vflast[0][_chnl]) < 1.0e-10f) { return 0.0f; } // performance hack - skip processing when the numbers get too small
+		else if constexpr( T == FilterType::Formantfilter || T == FilterType::FastFormant )
+		{
+			if (std::abs(_in0) < 1.0e-10f && std::abs(m_vflast[0][_chnl]) < 1.0e-10f) { return 0.0f; } // performance hack - skip processing when the numbers get too small
 
-				const int os = m_type == FilterType::FastFormant ? 1 : 4; // no oversampling for fast formant
-				for( int o = 0; o < os; ++o )
-				{
-					// first formant
-					sample_t in = _in0 + m_vfbp[0][_chnl] * m_vfq;
-					in = std::clamp(in, -1.0f, 1.0f);
+			sample_t out = 0.0f;
+			const int os = T == FilterType::FastFormant ? 1 : 4; // no oversampling for fast formant
+			for( int o = 0; o < os; ++o )
+			{
+				// first formant
+				sample_t in = _in0 + m_vfbp[0][_chnl] * m_vfq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					sample_t hp = m_vfc[0] * ( m_vfhp[0][_chnl] + in - m_vflast[0][_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				sample_t hp = m_vfc[0] * ( m_vfhp[0][_chnl] + in - m_vflast[0][_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					sample_t bp = hp * m_vfb[0] + m_vfbp[0][_chnl] * m_vfa[0];
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				sample_t bp = hp * m_vfb[0] + m_vfbp[0][_chnl] * m_vfa[0];
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_vflast[0][_chnl] = in;
-					m_vfhp[0][_chnl] = hp;
-					m_vfbp[0][_chnl] = bp;
+				m_vflast[0][_chnl] = in;
+				m_vfhp[0][_chnl] = hp;
+				m_vfbp[0][_chnl] = bp;
 
-					in = bp + m_vfbp[2][_chnl] * m_vfq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				in = bp + m_vfbp[2][_chnl] * m_vfq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_vfc[0] * ( m_vfhp[2][_chnl] + in - m_vflast[2][_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_vfc[0] * ( m_vfhp[2][_chnl] + in - m_vflast[2][_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_vfb[0] + m_vfbp[2][_chnl] * m_vfa[0];
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_vfb[0] + m_vfbp[2][_chnl] * m_vfa[0];
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_vflast[2][_chnl] = in;
-					m_vfhp[2][_chnl] = hp;
-					m_vfbp[2][_chnl] = bp;
+				m_vflast[2][_chnl] = in;
+				m_vfhp[2][_chnl] = hp;
+				m_vfbp[2][_chnl] = bp;
 
-					in = bp + m_vfbp[4][_chnl] * m_vfq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				in = bp + m_vfbp[4][_chnl] * m_vfq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_vfc[0] * ( m_vfhp[4][_chnl] + in - m_vflast[4][_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_vfc[0] * ( m_vfhp[4][_chnl] + in - m_vflast[4][_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_vfb[0] + m_vfbp[4][_chnl] * m_vfa[0];
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_vfb[0] + m_vfbp[4][_chnl] * m_vfa[0];
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_vflast[4][_chnl] = in;
-					m_vfhp[4][_chnl] = hp;
-					m_vfbp[4][_chnl] = bp;
+				m_vflast[4][_chnl] = in;
+				m_vfhp[4][_chnl] = hp;
+				m_vfbp[4][_chnl] = bp;
 
-					out += bp;
+				out += bp;
 
-					// second formant
-					in = _in0 + m_vfbp[0][_chnl] * m_vfq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				// second formant
+				in = _in0 + m_vfbp[0][_chnl] * m_vfq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_vfc[1] * ( m_vfhp[1][_chnl] + in - m_vflast[1][_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_vfc[1] * ( m_vfhp[1][_chnl] + in - m_vflast[1][_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_vfb[1] + m_vfbp[1][_chnl] * m_vfa[1];
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_vfb[1] + m_vfbp[1][_chnl] * m_vfa[1];
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_vflast[1][_chnl] = in;
-					m_vfhp[1][_chnl] = hp;
-					m_vfbp[1][_chnl] = bp;
+				m_vflast[1][_chnl] = in;
+				m_vfhp[1][_chnl] = hp;
+				m_vfbp[1][_chnl] = bp;
 
-					in = bp + m_vfbp[3][_chnl] * m_vfq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				in = bp + m_vfbp[3][_chnl] * m_vfq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_vfc[1] * ( m_vfhp[3][_chnl] + in - m_vflast[3][_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_vfc[1] * ( m_vfhp[3][_chnl] + in - m_vflast[3][_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_vfb[1] + m_vfbp[3][_chnl] * m_vfa[1];
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_vfb[1] + m_vfbp[3][_chnl] * m_vfa[1];
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_vflast[3][_chnl] = in;
-					m_vfhp[3][_chnl] = hp;
-					m_vfbp[3][_chnl] = bp;
+				m_vflast[3][_chnl] = in;
+				m_vfhp[3][_chnl] = hp;
+				m_vfbp[3][_chnl] = bp;
 
-					in = bp + m_vfbp[5][_chnl] * m_vfq;
-					in = std::clamp(in, -1.0f, 1.0f);
+				in = bp + m_vfbp[5][_chnl] * m_vfq;
+				in = std::clamp(in, -1.0f, 1.0f);
 
-					hp = m_vfc[1] * ( m_vfhp[5][_chnl] + in - m_vflast[5][_chnl] );
-					hp = std::clamp(hp, -1.0f, 1.0f);
+				hp = m_vfc[1] * ( m_vfhp[5][_chnl] + in - m_vflast[5][_chnl] );
+				hp = std::clamp(hp, -1.0f, 1.0f);
 
-					bp = hp * m_vfb[1] + m_vfbp[5][_chnl] * m_vfa[1];
-					bp = std::clamp(bp, -1.0f, 1.0f);
+				bp = hp * m_vfb[1] + m_vfbp[5][_chnl] * m_vfa[1];
+				bp = std::clamp(bp, -1.0f, 1.0f);
 
-					m_vflast[5][_chnl] = in;
-					m_vfhp[5][_chnl] = hp;
-					m_vfbp[5][_chnl] = bp;
+				m_vflast[5][_chnl] = in;
+				m_vfhp[5][_chnl] = hp;
+				m_vfbp[5][_chnl] = bp;
 
-					out += bp;
-				}
-            	return m_type == FilterType::FastFormant ? out * 2.0f : out * 0.5f;
+				out += bp;
 			}
-
-			default:
-				out = m_biQuad.update( _in0, _chnl );
-				break;
+			return T == FilterType::FastFormant ? out * 2.0f : out * 0.5f;
 		}
-
-		if( m_doubleFilter )
+		else
 		{
-			return m_subFilter->update( out, _chnl );
+			return m_biQuad.update( _in0, _chnl );
 		}
-
-		// Clipper band limited sigmoid
-		return out;
 	}
 
 
+public:
 	inline void calcFilterCoeffs( float _freq, float _q )
 	{
 		// temp coef vars
@@ -866,6 +1039,7 @@ public:
 		{
 			m_subFilter->m_biQuad.setCoeffs( m_biQuad.m_a1, m_biQuad.m_a2, m_biQuad.m_b0, m_biQuad.m_b1, m_biQuad.m_b2 );
 		}
+		m_biQuadValid = true;
 	}
 
 
@@ -903,12 +1077,176 @@ private:
 	frame m_delay1, m_delay2, m_delay3, m_delay4;
 
 	FilterType m_type;
+	//! the type as passed to setFilterType(), including the double filters
+	FilterType m_typeIndex;
+	//! whether m_biQuad holds coefficients for the current type
+	bool m_biQuadValid;
 	bool m_doubleFilter;
 
 	float m_sampleRate;
 	float m_sampleRatio;
 	BasicFilters<CHANNELS> * m_subFilter;
 
+	template<int> friend class BiQuadBatch;
+} ;
+
+
+
+
+/*! \brief Runs the biquad based BasicFilters of several voices at once
+ *
+ * The filter states and coefficients of up to VOICES stereo voices are kept
+ * in structure-of-arrays form, one lane per voice and channel, so the inner
+ * loop runs over all lanes and can be vectorised by the compiler. All voices
+ * of a batch must use the same biquad filter type (single or double).
+ *
+ * The voice filters stay the owners of the state: add() loads it into the
+ * batch and store() writes it back, so voices can move freely between the
+ * batched and the scalar code path.
+ */
+template<int VOICES>
+class BiQuadBatch
+{
+public:
+	static constexpr int Lanes = VOICES * DEFAULT_CHANNELS;
+	using Frame = std::array<sample_t, Lanes>;
+
+	BiQuadBatch()
+	{
+		clear();
+	}
+
+	inline void clear()
+	{
+		m_voices = 0;
+		m_doubleFilter = false;
+		m_filters.fill( nullptr );
+		for( auto& stage : m_z1 ) { stage.fill( 0.0f ); }
+		for( auto& stage : m_z2 ) { stage.fill( 0.0f ); }
+	}
+
+	inline int size() const
+	{
+		return m_voices;
+	}
+
+	//! Add a voice, returns false if its filter can't be processed by this batch
+	inline bool add( BasicFilters<>* filter )
+	{
+		if( m_voices == VOICES || !BasicFilters<>::isBiQuad( filter->m_type ) ||
+			( m_voices > 0 && filter->m_doubleFilter != m_doubleFilter ) )
+		{
+			return false;
+		}
+
+		const int v = m_voices++;
+		m_filters[v] = filter;
+		m_doubleFilter = filter->m_doubleFilter;
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			const int lane = v * DEFAULT_CHANNELS + ch;
+			m_z1[0][lane] = filter->m_biQuad.m_z1[ch];
+			m_z2[0][lane] = filter->m_biQuad.m_z2[ch];
+			if( m_doubleFilter )
+			{
+				m_z1[1][lane] = filter->m_subFilter->m_biQuad.m_z1[ch];
+				m_z2[1][lane] = filter->m_subFilter->m_biQuad.m_z2[ch];
+			}
+		}
+		return true;
+	}
+
+	inline void store()
+	{
+		for( int v = 0; v < m_voices; ++v )
+		{
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				const int lane = v * DEFAULT_CHANNELS + ch;
+				m_filters[v]->m_biQuad.m_z1[ch] = m_z1[0][lane];
+				m_filters[v]->m_biQuad.m_z2[ch] = m_z2[0][lane];
+				if( m_doubleFilter )
+				{
+					m_filters[v]->m_subFilter->m_biQuad.m_z1[ch] = m_z1[1][lane];
+					m_filters[v]->m_subFilter->m_biQuad.m_z2[ch] = m_z2[1][lane];
+				}
+			}
+		}
+	}
+
+	//! Filter \p frames frames of all voices while moving each voice's
+	//! coefficients linearly towards the ones for \p freq[v] and \p q[v],
+	//! just like BasicFilters::processBlock() does for a single voice
+	inline void process( Frame* buf, const fpp_t frames, const float* freq, const float* q )
+	{
+		Coeffs from = {};
+		Coeffs to = {};
+		for( int v = 0; v < m_voices; ++v )
+		{
+			auto filter = m_filters[v];
+			const bool ramp = filter->m_biQuadValid;
+			const auto prev = filter->m_biQuad.coeffs();
+			filter->calcFilterCoeffs( freq[v], q[v] );
+			const auto next = filter->m_biQuad.coeffs();
+			for( std::size_t c = 0; c < next.size(); ++c )
+			{
+				for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+				{
+					from[c][v * DEFAULT_CHANNELS + ch] = ramp ? prev[c] : next[c];
+					to[c][v * DEFAULT_CHANNELS + ch] = next[c];
+				}
+			}
+		}
+
+		processStage( buf, frames, from, to, m_z1[0], m_z2[0] );
+		if( m_doubleFilter )
+		{
+			processStage( buf, frames, from, to, m_z1[1], m_z2[1] );
+		}
+	}
+
+private:
+	using Coeffs = std::array<Frame, 5>;
+
+	static inline void processStage( Frame* buf, const fpp_t frames, Coeffs c, const Coeffs& to, Frame& z1, Frame& z2 )
+	{
+		const float step = 1.0f / frames;
+		Coeffs delta;
+		for( std::size_t i = 0; i < c.size(); ++i )
+		{
+			for( int l = 0; l < Lanes; ++l )
+			{
+				delta[i][l] = ( to[i][l] - c[i][l] ) * step;
+			}
+		}
+
+		auto& [a1, a2, b0, b1, b2] = c;
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			for( int l = 0; l < Lanes; ++l )
+			{
+				a1[l] += delta[0][l];
+				a2[l] += delta[1][l];
+				b0[l] += delta[2][l];
+				b1[l] += delta[3][l];
+				b2[l] += delta[4][l];
+
+				// biquad filter in transposed form, see BiQuad::update()
+				const float in = buf[f][l];
+				const float out = z1[l] + b0[l] * in;
+				z1[l] = b1[l] * in + z2[l] - a1[l] * out;
+				z2[l] = b2[l] * in - a2[l] * out;
+				buf[f][l] = out;
+			}
+		}
+	}
+
+	int m_voices;
+	bool m_doubleFilter;
+	std::array<BasicFilters<>*, VOICES> m_filters;
+	// filter states, the second stage is used by the double filters only
+	std::array<Frame, 2> m_z1;
+	std::array<Frame, 2> m_z2;
 } ;
 
 
@@ -0,0 +1,145 @@
+/*
+ * CompensationDelay.h - delay line aligning parallel signal paths
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_COMPENSATION_DELAY_H
+#define LMMS_COMPENSATION_DELAY_H
+
+#include <algorithm>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "SampleFrame.h"
+
+namespace lmms
+{
+
+/**
+	Integer delay line used by the plugin delay compensation.
+
+	The Mixer delays every audio port and every route by the difference
+	between the latency of the path and the latency of the slowest path into
+	the same mixer channel, so all signals arrive in time. Setting the delay
+	allocates and must only be done while the audio engine is locked; all
+	other methods are meant for the audio thread.
+*/
+class CompensationDelay
+{
+public:
+	CompensationDelay() :
+		m_delay( 0 ),
+		m_position( 0 ),
+		m_tail( 0 )
+	{
+	}
+
+	f_cnt_t delay() const
+	{
+		return m_delay;
+	}
+
+	//! Change the delay, discarding the audio which is currently delayed
+	void setDelay( f_cnt_t delay )
+	{
+		if( delay == m_delay )
+		{
+			return;
+		}
+		m_buffer.assign( delay, SampleFrame() );
+		m_buffer.shrink_to_fit();
+		m_delay = delay;
+		m_position = 0;
+		m_tail = 0;
+	}
+
+	//! Returns whether audio written before is still waiting to be output
+	bool hasTail() const
+	{
+		return m_tail > 0;
+	}
+
+	//! Delay \p frames frames from \p in into \p out, which may be the same buffer
+	void process( const SampleFrame* in, SampleFrame* out, fpp_t frames )
+	{
+		if( m_delay == 0 )
+		{
+			if( in != out )
+			{
+				std::copy( in, in + frames, out );
+			}
+			return;
+		}
+
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			const SampleFrame delayed = m_buffer[m_position];
+			m_buffer[m_position] = in[f];
+			out[f] = delayed;
+			if( ++m_position == m_delay )
+			{
+				m_position = 0;
+			}
+		}
+		m_tail = m_delay;
+	}
+
+	//! Output the next \p frames delayed frames while feeding silence
+	void drain( SampleFrame* out, fpp_t frames )
+	{
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			if( m_delay > 0 )
+			{
+				out[f] = m_buffer[m_position];
+				m_buffer[m_position] = SampleFrame();
+				if( ++m_position == m_delay )
+				{
+					m_position = 0;
+				}
+			}
+			else
+			{
+				out[f] = SampleFrame();
+			}
+		}
+		m_tail -= std::min<f_cnt_t>( m_tail, frames );
+	}
+
+	//! Forget all delayed audio
+	void clear()
+	{
+		std::fill( m_buffer.begin(), m_buffer.end(), SampleFrame() );
+		m_tail = 0;
+	}
+
+private:
+	std::vector<SampleFrame> m_buffer;
+	f_cnt_t m_delay;
+	f_cnt_t m_position;
+	f_cnt_t m_tail;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_COMPENSATION_DELAY_H
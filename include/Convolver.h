@@ -0,0 +1,186 @@
+/*
+ * Convolver.h - zero latency partitioned convolution with impulse responses
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_CONVOLVER_H
+#define LMMS_CONVOLVER_H
+
+#include <QString>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "SampleFrame.h"
+
+namespace lmms
+{
+
+class SampleBuffer;
+
+/*
+	The impulse response is split into a head, which is convolved directly,
+	and stages of uniformly partitioned FFT convolution with growing
+	partition sizes, so together they are non-uniformly partitioned:
+
+	  taps           partition size   computed
+	  [0, 64)        -                in the audio thread, frame by frame
+	  [64, 1024)     64               in the audio thread, every 64 frames
+	  [1024, 8192)   512              on the ThreadPool, every 512 frames
+	  [8192, end)    4096             on the ThreadPool, every 4096 frames
+
+	A stage can only transform a block of input once all of its partition
+	size P frames are there. The synchronous stage starts at P taps, so its
+	result is due just when its block is complete. The other stages start at
+	2 P taps, so their job has the time of the next block to finish, and is
+	only waited for when its result is due. Nothing is ever delayed.
+*/
+
+
+//! The spectra of an impulse response, split into the partitions of a Convolver
+class LMMS_EXPORT ImpulseResponse
+{
+public:
+	static constexpr f_cnt_t HeadLength = 64;
+	static constexpr int StageCount = 3;
+	static constexpr std::array<f_cnt_t, StageCount> PartitionSize = {64, 512, 4096};
+	//! First tap of each stage, the last one reaches to the end of the response
+	static constexpr std::array<f_cnt_t, StageCount> StageOffset = {64, 1024, 8192};
+
+	//! The partitions of one stage, PartitionSize + 1 bins after each other per channel
+	struct Spectra
+	{
+		f_cnt_t partitions = 0;
+		std::array<std::vector<float>, DEFAULT_CHANNELS> real;
+		std::array<std::vector<float>, DEFAULT_CHANNELS> imag;
+	} ;
+
+	//! Decode \p file and partition it for \p sampleRate. Every convolver
+	//! using the same file at the same rate shares the result. Returns nullptr
+	//! if the file couldn't be loaded. Only call this from the main thread,
+	//! the FFTW planner isn't thread safe.
+	static std::shared_ptr<const ImpulseResponse> load(const QString& file, sample_rate_t sampleRate);
+
+	ImpulseResponse(const SampleBuffer& buffer, sample_rate_t sampleRate);
+
+	//! The file as stored by SampleBuffer, i.e. relative where possible
+	const QString& file() const
+	{
+		return m_file;
+	}
+
+	f_cnt_t length() const
+	{
+		return m_length;
+	}
+
+	//! Gain bringing the energy of the louder channel to 1
+	float normalization() const
+	{
+		return m_normalization;
+	}
+
+	//! The taps of the head per channel, last tap first
+	const std::array<std::array<float, HeadLength>, DEFAULT_CHANNELS>& head() const
+	{
+		return m_head;
+	}
+
+	const Spectra& spectra(int stage) const
+	{
+		return m_spectra[stage];
+	}
+
+private:
+	QString m_file;
+	f_cnt_t m_length = 0;
+	float m_normalization = 1.f;
+	std::array<std::array<float, HeadLength>, DEFAULT_CHANNELS> m_head = {};
+	std::array<Spectra, StageCount> m_spectra;
+} ;
+
+
+/**
+	Convolves a stereo signal with an ImpulseResponse, channel by channel,
+	without latency.
+
+	process() accepts any number of frames. The stages only run at multiples
+	of their partition size, so the cost of a call depends on how many of
+	them it crosses. The asynchronous stages are handed to the ThreadPool,
+	which allocates, unless \p useThreadPool is false; then they run in the
+	calling thread, with the same timing.
+
+	The constructor allocates and plans the FFTs and must only be called from
+	the main thread.
+*/
+class LMMS_EXPORT Convolver
+{
+public:
+	explicit Convolver(std::shared_ptr<const ImpulseResponse> ir, bool useThreadPool = true);
+	~Convolver();
+
+	Convolver(const Convolver&) = delete;
+	Convolver& operator=(const Convolver&) = delete;
+
+	//! \p in and \p out may be the same buffer
+	void process(const SampleFrame* in, SampleFrame* out, fpp_t frames);
+
+	//! Forget the input so far, waits for running jobs
+	void reset();
+
+	const ImpulseResponse& impulseResponse() const
+	{
+		return *m_ir;
+	}
+
+private:
+	class Stage;
+
+	//! Frames up to the next multiple of HeadLength
+	void processChunk(const SampleFrame* in, SampleFrame* out, fpp_t frames);
+
+	//! Run the stages at a multiple of HeadLength
+	void runStages();
+
+	//! Add the output of a stage, which starts \p time frames into the signal
+	void addToOutput(const std::vector<SampleFrame>& block, f_cnt_t time);
+
+	std::shared_ptr<const ImpulseResponse> m_ir;
+
+	//! Input of the head with the last HeadLength - 1 frames in front, per channel
+	std::array<std::vector<float>, DEFAULT_CHANNELS> m_headInput;
+
+	std::vector<std::unique_ptr<Stage>> m_stages;
+
+	//! Ring buffer the stages add their output to, ahead of time
+	std::vector<SampleFrame> m_output;
+
+	//! Frames processed since the last reset
+	f_cnt_t m_time = 0;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_CONVOLVER_H
@@ -107,9 +107,9 @@ public:
 		return &m_controls;
 	}
 
-	bool processAudioBuffer( SampleFrame*, const fpp_t ) override
+	ProcessStatus processImpl( SampleFrame*, const fpp_t ) override
 	{
-		return false;
+		return ProcessStatus::Sleep;
 	}
 
 	const QDomElement& originalPluginData() const
@@ -0,0 +1,236 @@
+/*
+ * Dynamics.h - building blocks for compressors and limiters
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_DYNAMICS_H
+#define LMMS_DYNAMICS_H
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "SampleFrame.h"
+
+namespace lmms
+{
+
+/*
+	The classes in this file process blocks of up to MAXIMUM_BLOCK_SIZE
+	frames, with the two channels side by side in the lanes of a SampleFrame.
+	A dynamics processor chains them stage by stage over the whole block:
+	level and crest factor detection, the envelope follower, the lookahead
+	and finally the gain computer. Only the followers depend on their
+	previous frame; the other stages are plain loops over the block.
+	Nothing allocates outside of LookaheadDelay::resize().
+*/
+
+
+//! Absolute value or RMS of a signal, kept above a floor
+class LMMS_EXPORT LevelDetector
+{
+public:
+	explicit LevelDetector(float floor);
+
+	//! Detect the RMS with the given smoothing of the mean square instead of peaks
+	void setRms(bool rms, float timeConstant);
+
+	void process(const SampleFrame* in, SampleFrame* out, fpp_t frames);
+	void reset();
+
+private:
+	float m_floor;
+	bool m_rms = false;
+	float m_timeConstant = 0.f;
+	std::array<float, 2> m_meanSquare = {};
+} ;
+
+
+//! Ratio of the peak to the mean of the squared signal, smoothed over time
+class LMMS_EXPORT CrestFactorDetector
+{
+public:
+	explicit CrestFactorDetector(float floor);
+
+	void setTimeConstant(float timeConstant)
+	{
+		m_timeConstant = timeConstant;
+	}
+
+	void process(const SampleFrame* in, SampleFrame* out, fpp_t frames);
+	void reset();
+
+private:
+	float m_floor;
+	float m_timeConstant = 0.f;
+	std::array<float, 2> m_peak;
+	std::array<float, 2> m_meanSquare;
+} ;
+
+
+/**
+	Attack/release follower turning a detected level into the envelope the
+	gain is computed from.
+
+	With automatic timing, a crest factor above the neutral one shortens the
+	attack and release times, so transients are caught faster, while steady
+	signals are followed more slowly.
+*/
+class LMMS_EXPORT EnvelopeFollower
+{
+public:
+	explicit EnvelopeFollower(float floor);
+
+	void setSampleRate(float sampleRate);
+
+	//! Attack and release times in ms
+	void setTimes(float attack, float release);
+
+	//! How much the crest factor changes the attack and release times, 0 turns it off
+	void setAutoTime(float attackAmount, float releaseAmount, float neutralCrestFactor);
+
+	//! Frames the envelope doesn't release after an attack, cancels a running hold
+	void setHold(f_cnt_t frames);
+
+	//! \p crestFactor is only read if automatic timing is on
+	void process(const SampleFrame* level, const SampleFrame* crestFactor, SampleFrame* out, fpp_t frames);
+	void reset();
+
+	float envelope(int channel) const
+	{
+		return m_envelope[channel];
+	}
+
+	//! Smoothing coefficient of a time in ms
+	float coefficient(float ms) const
+	{
+		return ms == 0 ? 0 : std::exp(m_coefficientPrecalc / ms);
+	}
+
+private:
+	float m_floor;
+	float m_coefficientPrecalc = 0.f;
+	float m_attack = 0.f;
+	float m_release = 0.f;
+	float m_attackCoefficient = 0.f;
+	float m_releaseCoefficient = 0.f;
+	float m_autoAttack = 0.f;
+	float m_autoRelease = 0.f;
+	float m_neutralCrestFactor = 1.f;
+	f_cnt_t m_holdLength = 0;
+	std::array<f_cnt_t, 2> m_hold = {};
+	std::array<float, 2> m_envelope;
+} ;
+
+
+/**
+	Ring buffer delaying blocks by a fixed number of frames.
+
+	Every block is written once and can then be read at any delay up to the
+	one the buffer was sized for. Both only copy the one or two contiguous
+	parts of the ring, so no index has to be wrapped per frame.
+*/
+class LMMS_EXPORT LookaheadDelay
+{
+public:
+	//! Make room for delays up to \p maxDelay frames, filled with \p value.
+	//! This allocates and must not be called from the audio thread.
+	void resize(f_cnt_t maxDelay, float value);
+
+	void fill(float value);
+
+	void write(const SampleFrame* in, fpp_t frames);
+
+	//! The last \p frames frames written, delayed by \p delay frames
+	void read(SampleFrame* out, fpp_t frames, f_cnt_t delay) const;
+
+	//! The larger one of the last \p frames frames written, delayed by \p delay
+	//! frames, and the same frames \p lookahead (<= \p delay) frames later
+	void readWithLookahead(SampleFrame* out, fpp_t frames, f_cnt_t delay, f_cnt_t lookahead) const;
+
+private:
+	std::vector<SampleFrame> m_buffer;
+	f_cnt_t m_position = 0;
+} ;
+
+
+/**
+	Gain of a soft knee compressor for envelope levels in amplitude.
+
+	Below the knee the gain is 1, above it it's a power of the level. Only
+	levels within the knee need the conversion to dB and back.
+*/
+class LMMS_EXPORT CompressorGain
+{
+public:
+	//! \p threshold and \p knee in dB, \p ratio as output / input
+	void setCurve(float threshold, float ratio, float knee);
+
+	float gain(float level) const;
+	void process(const SampleFrame* envelope, SampleFrame* out, fpp_t frames) const;
+
+private:
+	float m_threshold = 0.f;
+	float m_ratio = 1.f;
+	float m_knee = 0.f;
+	float m_kneeStart = 1.f;
+	float m_kneeEnd = 1.f;
+	float m_scale = 1.f;
+} ;
+
+
+//! Output level in dB of a compressor lowering levels above \p threshold
+//! to \p ratio (output / input), with a soft knee reaching \p knee dB
+//! below and above the threshold
+inline float compressedLevel(float level, float threshold, float ratio, float knee)
+{
+	const float over = level - threshold;
+	if (over < -knee) { return level; }
+	if (over < knee)
+	{
+		const float kneeOver = over + knee;
+		return level + (ratio - 1) * kneeOver * kneeOver / (4 * knee);
+	}
+	return threshold + over * ratio;
+}
+
+
+//! Output level in dB of an upward compressor raising levels below
+//! \p threshold to \p ratio (output / input)
+inline float upwardCompressedLevel(float level, float threshold, float ratio, float knee)
+{
+	if (level - threshold > knee) { return level; }
+	const float under = threshold - level;
+	if (under < knee)
+	{
+		const float kneeUnder = under + knee;
+		return level + (1 - ratio) * kneeUnder * kneeUnder / (4 * knee);
+	}
+	return threshold + (level - threshold) * ratio;
+}
+
+
+} // namespace lmms
+
+#endif // LMMS_DYNAMICS_H
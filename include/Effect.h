@@ -30,6 +30,8 @@
 #include "Engine.h"
 #include "AudioEngine.h"
 #include "AutomatableModel.h"
+#include "CompensationDelay.h"
+#include "Oversampler.h"
 #include "TempoSyncKnobModel.h"
 
 namespace lmms
@@ -63,9 +65,25 @@ public:
 		return "effect";
 	}
 
-	
-	virtual bool processAudioBuffer( SampleFrame* _buf,
-						const fpp_t _frames ) = 0;
+
+	//! What processImpl() wants to happen after a period
+	enum class ProcessStatus
+	{
+		//! Keep running, no matter what the output is
+		Continue,
+		//! Keep running until the output stays below the gate for the decay time
+		ContinueIfNotQuiet,
+		//! Stop running, the buffer has not been touched
+		Sleep
+	} ;
+
+	/**
+		Runs processImpl() on \p _buf and mixes the result with the dry
+		input according to the wet/dry level. The dry signal is delayed by
+		latency(), so both stay in time. Returns whether the effect is still
+		running.
+	*/
+	bool processAudioBuffer( SampleFrame* _buf, const fpp_t _frames );
 
 	inline ch_cnt_t processorCount() const
 	{
@@ -95,7 +113,7 @@ public:
 
 	inline void startRunning() 
 	{ 
-		m_bufferCount = 0;
+		m_quietFrames = 0;
 		m_running = true; 
 	}
 
@@ -109,10 +127,17 @@ public:
 		return m_enabledModel.value();
 	}
 
+	//! Expendable effects may be bypassed by the OverloadManager under critical CPU load
+	inline bool isExpendable() const
+	{
+		return m_expendableModel.value();
+	}
+
+	//! Frames of silence after which the effect stops running
 	inline f_cnt_t timeout() const
 	{
 		const float samples = Engine::audioEngine()->outputSampleRate() * m_autoQuitModel.value() / 1000.0f;
-		return 1 + ( static_cast<int>( samples ) / Engine::audioEngine()->framesPerPeriod() );
+		return static_cast<f_cnt_t>( samples );
 	}
 
 	inline float wetLevel() const
@@ -131,19 +156,19 @@ public:
 		return level*level * m_processors;
 	}
 
-	inline f_cnt_t bufferCount() const
+	inline f_cnt_t quietFrames() const
 	{
-		return m_bufferCount;
+		return m_quietFrames;
 	}
 
-	inline void resetBufferCount()
+	inline void resetQuietFrames()
 	{
-		m_bufferCount = 0;
+		m_quietFrames = 0;
 	}
 
-	inline void incrementBufferCount()
+	inline void addQuietFrames( const fpp_t _frames )
 	{
-		++m_bufferCount;
+		m_quietFrames += _frames;
 	}
 
 	inline bool dontRun() const
@@ -166,6 +191,19 @@ public:
 		return m_parent;
 	}
 
+	//! The delay of the oversampler plus processLatency()
+	f_cnt_t latency() const final
+	{
+		return m_oversampler.latency() + processLatency();
+	}
+
+	//! Return the number of frames by which processImpl() itself delays its
+	//! output, at the sample rate of the audio engine
+	virtual f_cnt_t processLatency() const
+	{
+		return 0;
+	}
+
 	virtual EffectControls * controls() = 0;
 
 	static Effect * instantiate( const QString & _plugin_name,
@@ -173,15 +211,22 @@ public:
 				Descriptor::SubPluginFeatures::Key * _key );
 
 
+signals:
+	//! Emitted from the audio thread when latency() has changed
+	void dryDelayOutdated();
+
 protected:
 	/**
-		Effects should call this at the end of audio processing
-
-		If the setting "Keep effects running even without input" is disabled,
-		after "decay" ms of a signal below "gate", the effect is turned off
-		and won't be processed again until it receives new audio input
+		Replace the frames in \p buf by the wet signal. \p frames can be
+		anything from 1 to MAXIMUM_BLOCK_SIZE and change from call to call,
+		so don't size buffers to the period; temporary buffers come from
+		ScratchArena. \p buf always starts at the beginning of a period, so
+		sample exact value buffers of the controls are indexed from 0.
 	*/
-	void checkGate( double _out_sum );
+	virtual ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) = 0;
+
+	//! Called instead of processImpl() while the effect is disabled or not running
+	virtual void processBypassedImpl() {}
 
 	gui::PluginView* instantiateView( QWidget * ) override;
 
@@ -189,43 +234,82 @@ protected:
 	// sample it down before processing and back after processing
 	inline void sampleDown( const SampleFrame* _src_buf,
 							SampleFrame* _dst_buf,
-							sample_rate_t _dst_sr )
+							sample_rate_t _dst_sr,
+							const fpp_t _frames )
 	{
 		resample( 0, _src_buf,
 				Engine::audioEngine()->outputSampleRate(),
 					_dst_buf, _dst_sr,
-					Engine::audioEngine()->framesPerPeriod() );
+					_frames, _frames );
 	}
 
+	//! \p _frames is the number of frames at the output sample rate
 	inline void sampleBack( const SampleFrame* _src_buf,
 							SampleFrame* _dst_buf,
-							sample_rate_t _src_sr )
+							sample_rate_t _src_sr,
+							const fpp_t _frames )
 	{
 		resample( 1, _src_buf, _src_sr, _dst_buf,
 				Engine::audioEngine()->outputSampleRate(),
-			Engine::audioEngine()->framesPerPeriod() * _src_sr /
-				Engine::audioEngine()->outputSampleRate() );
+			_frames * _src_sr /
+				Engine::audioEngine()->outputSampleRate(),
+			_frames );
 	}
 	void reinitSRC();
 
+	/**
+		Nonlinear effects can opt into running at 2, 4 or 8 times the sample
+		rate: processImpl() then passes its buffer to upsample(),
+		processes the returned oversampling() times larger buffer in place and
+		writes the result back with downsample(). The added delay is reported
+		through latency().
+	*/
+	void setOversampling( int factor );
+
+	inline int oversampling() const
+	{
+		return m_oversampler.factor();
+	}
+
+	inline SampleFrame* upsample( const SampleFrame* _buf, const fpp_t _frames )
+	{
+		return m_oversampler.upsample( _buf, _frames );
+	}
+
+	inline void downsample( SampleFrame* _buf, const fpp_t _frames )
+	{
+		m_oversampler.downsample( _buf, _frames );
+	}
+
 	virtual void onEnabledChanged() {}
 
 
+private slots:
+	void updateDryDelay();
+
 private:
+	/**
+		If the setting "Keep effects running even without input" is disabled,
+		after "decay" ms of a signal below "gate", the effect is turned off
+		and won't be processed again until it receives new audio input
+	*/
+	void checkGate( double _out_sum, const fpp_t _frames );
+
 	EffectChain * m_parent;
 	void resample( int _i, const SampleFrame* _src_buf,
 					sample_rate_t _src_sr,
 					SampleFrame* _dst_buf, sample_rate_t _dst_sr,
-					const f_cnt_t _frames );
+					const f_cnt_t _frames, const f_cnt_t _maxOutputFrames );
 
 	ch_cnt_t m_processors;
 
 	bool m_okay;
 	bool m_noRun;
 	bool m_running;
-	f_cnt_t m_bufferCount;
+	f_cnt_t m_quietFrames;
 
 	BoolModel m_enabledModel;
+	BoolModel m_expendableModel;
 	FloatModel m_wetDryModel;
 	FloatModel m_gateModel;
 	TempoSyncKnobModel m_autoQuitModel;
@@ -235,6 +319,12 @@ private:
 	SRC_DATA m_srcData[2];
 	SRC_STATE * m_srcState[2];
 
+	Oversampler m_oversampler;
+
+	CompensationDelay m_dryDelay;
+	bool m_dryDelayPending;
+	bool m_dryDelayUsed;
+
 
 	friend class gui::EffectView;
 	friend class EffectChain;
@@ -59,6 +59,8 @@ public:
 		return "fxchain";
 	}
 
+	using EffectList = std::vector<Effect*>;
+
 	void appendEffect( Effect * _effect );
 	void removeEffect( Effect * _effect );
 	void moveDown( Effect * _effect );
@@ -66,11 +68,21 @@ public:
 	bool processAudioBuffer( SampleFrame* _buf, const fpp_t _frames, bool hasInputNoise );
 	void startRunning();
 
+	//! Return the summed latency of all enabled effects
+	f_cnt_t latency() const;
+
 	void clear();
 
+	const EffectList& effects() const
+	{
+		return m_effects;
+	}
+
 
 private:
-	using EffectList = std::vector<Effect*>;
+	//! Let the mixer update its delay compensation
+	void invalidateLatency();
+
 	EffectList m_effects;
 
 	BoolModel m_enabledModel;
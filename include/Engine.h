@@ -35,6 +35,7 @@
 namespace lmms
 {
 
+class AnalysisService;
 class AudioEngine;
 class Mixer;
 class PatternStore;
@@ -81,6 +82,11 @@ public:
 		return s_projectJournal;
 	}
 
+	static AnalysisService * analysisService()
+	{
+		return s_analysisService;
+	}
+
 #ifdef LMMS_HAVE_LV2
 	static class Lv2Manager * getLv2Manager()
 	{
@@ -137,6 +143,7 @@ private:
 	static Song * s_song;
 	static PatternStore * s_patternStore;
 	static ProjectJournal * s_projectJournal;
+	static AnalysisService * s_analysisService;
 
 #ifdef LMMS_HAVE_LV2
 	static class Lv2Manager* s_lv2Manager;
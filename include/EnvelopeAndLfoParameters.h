@@ -63,6 +63,10 @@ public:
 		void trigger();
 		void reset();
 
+		//! Apply a changed "envcontrolinterval" setting, only call this
+		//! while the audio engine doesn't process
+		void updateControlInterval();
+
 		void add( EnvelopeAndLfoParameters * lfo );
 		void remove( EnvelopeAndLfoParameters * lfo );
 
@@ -102,6 +106,19 @@ public:
 				const f_cnt_t _release_begin,
 				const fpp_t _frames );
 
+	//! Like fillLevel(), but only evaluates every \p interval th frame of
+	//! \p buf, the frames in between are left untouched
+	void fillControlLevel( float * buf, f_cnt_t frame,
+				const f_cnt_t releaseBegin,
+				const fpp_t frames, const fpp_t interval );
+
+	//! Number of frames between two evaluations of the level in
+	//! fillLevel(), the frames in between are interpolated linearly
+	inline fpp_t controlInterval() const
+	{
+		return m_controlInterval;
+	}
+
 	inline bool isUsed() const
 	{
 		return m_used;
@@ -157,6 +174,11 @@ protected:
 
 
 private:
+	void fillEnvelope( float * buf, f_cnt_t frame, const f_cnt_t releaseBegin, const fpp_t frames ) const;
+	f_cnt_t fillPahd( float * buf, f_cnt_t frame, const f_cnt_t frames ) const;
+	void fillControlPoints( float * buf, const f_cnt_t frame, const f_cnt_t releaseBegin,
+		const fpp_t frames, const fpp_t interval, const bool withLastFrame );
+
 	static LfoInstances * s_lfoInstances;
 	bool m_used;
 
@@ -176,10 +198,14 @@ private:
 	float  m_amountAdd;
 	f_cnt_t m_pahdFrames;
 	f_cnt_t m_rFrames;
-	sample_t * m_pahdEnv;
-	sample_t * m_rEnv;
-	f_cnt_t m_pahdBufSize;
-	f_cnt_t m_rBufSize;
+	// the envelope is evaluated segment by segment from these
+	f_cnt_t m_predelayFrames;
+	f_cnt_t m_attackFrames;
+	f_cnt_t m_holdFrames;
+	float m_attackStep;
+	float m_decayStep;
+	float m_releaseStep;
+	fpp_t m_controlInterval;
 
 
 	FloatModel m_lfoPredelayModel;
@@ -42,6 +42,7 @@ class MainWindow;
 class MicrotunerConfig;
 class PatternEditorWindow;
 class PianoRollWindow;
+class ProfilerView;
 class ProjectNotes;
 class SongEditorWindow;
 
@@ -64,6 +65,7 @@ public:
 	PianoRollWindow* pianoRoll() { return m_pianoRoll; }
 	ProjectNotes* getProjectNotes() { return m_projectNotes; }
 	MicrotunerConfig* getMicrotunerConfig() { return m_microtunerConfig; }
+	ProfilerView* profilerView() { return m_profilerView; }
 	AutomationEditorWindow* automationEditor() { return m_automationEditor; }
 	ControllerRackView* getControllerRackView() { return m_controllerRackView; }
 
@@ -84,6 +86,7 @@ private:
 	PianoRollWindow* m_pianoRoll;
 	ProjectNotes* m_projectNotes;
 	MicrotunerConfig* m_microtunerConfig;
+	ProfilerView* m_profilerView;
 	ControllerRackView* m_controllerRackView;
 	QLabel* m_loadingProgressLabel;
 };
@@ -32,9 +32,11 @@
 #include "lmms_export.h"
 #include "lmms_basics.h"
 #include "Plugin.h"
+#include "SampleFrame.h"
 #include "TimePos.h"
 
 #include <cmath>
+#include <cstddef>
 
 
 namespace lmms
@@ -45,7 +47,6 @@ class InstrumentTrack;
 class MidiEvent;
 class NotePlayHandle;
 class Track;
-class SampleFrame;
 
 
 class LMMS_EXPORT Instrument : public Plugin
@@ -57,6 +58,7 @@ public:
 		IsSingleStreamed = 0x01,	/*! Instrument provides a single audio stream for all notes */
 		IsMidiBased = 0x02,			/*! Instrument is controlled by MIDI events rather than NotePlayHandles */
 		IsNotBendable = 0x04,		/*! Instrument can't react to pitch bend changes */
+		RendersAllVoices = 0x08,	/*! Instrument renders all notes of the track in playNotes() */
 	};
 
 	using Flags = lmms::Flags<Flag>;
@@ -84,6 +86,17 @@ public:
 	{
 	}
 
+	// instruments with Flag::RendersAllVoices render all sounding notes
+	// of the track at once instead of getting one playNote() call with
+	// a buffer of its own per note. Every note starts at its noteOffset()
+	// and lasts framesLeftForCurrentPeriod() frames; its sound has to be
+	// added to the period long _working_buffer. The instrument has to
+	// create an InstrumentPlayHandle like single streamed instruments.
+	// The default implementation renders the notes one by one using
+	// playNote() and applies the sound shaping of the track to them.
+	virtual void playNotes( NotePlayHandle* const* _notes, std::size_t _count,
+					SampleFrame* _working_buffer );
+
 	// needed for deleting plugin-specific-data of a note - plugin has to
 	// cast void-ptr so that the plugin-data is deleted properly
 	// (call of dtor if it's a class etc.)
@@ -121,6 +134,11 @@ public:
 		return m_flags.testFlag(Instrument::Flag::IsSingleStreamed);
 	}
 
+	bool rendersAllVoices() const
+	{
+		return m_flags.testFlag(Instrument::Flag::RendersAllVoices);
+	}
+
 	bool isMidiBased() const
 	{
 		return m_flags.testFlag(Instrument::Flag::IsMidiBased);
@@ -25,6 +25,7 @@
 #ifndef LMMS_INSTRUMENT_SOUND_SHAPING_H
 #define LMMS_INSTRUMENT_SOUND_SHAPING_H
 
+#include "AudioPort.h"
 #include "ComboBoxModel.h"
 
 namespace lmms
@@ -42,7 +43,7 @@ class InstrumentSoundShapingView;
 }
 
 
-class InstrumentSoundShaping : public Model, public JournallingObject
+class InstrumentSoundShaping : public Model, public JournallingObject, public AudioPort::BatchProcessor
 {
 	Q_OBJECT
 public:
@@ -52,6 +53,20 @@ public:
 	void processAudioBuffer( SampleFrame* _ab, const fpp_t _frames,
 							NotePlayHandle * _n );
 
+	//! Number of voices whose filters are processed together
+	static constexpr int BatchVoices = 8;
+
+	/*! \brief Postpone the processing of a voice to processBatch()
+	 *
+	 * This is done for all voices using a biquad based filter, so the filters
+	 * of up to BatchVoices voices can be run in parallel. Returns false if
+	 * the voice has to be processed by processAudioBuffer() right away.
+	 */
+	bool deferAudioBuffer( const f_cnt_t offset, const fpp_t frames, NotePlayHandle* n );
+
+	//! Process all deferred voices including their volume and panning
+	void processBatch( const PlayHandleList& playHandles ) override;
+
 	enum class Target
 	{
 		Volume,
@@ -76,6 +91,21 @@ public:
 
 
 private:
+	void envelopePosition( const NotePlayHandle* n, const fpp_t frames,
+				f_cnt_t& envTotalFrames, f_cnt_t& envReleaseBegin ) const;
+	void processFilter( SampleFrame* buffer, const fpp_t frames, NotePlayHandle* n,
+				const f_cnt_t envTotalFrames, const f_cnt_t envReleaseBegin );
+	void processVolume( SampleFrame* buffer, const fpp_t frames,
+				const f_cnt_t envTotalFrames, const f_cnt_t envReleaseBegin );
+	void prepareFilter( NotePlayHandle* n );
+	//! Process a deferred voice on its own
+	void processVoice( NotePlayHandle* n );
+	void processVoices( NotePlayHandle** voices, const int count );
+
+	//! Fill \p freq and \p q with the modulated filter parameters
+	void filterParameters( float* freq, float* q, const fpp_t frames,
+				const f_cnt_t envTotalFrames, const f_cnt_t envReleaseBegin );
+
 	EnvelopeAndLfoParameters * m_envLfoParameters[NumTargets];
 	InstrumentTrack * m_instrumentTrack;
 
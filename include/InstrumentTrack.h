@@ -26,6 +26,8 @@
 #ifndef LMMS_INSTRUMENT_TRACK_H
 #define LMMS_INSTRUMENT_TRACK_H
 
+#include <vector>
+
 #include "AudioPort.h"
 #include "InstrumentFunctions.h"
 #include "InstrumentSoundShaping.h"
@@ -62,6 +64,9 @@ class LMMS_EXPORT InstrumentTrack : public Track, public MidiEventProcessor
 	Q_OBJECT
 	mapPropertyFromModel(int,getVolume,setVolume,m_volumeModel);
 public:
+	//! Upper limit for the per-track polyphony budget
+	static constexpr int MaxVoices = 256;
+
 	InstrumentTrack( TrackContainer* tc );
 	~InstrumentTrack() override;
 
@@ -69,6 +74,9 @@ public:
 	void processAudioBuffer( SampleFrame* _buf, const fpp_t _frames,
 							NotePlayHandle * _n );
 
+	//! Apply volume and panning of a note to its buffer
+	void applyNoteVolume( SampleFrame* buf, const fpp_t frames, const NotePlayHandle* n );
+
 	MidiEvent applyMasterKey( const MidiEvent& event );
 
 	void processInEvent( const MidiEvent& event, const TimePos& time = TimePos(), f_cnt_t offset = 0 ) override;
@@ -88,6 +96,10 @@ public:
 	// filter and so on
 	void playNote( NotePlayHandle * _n, SampleFrame* _working_buffer );
 
+	//! Play all notes of the track for instruments which render all
+	//! voices at once, called by their InstrumentPlayHandle
+	void playVoices( SampleFrame* buffer );
+
 	QString instrumentName() const;
 	const Instrument *instrument() const
 	{
@@ -228,6 +240,17 @@ public:
 		return &m_useMasterPitchModel;
 	}
 
+	IntModel* maxVoicesModel()
+	{
+		return &m_maxVoicesModel;
+	}
+
+	//! Returns the polyphony budget of this track, 0 means unlimited
+	int maxVoices() const
+	{
+		return m_maxVoicesModel.value();
+	}
+
 	void setPreviewMode( const bool );
 
 	bool isPreviewMode() const
@@ -289,6 +312,11 @@ private:
 
 	NotePlayHandleList m_processHandles;
 
+	// scratch space for playVoices(), reserved up front to avoid
+	// allocations in the audio thread
+	std::vector<NotePlayHandle*> m_periodNotes;
+	std::vector<NotePlayHandle*> m_voices;
+
 	FloatModel m_volumeModel;
 	FloatModel m_panningModel;
 
@@ -298,6 +326,7 @@ private:
 	IntModel m_pitchRangeModel;
 	IntModel m_mixerChannelModel;
 	BoolModel m_useMasterPitchModel;
+	IntModel m_maxVoicesModel;
 
 	Instrument * m_instrument;
 	InstrumentSoundShaping m_soundShaping;
@@ -142,6 +142,7 @@ private:
 	QLabel * m_pitchLabel;
 	LcdSpinBox* m_pitchRangeSpinBox;
 	QLabel * m_pitchRangeLabel;
+	LcdSpinBox* m_maxVoicesSpinBox;
 	MixerChannelLcdSpinBox * m_mixerChannelNumber;
 
 
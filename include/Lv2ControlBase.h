@@ -36,6 +36,7 @@
 #include "LinkedModelGroups.h"
 #include "lmms_export.h"
 #include "Plugin.h"
+#include "ThreadableJob.h"
 
 namespace lmms
 {
@@ -118,12 +119,11 @@ protected:
 	//! Bring values from all ports to the LMMS core
 	void copyModelsToLmms() const;
 
-	//! Copy buffer passed by LMMS into our ports
-	void copyBuffersFromLmms(const SampleFrame* buf, fpp_t frames);
-	//! Copy our ports into buffers passed by LMMS
-	void copyBuffersToLmms(SampleFrame* buf, fpp_t frames) const;
-	//! Run the Lv2 plugin instance for @param frames frames
-	void run(fpp_t frames);
+	//! Copy @p in into our ports, run all Lv2 plugin instances for @p frames
+	//! frames and copy the result into @p out. @p in may be nullptr if the
+	//! plugin has no audio inputs. Multiple instances (mono plugins) are run
+	//! in parallel.
+	void run(const SampleFrame* in, SampleFrame* out, fpp_t frames);
 
 	/*
 		load/save, must be called from virtuals
@@ -138,14 +138,39 @@ protected:
 	std::size_t controlCount() const;
 	QString nodeName() const { return "lv2controls"; }
 	bool hasNoteInput() const;
+	f_cnt_t latency() const;
 	void handleMidiInputEvent(const class MidiEvent &event,
 		const class TimePos &time, f_cnt_t offset);
 
 private:
+	//! Runs a single Lv2Proc including copying its buffers
+	class ProcJob : public ThreadableJob
+	{
+	public:
+		ProcJob(Lv2Proc* proc, unsigned firstChan, unsigned channels) :
+			m_proc(proc), m_firstChan(firstChan), m_channels(channels) {}
+
+		bool requiresProcessing() const override { return true; }
+
+		const SampleFrame* m_in = nullptr;
+		SampleFrame* m_out = nullptr;
+		fpp_t m_frames = 0;
+
+	private:
+		void doProcessing() override;
+
+		Lv2Proc* m_proc;
+		unsigned m_firstChan;
+		unsigned m_channels;
+	};
+
 	//! Independent processors
 	//! If this is a mono effect, the vector will have size 2 in order to
 	//! fulfill LMMS' requirement of having stereo input and output
 	std::vector<std::unique_ptr<Lv2Proc>> m_procs;
+	//! One job per processor, used to run them in parallel
+	std::vector<std::unique_ptr<ProcJob>> m_jobs;
+	std::vector<ThreadableJob*> m_jobList;
 
 	bool m_hasGUI = false;
 	unsigned m_channelsPerProc;
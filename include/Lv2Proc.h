@@ -162,6 +162,8 @@ public:
 	class AutomatableModel *modelAtPort(const QString &uri); // unused currently
 	std::size_t controlCount() const { return LinkedModelGroup::modelNum(); }
 	bool hasNoteInput() const;
+	//! Return the latency the plugin reports on its latency port, if any
+	f_cnt_t latency() const;
 
 protected:
 	/*
@@ -189,6 +191,8 @@ private:
 	// quick reference to specific, unique ports
 	StereoPortRef m_inPorts, m_outPorts;
 	Lv2Ports::AtomSeq *m_midiIn = nullptr, *m_midiOut = nullptr;
+	//! control output port with the lv2:reportsLatency property
+	const Lv2Ports::Control *m_latencyPort = nullptr;
 
 	// MIDI
 	// many things here may be moved into the `Instrument` class
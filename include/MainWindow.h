@@ -163,6 +163,7 @@ public slots:
 	void toggleSongEditorWin();
 	void toggleProjectNotesWin();
 	void toggleMicrotunerWin();
+	void toggleProfilerWin();
 	void toggleMixerWin();
 	void togglePianoRollWin();
 	void toggleControllerRack();
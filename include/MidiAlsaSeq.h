@@ -125,6 +125,10 @@ private:
 	void run() override;
 
 #ifdef LMMS_HAVE_ALSA
+	//! Arrival time of an input event in the clock of the audio engine,
+	//! see MidiEvent::timestamp()
+	std::int64_t eventTimestamp( const snd_seq_event_t * _ev );
+
 	QMutex m_seqMutex;
 	snd_seq_t * m_seqHandle;
 	struct Ports
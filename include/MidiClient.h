@@ -138,6 +138,13 @@ protected:
 	// generic raw-MIDI-parser which generates appropriate MIDI-events
 	void parseData( const unsigned char c );
 
+	// time at which the bytes passed to parseData() from now on have been
+	// received, see MidiEvent::timestamp()
+	void setTimestamp( std::int64_t timestamp )
+	{
+		m_timestamp = timestamp;
+	}
+
 	// to be implemented by actual client-implementation
 	virtual void sendByte( const unsigned char c ) = 0;
 
@@ -169,6 +176,8 @@ private:
 		MidiEvent m_midiEvent;	// midi-event
 	} m_midiParseData;
 
+	std::int64_t m_timestamp = 0;
+
 } ;
 
 } // namespace lmms
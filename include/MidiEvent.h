@@ -25,6 +25,7 @@
 #ifndef LMMS_MIDI_EVENT_H
 #define LMMS_MIDI_EVENT_H
 
+#include <cstdint>
 #include <cstdlib>
 #include "Midi.h"
 #include "panning_constants.h"
@@ -49,7 +50,8 @@ public:
 		m_channel( channel ),
 		m_sysExData( nullptr ),
 		m_sourcePort(sourcePort),
-		m_source(source)
+		m_source(source),
+		m_timestamp(0)
 	{
 		m_data.m_param[0] = param1;
 		m_data.m_param[1] = param2;
@@ -61,7 +63,8 @@ public:
 		m_channel( 0 ),
 		m_sysExData( sysExData ),
 		m_sourcePort(nullptr),
-		m_source(source)
+		m_source(source),
+		m_timestamp(0)
 	{
 		m_data.m_sysExDataLen = dataLen;
 	}
@@ -200,6 +203,18 @@ public:
 		m_source = value;
 	}
 
+	//! Time at which the MIDI device sent the event, in microseconds of
+	//! AudioEngine::midiInputTime(), or 0 if unknown
+	std::int64_t timestamp() const
+	{
+		return m_timestamp;
+	}
+
+	void setTimestamp(std::int64_t timestamp)
+	{
+		m_timestamp = timestamp;
+	}
+
 
 private:
 	MidiEventTypes m_type;		// MIDI event type
@@ -217,6 +232,8 @@ private:
 
 	// Stores the source of the MidiEvent: Internal or External (hardware controllers).
 	Source m_source;
+
+	std::int64_t m_timestamp;
 } ;
 
 } // namespace lmms
@@ -30,15 +30,20 @@
 #include <QList>
 #include <QMap>
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
 #include "Midi.h"
+#include "MidiEvent.h"
 #include "TimePos.h"
 #include "AutomatableModel.h"
+#include "LocklessRingBuffer.h"
 
 namespace lmms
 {
 
 class MidiClient;
-class MidiEvent;
 class MidiEventProcessor;
 
 namespace gui
@@ -114,6 +119,19 @@ public:
 	void processInEvent( const MidiEvent& event, const TimePos& time = TimePos() );
 	void processOutEvent( const MidiEvent& event, const TimePos& time = TimePos() );
 
+	//! Queue input events for the audio thread instead of passing them to the
+	//! event processor in the thread of the MIDI client. The event processor
+	//! then gets them at the beginning of the next period, with an offset
+	//! matching their time of arrival.
+	void enableInputQueue();
+
+	//! Pass the queued input events to the event processor, called by the
+	//! AudioEngine in the audio thread
+	void processQueuedInEvents();
+
+	//! Number of input events which can be queued during a single period
+	static constexpr std::size_t InputQueueSize = 1024;
+
 
 	void saveSettings( QDomDocument& doc, QDomElement& thisElement ) override;
 	void loadSettings( const QDomElement& thisElement ) override;
@@ -173,6 +191,18 @@ private:
 	Map m_readablePorts;
 	Map m_writablePorts;
 
+	struct QueuedInEvent
+	{
+		MidiEvent event;
+		TimePos time;
+		std::int64_t arrival = 0;
+	};
+
+	std::unique_ptr<LocklessRingBuffer<QueuedInEvent>> m_inputQueue;
+	std::unique_ptr<LocklessRingBufferReader<QueuedInEvent>> m_inputQueueReader;
+	// whether the port is waiting for the AudioEngine to process its queue
+	std::atomic<bool> m_inputPending;
+
 
 	friend class gui::ControllerConnectionDialog;
 	friend class gui::InstrumentMidiIOView;
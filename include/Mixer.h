@@ -26,12 +26,14 @@
 #define LMMS_MIXER_H
 
 #include "Model.h"
+#include "CompensationDelay.h"
 #include "EffectChain.h"
 #include "JournallingObject.h"
 #include "ThreadableJob.h"
 
 #include <atomic>
 #include <optional>
+#include <vector>
 #include <QColor>
 
 namespace lmms
@@ -57,6 +59,8 @@ class MixerChannel : public ThreadableJob
 		float m_peakLeft;
 		float m_peakRight;
 		SampleFrame* m_buffer;
+		// the delayed output of a sender, see MixerRoute::compensation()
+		SampleFrame* m_compensationBuffer;
 		bool m_muteBeforeSolo;
 		BoolModel m_muteModel;
 		BoolModel m_soloModel;
@@ -66,6 +70,7 @@ class MixerChannel : public ThreadableJob
 		int m_channelIndex; // what channel index are we
 		bool m_queued; // are we queued up for rendering yet?
 		bool m_muted; // are we muted? updated per period so we don't have to call m_muteModel.value() twice
+		float m_processingTime; // average time in microseconds doProcessing() takes
 
 		// pointers to other channels that this one sends to
 		MixerRouteVector m_sends;
@@ -121,12 +126,19 @@ public:
 		return m_to;
 	}
 
+	//! Delay which aligns this route with the other inputs of the receiver
+	CompensationDelay& compensation()
+	{
+		return m_compensation;
+	}
+
 	void updateName();
 
 	private:
 		MixerChannel * m_from;
 		MixerChannel * m_to;
 		FloatModel m_amount;
+		CompensationDelay m_compensation;
 };
 
 
@@ -207,9 +219,38 @@ public:
 		return m_mixerChannels.size();
 	}
 
+	//! Return the latency of the master output, i.e. of the slowest path
+	//! through the mixer, as of the last update of the delay compensation
+	f_cnt_t latency() const
+	{
+		return m_latency;
+	}
+
+	//! Schedule updateLatencyCompensation() after a latency or the mixer
+	//! graph changed, can be called from any thread
+	void invalidateLatencyCompensation();
+
 	MixerRouteVector m_mixerRoutes;
 
+public slots:
+	//! Recompute the delays of all audio ports and routes, so that all
+	//! inputs of every channel are aligned to the slowest one
+	void updateLatencyCompensation();
+
+signals:
+	//! Emitted by invalidateLatencyCompensation(), possibly from the audio thread
+	void latencyCompensationOutdated();
+
 private:
+	//! Fraction of the period above which a channel is bound to a thread
+	static constexpr float HeavyChannelLoad = 0.05f;
+
+	void updateAffinities();
+
+	void computeLatencies();
+	f_cnt_t inputLatency(mix_ch_t channel);
+	f_cnt_t outputLatency(mix_ch_t channel);
+
 	// the mixer channels in the mixer. index 0 is always master.
 	std::vector<MixerChannel*> m_mixerChannels;
 
@@ -217,6 +258,17 @@ private:
 	void allocateChannelsTo(int num);
 
 	int m_lastSoloed;
+
+	// whether heavy channels are bound to worker threads, see updateAffinities()
+	bool m_busAffinity;
+	int m_nextAffineThread;
+
+	// latency of the slowest audio port feeding each channel and the memoized
+	// latency at the input of each channel, used by computeLatencies()
+	std::vector<f_cnt_t> m_portLatencies;
+	std::vector<std::optional<f_cnt_t>> m_inputLatencies;
+	f_cnt_t m_latency;
+	std::atomic<bool> m_compensationPending;
 } ;
 
 
@@ -0,0 +1,252 @@
+/*
+ * NoteArena.h - recycled memory for the DSP state of a note
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_NOTE_ARENA_H
+#define LMMS_NOTE_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace lmms
+{
+
+/**
+	Bump allocator for the per-note state of instruments and the sound shaping.
+
+	NotePlayHandleManager keeps one arena per NotePlayHandle slot. Objects
+	created in the arena live until the note is destroyed; then they are
+	destructed in reverse order of creation and the memory is handed to the
+	next note using the slot. The arena grows when a note needs more memory
+	than is available, and keeps that memory (up to MaxRetainedSize) for the
+	following notes, so after warming up starting a note doesn't allocate.
+*/
+class NoteArena
+{
+public:
+	//! Size of the memory block every arena starts with
+	static constexpr std::size_t InitialSize = 4096;
+	//! Memory beyond this size is released again when the arena is reset
+	static constexpr std::size_t MaxRetainedSize = 256 * 1024;
+
+	NoteArena( std::size_t initialSize = InitialSize ) :
+		m_blocks( nullptr ),
+		m_current( nullptr ),
+		m_offset( 0 ),
+		m_destructors( nullptr ),
+		m_growths( 0 )
+	{
+		if( initialSize > 0 )
+		{
+			m_blocks = m_current = newBlock( initialSize );
+		}
+	}
+
+	~NoteArena()
+	{
+		reset();
+		while( m_blocks )
+		{
+			Block* next = m_blocks->next;
+			deleteBlock( m_blocks );
+			m_blocks = next;
+		}
+	}
+
+	NoteArena( const NoteArena& ) = delete;
+	NoteArena& operator=( const NoteArena& ) = delete;
+
+	//! Construct an object in the arena, it is destroyed by reset()
+	template<class T, class... Args>
+	T* create( Args&&... args )
+	{
+		void* memory = allocate( sizeof( T ), alignof( T ) );
+		T* object = new( memory ) T( std::forward<Args>( args )... );
+		if constexpr( !std::is_trivially_destructible_v<T> )
+		{
+			auto destructor = static_cast<Destructor*>( allocate( sizeof( Destructor ), alignof( Destructor ) ) );
+			destructor->destroy = []( void* o ) { static_cast<T*>( o )->~T(); };
+			destructor->object = object;
+			destructor->next = m_destructors;
+			m_destructors = destructor;
+		}
+		return object;
+	}
+
+	//! Allocate a zero-initialised array, e.g. for buffers
+	template<class T>
+	T* createArray( std::size_t count )
+	{
+		static_assert( std::is_trivially_destructible_v<T>, "arrays are not destructed" );
+		auto array = static_cast<T*>( allocate( sizeof( T ) * count, alignof( T ) ) );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			new( array + i ) T();
+		}
+		return array;
+	}
+
+	//! Destroy all objects and make the memory available again
+	void reset()
+	{
+		while( m_destructors )
+		{
+			Destructor* destructor = m_destructors;
+			m_destructors = destructor->next;
+			destructor->destroy( destructor->object );
+		}
+
+		// release the memory which exceeds the limit
+		std::size_t retained = 0;
+		for( Block** block = &m_blocks; *block; )
+		{
+			retained += ( *block )->size;
+			if( retained > MaxRetainedSize && *block != m_blocks )
+			{
+				retained -= ( *block )->size;
+				Block* next = ( *block )->next;
+				deleteBlock( *block );
+				*block = next;
+			}
+			else
+			{
+				block = &( *block )->next;
+			}
+		}
+
+		m_current = m_blocks;
+		m_offset = 0;
+	}
+
+	//! Total size of the memory held by the arena
+	std::size_t capacity() const
+	{
+		std::size_t size = 0;
+		for( Block* block = m_blocks; block; block = block->next )
+		{
+			size += block->size;
+		}
+		return size;
+	}
+
+	//! Number of times the arena had to allocate a new block
+	int growths() const
+	{
+		return m_growths;
+	}
+
+private:
+	struct Block
+	{
+		Block* next;
+		std::size_t size;
+	};
+
+	struct Destructor
+	{
+		void (*destroy)( void* );
+		void* object;
+		Destructor* next;
+	};
+
+	static constexpr std::size_t HeaderSize =
+		( sizeof( Block ) + alignof( std::max_align_t ) - 1 ) / alignof( std::max_align_t ) * alignof( std::max_align_t );
+
+	static Block* newBlock( std::size_t size )
+	{
+		auto block = static_cast<Block*>( ::operator new( HeaderSize + size ) );
+		block->next = nullptr;
+		block->size = size;
+		return block;
+	}
+
+	static void deleteBlock( Block* block )
+	{
+		::operator delete( block );
+	}
+
+	static std::byte* data( Block* block )
+	{
+		return reinterpret_cast<std::byte*>( block ) + HeaderSize;
+	}
+
+	//! Returns the offset of aligned memory of the given size in \p block or
+	//! the size of the block if it doesn't fit
+	static std::size_t fit( Block* block, std::size_t offset, std::size_t size, std::size_t alignment )
+	{
+		const auto base = reinterpret_cast<std::uintptr_t>( data( block ) );
+		const auto aligned = ( base + offset + alignment - 1 ) / alignment * alignment - base;
+		return aligned + size <= block->size ? aligned : block->size;
+	}
+
+	void* allocate( std::size_t size, std::size_t alignment )
+	{
+		size = std::max<std::size_t>( size, 1 );
+
+		// try the current block, then the ones which have been kept from
+		// previous notes
+		for( std::size_t offset = m_offset; m_current; offset = 0 )
+		{
+			const std::size_t aligned = fit( m_current, offset, size, alignment );
+			if( aligned < m_current->size )
+			{
+				m_offset = aligned + size;
+				return data( m_current ) + aligned;
+			}
+			if( m_current->next == nullptr )
+			{
+				break;
+			}
+			m_current = m_current->next;
+		}
+
+		Block* block = newBlock( std::max( size + alignment, m_current ? m_current->size * 2 : InitialSize ) );
+		++m_growths;
+		if( m_current )
+		{
+			m_current->next = block;
+		}
+		else
+		{
+			m_blocks = block;
+		}
+		m_current = block;
+		m_offset = 0;
+		return allocate( size, alignment );
+	}
+
+	Block* m_blocks;
+	Block* m_current;
+	std::size_t m_offset;
+	Destructor* m_destructors;
+	int m_growths;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_NOTE_ARENA_H
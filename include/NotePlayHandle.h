@@ -27,9 +27,11 @@
 #define LMMS_NOTE_PLAY_HANDLE_H
 
 #include <memory>
+#include <vector>
 
 #include "BasicFilters.h"
 #include "Note.h"
+#include "NoteArena.h"
 #include "PlayHandle.h"
 #include "Track.h"
 
@@ -48,7 +50,20 @@ class LMMS_EXPORT NotePlayHandle : public PlayHandle, public Note
 {
 public:
 	void * m_pluginData;
-	std::unique_ptr<BasicFilters<>> m_filter;
+	//! Filter of the sound shaping, created in arena()
+	BasicFilters<>* m_filter;
+
+	//! Position of a note whose sound shaping has been deferred to
+	//! InstrumentSoundShaping::processBatch()
+	struct DeferredShaping
+	{
+		bool pending = false;
+		fpp_t offset = 0;
+		fpp_t frames = 0;
+		f_cnt_t envTotalFrames = 0;
+		f_cnt_t envReleaseBegin = 0;
+	};
+	DeferredShaping m_deferredShaping;
 
 	// length of the declicking fade in
 	fpp_t m_fadeInLength;
@@ -62,7 +77,8 @@ public:
 		Arpeggio,		/*! created by arpeggio instrument function */
 	};
 
-	NotePlayHandle( InstrumentTrack* instrumentTrack,
+	NotePlayHandle( NoteArena& arena,
+					InstrumentTrack* instrumentTrack,
 					const f_cnt_t offset,
 					const f_cnt_t frames,
 					const Note& noteToPlay,
@@ -112,6 +128,13 @@ public:
 	/*! Renders one chunk using the attached instrument into the buffer */
 	void play( SampleFrame* buffer ) override;
 
+	/*! Notes of instruments rendering all voices at once are played by the
+	    InstrumentPlayHandle of their instrument, see InstrumentTrack::playVoices() */
+	bool requiresProcessing() const override
+	{
+		return !m_playedByInstrument && PlayHandle::requiresProcessing();
+	}
+
 	/*! Returns whether playback of note is finished and thus handle can be deleted */
 	bool isFinished() const override
 	{
@@ -211,6 +234,20 @@ public:
 		setUsesBuffer( false );
 	}
 
+	/*! Fades the note out within the given number of frames and releases it,
+	    used for voice stealing by the OverloadManager */
+	void steal( const f_cnt_t fadeFrames );
+
+	/*! Returns whether note was stolen and is fading out */
+	bool isStolen() const
+	{
+		return m_stealFrames > 0;
+	}
+
+	/*! Applies the fade-out of a stolen note to the frames rendered in the
+	    current period, \p buffer holds the whole period */
+	void applyStealFade( SampleFrame* buffer, const fpp_t frames ) const;
+
 	/*! Returns whether note is muted */
 	bool isMuted() const
 	{
@@ -268,6 +305,14 @@ public:
 		m_frequencyNeedsUpdate = true;
 	}
 
+	/*! Returns the memory for the per-note state of instruments. Everything
+	 * created in it is destroyed together with the note, after
+	 * Instrument::deleteNotePluginData() has been called. */
+	NoteArena& arena()
+	{
+		return *m_arena;
+	}
+
 private:
 	class BaseDetuning
 	{
@@ -292,6 +337,12 @@ private:
 
 	void updateFrequency();
 
+	/*! Prepares playback of the current period and locks the note, returns
+	    false if the note doesn't play in this period */
+	bool beginPeriod();
+	/*! Advances the note by one period and unlocks it */
+	void endPeriod();
+
 	InstrumentTrack* m_instrumentTrack;		// needed for calling
 											// InstrumentTrack::playNote
 	f_cnt_t m_frames;						// total frames to play
@@ -330,6 +381,20 @@ private:
 	Origin m_origin;
 
 	bool m_frequencyNeedsUpdate;				// used to update pitch
+
+	f_cnt_t m_stealFrames;					// length of the fade-out when stolen
+	f_cnt_t m_stealFramesDone;				// frames of the fade-out done so far
+
+	f_cnt_t m_framesThisPeriod;				// frames the note advances in the
+											// current period
+	fpp_t m_framesToPlay;					// frames rendered in the current period
+	bool m_playedByInstrument;				// instrument renders all voices
+											// of the track at once
+
+	NoteArena* m_arena;
+
+	friend class InstrumentTrack;
+	friend class NotePlayHandleManager;
 } ;
 
 
@@ -352,7 +417,15 @@ public:
 	static void free();
 
 private:
-	static NotePlayHandle ** s_available;
+	//! A NotePlayHandle and the arena recycled together with it
+	struct Slot
+	{
+		NotePlayHandle* handle;
+		NoteArena* arena;
+	};
+
+	static Slot * s_available;
+	static std::vector<std::unique_ptr<NoteArena[]>> s_arenas;
 	static QReadWriteLock s_mutex;
 	static std::atomic_int s_availableIndex;
 	static int s_size;
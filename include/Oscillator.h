@@ -26,6 +26,7 @@
 #ifndef LMMS_OSCILLATOR_H
 #define LMMS_OSCILLATOR_H
 
+#include <array>
 #include <cassert>
 #include <fftw3.h>
 #include <memory>
@@ -85,10 +86,9 @@ public:
 			const float &phase_offset,
 			const float &volume,
 			Oscillator *m_subOsc = nullptr);
-	virtual ~Oscillator()
-	{
-		delete m_subOsc;
-	}
+	//! The sub oscillator is not owned, instruments create the whole chain
+	//! in the arena of the note
+	virtual ~Oscillator() = default;
 
 	static void waveTableInit();
 	static void destroyFFTPlans();
@@ -111,6 +111,14 @@ public:
 
 	void update(SampleFrame* ab, const fpp_t frames, const ch_cnt_t chnl, bool modulator = false);
 
+	/*! Render this oscillator into the left and \p right into the right
+	 * channel of \p ab in a single pass. The wave shape and modulation are
+	 * dispatched once per block, and if both channels run in phase their
+	 * waveform is only computed once. Both chains need the same wave shapes
+	 * and modulation algorithms, otherwise they are rendered one after the
+	 * other like with update(). */
+	void updateStereo(Oscillator* right, SampleFrame* ab, const fpp_t frames, bool modulator = false);
+
 	// now follow the wave-shape-routines...
 	static inline sample_t sinSample( const float _sample )
 	{
@@ -199,8 +207,7 @@ public:
 		control.f2 = control.f1 < OscillatorConstants::WAVETABLE_LENGTH - 1 ?
 					control.f1 + 1 :
 					0;
-		control.band = waveTableBandFromFreq(
-			m_freq * m_detuning_div_samplerate * Engine::audioEngine()->outputSampleRate());
+		control.band = m_band;
 		return control;
 	}
 
@@ -264,6 +271,8 @@ private:
 	// There are many update*() variants; the modulator flag is stored as a member variable to avoid
 	// adding more explicit parameters to all of them. Can be converted to a parameter if needed.
 	bool m_isModulator;
+	// wave table band for the current frequency, updated once per block
+	int m_band;
 
 	/* Multiband WaveTable */
 	static sample_t s_waveTables[NumWaveShapeTables][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT][OscillatorConstants::WAVETABLE_LENGTH];
@@ -321,7 +330,19 @@ private:
 	template<WaveShape W>
 	inline sample_t getSample( const float _sample );
 
+	//! Used as the modulation algorithm of oscillators without sub oscillator
+	static constexpr auto NoSubOsc = ModulationAlgo::Count;
+
+	bool isStereoPair(const Oscillator* right) const;
+	bool sharesWaveform(const Oscillator* right) const;
+	template<class F>
+	void dispatchWaveShape(F&& f) const;
+	template<ModulationAlgo A, WaveShape W>
+	void updateStereo(Oscillator* right, SampleFrame* ab, const fpp_t frames);
+	std::array<float, 2> syncInitStereo(Oscillator* right, SampleFrame* ab, const fpp_t frames);
+
 	inline void recalcPhase();
+	inline void recalcBand();
 
 } ;
 
@@ -0,0 +1,147 @@
+/*
+ * OverloadManager.h - graceful handling of CPU overload in the AudioEngine
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_OVERLOAD_MANAGER_H
+#define LMMS_OVERLOAD_MANAGER_H
+
+#include <atomic>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "PlayHandle.h"
+
+namespace lmms
+{
+
+class NotePlayHandle;
+
+/**
+	Decides what the AudioEngine does when it runs out of CPU time.
+
+	The legacy behaviour is to drop every new NotePlayHandle while the
+	profiler reports a critical load. With voice stealing enabled, new notes
+	are always accepted and the polyphony budgets (global and per instrument
+	track) are enforced once per period in the note setup stage instead. Under
+	critical load the global budget is temporarily lowered, so the oldest or
+	quietest voices are faded out rather than the newest being lost.
+
+	The manager additionally exposes a degraded state which sample based
+	instruments and "expendable" effects can query to trade quality for CPU.
+
+	Settings are read from the "audioengine" section of the configuration.
+	All methods except loadSettings() are meant to be called from the audio
+	thread.
+*/
+class LMMS_EXPORT OverloadManager
+{
+public:
+	enum class StealMode
+	{
+		Oldest,
+		Quietest
+	};
+
+	enum class Level
+	{
+		Normal,
+		High,
+		Critical
+	};
+
+	OverloadManager();
+	~OverloadManager() = default;
+
+	//! (Re-)read the settings from ConfigManager
+	void loadSettings();
+
+	//! Update the overload level from the current CPU load, called once per period
+	void update(int cpuLoad);
+
+	//! Returns whether a new play handle has to be dropped (legacy policy only)
+	bool shouldDrop(const PlayHandle* handle) const;
+
+	//! Steal voices until all polyphony budgets are met
+	void enforcePolyphony(const PlayHandleList& playHandles);
+
+	Level level() const { return m_level; }
+
+	//! Returns whether quality reductions are currently active
+	bool isDegraded() const { return m_level != Level::Normal; }
+
+	//! Returns the libsamplerate converter type to use for newly started samples
+	int interpolationMode(int requested) const;
+
+	//! Returns whether effects marked as expendable have to be bypassed right now
+	bool bypassExpendableEffects() const
+	{
+		return m_bypassExpendableEffects && m_level == Level::Critical;
+	}
+
+	bool stealVoices() const { return m_stealVoices; }
+	int maxVoices() const { return m_maxVoices; }
+	StealMode stealMode() const { return m_stealMode; }
+
+	int stolenVoices() const { return m_stolenVoices.load(std::memory_order_relaxed); }
+	int droppedVoices() const { return m_droppedVoices.load(std::memory_order_relaxed); }
+	void countDroppedVoice() { m_droppedVoices.fetch_add(1, std::memory_order_relaxed); }
+	void resetCounters();
+
+	//! Load (in percent) at which the manager enters the respective level
+	static constexpr int HighLoad = 85;
+	static constexpr int CriticalLoad = 99;
+	//! Load below which the manager returns to Level::Normal
+	static constexpr int RecoveredLoad = 75;
+
+	//! Number of periods to wait before shedding more voices under critical load
+	static constexpr int ShedInterval = 16;
+
+	//! Default length of the fade-out applied to stolen voices
+	static constexpr float DefaultFadeOutMs = 5.f;
+
+private:
+	bool isBetterVictim(const NotePlayHandle* a, const NotePlayHandle* b) const;
+	void steal(NotePlayHandle* n);
+
+	bool m_stealVoices;
+	int m_maxVoices;
+	StealMode m_stealMode;
+	float m_fadeOutMs;
+	bool m_degradeSamples;
+	bool m_bypassExpendableEffects;
+
+	Level m_level;
+	int m_periodsSinceShed;
+
+	// scratch space for enforcePolyphony(), reserved up front to avoid
+	// allocations in the audio thread
+	std::vector<NotePlayHandle*> m_voices;
+
+	std::atomic<int> m_stolenVoices;
+	std::atomic<int> m_droppedVoices;
+};
+
+} // namespace lmms
+
+#endif // LMMS_OVERLOAD_MANAGER_H
@@ -0,0 +1,122 @@
+/*
+ * Oversampler.h - polyphase half-band up- and downsampling
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_OVERSAMPLER_H
+#define LMMS_OVERSAMPLER_H
+
+#include <array>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "SampleFrame.h"
+
+namespace lmms
+{
+
+/**
+	Runs nonlinear processing at 2, 4 or 8 times the sample rate to reduce
+	aliasing.
+
+	upsample() interpolates a period into an internal buffer with factor()
+	times as many frames; after processing that buffer in place, downsample()
+	filters it back to the original rate. Every factor of 2 is a linear phase
+	half-band FIR in polyphase form, so only half of the taps are computed
+	and both channels are filtered in the same loop. The round trip delays
+	the signal by exactly latency() frames, which effects have to report.
+
+	setFactor() allocates and must not be called from the audio thread.
+*/
+class LMMS_EXPORT Oversampler
+{
+public:
+	static constexpr int MaxFactor = 8;
+
+	explicit Oversampler( int factor = 1, fpp_t maxFrames = 0 );
+
+	//! Change the oversampling factor (1, 2, 4 or 8) and the maximum number
+	//! of frames passed to upsample(); this clears the filter state
+	void setFactor( int factor, fpp_t maxFrames );
+
+	int factor() const
+	{
+		return m_factor;
+	}
+
+	//! Delay of upsampling and downsampling in frames at the original rate
+	f_cnt_t latency() const;
+
+	//! Upsample \p frames frames, returns the buffer holding factor() * frames frames
+	SampleFrame* upsample( const SampleFrame* in, fpp_t frames );
+
+	//! Downsample the buffer returned by upsample() into \p frames frames of \p out
+	void downsample( SampleFrame* out, fpp_t frames );
+
+	//! Forget the filter state
+	void reset();
+
+private:
+	//! One factor of 2, \p frames always refers to the lower rate
+	class HalfBand
+	{
+	public:
+		HalfBand( int halfLength, fpp_t maxFrames );
+
+		void upsample( const SampleFrame* in, SampleFrame* out, fpp_t frames );
+		void downsample( const SampleFrame* in, SampleFrame* out, fpp_t frames );
+		void reset();
+
+		//! Group delay of the filter at the higher rate
+		int delay() const
+		{
+			return 2 * m_halfLength - 1;
+		}
+
+	private:
+		int m_halfLength;
+		//! Non-zero taps besides the center one, reversed
+		std::vector<float> m_taps;
+		//! Input with the history of the previous call in front, per channel
+		std::array<std::vector<float>, DEFAULT_CHANNELS> m_upInput;
+		std::array<std::vector<float>, DEFAULT_CHANNELS> m_downEven;
+		std::array<std::vector<float>, DEFAULT_CHANNELS> m_downOdd;
+	} ;
+
+	//! Delay the highest rate by m_alignment frames so latency() is exact
+	void align( SampleFrame* buf, f_cnt_t frames );
+
+	int m_factor;
+	std::vector<HalfBand> m_stages;
+	int m_alignment;
+	std::array<std::vector<float>, DEFAULT_CHANNELS> m_alignmentHistory;
+	std::vector<float> m_alignmentTemp;
+	//! Output of every stage but the last one goes to the other buffer
+	std::array<std::vector<SampleFrame>, 2> m_buffers;
+	SampleFrame* m_output;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_OVERSAMPLER_H
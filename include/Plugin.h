@@ -276,6 +276,12 @@ public:
 	//! reference the class header.  Should return null if not key not found.
 	virtual AutomatableModel* childModel( const QString & modelName );
 
+	//! Return the number of frames by which the plugin delays its output
+	virtual f_cnt_t latency() const
+	{
+		return 0;
+	}
+
 	//! Overload if the argument passed to the plugin is a subPluginKey
 	//! If you can not pass the key and are aware that it's stored in
 	//! Engine::pickDndPluginKey(), use this function, too
@@ -0,0 +1,79 @@
+/*
+ * ProfilerView.h - window showing the DSP load of single tracks, effects and
+ *                  mixer channels
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_GUI_PROFILER_VIEW_H
+#define LMMS_GUI_PROFILER_VIEW_H
+
+#include <QHash>
+#include <QTimer>
+#include <QWidget>
+
+#include "AudioEngineProfiler.h"
+
+class QLabel;
+class QPushButton;
+class QTableWidget;
+
+namespace lmms::gui
+{
+
+
+//! Lists which track, effect or mixer channel uses how much of the period
+//! length and allows recording traces for chrome://tracing or Perfetto
+class ProfilerView : public QWidget
+{
+	Q_OBJECT
+public:
+	ProfilerView();
+	~ProfilerView() override = default;
+
+	QSize sizeHint() const override { return QSize(480, 360); }
+
+protected:
+	void showEvent(QShowEvent* se) override;
+	void hideEvent(QHideEvent* he) override;
+	void closeEvent(QCloseEvent* ce) override;
+
+private slots:
+	void updateStatistics();
+	void toggleTrace();
+
+private:
+	//! Maps the sources reported by the profiler to human readable names
+	QHash<const void*, QString> sourceNames() const;
+	static QString typeName(AudioEngineProfiler::SourceType type);
+
+	bool exportTrace(const std::vector<AudioEngineProfiler::SourceEvent>& events, const QString& fileName) const;
+
+	QTableWidget* m_table;
+	QLabel* m_statusLabel;
+	QPushButton* m_traceButton;
+	QTimer m_updateTimer;
+};
+
+
+} // namespace lmms::gui
+
+#endif // LMMS_GUI_PROFILER_VIEW_H
@@ -99,6 +99,23 @@ public:
 
 	bool process( const SampleFrame* _in_buf, SampleFrame* _out_buf );
 
+	//! In pipelined mode, process() only hands the input over to the remote
+	//! process and returns the output of the previous period, so the remote
+	//! process runs concurrently to the rest of the engine. This adds one
+	//! period of latency.
+	void setPipelined(bool pipelined)
+	{
+		m_pipelined = pipelined;
+	}
+
+	bool isPipelined() const
+	{
+		return m_pipelined;
+	}
+
+	//! Return the latency in frames added by the communication with the remote process
+	f_cnt_t latency() const;
+
 	void processMidiEvent( const MidiEvent&, const f_cnt_t _offset );
 
 	void updateSampleRate( sample_rate_t _sr )
@@ -156,6 +173,12 @@ protected:
 private:
 	void resizeSharedProcessingMemory();
 
+	//! Wait for all outstanding IdProcessingDone messages, returns false if the
+	//! remote process does not answer anymore
+	bool waitForProcessingDone();
+	void copyInputToSharedMemory(const SampleFrame* buf, fpp_t frames);
+	void copyOutputFromSharedMemory(SampleFrame* buf, fpp_t frames);
+
 
 	QProcess m_process;
 	ProcessWatcher m_watcher;
@@ -176,6 +199,13 @@ private:
 	int m_inputCount;
 	int m_outputCount;
 
+	bool m_pipelined;
+	//! Number of IdStartProcessing messages not answered yet
+	int m_pendingProcessing;
+	//! In pipelined mode, whether the shared memory holds output of a period
+	//! that process() hasn't returned yet
+	bool m_outputPending;
+
 #ifndef SYNC_WITH_SHM_FIFO
 	int m_server;
 	QString m_socketFile;
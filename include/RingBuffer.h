@@ -108,6 +108,13 @@ public:
  */
 	void pop( SampleFrame* dst );
 
+/** \brief Destructively reads a number of frames up to the period size from the current
+ * 	position, writes them to a specified destination, and advances the position by as many frames
+ * 	\param dst Destination pointer
+ * 	\param frames Number of frames
+ */
+	void pop( SampleFrame* dst, f_cnt_t frames );
+
 // note: ringbuffer position is unaffected by all other read functions beside pop()
 
 /** \brief Reads a period-sized buffer from the ringbuffer and writes it to a specified destination
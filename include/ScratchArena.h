@@ -0,0 +1,85 @@
+/*
+ * ScratchArena.h - per-thread temporary buffers for audio processing
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SCRATCH_ARENA_H
+#define LMMS_SCRATCH_ARENA_H
+
+#include <cstddef>
+
+#include "lmms_export.h"
+#include "SampleFrame.h"
+
+namespace lmms
+{
+
+/**
+	Temporary buffers for effects and instruments.
+
+	Every thread has its own arena, so taking a buffer doesn't need a lock.
+	Buffers are taken inside a Scope and given back when it ends, which makes
+	them behave like variables on the stack, just without the size limit of
+	the stack. The memory is kept for the lifetime of the thread; the audio
+	threads reserve() it when they start, afterwards a buffer only has to be
+	allocated if more than ChunkFrames frames are in use at the same time.
+
+	Plugins use this instead of buffers sized to the period when they are
+	created, because processing may be called for any number of frames up to
+	MAXIMUM_BLOCK_SIZE.
+*/
+class LMMS_EXPORT ScratchArena
+{
+public:
+	//! Frames every chunk of memory holds (16 blocks of MAXIMUM_BLOCK_SIZE),
+	//! or more if a single buffer is larger
+	static constexpr std::size_t ChunkFrames = 16 * 256;
+
+	//! Gives back all buffers taken since it was created
+	class LMMS_EXPORT Scope
+	{
+	public:
+		Scope();
+		~Scope();
+
+		Scope( const Scope& ) = delete;
+		Scope& operator=( const Scope& ) = delete;
+
+	private:
+		std::size_t m_chunk;
+		std::size_t m_offset;
+	} ;
+
+	//! Uninitialized buffer of \p count frames, valid until the innermost Scope ends
+	static SampleFrame* frames( std::size_t count );
+
+	//! Allocate the first chunk of the calling thread's arena
+	static void reserve();
+
+	//! Number of chunks the calling thread's arena has allocated
+	static std::size_t chunkCount();
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_SCRATCH_ARENA_H
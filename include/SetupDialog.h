@@ -40,6 +40,7 @@ class QComboBox;
 class QLabel;
 class QLineEdit;
 class QSlider;
+class QSpinBox;
 
 
 namespace lmms::gui
@@ -99,6 +100,15 @@ private slots:
 	void vstEmbedMethodChanged();
 	void toggleVSTAlwaysOnTop(bool en);
 	void toggleDisableAutoQuit(bool enabled);
+	void toggleRemotePipelined(bool enabled);
+	void toggleBusAffinity(bool enabled);
+	void setEnvControlInterval(int frames);
+	void toggleStealVoices(bool enabled);
+	void toggleStealQuietest(bool enabled);
+	void setMaxVoices(int voices);
+	void toggleDegradeSamples(bool enabled);
+	void toggleBypassExpendable(bool enabled);
+	void toggleFlightRecorder(bool enabled);
 
 	// Audio settings widget.
 	void audioInterfaceChanged(const QString & driver);
@@ -169,6 +179,15 @@ private:
 	QCheckBox * m_vstAlwaysOnTopCheckBox;
 	bool m_vstAlwaysOnTop;
 	bool m_disableAutoQuit;
+	bool m_remotePipelined;
+	bool m_busAffinity;
+	int m_envControlInterval;
+	bool m_stealVoices;
+	bool m_stealQuietest;
+	int m_maxVoices;
+	bool m_degradeSamples;
+	bool m_bypassExpendable;
+	bool m_flightRecorder;
 
 	using AswMap = QMap<QString, AudioDeviceSetupWidget*>;
 	using MswMap = QMap<QString, MidiSetupWidget*>;
@@ -45,7 +45,8 @@ public:
 	};
 
 	ThreadableJob() :
-		m_state(ProcessingState::Unstarted)
+		m_state(ProcessingState::Unstarted),
+		m_affinity(-1)
 	{
 	}
 
@@ -81,11 +82,28 @@ public:
 
 	virtual bool requiresProcessing() const = 0;
 
+	//! Returns the thread which should process this job (see
+	//! AudioEngineWorkerThread::currentThread()), or -1 for any thread
+	int affinity() const
+	{
+		return m_affinity;
+	}
+
+	//! Bind the job to a thread, so the state it works on stays in that
+	//! thread's CPU cache. Other threads only take the job if they are idle.
+	void setAffinity(int thread)
+	{
+		m_affinity = thread;
+	}
+
 
 protected:
 	virtual void doProcessing() = 0;
 
 	std::atomic<ProcessingState> m_state;
+
+private:
+	int m_affinity;
 } ;
 
 } // namespace lmms
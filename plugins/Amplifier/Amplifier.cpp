@@ -57,14 +57,8 @@ AmplifierEffect::AmplifierEffect(Model* parent, const Descriptor::SubPluginFeatu
 }
 
 
-bool AmplifierEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
+Effect::ProcessStatus AmplifierEffect::processImpl(SampleFrame* buf, const fpp_t frames)
 {
-	if (!isEnabled() || !isRunning()) { return false ; }
-
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-
 	const ValueBuffer* volumeBuf = m_ampControls.m_volumeModel.valueBuffer();
 	const ValueBuffer* panBuf = m_ampControls.m_panModel.valueBuffer();
 	const ValueBuffer* leftBuf = m_ampControls.m_leftModel.valueBuffer();
@@ -80,19 +74,10 @@ bool AmplifierEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 		const float panLeft = std::min(1.0f, 1.0f - pan);
 		const float panRight = std::min(1.0f, 1.0f + pan);
 
-		auto& currentFrame = buf[f];
-
-		const auto s = currentFrame * SampleFrame(left * panLeft, right * panRight) * volume;
-
-		// Dry/wet mix
-		currentFrame = currentFrame * d + s * w;
-
-		outSum += currentFrame.sumOfSquaredAmplitudes();
+		buf[f] = buf[f] * SampleFrame(left * panLeft, right * panRight) * volume;
 	}
 
-	checkGate(outSum / frames);
-
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -144,6 +144,8 @@ void AudioFileProcessor::playNote( NotePlayHandle * _n,
 				srcmode = SRC_SINC_MEDIUM_QUALITY;
 				break;
 		}
+		// trade interpolation quality for CPU time while the engine is overloaded
+		srcmode = Engine::audioEngine()->overloadManager().interpolationMode(srcmode);
 		_n->m_pluginData = new Sample::PlaybackState(_n->hasDetuningInfo(), srcmode);
 		static_cast<Sample::PlaybackState*>(_n->m_pluginData)->setFrameIndex(m_nextPlayStartPoint);
 		static_cast<Sample::PlaybackState*>(_n->m_pluginData)->setBackwards(m_nextPlayBackwards);
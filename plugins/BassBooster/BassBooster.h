@@ -38,7 +38,7 @@ class BassBoosterEffect : public Effect
 public:
 	BassBoosterEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	~BassBoosterEffect() override = default;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 
 	EffectControls* controls() override
 	{
@@ -25,18 +25,14 @@
 
 #include "Bitcrush.h"
 #include "embed.h"
+#include "lmms_math.h"
 #include "plugin_export.h"
 
 namespace lmms
 {
 
 
-const int OS_RATE = 5;
-const float OS_RATIO = 1.0f / OS_RATE;
-const float CUTOFF_RATIO = 0.353553391f;
-const int SILENCEFRAMES = 10;
-const auto OS_RESAMPLE = std::array{0.0001490062883964112f, 0.1645978376763992f, 0.6705063120704088f,
-		0.1645978376763992f, 0.0001490062883964112f };
+const int OS_RATE = 4;
 
 extern "C"
 {
@@ -59,11 +55,9 @@ Plugin::Descriptor PLUGIN_EXPORT bitcrush_plugin_descriptor =
 BitcrushEffect::BitcrushEffect( Model * parent, const Descriptor::SubPluginFeatures::Key * key ) :
 	Effect( &bitcrush_plugin_descriptor, parent, key ),
 	m_controls( this ),
-	m_sampleRate( Engine::audioEngine()->outputSampleRate() ),
-	m_filter( m_sampleRate )
+	m_sampleRate( Engine::audioEngine()->outputSampleRate() )
 {
-	m_buffer = new SampleFrame[Engine::audioEngine()->framesPerPeriod() * OS_RATE];
-	m_filter.setLowpass( m_sampleRate * ( CUTOFF_RATIO * OS_RATIO ) );
+	setOversampling( OS_RATE );
 	m_needsUpdate = true;
 
 	m_bitCounterL = 0.0f;
@@ -71,21 +65,12 @@ BitcrushEffect::BitcrushEffect( Model * parent, const Descriptor::SubPluginFeatu
 
 	m_left = 0.0f;
 	m_right = 0.0f;
-
-	m_silenceCounter = 0;
-}
-
-BitcrushEffect::~BitcrushEffect()
-{
-	delete[] m_buffer;
 }
 
 
 void BitcrushEffect::sampleRateChanged()
 {
 	m_sampleRate = Engine::audioEngine()->outputSampleRate();
-	m_filter.setSampleRate( m_sampleRate );
-	m_filter.setLowpass( m_sampleRate * ( CUTOFF_RATIO * OS_RATIO ) );
 	m_needsUpdate = true;
 }
 
@@ -100,13 +85,8 @@ inline float BitcrushEffect::noise( float amt )
 	return fastRandf( amt * 2.0f ) - amt;
 }
 
-bool BitcrushEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
+Effect::ProcessStatus BitcrushEffect::processImpl( SampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-
 	// update values
 	if( m_needsUpdate || m_controls.m_rateEnabled.isValueChanged() )
 	{
@@ -123,8 +103,8 @@ bool BitcrushEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 		const float rate = m_controls.m_rate.value();
 		const float diff = m_controls.m_stereoDiff.value() * 0.005 * rate;
 
-		m_rateCoeffL = ( m_sampleRate * OS_RATE ) / ( rate - diff );
-		m_rateCoeffR = ( m_sampleRate * OS_RATE ) / ( rate + diff );
+		m_rateCoeffL = ( m_sampleRate * oversampling() ) / ( rate - diff );
+		m_rateCoeffR = ( m_sampleRate * oversampling() ) / ( rate + diff );
 
 		m_bitCounterL = 0.0f;
 		m_bitCounterR = 0.0f;
@@ -150,98 +130,46 @@ bool BitcrushEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 
 	const float noiseAmt = m_controls.m_inNoise.value() * 0.01f;
 
-	// read input buffer and write it to oversampled buffer
-	if( m_rateEnabled ) // rate crushing enabled so do that
+	// crush at the oversampled rate, so the steps are filtered before they alias
+	SampleFrame* osBuf = upsample( buf, frames );
+	const fpp_t osFrames = frames * oversampling();
+	for( fpp_t f = 0; f < osFrames; ++f )
 	{
-		for( int f = 0; f < frames; ++f )
+		const float inL = osBuf[f][0] * m_inGain + noise( osBuf[f][0] * noiseAmt );
+		const float inR = osBuf[f][1] * m_inGain + noise( osBuf[f][1] * noiseAmt );
+		if( m_rateEnabled ) // rate crushing enabled: sample and hold
 		{
-			for( int o = 0; o < OS_RATE; ++o )
+			m_bitCounterL += 1.0f;
+			m_bitCounterR += 1.0f;
+			if( m_bitCounterL > m_rateCoeffL )
 			{
-				m_buffer[f * OS_RATE + o][0] = m_left;
-				m_buffer[f * OS_RATE + o][1] = m_right;
-				m_bitCounterL += 1.0f;
-				m_bitCounterR += 1.0f;
-				if( m_bitCounterL > m_rateCoeffL )
-				{
-					m_bitCounterL -= m_rateCoeffL;
-					m_left = m_depthEnabled
-						? depthCrush( buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt ) )
-						: buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt );
-				}
-				if( m_bitCounterR > m_rateCoeffR )
-				{
-					m_bitCounterR -= m_rateCoeffR;
-					m_right = m_depthEnabled
-						? depthCrush( buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt ) )
-						: buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt );
-				}
+				m_bitCounterL -= m_rateCoeffL;
+				m_left = m_depthEnabled ? depthCrush( inL ) : inL;
 			}
-		}
-	}
-	else // rate crushing disabled: simply oversample with zero-order hold
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			for( int o = 0; o < OS_RATE; ++o )
+			if( m_bitCounterR > m_rateCoeffR )
 			{
-				m_buffer[f * OS_RATE + o][0] = m_depthEnabled
-					? depthCrush( buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt ) )
-					: buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt );
-				m_buffer[f * OS_RATE + o][1] = m_depthEnabled
-					? depthCrush( buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt ) )
-					: buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt );
+				m_bitCounterR -= m_rateCoeffR;
+				m_right = m_depthEnabled ? depthCrush( inR ) : inR;
 			}
-		}
-	}
-
-	// the oversampled buffer is now written, so filter it to reduce aliasing
-
-	for( int f = 0; f < frames * OS_RATE; ++f )
-	{
-		if( qMax( qAbs( m_buffer[f][0] ), qAbs( m_buffer[f][1] ) ) >= 1.0e-10f )
-		{
-			m_silenceCounter = 0;
-			m_buffer[f][0] = m_filter.update( m_buffer[f][0], 0 );
-			m_buffer[f][1] = m_filter.update( m_buffer[f][1], 1 );
+			osBuf[f][0] = m_left;
+			osBuf[f][1] = m_right;
 		}
 		else
 		{
-			if( m_silenceCounter > SILENCEFRAMES )
-			{
-				m_buffer[f][0] = m_buffer[f][1] = 0.0f;
-			}
-			else
-			{
-				++m_silenceCounter;
-				m_buffer[f][0] = m_filter.update( m_buffer[f][0], 0 );
-				m_buffer[f][1] = m_filter.update( m_buffer[f][1], 1 );
-			}
+			osBuf[f][0] = m_depthEnabled ? depthCrush( inL ) : inL;
+			osBuf[f][1] = m_depthEnabled ? depthCrush( inR ) : inR;
 		}
 	}
 
-
 	// now downsample and write it back to main buffer
-
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-	for( int f = 0; f < frames; ++f )
+	downsample( buf, frames );
+	for( fpp_t f = 0; f < frames; ++f )
 	{
-		float lsum = 0.0f;
-		float rsum = 0.0f;
-		for( int o = 0; o < OS_RATE; ++o )
-		{
-			lsum += m_buffer[f * OS_RATE + o][0] * OS_RESAMPLE[o];
-			rsum += m_buffer[f * OS_RATE + o][1] * OS_RESAMPLE[o];
-		}
-		buf[f][0] = d * buf[f][0] + w * qBound( -m_outClip, lsum, m_outClip ) * m_outGain;
-		buf[f][1] = d * buf[f][1] + w * qBound( -m_outClip, rsum, m_outClip ) * m_outGain;
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
+		buf[f][0] = qBound( -m_outClip, buf[f][0], m_outClip ) * m_outGain;
+		buf[f][1] = qBound( -m_outClip, buf[f][1], m_outClip ) * m_outGain;
 	}
 
-	checkGate( outSum / frames );
-
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
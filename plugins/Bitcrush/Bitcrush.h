@@ -29,7 +29,6 @@
 
 #include "Effect.h"
 #include "BitcrushControls.h"
-#include "BasicFilters.h"
 
 
 namespace lmms
@@ -40,8 +39,7 @@ class BitcrushEffect : public Effect
 {
 public:
 	BitcrushEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
-	~BitcrushEffect() override;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 
 	EffectControls* controls() override
 	{
@@ -55,9 +53,7 @@ private:
 
 	BitcrushControls m_controls;
 	
-	SampleFrame* m_buffer;
 	float m_sampleRate;
-	StereoLinkwitzRiley m_filter;
 	
 	float m_bitCounterL;
 	float m_rateCoeffL;
@@ -77,8 +73,6 @@ private:
 	float m_outClip;
 
 	bool m_needsUpdate;
-	
-	int m_silenceCounter;
 
 	friend class BitcrushControls;
 };
@@ -28,6 +28,7 @@
 #include "interpolation.h"
 #include "lmms_math.h"
 #include "plugin_export.h"
+#include "ScratchArena.h"
 
 namespace lmms
 {
@@ -54,15 +55,13 @@ Plugin::Descriptor PLUGIN_EXPORT compressor_plugin_descriptor =
 
 CompressorEffect::CompressorEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key) :
 	Effect(&compressor_plugin_descriptor, parent, key),
-	m_compressorControls(this)
+	m_compressorControls(this),
+	m_levelDetector(COMP_NOISE_FLOOR),
+	m_crestFactor(COMP_NOISE_FLOOR),
+	m_envelopeFollower(COMP_NOISE_FLOOR)
 {
 	m_sampleRate = Engine::audioEngine()->outputSampleRate();
 
-	m_yL[0] = m_yL[1] = COMP_NOISE_FLOOR;
-
-	// 200 ms
-	m_crestTimeConst = exp(-1.f / (0.2f * m_sampleRate));
-
 	connect(&m_compressorControls.m_attackModel, SIGNAL(dataChanged()), this, SLOT(calcAttack()), Qt::DirectConnection);
 	connect(&m_compressorControls.m_releaseModel, SIGNAL(dataChanged()), this, SLOT(calcRelease()), Qt::DirectConnection);
 	connect(&m_compressorControls.m_holdModel, SIGNAL(dataChanged()), this, SLOT(calcHold()), Qt::DirectConnection);
@@ -94,14 +93,6 @@ CompressorEffect::CompressorEffect(Model* parent, const Descriptor::SubPluginFea
 
 
 
-float CompressorEffect::msToCoeff(float ms)
-{
-	// Convert time in milliseconds to applicable lowpass coefficient
-	return exp(m_coeffPrecalc / ms);
-}
-
-
-
 void CompressorEffect::calcAutoMakeup()
 {
 	// Formulas using the compressor's Threshold, Ratio, and Knee values to estimate a good makeup gain value
@@ -126,29 +117,31 @@ void CompressorEffect::calcAutoMakeup()
 
 void CompressorEffect::calcAttack()
 {
-	m_attCoeff = msToCoeff(m_compressorControls.m_attackModel.value());
+	m_envelopeFollower.setTimes(m_compressorControls.m_attackModel.value(), m_compressorControls.m_releaseModel.value());
 }
 
 void CompressorEffect::calcRelease()
 {
-	m_relCoeff = msToCoeff(m_compressorControls.m_releaseModel.value());
+	m_envelopeFollower.setTimes(m_compressorControls.m_attackModel.value(), m_compressorControls.m_releaseModel.value());
 }
 
 void CompressorEffect::calcAutoAttack()
 {
 	m_autoAttVal = m_compressorControls.m_autoAttackModel.value() * 0.01f;
+	// We want the "resting value" of our crest factor to be with a sine wave,
+	// which has a crest factor of 2.
+	m_envelopeFollower.setAutoTime(m_autoAttVal, m_autoRelVal, 2.f);
 }
 
 void CompressorEffect::calcAutoRelease()
 {
 	m_autoRelVal = m_compressorControls.m_autoReleaseModel.value() * 0.01f;
+	m_envelopeFollower.setAutoTime(m_autoAttVal, m_autoRelVal, 2.f);
 }
 
 void CompressorEffect::calcHold()
 {
-	m_holdLength = m_compressorControls.m_holdModel.value() * 0.001f * m_sampleRate;
-	m_holdTimer[0] = 0;
-	m_holdTimer[1] = 0;
+	m_envelopeFollower.setHold(m_compressorControls.m_holdModel.value() * 0.001f * m_sampleRate);
 }
 
 void CompressorEffect::calcOutGain()
@@ -233,33 +226,27 @@ void CompressorEffect::calcMix()
 
 
 
-bool CompressorEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
+void CompressorEffect::processBypassedImpl()
 {
-	if (!isEnabled() || !isRunning())
-	{
-		// Clear lookahead buffers and other values when needed
-		if (!m_cleanedBuffers)
-		{
-			m_yL[0] = m_yL[1] = COMP_NOISE_FLOOR;
-			m_gainResult[0] = m_gainResult[1] = 1;
-			m_displayPeak[0] = m_displayPeak[1] = COMP_NOISE_FLOOR;
-			m_displayGain[0] = m_displayGain[1] = COMP_NOISE_FLOOR;
-			std::fill(std::begin(m_scLookBuf[0]), std::end(m_scLookBuf[0]), COMP_NOISE_FLOOR);
-			std::fill(std::begin(m_scLookBuf[1]), std::end(m_scLookBuf[1]), COMP_NOISE_FLOOR);
-			std::fill(std::begin(m_inLookBuf[0]), std::end(m_inLookBuf[0]), 0);
-			std::fill(std::begin(m_inLookBuf[1]), std::end(m_inLookBuf[1]), 0);
-			m_cleanedBuffers = true;
-		}
-		return false;
-	}
-	else
+	// Clear lookahead buffers and other values when needed
+	if (!m_cleanedBuffers)
 	{
-		m_cleanedBuffers = false;
+		m_envelopeFollower.reset();
+		m_gainResult[0] = m_gainResult[1] = 1;
+		m_displayPeak[0] = m_displayPeak[1] = COMP_NOISE_FLOOR;
+		m_displayGain[0] = m_displayGain[1] = COMP_NOISE_FLOOR;
+		m_scLookahead.fill(COMP_NOISE_FLOOR);
+		m_inLookahead.fill(0);
+		m_cleanedBuffers = true;
 	}
+}
 
-	float outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
+
+
+
+Effect::ProcessStatus CompressorEffect::processImpl(SampleFrame* buf, const fpp_t frames)
+{
+	m_cleanedBuffers = false;
 
 	float lOutPeak = 0.0;
 	float rOutPeak = 0.0;
@@ -279,120 +266,86 @@ bool CompressorEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 	const bool feedback = m_compressorControls.m_feedbackModel.value();
 	const bool lookahead = m_compressorControls.m_lookaheadModel.value();
 
-	for(fpp_t f = 0; f < frames; ++f)
+	const float inBalanceL = inBalance > 0 ? 1 - inBalance : 1;
+	const float inBalanceR = inBalance < 0 ? 1 + inBalance : 1;
+	const float outBalanceL = outBalance > 0 ? 1 - outBalance : 1;
+	const float outBalanceR = outBalance < 0 ? 1 + outBalance : 1;
+	const float stereoBalanceL = stereoBalance > 0 ? 1 - stereoBalance : 1;
+	const float stereoBalanceR = stereoBalance < 0 ? 1 + stereoBalance : 1;
+
+	m_levelDetector.setRms(!peakmode, m_rmsTimeConst);
+	m_compressorGain.setCurve(m_thresholdVal, limiter ? 0 : m_ratioVal, m_kneeVal);
+
+	auto scratch = ScratchArena::Scope{};
+	SampleFrame* sidechain = ScratchArena::frames(frames);
+	SampleFrame* crestFactor = ScratchArena::frames(frames);
+	SampleFrame* gain = ScratchArena::frames(frames);
+	SampleFrame* delayedDry = ScratchArena::frames(frames);
+
+	// Every stage runs over the whole block, except with feedback, where the
+	// sidechain of every frame is the output of the frame before.
+	const fpp_t blockSize = (feedback && !lookahead) ? 1 : frames;
+	for (fpp_t start = 0; start < frames; start += blockSize)
 	{
-		auto drySignal = std::array{buf[f][0], buf[f][1]};
-		auto s = std::array{drySignal[0] * m_inGainVal, drySignal[1] * m_inGainVal};
-
-		// Calculate tilt filters, to bias the sidechain to the low or high frequencies
-		if (m_tiltVal)
-		{
-			calcTiltFilter(s[0], s[0], 0);
-			calcTiltFilter(s[1], s[1], 1);
-		}
-
-		if (midside)// Convert left/right to mid/side
-		{
-			const float temp = s[0];
-			s[0] = (temp + s[1]) * 0.5;
-			s[1] = temp - s[1];
-		}
-
-		s[0] *= inBalance > 0 ? 1 - inBalance : 1;
-		s[1] *= inBalance < 0 ? 1 + inBalance : 1;
-
-		m_gainResult[0] = 0;
-		m_gainResult[1] = 0;
+		SampleFrame* block = buf + start;
+		const fpp_t blockFrames = std::min(blockSize, frames - start);
 
-		for (int i = 0; i < 2; i++)
+		for (fpp_t f = 0; f < blockFrames; ++f)
 		{
-			float inputValue = (feedback && !lookahead) ? m_prevOut[i] : s[i];
+			SampleFrame s = block[f] * m_inGainVal;
 
-			// Calculate the crest factor of the audio by diving the peak by the RMS
-			m_crestPeakVal[i] = qMax(qMax(COMP_NOISE_FLOOR, inputValue * inputValue), m_crestTimeConst * m_crestPeakVal[i] + (1 - m_crestTimeConst) * (inputValue * inputValue));
-			m_crestRmsVal[i] = qMax(COMP_NOISE_FLOOR, m_crestTimeConst * m_crestRmsVal[i] + ((1 - m_crestTimeConst) * (inputValue * inputValue)));
-			m_crestFactorVal[i] = m_crestPeakVal[i] / m_crestRmsVal[i];
-
-			m_rmsVal[i] = m_rmsTimeConst * m_rmsVal[i] + ((1 - m_rmsTimeConst) * (inputValue * inputValue));
-
-			// Grab the peak or RMS value
-			inputValue = qMax(COMP_NOISE_FLOOR, peakmode ? std::abs(inputValue) : std::sqrt(m_rmsVal[i]));
-
-			float t = inputValue;
-
-			if (t > m_yL[i])// Attack phase
-			{
-				// We want the "resting value" of our crest factor to be with a sine wave,
-				// which with this variable has a value of 2.
-				// So, we pull this value down to 0, and multiply it by the percentage of
-				// automatic attack control that is applied.  We then add 2 back to it.
-				float crestFactorValTemp = ((m_crestFactorVal[i] - 2.f) * m_autoAttVal) + 2.f;
-
-				// Calculate attack value depending on crest factor
-				const float att = m_autoAttVal
-					? msToCoeff(2.f * m_compressorControls.m_attackModel.value() / (crestFactorValTemp))
-					: m_attCoeff;
-
-				m_yL[i] = m_yL[i] * att + (1 - att) * t;
-				m_holdTimer[i] = m_holdLength;// Reset hold timer
-			}
-			else// Release phase
+			// Calculate tilt filters, to bias the sidechain to the low or high frequencies
+			if (m_tiltVal)
 			{
-				float crestFactorValTemp = ((m_crestFactorVal[i] - 2.f) * m_autoRelVal) + 2.f;
-
-				const float rel = m_autoRelVal
-					? msToCoeff(2.f * m_compressorControls.m_releaseModel.value() / (crestFactorValTemp))
-					: m_relCoeff;
-
-				if (m_holdTimer[i])// Don't change peak if hold is being applied
-				{
-					--m_holdTimer[i];
-				}
-				else
-				{
-					m_yL[i] = m_yL[i] * rel + (1 - rel) * t;
-				}
+				calcTiltFilter(s[0], s[0], 0);
+				calcTiltFilter(s[1], s[1], 1);
 			}
 
-			// Keep it above the noise floor
-			m_yL[i] = qMax(COMP_NOISE_FLOOR, m_yL[i]);
-			
-			float scVal = m_yL[i];
-			
-			if (lookahead)
+			if (midside)// Convert left/right to mid/side
 			{
-				const float temp = scVal;
-				// Lookahead is calculated by picking the largest value between
-				// the current sidechain signal and the delayed sidechain signal.
-				scVal = std::max(m_scLookBuf[i][m_lookWrite], m_scLookBuf[i][(m_lookWrite + m_lookBufLength - m_lookaheadLength) % m_lookBufLength]);
-				m_scLookBuf[i][m_lookWrite] = temp;
+				const float temp = s[0];
+				s[0] = (temp + s[1]) * 0.5;
+				s[1] = temp - s[1];
 			}
 
-			// For the visualizer
-			m_displayPeak[i] = qMax(scVal, m_displayPeak[i]);
+			s[0] *= inBalanceL;
+			s[1] *= inBalanceR;
+			sidechain[f] = s;
+		}
 
-			const float currentPeakDbfs = ampToDbfs(scVal);
+		if (feedback && !lookahead)
+		{
+			sidechain[0] = SampleFrame(m_prevOut[0], m_prevOut[1]);
+		}
 
-			// Now find the gain change that should be applied,
-			// depending on the measured input value.
-			if (currentPeakDbfs - m_thresholdVal < -m_kneeVal)// Below knee
-			{
-				m_gainResult[i] = currentPeakDbfs;
-			}
-			else if (currentPeakDbfs - m_thresholdVal < m_kneeVal)// Within knee
-			{
-				const float temp = currentPeakDbfs - m_thresholdVal + m_kneeVal;
-				m_gainResult[i] = currentPeakDbfs + ((limiter ? 0 : m_ratioVal) - 1) * temp * temp / (4 * m_kneeVal);
-			}
-			else// Above knee
-			{
-				m_gainResult[i] = limiter
-					? m_thresholdVal
-					: m_thresholdVal + (currentPeakDbfs - m_thresholdVal) * m_ratioVal;
-			}
+		// Calculate the crest factor of the audio by diving the peak by the RMS,
+		// then grab the peak or RMS value and follow it
+		m_crestFactor.process(sidechain, crestFactor, blockFrames);
+		m_levelDetector.process(sidechain, gain, blockFrames);
+		m_envelopeFollower.process(gain, crestFactor, gain, blockFrames);
 
-			m_gainResult[i] = dbfsToAmp(m_gainResult[i]) / scVal;
-			m_gainResult[i] = qMax(m_rangeVal, m_gainResult[i]);
+		if (lookahead)
+		{
+			// Lookahead is calculated by picking the largest value between
+			// the current sidechain signal and the delayed sidechain signal.
+			m_scLookahead.write(gain, blockFrames);
+			m_scLookahead.readWithLookahead(gain, blockFrames, m_lookBufLength, m_lookaheadLength);
+		}
+
+		// For the visualizer
+		for (fpp_t f = 0; f < blockFrames; ++f)
+		{
+			m_displayPeak[0] = qMax(gain[f][0], m_displayPeak[0]);
+			m_displayPeak[1] = qMax(gain[f][1], m_displayPeak[1]);
+		}
+
+		// Now find the gain change that should be applied,
+		// depending on the measured input value.
+		m_compressorGain.process(gain, gain, blockFrames);
+		for (fpp_t f = 0; f < blockFrames; ++f)
+		{
+			gain[f][0] = qMax(m_rangeVal, gain[f][0]);
+			gain[f][1] = qMax(m_rangeVal, gain[f][1]);
 		}
 
 		switch (static_cast<StereoLinkMode>(stereoLink))
@@ -403,42 +356,60 @@ bool CompressorEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 			}
 			case StereoLinkMode::Maximum:
 			{
-				m_gainResult[0] = m_gainResult[1] = qMin(m_gainResult[0], m_gainResult[1]);
+				for (fpp_t f = 0; f < blockFrames; ++f)
+				{
+					gain[f] = SampleFrame(qMin(gain[f][0], gain[f][1]));
+				}
 				break;
 			}
 			case StereoLinkMode::Average:
 			{
-				m_gainResult[0] = m_gainResult[1] = (m_gainResult[0] + m_gainResult[1]) * 0.5f;
+				for (fpp_t f = 0; f < blockFrames; ++f)
+				{
+					gain[f] = SampleFrame((gain[f][0] + gain[f][1]) * 0.5f);
+				}
 				break;
 			}
 			case StereoLinkMode::Minimum:
 			{
-				m_gainResult[0] = m_gainResult[1] = qMax(m_gainResult[0], m_gainResult[1]);
+				for (fpp_t f = 0; f < blockFrames; ++f)
+				{
+					gain[f] = SampleFrame(qMax(gain[f][0], gain[f][1]));
+				}
 				break;
 			}
 			case StereoLinkMode::Blend:
 			{
-				if (blend > 0)// 0 is unlinked
+				if (blend <= 0)// 0 is unlinked
+				{
+					break;
+				}
+
+				if (blend <= 1)// Blend to minimum volume
 				{
-					if (blend <= 1)// Blend to minimum volume
+					for (fpp_t f = 0; f < blockFrames; ++f)
 					{
-						const float temp1 = qMin(m_gainResult[0], m_gainResult[1]);
-						m_gainResult[0] = linearInterpolate(m_gainResult[0], temp1, blend);
-						m_gainResult[1] = linearInterpolate(m_gainResult[1], temp1, blend);
+						const float temp1 = qMin(gain[f][0], gain[f][1]);
+						gain[f] = SampleFrame(linearInterpolate(gain[f][0], temp1, blend),
+							linearInterpolate(gain[f][1], temp1, blend));
 					}
-					else if (blend <= 2)// Blend to average volume
+				}
+				else if (blend <= 2)// Blend to average volume
+				{
+					for (fpp_t f = 0; f < blockFrames; ++f)
 					{
-						const float temp1 = qMin(m_gainResult[0], m_gainResult[1]);
-						const float temp2 = (m_gainResult[0] + m_gainResult[1]) * 0.5f;
-						m_gainResult[0] = linearInterpolate(temp1, temp2, blend - 1);
-						m_gainResult[1] = m_gainResult[0];
+						const float temp1 = qMin(gain[f][0], gain[f][1]);
+						const float temp2 = (gain[f][0] + gain[f][1]) * 0.5f;
+						gain[f] = SampleFrame(linearInterpolate(temp1, temp2, blend - 1));
 					}
-					else// Blend to maximum volume
+				}
+				else// Blend to maximum volume
+				{
+					for (fpp_t f = 0; f < blockFrames; ++f)
 					{
-						const float temp1 = (m_gainResult[0] + m_gainResult[1]) * 0.5f;
-						const float temp2 = qMax(m_gainResult[0], m_gainResult[1]);
-						m_gainResult[0] = linearInterpolate(temp1, temp2, blend - 2);
-						m_gainResult[1] = m_gainResult[0];
+						const float temp1 = (gain[f][0] + gain[f][1]) * 0.5f;
+						const float temp2 = qMax(gain[f][0], gain[f][1]);
+						gain[f] = SampleFrame(linearInterpolate(temp1, temp2, blend - 2));
 					}
 				}
 				break;
@@ -448,91 +419,91 @@ bool CompressorEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 		// Bias compression to the left or right (or mid or side)
 		if (stereoBalance != 0)
 		{
-			m_gainResult[0] = 1 - ((1 - m_gainResult[0]) * (stereoBalance > 0 ? 1 - stereoBalance : 1));
-			m_gainResult[1] = 1 - ((1 - m_gainResult[1]) * (stereoBalance < 0 ? 1 + stereoBalance : 1));
+			for (fpp_t f = 0; f < blockFrames; ++f)
+			{
+				gain[f][0] = 1 - ((1 - gain[f][0]) * stereoBalanceL);
+				gain[f][1] = 1 - ((1 - gain[f][1]) * stereoBalanceR);
+			}
 		}
 
 		// For visualizer
-		m_displayGain[0] = qMax(m_gainResult[0], m_displayGain[0]);
-		m_displayGain[1] = qMax(m_gainResult[1], m_displayGain[1]);
+		for (fpp_t f = 0; f < blockFrames; ++f)
+		{
+			m_displayGain[0] = qMax(gain[f][0], m_displayGain[0]);
+			m_displayGain[1] = qMax(gain[f][1], m_displayGain[1]);
+		}
+		m_gainResult[0] = gain[blockFrames - 1][0];
+		m_gainResult[1] = gain[blockFrames - 1][1];
 
 		// Delay the signal by 20 ms via ring buffer if lookahead is enabled
+		const SampleFrame* delayedDrySignal = block;
 		if (lookahead)
 		{
-			s[0] = m_inLookBuf[0][m_lookWrite];
-			s[1] = m_inLookBuf[1][m_lookWrite];
-			m_inLookBuf[0][m_lookWrite] = drySignal[0];
-			m_inLookBuf[1][m_lookWrite] = drySignal[1];
+			m_inLookahead.write(block, blockFrames);
+			m_inLookahead.read(delayedDry, blockFrames, m_lookBufLength);
+			delayedDrySignal = delayedDry;
 		}
-		else
+
+		for (fpp_t f = 0; f < blockFrames; ++f)
 		{
-			s[0] = drySignal[0];
-			s[1] = drySignal[1];
-		}
+			const SampleFrame drySignal = block[f];
+			SampleFrame s = delayedDrySignal[f];
+			const SampleFrame dry = s;
 
-		auto delayedDrySignal = std::array{s[0], s[1]};
+			if (midside)// Convert left/right to mid/side
+			{
+				const float temp = s[0];
+				s[0] = (temp + s[1]) * 0.5;
+				s[1] = temp - s[1];
+			}
 
-		if (midside)// Convert left/right to mid/side
-		{
-			const float temp = s[0];
-			s[0] = (temp + s[1]) * 0.5;
-			s[1] = temp - s[1];
-		}
+			s[0] *= inBalanceL;
+			s[1] *= inBalanceR;
+
+			s[0] *= gain[f][0] * m_inGainVal * m_outGainVal * outBalanceL;
+			s[1] *= gain[f][1] * m_inGainVal * m_outGainVal * outBalanceR;
 
-		s[0] *= inBalance > 0 ? 1 - inBalance : 1;
-		s[1] *= inBalance < 0 ? 1 + inBalance : 1;
+			if (midside)// Convert mid/side back to left/right
+			{
+				const float temp1 = s[0];
+				const float temp2 = s[1] * 0.5;
+				s[0] = temp1 + temp2;
+				s[1] = temp1 - temp2;
+			}
 
-		s[0] *= m_gainResult[0] * m_inGainVal * m_outGainVal * (outBalance > 0 ? 1 - outBalance : 1);
-		s[1] *= m_gainResult[1] * m_inGainVal * m_outGainVal * (outBalance < 0 ? 1 + outBalance : 1);
+			m_prevOut[0] = s[0];
+			m_prevOut[1] = s[1];
 
-		if (midside)// Convert mid/side back to left/right
-		{
-			const float temp1 = s[0];
-			const float temp2 = s[1] * 0.5;
-			s[0] = temp1 + temp2;
-			s[1] = temp1 - temp2;
-		}
+			// Negate wet signal from dry signal
+			if (audition)
+			{
+				s[0] = (-s[0] + dry[0] * m_outGainVal * m_inGainVal);
+				s[1] = (-s[1] + dry[1] * m_outGainVal * m_inGainVal);
+			}
+			else if (autoMakeup)
+			{
+				s[0] *= m_autoMakeupVal;
+				s[1] *= m_autoMakeupVal;
+			}
 
-		m_prevOut[0] = s[0];
-		m_prevOut[1] = s[1];
+			// The wet/dry level is applied by Effect, with the dry signal
+			// delayed by the same lookahead
+			block[f][0] = (1 - m_mixVal) * dry[0] + m_mixVal * s[0];
+			block[f][1] = (1 - m_mixVal) * dry[1] + m_mixVal * s[1];
 
-		// Negate wet signal from dry signal
-		if (audition)
-		{
-			s[0] = (-s[0] + delayedDrySignal[0] * m_outGainVal * m_inGainVal);
-			s[1] = (-s[1] + delayedDrySignal[1] * m_outGainVal * m_inGainVal);
-		}
-		else if (autoMakeup)
-		{
-			s[0] *= m_autoMakeupVal;
-			s[1] *= m_autoMakeupVal;
+			lInPeak = drySignal[0] > lInPeak ? drySignal[0] : lInPeak;
+			rInPeak = drySignal[1] > rInPeak ? drySignal[1] : rInPeak;
+			lOutPeak = s[0] > lOutPeak ? s[0] : lOutPeak;
+			rOutPeak = s[1] > rOutPeak ? s[1] : rOutPeak;
 		}
-
-		// Calculate wet/dry value results
-		const float temp1 = delayedDrySignal[0];
-		const float temp2 = delayedDrySignal[1];
-		buf[f][0] = d * temp1 + w * s[0];
-		buf[f][1] = d * temp2 + w * s[1];
-		buf[f][0] = (1 - m_mixVal) * temp1 + m_mixVal * buf[f][0];
-		buf[f][1] = (1 - m_mixVal) * temp2 + m_mixVal * buf[f][1];
-
-		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
-		
-		if (--m_lookWrite < 0) { m_lookWrite = m_lookBufLength - 1; }
-
-		lInPeak = drySignal[0] > lInPeak ? drySignal[0] : lInPeak;
-		rInPeak = drySignal[1] > rInPeak ? drySignal[1] : rInPeak;
-		lOutPeak = s[0] > lOutPeak ? s[0] : lOutPeak;
-		rOutPeak = s[1] > rOutPeak ? s[1] : rOutPeak;
 	}
 
-	checkGate(outSum / frames);
 	m_compressorControls.m_outPeakL = lOutPeak;
 	m_compressorControls.m_outPeakR = rOutPeak;
 	m_compressorControls.m_inPeakL = lInPeak;
 	m_compressorControls.m_inPeakR = rInPeak;
 
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -562,18 +533,14 @@ void CompressorEffect::changeSampleRate()
 {
 	m_sampleRate = Engine::audioEngine()->outputSampleRate();
 
-	m_coeffPrecalc = COMP_LOG / (m_sampleRate * 0.001f);
+	m_envelopeFollower.setSampleRate(m_sampleRate);
 
 	// 200 ms
-	m_crestTimeConst = exp(-1.f / (0.2f * m_sampleRate));
+	m_crestFactor.setTimeConstant(exp(-1.f / (0.2f * m_sampleRate)));
 
 	m_lookBufLength = std::ceil((20.f / 1000.f) * m_sampleRate) + 2;
-	for (int i = 0; i < 2; ++i)
-	{
-		m_inLookBuf[i].resize(m_lookBufLength);
-		m_scLookBuf[i].resize(m_lookBufLength, COMP_NOISE_FLOOR);
-	}
-	m_lookWrite = 0;
+	m_inLookahead.resize(m_lookBufLength, 0);
+	m_scLookahead.resize(m_lookBufLength, COMP_NOISE_FLOOR);
 
 	calcThreshold();
 	calcKnee();
@@ -597,6 +564,14 @@ void CompressorEffect::changeSampleRate()
 
 
 
+f_cnt_t CompressorEffect::processLatency() const
+{
+	// with lookahead enabled, the signal goes through the whole lookahead buffer
+	return m_compressorControls.m_lookaheadModel.value() ? m_lookBufLength : 0;
+}
+
+
+
 extern "C"
 {
 
@@ -28,6 +28,7 @@
 
 #include "CompressorControls.h"
 
+#include "Dynamics.h"
 #include "Effect.h"
 
 
@@ -35,21 +36,22 @@ namespace lmms
 {
 
 
-constexpr float COMP_LOG = -2.2f;
-
 class CompressorEffect : public Effect
 {
 	Q_OBJECT
 public:
 	CompressorEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
 	~CompressorEffect() override = default;
-	bool processAudioBuffer(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
+	void processBypassedImpl() override;
 
 	EffectControls* controls() override
 	{
 		return &m_compressorControls;
 	}
 
+	f_cnt_t processLatency() const override;
+
 private slots:
 	void calcAutoMakeup();
 	void calcAttack();
@@ -73,26 +75,23 @@ private slots:
 private:
 	CompressorControls m_compressorControls;
 
-	float msToCoeff(float ms);
-
 	inline void calcTiltFilter(sample_t inputSample, sample_t &outputSample, int filtNum);
 	inline int realmod(int k, int n);
 	inline float realfmod(float k, float n);
 
 	enum class StereoLinkMode { Unlinked, Maximum, Average, Minimum, Blend };
 
-	std::array<std::vector<float>, 2> m_inLookBuf;
-	std::array<std::vector<float>, 2> m_scLookBuf;
-	int m_lookWrite;
-	int m_lookBufLength;
+	LevelDetector m_levelDetector;
+	CrestFactorDetector m_crestFactor;
+	EnvelopeFollower m_envelopeFollower;
+	CompressorGain m_compressorGain;
 
-	float m_attCoeff;
-	float m_relCoeff;
-	float m_autoAttVal;
-	float m_autoRelVal;
+	LookaheadDelay m_inLookahead;
+	LookaheadDelay m_scLookahead;
+	int m_lookBufLength;
 
-	int m_holdLength = 0;
-	int m_holdTimer[2] = {0, 0};
+	float m_autoAttVal = 0;
+	float m_autoRelVal = 0;
 
 	int m_lookaheadLength;
 	float m_thresholdAmpVal;
@@ -103,19 +102,11 @@ private:
 	float m_tiltVal;
 	float m_mixVal;
 
-	float m_coeffPrecalc;
-
 	SampleFrame m_maxLookaheadVal;
 
 	int m_maxLookaheadTimer[2] = {1, 1};
 	
 	float m_rmsTimeConst;
-	float m_rmsVal[2] = {0, 0};
-
-	float m_crestPeakVal[2] = {0, 0};
-	float m_crestRmsVal[2] = {0, 0};
-	float m_crestFactorVal[2] = {0, 0};
-	float m_crestTimeConst;
 
 	float m_tiltOut[2] = {0};
 
@@ -130,7 +121,6 @@ private:
 
 	float m_prevOut[2] = {0};
 
-	float m_yL[2];
 	float m_gainResult[2];
 	float m_displayPeak[2];
 	float m_displayGain[2];
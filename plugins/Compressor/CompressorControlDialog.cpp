@@ -389,8 +389,8 @@ void CompressorControlDialog::updateDisplay()
 	m_peakAvg = (m_controls->m_effect->m_displayPeak[0] + m_controls->m_effect->m_displayPeak[1]) * 0.5f;
 	m_gainAvg = (m_controls->m_effect->m_displayGain[0] + m_controls->m_effect->m_displayGain[1]) * 0.5f;
 
-	m_controls->m_effect->m_displayPeak[0] = m_controls->m_effect->m_yL[0];
-	m_controls->m_effect->m_displayPeak[1] = m_controls->m_effect->m_yL[1];
+	m_controls->m_effect->m_displayPeak[0] = m_controls->m_effect->m_envelopeFollower.envelope(0);
+	m_controls->m_effect->m_displayPeak[1] = m_controls->m_effect->m_envelopeFollower.envelope(1);
 	m_controls->m_effect->m_displayGain[0] = m_controls->m_effect->m_gainResult[0];
 	m_controls->m_effect->m_displayGain[1] = m_controls->m_effect->m_gainResult[1];
 
@@ -0,0 +1,154 @@
+/*
+ * ConvolutionReverb.cpp - reverb convolving with impulse responses
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ConvolutionReverb.h"
+
+#include "embed.h"
+#include "lmms_math.h"
+#include "plugin_export.h"
+
+namespace lmms
+{
+
+
+extern "C"
+{
+
+Plugin::Descriptor PLUGIN_EXPORT convolutionreverb_plugin_descriptor =
+{
+	LMMS_STRINGIFY(PLUGIN_NAME),
+	"Convolution Reverb",
+	QT_TRANSLATE_NOOP("PluginBrowser", "Reverb using the impulse response of a room or device"),
+	"LMMS team",
+	0x0100,
+	Plugin::Type::Effect,
+	new PluginPixmapLoader("logo"),
+	nullptr,
+	nullptr,
+} ;
+
+}
+
+
+
+
+ConvolutionReverbEffect::ConvolutionReverbEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key) :
+	Effect(&convolutionreverb_plugin_descriptor, parent, key),
+	m_controls(this)
+{
+}
+
+
+
+
+Effect::ProcessStatus ConvolutionReverbEffect::processImpl(SampleFrame* buf, const fpp_t frames)
+{
+	if (!m_convolver) { return ProcessStatus::Sleep; }
+
+	m_convolver->process(buf, buf, frames);
+	m_convolverCleared = false;
+
+	const float gain = targetGain();
+	const float gainInc = (gain - m_gain) / frames;
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		m_gain += gainInc;
+		buf[f] *= m_gain;
+	}
+	m_gain = gain;
+
+	return ProcessStatus::ContinueIfNotQuiet;
+}
+
+
+
+
+void ConvolutionReverbEffect::processBypassedImpl()
+{
+	// don't play the old tail when the effect runs again
+	if (m_convolver && !m_convolverCleared)
+	{
+		m_convolver->reset();
+		m_convolverCleared = true;
+		// the gain may have changed while bypassed, there is nothing to ramp
+		m_gain = targetGain();
+	}
+}
+
+
+
+
+void ConvolutionReverbEffect::loadImpulseResponse(const QString& file)
+{
+	auto ir = ImpulseResponse::load(file, Engine::audioEngine()->outputSampleRate());
+	if (!ir) { return; }
+
+	auto convolver = std::make_unique<Convolver>(std::move(ir));
+	{
+		const auto guard = Engine::audioEngine()->requestChangesGuard();
+		m_file = convolver->impulseResponse().file();
+		std::swap(m_convolver, convolver);
+		m_convolverCleared = true;
+		// the new response starts silent, so it doesn't need a ramp from the old level
+		m_gain = targetGain();
+	}
+	// the old convolver is only destroyed outside of the guard
+	emit m_controls.impulseResponseChanged();
+}
+
+
+
+
+float ConvolutionReverbEffect::targetGain() const
+{
+	const float normalization = m_controls.m_normalizeModel.value()
+		? m_convolver->impulseResponse().normalization()
+		: 1.f;
+	return dbfsToAmp(m_controls.m_gainModel.value()) * normalization;
+}
+
+
+
+
+void ConvolutionReverbEffect::changeSampleRate()
+{
+	if (!m_file.isEmpty()) { loadImpulseResponse(m_file); }
+}
+
+
+
+
+extern "C"
+{
+
+// necessary for getting instance out of shared lib
+PLUGIN_EXPORT Plugin* lmms_plugin_main(Model* parent, void* data)
+{
+	return new ConvolutionReverbEffect(parent, static_cast<const Plugin::Descriptor::SubPluginFeatures::Key*>(data));
+}
+
+}
+
+
+} // namespace lmms
@@ -0,0 +1,82 @@
+/*
+ * ConvolutionReverb.h - reverb convolving with impulse responses
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_CONVOLUTION_REVERB_H
+#define LMMS_CONVOLUTION_REVERB_H
+
+#include <memory>
+
+#include "ConvolutionReverbControls.h"
+#include "Convolver.h"
+#include "Effect.h"
+
+namespace lmms
+{
+
+
+class ConvolutionReverbEffect : public Effect
+{
+public:
+	ConvolutionReverbEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
+	~ConvolutionReverbEffect() override = default;
+	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
+	void processBypassedImpl() override;
+
+	EffectControls* controls() override
+	{
+		return &m_controls;
+	}
+
+	//! Convolve with \p file from now on, keeps the current response if it can't be loaded
+	void loadImpulseResponse(const QString& file);
+
+	//! Empty if no response is loaded
+	const QString& impulseResponseFile() const
+	{
+		return m_file;
+	}
+
+	void changeSampleRate();
+
+private:
+	//! Output gain the current controls ask for, requires a convolver
+	float targetGain() const;
+
+	ConvolutionReverbControls m_controls;
+
+	QString m_file;
+	std::unique_ptr<Convolver> m_convolver;
+	bool m_convolverCleared = true;
+
+	//! Output gain at the end of the last period, which the next one ramps from,
+	//! set to targetGain() whenever a response is loaded or the convolver is reset
+	float m_gain = 1.f;
+
+	friend class ConvolutionReverbControls;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_CONVOLUTION_REVERB_H
@@ -0,0 +1,90 @@
+/*
+ * ConvolutionReverbControlDialog.cpp - control dialog for the convolution reverb
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ConvolutionReverbControlDialog.h"
+#include "ConvolutionReverbControls.h"
+#include "ConvolutionReverb.h"
+
+#include <QFileInfo>
+#include <QLabel>
+#include <QPushButton>
+
+#include "Knob.h"
+#include "LedCheckBox.h"
+#include "SampleLoader.h"
+
+namespace lmms::gui
+{
+
+
+ConvolutionReverbControlDialog::ConvolutionReverbControlDialog(ConvolutionReverbControls* controls) :
+	EffectControlDialog(controls),
+	m_controls(controls)
+{
+	setFixedSize(220, 80);
+
+	auto openButton = new QPushButton(tr("Open"), this);
+	openButton->move(10, 10);
+	openButton->setToolTip(tr("Open an impulse response"));
+	connect(openButton, SIGNAL(clicked()), this, SLOT(openImpulseResponse()));
+
+	m_fileLabel = new QLabel(this);
+	m_fileLabel->setGeometry(10, 44, 140, 20);
+
+	auto gainKnob = new Knob(KnobType::Bright26, this);
+	gainKnob->move(170, 8);
+	gainKnob->setModel(&controls->m_gainModel);
+	gainKnob->setLabel(tr("GAIN"));
+	gainKnob->setHintText(tr("Output gain:"), " dB");
+
+	auto normalize = new LedCheckBox(tr("NORM"), this, tr("Normalize"), LedCheckBox::LedColor::Green);
+	normalize->move(160, 56);
+	normalize->setModel(&controls->m_normalizeModel);
+	normalize->setToolTip(tr("Bring the impulse response to the same energy as an impulse"));
+
+	connect(controls, SIGNAL(impulseResponseChanged()), this, SLOT(updateFileLabel()));
+	updateFileLabel();
+}
+
+
+
+
+void ConvolutionReverbControlDialog::openImpulseResponse()
+{
+	const auto file = SampleLoader::openAudioFile(m_controls->m_effect->impulseResponseFile());
+	if (!file.isEmpty()) { m_controls->m_effect->loadImpulseResponse(file); }
+}
+
+
+
+
+void ConvolutionReverbControlDialog::updateFileLabel()
+{
+	const auto& file = m_controls->m_effect->impulseResponseFile();
+	m_fileLabel->setText(file.isEmpty() ? tr("No impulse response") : QFileInfo(file).fileName());
+	m_fileLabel->setToolTip(file);
+}
+
+
+} // namespace lmms::gui
@@ -0,0 +1,85 @@
+/*
+ * ConvolutionReverbControls.cpp - controls for the convolution reverb
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ConvolutionReverbControls.h"
+#include "ConvolutionReverb.h"
+
+#include <QDomElement>
+#include <QFileInfo>
+
+#include "Engine.h"
+#include "PathUtil.h"
+#include "Song.h"
+
+namespace lmms
+{
+
+
+ConvolutionReverbControls::ConvolutionReverbControls(ConvolutionReverbEffect* effect) :
+	EffectControls(effect),
+	m_effect(effect),
+	m_gainModel(0.f, -60.f, 24.f, 0.1f, this, tr("Output gain")),
+	m_normalizeModel(true, this, tr("Normalize"))
+{
+	connect(Engine::audioEngine(), SIGNAL(sampleRateChanged()), this, SLOT(changeSampleRate()));
+}
+
+
+
+
+void ConvolutionReverbControls::loadSettings(const QDomElement& parent)
+{
+	m_gainModel.loadSettings(parent, "gain");
+	m_normalizeModel.loadSettings(parent, "normalize");
+
+	if (const auto file = parent.attribute("src"); !file.isEmpty())
+	{
+		if (QFileInfo(PathUtil::toAbsolute(file)).exists())
+		{
+			m_effect->loadImpulseResponse(file);
+		}
+		else { Engine::getSong()->collectError(QString("%1: %2").arg(tr("Impulse response not found"), file)); }
+	}
+}
+
+
+
+
+void ConvolutionReverbControls::saveSettings(QDomDocument& doc, QDomElement& parent)
+{
+	m_gainModel.saveSettings(doc, parent, "gain");
+	m_normalizeModel.saveSettings(doc, parent, "normalize");
+	parent.setAttribute("src", m_effect->impulseResponseFile());
+}
+
+
+
+
+void ConvolutionReverbControls::changeSampleRate()
+{
+	m_effect->changeSampleRate();
+}
+
+
+} // namespace lmms
@@ -28,6 +28,7 @@
 #include "lmms_math.h"
 #include "embed.h"
 #include "plugin_export.h"
+#include "ScratchArena.h"
 
 namespace lmms
 {
@@ -64,16 +65,6 @@ CrossoverEQEffect::CrossoverEQEffect( Model* parent, const Descriptor::SubPlugin
 	m_hp4( m_sampleRate ),
 	m_needsUpdate( true )
 {
-	m_tmp2 = new SampleFrame[Engine::audioEngine()->framesPerPeriod()];
-	m_tmp1 = new SampleFrame[Engine::audioEngine()->framesPerPeriod()];
-	m_work = new SampleFrame[Engine::audioEngine()->framesPerPeriod()];
-}
-
-CrossoverEQEffect::~CrossoverEQEffect()
-{
-	delete[] m_tmp1;
-	delete[] m_tmp2;
-	delete[] m_work;
 }
 
 void CrossoverEQEffect::sampleRateChanged()
@@ -89,13 +80,8 @@ void CrossoverEQEffect::sampleRateChanged()
 }
 
 
-bool CrossoverEQEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
+Effect::ProcessStatus CrossoverEQEffect::processImpl( SampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	
 	// filters update
 	if( m_needsUpdate || m_controls.m_xover12.isValueChanged() )
 	{
@@ -139,24 +125,28 @@ bool CrossoverEQEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames
 	
 	m_needsUpdate = false;
 	
-	zeroSampleFrames(m_work, frames);
-	
 	// run temp bands
+	auto scratch = ScratchArena::Scope{};
+	SampleFrame* tmp1 = ScratchArena::frames( frames );
+	SampleFrame* tmp2 = ScratchArena::frames( frames );
 	for( int f = 0; f < frames; ++f )
 	{
-		m_tmp1[f][0] = m_lp2.update( buf[f][0], 0 );
-		m_tmp1[f][1] = m_lp2.update( buf[f][1], 1 );
-		m_tmp2[f][0] = m_hp3.update( buf[f][0], 0 );
-		m_tmp2[f][1] = m_hp3.update( buf[f][1], 1 );
+		tmp1[f][0] = m_lp2.update( buf[f][0], 0 );
+		tmp1[f][1] = m_lp2.update( buf[f][1], 1 );
+		tmp2[f][0] = m_hp3.update( buf[f][0], 0 );
+		tmp2[f][1] = m_hp3.update( buf[f][1], 1 );
 	}
 
+	// the bands are summed up in the buffer
+	zeroSampleFrames(buf, frames);
+
 	// run band 1
 	if( mute1 )
 	{
 		for( int f = 0; f < frames; ++f )
 		{
-			m_work[f][0] += m_lp1.update( m_tmp1[f][0], 0 ) * m_gain1;
-			m_work[f][1] += m_lp1.update( m_tmp1[f][1], 1 ) * m_gain1;
+			buf[f][0] += m_lp1.update( tmp1[f][0], 0 ) * m_gain1;
+			buf[f][1] += m_lp1.update( tmp1[f][1], 1 ) * m_gain1;
 		}
 	}
 	
@@ -165,8 +155,8 @@ bool CrossoverEQEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames
 	{
 		for( int f = 0; f < frames; ++f )
 		{
-			m_work[f][0] += m_hp2.update( m_tmp1[f][0], 0 ) * m_gain2;
-			m_work[f][1] += m_hp2.update( m_tmp1[f][1], 1 ) * m_gain2;
+			buf[f][0] += m_hp2.update( tmp1[f][0], 0 ) * m_gain2;
+			buf[f][1] += m_hp2.update( tmp1[f][1], 1 ) * m_gain2;
 		}
 	}
 	
@@ -175,8 +165,8 @@ bool CrossoverEQEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames
 	{
 		for( int f = 0; f < frames; ++f )
 		{
-			m_work[f][0] += m_lp3.update( m_tmp2[f][0], 0 ) * m_gain3;
-			m_work[f][1] += m_lp3.update( m_tmp2[f][1], 1 ) * m_gain3;
+			buf[f][0] += m_lp3.update( tmp2[f][0], 0 ) * m_gain3;
+			buf[f][1] += m_lp3.update( tmp2[f][1], 1 ) * m_gain3;
 		}
 	}
 	
@@ -185,24 +175,12 @@ bool CrossoverEQEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames
 	{
 		for( int f = 0; f < frames; ++f )
 		{
-			m_work[f][0] += m_hp4.update( m_tmp2[f][0], 0 ) * m_gain4;
-			m_work[f][1] += m_hp4.update( m_tmp2[f][1], 1 ) * m_gain4;
+			buf[f][0] += m_hp4.update( tmp2[f][0], 0 ) * m_gain4;
+			buf[f][1] += m_hp4.update( tmp2[f][1], 1 ) * m_gain4;
 		}
 	}
 	
-	const float d = dryLevel();
-	const float w = wetLevel();
-	double outSum = 0.0;
-	for( int f = 0; f < frames; ++f )
-	{
-		buf[f][0] = d * buf[f][0] + w * m_work[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_work[f][1];
-		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
-	}
-	
-	checkGate( outSum / frames );
-	
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 void CrossoverEQEffect::clearFilterHistories()
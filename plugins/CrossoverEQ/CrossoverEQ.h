@@ -39,8 +39,7 @@ class CrossoverEQEffect : public Effect
 {
 public:
 	CrossoverEQEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
-	~CrossoverEQEffect() override;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 
 	EffectControls* controls() override
 	{
@@ -69,10 +68,6 @@ private:
 	StereoLinkwitzRiley m_hp3;
 	StereoLinkwitzRiley m_hp4;
 	
-	SampleFrame* m_tmp1;
-	SampleFrame* m_tmp2;
-	SampleFrame* m_work;
-	
 	bool m_needsUpdate;
 	
 	friend class CrossoverEQControls;
@@ -81,16 +81,9 @@ DelayEffect::~DelayEffect()
 
 
 
-bool DelayEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
+Effect::ProcessStatus DelayEffect::processImpl( SampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	double outSum = 0.0;
 	const float sr = Engine::audioEngine()->outputSampleRate();
-	const float d = dryLevel();
-	const float w = wetLevel();
 
 	SampleFrame peak;
 	float length = m_delayControls.m_delayTimeModel.value();
@@ -118,7 +111,6 @@ bool DelayEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 	for (fpp_t f = 0; f < frames; ++f)
 	{
 		auto& currentFrame = buf[f];
-		const auto dryS = currentFrame;
 
 		// Prepare delay for current sample
 		m_delay->setFeedback( *feedbackPtr );
@@ -133,21 +125,15 @@ bool DelayEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 		// Calculate peak of wet signal
 		peak = peak.absMax(currentFrame);
 
-		// Dry/wet mix
-		currentFrame = dryS * d + currentFrame * w;
-		
-		outSum += currentFrame.sumOfSquaredAmplitudes();
-
 		lengthPtr += lengthInc;
 		amplitudePtr += amplitudeInc;
 		lfoTimePtr += lfoTimeInc;
 		feedbackPtr += feedbackInc;
 	}
-	checkGate( outSum / frames );
 	m_delayControls.m_outPeakL = peak.left();
 	m_delayControls.m_outPeakR = peak.right();
 
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 void DelayEffect::changeSampleRate()
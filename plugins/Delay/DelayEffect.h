@@ -39,7 +39,7 @@ class DelayEffect : public Effect
 public:
 	DelayEffect(Model* parent , const Descriptor::SubPluginFeatures::Key* key );
 	~DelayEffect() override;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 	EffectControls* controls() override
 	{
 		return &m_delayControls;
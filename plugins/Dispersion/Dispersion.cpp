@@ -24,6 +24,8 @@
 
 #include "Dispersion.h"
 
+#include <algorithm>
+
 #include "embed.h"
 #include "plugin_export.h"
 
@@ -58,17 +60,8 @@ DispersionEffect::DispersionEffect(Model* parent, const Descriptor::SubPluginFea
 }
 
 
-bool DispersionEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
+Effect::ProcessStatus DispersionEffect::processImpl(SampleFrame* buf, const fpp_t frames)
 {
-	if (!isEnabled() || !isRunning())
-	{
-		return false;
-	}
-
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-	
 	const int amount = m_dispersionControls.m_amountModel.value();
 	const float freq = m_dispersionControls.m_freqModel.value();
 	const float reso = m_dispersionControls.m_resoModel.value();
@@ -81,6 +74,24 @@ bool DispersionEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 	float apCoeff1 = (1 - (a0 - 1)) / a0;
 	float apCoeff2 = (-2 * std::cos(w0)) / a0;
 	
+	// Ramp the coefficients over the block, so fast frequency and resonance changes don't click
+	if (!m_coeffsSet)
+	{
+		m_apCoeff1 = apCoeff1;
+		m_apCoeff2 = apCoeff2;
+		m_coeffsSet = true;
+	}
+	Coeffs coeffs;
+	const float ramp1 = (apCoeff1 - m_apCoeff1) / frames;
+	const float ramp2 = (apCoeff2 - m_apCoeff2) / frames;
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		coeffs[f][0] = m_apCoeff1 + ramp1 * (f + 1);
+		coeffs[f][1] = m_apCoeff2 + ramp2 * (f + 1);
+	}
+	m_apCoeff1 = apCoeff1;
+	m_apCoeff2 = apCoeff2;
+	
 	float dcCoeff = 0.001 * (44100.f / m_sampleRate);
 	
 	if (amount != m_amountVal)
@@ -88,9 +99,9 @@ bool DispersionEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 		if (amount < m_amountVal)
 		{
 			// Flush filter buffers when they're no longer in use
-			for (int i = amount * 2; i < m_amountVal * 2; ++i)
+			for (int i = amount; i < m_amountVal; ++i)
 			{
-				m_state.x0[i] = m_state.x1[i] = m_state.y0[i] = m_state.y1[i] = 0;
+				m_state[i] = FilterState{};
 			}
 		}
 		m_amountVal = amount;
@@ -102,49 +113,110 @@ bool DispersionEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 		m_feedbackVal[0] = m_feedbackVal[1] = 0;
 	}
 
-	for (fpp_t f = 0; f < frames; ++f)
+	if (feedback == 0)
+	{
+		// Without feedback, a filter only needs the output of the previous one, so the
+		// cascade can run filter by filter over the whole block. Their state stays in
+		// registers instead of being loaded and stored for every frame. Two filters run
+		// in the same pass, which gives the CPU independent work while one of them waits
+		// for its previous output.
+		buf[0][0] += m_feedbackVal[0];
+		buf[0][1] += m_feedbackVal[1];
+		m_feedbackVal[0] = m_feedbackVal[1] = 0;
+
+		int i = 0;
+		for (; i + 2 <= m_amountVal; i += 2)
+		{
+			runDispersionAPBlock<2>(i, coeffs, buf, frames);
+		}
+		if (i < m_amountVal)
+		{
+			runDispersionAPBlock<1>(i, coeffs, buf, frames);
+		}
+	}
+	else
 	{
-		std::array<sample_t, 2> s = { buf[f][0] + m_feedbackVal[0], buf[f][1] + m_feedbackVal[1] };
-		
-		runDispersionAP(m_amountVal, apCoeff1, apCoeff2, s);
-		m_feedbackVal[0] = s[0] * feedback;
-		m_feedbackVal[1] = s[1] * feedback;
-		
-		if (dc)
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			std::array<sample_t, 2> s = { buf[f][0] + m_feedbackVal[0], buf[f][1] + m_feedbackVal[1] };
+			
+			runDispersionAP(m_amountVal, coeffs[f][0], coeffs[f][1], s);
+			m_feedbackVal[0] = s[0] * feedback;
+			m_feedbackVal[1] = s[1] * feedback;
+			
+			buf[f][0] = s[0];
+			buf[f][1] = s[1];
+		}
+	}
+
+	if (dc)
+	{
+		// DC offset removal
+		for (fpp_t f = 0; f < frames; ++f)
 		{
-			// DC offset removal
 			for (int i = 0; i < 2; ++i)
 			{
-				m_integrator[i] = m_integrator[i] * (1.f - dcCoeff) + s[i] * dcCoeff;
-				s[i] -= m_integrator[i];
+				m_integrator[i] = m_integrator[i] * (1.f - dcCoeff) + buf[f][i] * dcCoeff;
+				buf[f][i] -= m_integrator[i];
 			}
 		}
-
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
 	}
 
-	checkGate(outSum / frames);
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
 void DispersionEffect::runDispersionAP(const int filtNum, const float apCoeff1, const float apCoeff2, std::array<sample_t, 2> &put)
 {
-	for (int i = 0; i < filtNum * 2; ++i)
+	for (int i = 0; i < filtNum; ++i)
+	{
+		FilterState& state = m_state[i];
+		for (int channel = 0; channel < 2; ++channel)
+		{
+			const sample_t currentInput = put[channel];
+			const sample_t filterOutput = apCoeff1 * (currentInput - state.y1[channel])
+				+ apCoeff2 * (state.x0[channel] - state.y0[channel]) + state.x1[channel];
+			state.x1[channel] = state.x0[channel];
+			state.x0[channel] = currentInput;
+			state.y1[channel] = state.y0[channel];
+			state.y0[channel] = filterOutput;
+
+			put[channel] = filterOutput;
+		}
+	}
+}
+
+
+template<int Stages>
+void DispersionEffect::runDispersionAPBlock(const int first, const Coeffs& coeffs, SampleFrame* buf, const fpp_t frames)
+{
+	std::array<FilterState, Stages> state;
+	std::copy(m_state.begin() + first, m_state.begin() + first + Stages, state.begin());
+
+	for (fpp_t f = 0; f < frames; ++f)
 	{
-		const int channel = i % 2;
-		const sample_t currentInput = put[channel];
-		const sample_t filterOutput = apCoeff1 * (currentInput - m_state.y1[i])
-			+ apCoeff2 * (m_state.x0[i] - m_state.y0[i]) + m_state.x1[i];
-		m_state.x1[i] = m_state.x0[i];
-		m_state.x0[i] = currentInput;
-		m_state.y1[i] = m_state.y0[i];
-		m_state.y0[i] = filterOutput;
-
-		put[channel] = filterOutput;
+		const float apCoeff1 = coeffs[f][0];
+		const float apCoeff2 = coeffs[f][1];
+		std::array<sample_t, 2> put = { buf[f][0], buf[f][1] };
+		for (auto& filter : state)
+		{
+			std::array<sample_t, 2> filterOutput;
+			for (int channel = 0; channel < 2; ++channel)
+			{
+				filterOutput[channel] = apCoeff1 * (put[channel] - filter.y1[channel])
+					+ apCoeff2 * (filter.x0[channel] - filter.y0[channel]) + filter.x1[channel];
+			}
+			filter.x1 = filter.x0;
+			filter.x0 = put;
+			filter.y1 = filter.y0;
+			filter.y0 = filterOutput;
+			put = filterOutput;
+		}
+		buf[f][0] = put[0];
+		buf[f][1] = put[1];
 	}
+
+	std::copy(state.begin(), state.end(), m_state.begin() + first);
 }
 
 
@@ -41,7 +41,7 @@ class DispersionEffect : public Effect
 public:
 	DispersionEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
 	~DispersionEffect() override = default;
-	bool processAudioBuffer(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
 
 	EffectControls* controls() override
 	{
@@ -51,20 +51,32 @@ public:
 	void runDispersionAP(const int filtNum, const float apCoeff1, const float apCoeff2, std::array<sample_t, 2> &put);
 
 private:
+	//! Both all-pass coefficients for every frame of the block
+	using Coeffs = std::array<std::array<float, 2>, MAXIMUM_BLOCK_SIZE>;
+
+	//! Run \p Stages filters starting at \p first over the whole block
+	template<int Stages>
+	void runDispersionAPBlock(const int first, const Coeffs& coeffs, SampleFrame* buf, const fpp_t frames);
+
 	DispersionControls m_dispersionControls;
 	
 	float m_sampleRate;
 	
 	int m_amountVal;
 	
-	using Filter = std::array<sample_t, MAX_DISPERSION_FILTERS * 2>;
+	// the channels of a filter are next to each other, so they can be computed together
 	struct FilterState {
-		Filter x0{};
-		Filter x1{};
-		Filter y0{};
-		Filter y1{};
+		std::array<sample_t, 2> x0{};
+		std::array<sample_t, 2> x1{};
+		std::array<sample_t, 2> y0{};
+		std::array<sample_t, 2> y1{};
 	};
-	FilterState m_state = {};
+	std::array<FilterState, MAX_DISPERSION_FILTERS> m_state = {};
+	
+	// coefficients at the end of the last block, which the next one ramps from
+	float m_apCoeff1 = 0.f;
+	float m_apCoeff2 = 0.f;
+	bool m_coeffsSet = false;
 	
 	std::array<float, 2> m_feedbackVal{};
 	std::array<float, 2> m_integrator{};
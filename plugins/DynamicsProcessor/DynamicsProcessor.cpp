@@ -91,15 +91,18 @@ inline void DynProcEffect::calcRelease()
 }
 
 
-bool DynProcEffect::processAudioBuffer( SampleFrame* _buf,
-							const fpp_t _frames )
+void DynProcEffect::processBypassedImpl()
 {
-	if( !isEnabled() || !isRunning () )
-	{
 //apparently we can't keep running after the decay value runs out so we'll just set the peaks to zero
-		m_currentPeak[0] = m_currentPeak[1] = DYN_NOISE_FLOOR;
-		return( false );
-	}
+	m_currentPeak[0] = m_currentPeak[1] = DYN_NOISE_FLOOR;
+}
+
+
+
+
+Effect::ProcessStatus DynProcEffect::processImpl( SampleFrame* _buf,
+							const fpp_t _frames )
+{
 	//qDebug( "%f %f", m_currentPeak[0], m_currentPeak[1] );
 
 // variables for effect
@@ -107,10 +110,6 @@ bool DynProcEffect::processAudioBuffer( SampleFrame* _buf,
 
 	auto sm_peak = std::array{0.0f, 0.0f};
 
-	double out_sum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-
 	const int stereoMode = m_dpControls.m_stereomodeModel.value();
 	const float inputGain = m_dpControls.m_inputModel.value();
 	const float outputGain = m_dpControls.m_outputModel.value();
@@ -209,15 +208,11 @@ bool DynProcEffect::processAudioBuffer( SampleFrame* _buf,
 		s[0] *= outputGain;
 		s[1] *= outputGain;
 
-// mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-		out_sum += _buf[f][0] * _buf[f][0] + _buf[f][1] * _buf[f][1];
+		_buf[f][0] = s[0];
+		_buf[f][1] = s[1];
 	}
 
-	checkGate( out_sum / _frames );
-
-	return( isRunning() );
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
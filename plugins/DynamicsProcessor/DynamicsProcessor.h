@@ -42,8 +42,8 @@ public:
 	DynProcEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key );
 	~DynProcEffect() override;
-	bool processAudioBuffer( SampleFrame* _buf,
-							const fpp_t _frames ) override;
+	ProcessStatus processImpl( SampleFrame* _buf, const fpp_t _frames ) override;
+	void processBypassedImpl() override;
 
 	EffectControls * controls() override
 	{
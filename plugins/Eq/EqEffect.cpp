@@ -24,6 +24,10 @@
 
 #include "EqEffect.h"
 
+#include <array>
+#include <cmath>
+
+#include "AnalysisService.h"
 #include "Engine.h"
 #include "lmms_math.h"
 
@@ -59,19 +63,30 @@ EqEffect::EqEffect( Model *parent, const Plugin::Descriptor::SubPluginFeatures::
 	m_inGain( 1.0 ),
 	m_outGain( 1.0 )
 {
+	// the band peaks are derived from the output spectrum, so update them
+	// whenever the analysis worker has computed a new one
+	m_eqControls.m_outFftBands.setAnalysisCallback( [this]
+	{
+		setBandPeaks( &m_eqControls.m_outFftBands, Engine::audioEngine()->outputSampleRate() );
+	} );
+}
+
+
+
+
+EqEffect::~EqEffect()
+{
+	// make sure the callback doesn't run while the models are destroyed
+	Engine::analysisService()->remove( &m_eqControls.m_outFftBands );
 }
 
 
 
 
-bool EqEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
+Effect::ProcessStatus EqEffect::processImpl( SampleFrame* buf, const fpp_t frames )
 {
 	const int sampleRate = Engine::audioEngine()->outputSampleRate();
 
-	//wet/dry controls
-	const float dry = dryLevel();
-	const float wet = wetLevel();
-	auto dryS = std::array<sample_t, 2>{};
 	// setup sample exact controls
 	float hpRes = m_eqControls.m_hpResModel.value();
 	float lowShelfRes = m_eqControls.m_lowShelfResModel.value();
@@ -112,8 +127,8 @@ bool EqEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 	float para4Gain = m_eqControls.m_para4GainModel.value();
 	float highShelfGain = m_eqControls.m_highShelfGainModel.value();
 
-	//set all filter parameters once per frame, EqFilter handles
-	//smooth xfading, reducing pops clicks and dc bias offsets
+	//set all filter parameters once per period, EqFilter handles
+	//smooth ramping, reducing pops clicks and dc bias offsets
 
 	m_hp12.setParameters( sampleRate, hpFreq, hpRes, 1 );
 	m_hp24.setParameters( sampleRate, hpFreq, hpRes, 1 );
@@ -130,14 +145,6 @@ bool EqEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 	m_lp480.setParameters( sampleRate, lpFreq, lpRes, 1 );
 	m_lp481.setParameters( sampleRate, lpFreq, lpRes, 1 );
 
-
-
-
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-
 	if( m_eqControls.m_outGainModel.isValueChanged() )
 	{
 		m_outGain = dbfsToAmp(m_eqControls.m_outGainModel.value());
@@ -149,131 +156,83 @@ bool EqEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 	}
 
 	m_eqControls.m_inProgress = true;
-	double outSum = 0.0;
 
-	for( fpp_t f = 0; f < frames; ++f )
+	// the analyser skips silent input by itself, so the frames can be
+	// queued before the input pass
+	if( m_eqControls.m_analyseInModel.value( true ) && m_eqControls.isViewVisible() )
 	{
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
-	}
-
-	const float outGain =  m_outGain;
-	SampleFrame m_inPeak = { 0, 0 };
-
-	if(m_eqControls.m_analyseInModel.value( true ) &&  outSum > 0 && m_eqControls.isViewVisible()  )
-	{
-		m_eqControls.m_inFftBands.analyze( buf, frames );
+		m_eqControls.m_inFftBands.queue( buf, frames );
 	}
 	else
 	{
 		m_eqControls.m_inFftBands.clear();
 	}
 
-	gain( buf, frames, m_inGain, &m_inPeak );
-	m_eqControls.m_inPeakL = m_eqControls.m_inPeakL < m_inPeak[0] ? m_inPeak[0] : m_eqControls.m_inPeakL;
-	m_eqControls.m_inPeakR = m_eqControls.m_inPeakR < m_inPeak[1] ? m_inPeak[1] : m_eqControls.m_inPeakR;
-
-	float periodProgress = 0.0f; // percentage of period processed
-	for( fpp_t f = 0; f < frames; ++f)
+	// input gain and input peak in one pass
+	SampleFrame inPeak = { 0, 0 };
+	for( fpp_t f = 0; f < frames; ++f )
 	{
-		periodProgress = (float)f / (float)(frames-1);
-		//wet dry buffer
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
-		if( hpActive )
-		{
-			buf[f][0] = m_hp12.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_hp12.update( buf[f][1], 1, periodProgress );
-
-			if( hp24Active || hp48Active )
-			{
-				buf[f][0] = m_hp24.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp24.update( buf[f][1], 1, periodProgress );
-			}
-
-			if( hp48Active )
-			{
-				buf[f][0] = m_hp480.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp480.update( buf[f][1], 1, periodProgress );
-
-				buf[f][0] = m_hp481.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp481.update( buf[f][1], 1, periodProgress );
-			}
-		}
-
-		if( lowShelfActive )
-		{
-			buf[f][0] = m_lowShelf.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_lowShelf.update( buf[f][1], 1, periodProgress );
-		}
-
-		if( para1Active )
-		{
-			buf[f][0] = m_para1.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para1.update( buf[f][1], 1, periodProgress );
-		}
-
-		if( para2Active )
-		{
-			buf[f][0] = m_para2.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para2.update( buf[f][1], 1, periodProgress );
-		}
-
-		if( para3Active )
-		{
-			buf[f][0] = m_para3.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para3.update( buf[f][1], 1, periodProgress );
-		}
+		buf[f][0] *= m_inGain;
+		buf[f][1] *= m_inGain;
+		inPeak[0] = std::max( inPeak[0], std::abs( buf[f][0] ) );
+		inPeak[1] = std::max( inPeak[1], std::abs( buf[f][1] ) );
+	}
+	m_eqControls.m_inPeakL = m_eqControls.m_inPeakL < inPeak[0] ? inPeak[0] : m_eqControls.m_inPeakL;
+	m_eqControls.m_inPeakR = m_eqControls.m_inPeakR < inPeak[1] ? inPeak[1] : m_eqControls.m_inPeakR;
 
-		if( para4Active )
+	// compile the cascade of active bands, bypassed bands aren't processed at all
+	std::array<EqFilter*, MaxStages> cascade;
+	std::size_t stages = 0;
+	if( hpActive )
+	{
+		cascade[stages++] = &m_hp12;
+		if( hp24Active || hp48Active ) { cascade[stages++] = &m_hp24; }
+		if( hp48Active )
 		{
-			buf[f][0] = m_para4.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para4.update( buf[f][1], 1, periodProgress );
+			cascade[stages++] = &m_hp480;
+			cascade[stages++] = &m_hp481;
 		}
-
-		if( highShelfActive )
+	}
+	if( lowShelfActive ) { cascade[stages++] = &m_lowShelf; }
+	if( para1Active ) { cascade[stages++] = &m_para1; }
+	if( para2Active ) { cascade[stages++] = &m_para2; }
+	if( para3Active ) { cascade[stages++] = &m_para3; }
+	if( para4Active ) { cascade[stages++] = &m_para4; }
+	if( highShelfActive ) { cascade[stages++] = &m_highShelf; }
+	if( lpActive )
+	{
+		cascade[stages++] = &m_lp12;
+		if( lp24Active || lp48Active ) { cascade[stages++] = &m_lp24; }
+		if( lp48Active )
 		{
-			buf[f][0] = m_highShelf.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_highShelf.update( buf[f][1], 1, periodProgress );
-		}
-
-		if( lpActive ){
-			buf[f][0] = m_lp12.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_lp12.update( buf[f][1], 1, periodProgress );
-
-			if( lp24Active || lp48Active )
-			{
-				buf[f][0] = m_lp24.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp24.update( buf[f][1], 1, periodProgress );
-			}
-
-			if( lp48Active )
-			{
-				buf[f][0] = m_lp480.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp480.update( buf[f][1], 1, periodProgress );
-
-				buf[f][0] = m_lp481.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp481.update( buf[f][1], 1, periodProgress );
-			}
+			cascade[stages++] = &m_lp480;
+			cascade[stages++] = &m_lp481;
 		}
+	}
 
-		//apply wet / dry levels
-		buf[f][1] = ( dry * dryS[1] ) + ( wet * buf[f][1] );
-		buf[f][0] = ( dry * dryS[0] ) + ( wet * buf[f][0] );
-
-
+	// every stage filters the whole period, both channels at once
+	for( std::size_t s = 0; s < stages; ++s )
+	{
+		cascade[s]->processBlock( buf, frames );
 	}
 
+	// output gain, output energy and output peak in one pass
+	double outSum = 0.0;
 	SampleFrame outPeak = { 0, 0 };
-	gain( buf, frames, outGain, &outPeak );
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		buf[f][0] *= m_outGain;
+		buf[f][1] *= m_outGain;
+		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
+		outPeak[0] = std::max( outPeak[0], std::abs( buf[f][0] ) );
+		outPeak[1] = std::max( outPeak[1], std::abs( buf[f][1] ) );
+	}
 	m_eqControls.m_outPeakL = m_eqControls.m_outPeakL < outPeak[0] ? outPeak[0] : m_eqControls.m_outPeakL;
 	m_eqControls.m_outPeakR = m_eqControls.m_outPeakR < outPeak[1] ? outPeak[1] : m_eqControls.m_outPeakR;
 
-	checkGate( outSum / frames );
-
 	if(m_eqControls.m_analyseOutModel.value( true ) && outSum > 0 && m_eqControls.isViewVisible() )
 	{
-		m_eqControls.m_outFftBands.analyze( buf, frames );
-		setBandPeaks( &m_eqControls.m_outFftBands , ( int )( sampleRate ) );
+		m_eqControls.m_outFftBands.queue( buf, frames );
 	}
 	else
 	{
@@ -281,7 +240,7 @@ bool EqEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 	}
 
 	m_eqControls.m_inProgress = false;
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -39,30 +39,16 @@ class EqEffect : public Effect
 {
 public:
 	EqEffect( Model * parent , const Descriptor::SubPluginFeatures::Key * key );
-	~EqEffect() override = default;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	~EqEffect() override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 	EffectControls * controls() override
 	{
 		return &m_eqControls;
 	}
-	inline void gain( SampleFrame* buf, const fpp_t frames, float scale, SampleFrame* peak )
-	{
-		peak[0][0] = 0.0f; peak[0][1] = 0.0f;
-		for( fpp_t f = 0; f < frames; ++f )
-		{
-			auto & sf = buf[f];
-
-			// Apply gain to sample frame
-			sf[0] *= scale;
-			sf[1] *= scale;
-
-			// Update peaks
-			peak[0][0] = std::max(peak[0][0], (float)fabs(sf[0]));
-			peak[0][1] = std::max(peak[0][1], (float)fabs(sf[1]));
-		}
-	}
-
 private:
+	//! All filters of the bands, the high and the low pass
+	static constexpr std::size_t MaxStages = 14;
+
 	EqControls m_eqControls;
 
 	EqHp12Filter m_hp12;
@@ -35,7 +35,7 @@ namespace lmms
 ///
 /// \brief The EqFilter class.
 /// A wrapper for the StereoBiQuad class, giving it freq, res, and gain controls.
-/// Used on a per channel per frame basis with recalculation of coefficents
+/// Processes both channels of a block at once, with recalculation of coefficents
 /// upon parameter changes. The intention is to use this as a bass class, children override
 /// the calcCoefficents() function, providing the coefficents a1, a2, b0, b1, b2.
 ///
@@ -119,26 +119,16 @@ public:
 
 
 	///
-	/// \brief update
-	/// filters using two BiQuads, then crossfades,
-	///  depending on on percentage of period processes
-	/// \param in
-	/// \param ch
-	/// \param frameProgress percentage of frame processed
-	/// \return
+	/// \brief processBlock
+	/// filters a block of frames in place, moving the coefficients linearly
+	/// from the previous to the current parameters over the block, which
+	/// avoids pops and clicks when the parameters change
+	/// \param buf
+	/// \param frames
 	///
-	inline float update( float in, ch_cnt_t ch, float frameProgress)
+	inline void processBlock( SampleFrame* buf, const fpp_t frames )
 	{
-		float initailF =  m_biQuadFrameInitial.update( in, ch );
-		float targetF = m_biQuadFrameTarget.update( in, ch );
-
-		if(frameProgress > 0.99999 )
-		{
-			m_biQuadFrameInitial= m_biQuadFrameTarget;
-		}
-
-		return (1.0f-frameProgress) * initailF + frameProgress * targetF;
-
+		m_biQuad.processRamped( buf, frames, m_targetCoeffs );
 	}
 
 
@@ -154,7 +144,7 @@ protected:
 
 	inline void setCoeffs( float a1, float a2, float b0, float b1, float b2 )
 	{
-		m_biQuadFrameTarget.setCoeffs( a1, a2, b0, b1, b2 );
+		m_targetCoeffs = { a1, a2, b0, b1, b2 };
 	}
 
 
@@ -167,8 +157,8 @@ protected:
 	float m_res;
 	float m_gain;
 	float m_bw;
-	StereoBiQuad m_biQuadFrameInitial;
-	StereoBiQuad m_biQuadFrameTarget;
+	StereoBiQuad m_biQuad;
+	StereoBiQuad::Coeffs m_targetCoeffs = {};
 };
 
 
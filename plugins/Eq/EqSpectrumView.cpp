@@ -22,6 +22,7 @@
 
 #include "EqSpectrumView.h"
 
+#include <algorithm>
 #include <cmath>
 #include <QPainter>
 #include <QPen>
@@ -38,12 +39,15 @@ namespace lmms
 
 
 EqAnalyser::EqAnalyser() :
+	AnalysisService::Task( 2 * FFT_BUFFER_SIZE ),
 	m_framesFilledUp ( 0 ),
 	m_energy ( 0 ),
 	m_sampleRate ( 1 ),
-	m_active ( true )
+	m_active ( true ),
+	m_inProgress ( false ),
+	m_clearRequested ( false ),
+	m_cleared ( true )
 {
-	m_inProgress=false;
 	m_specBuf = ( fftwf_complex * ) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
 	m_fftPlan = fftwf_plan_dft_r2c_1d( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf, FFTW_MEASURE );
 
@@ -60,7 +64,9 @@ EqAnalyser::EqAnalyser() :
 								+ a2 * cos(4 * F_PI * i / ((float)FFT_BUFFER_SIZE - 1.0))
 								- a3 * cos(6 * F_PI * i / ((float)FFT_BUFFER_SIZE - 1.0)));
 	}
-	clear();
+	reset();
+
+	Engine::analysisService()->add( this );
 }
 
 
@@ -68,6 +74,8 @@ EqAnalyser::EqAnalyser() :
 
 EqAnalyser::~EqAnalyser()
 {
+	Engine::analysisService()->remove( this );
+
 	fftwf_destroy_plan( m_fftPlan );
 	fftwf_free( m_specBuf );
 }
@@ -75,31 +83,51 @@ EqAnalyser::~EqAnalyser()
 
 
 
-void EqAnalyser::analyze( SampleFrame* buf, const fpp_t frames )
+void EqAnalyser::analyze( LocklessRingBufferReader<SampleFrame>& reader )
 {
-	//only analyse if the view is visible
-	if ( m_active )
+	if( m_clearRequested.exchange( false ) )
+	{
+		reset();
+	}
+
+	while( !reader.empty() )
 	{
-		m_inProgress=true;
-		const int FFT_BUFFER_SIZE = 2048;
-		fpp_t f = 0;
+		auto in = reader.read_max( capacity() );
+		const auto frames = in.size();
+
+		//only analyse if the view is visible
+		if( !m_active )
+		{
+			continue;
+		}
+
+		m_inProgress = true;
+		std::size_t f = 0;
 		if( frames > FFT_BUFFER_SIZE )
 		{
 			m_framesFilledUp = 0;
 			f = frames - FFT_BUFFER_SIZE;
 		}
 		// meger channels
-		for( ; f < frames; ++f )
+		for( ; f < frames && m_framesFilledUp < FFT_BUFFER_SIZE; ++f )
 		{
 			m_buffer[m_framesFilledUp] =
-					( buf[f][0] + buf[f][1] ) * 0.5;
+					( in[f][0] + in[f][1] ) * 0.5;
 			++m_framesFilledUp;
 		}
 
 		if( m_framesFilledUp < FFT_BUFFER_SIZE )
 		{
 			m_inProgress = false;
-			return;
+			continue;
+		}
+
+		// there is nothing to show for silence
+		if( std::all_of( m_buffer, m_buffer + FFT_BUFFER_SIZE, []( float sample ) { return sample == 0.f; } ) )
+		{
+			reset();
+			m_inProgress = false;
+			continue;
 		}
 
 		m_sampleRate = Engine::audioEngine()->outputSampleRate();
@@ -124,6 +152,11 @@ void EqAnalyser::analyze( SampleFrame* buf, const fpp_t frames )
 		m_framesFilledUp = 0;
 		m_inProgress = false;
 		m_active = false;
+
+		if( m_analysisCallback )
+		{
+			m_analysisCallback();
+		}
 	}
 }
 
@@ -162,6 +195,14 @@ void EqAnalyser::setActive(bool active)
 
 
 
+void EqAnalyser::setAnalysisCallback( std::function<void()> callback )
+{
+	m_analysisCallback = std::move( callback );
+}
+
+
+
+
 bool EqAnalyser::getInProgress()
 {
 	return m_inProgress;
@@ -170,7 +211,31 @@ bool EqAnalyser::getInProgress()
 
 
 
+void EqAnalyser::queue( const SampleFrame* buf, const fpp_t frames )
+{
+	m_cleared = false;
+	write( buf, frames );
+}
+
+
+
+
 void EqAnalyser::clear()
+{
+	// the buffers belong to the analysis worker, so only wake it once to
+	// reset them instead of clearing them in every period
+	if( !m_cleared )
+	{
+		m_cleared = true;
+		m_clearRequested = true;
+		wake();
+	}
+}
+
+
+
+
+void EqAnalyser::reset()
 {
 	m_framesFilledUp = 0;
 	m_energy = 0;
@@ -180,6 +245,7 @@ void EqAnalyser::clear()
 
 
 
+
 namespace gui
 {
 
@@ -25,35 +25,48 @@
 
 #include <QPainterPath>
 #include <QWidget>
+#include <atomic>
+#include <functional>
 
+#include "AnalysisService.h"
 #include "fft_helpers.h"
 #include "lmms_basics.h"
 
 namespace lmms
 {
 
-class SampleFrame;
-
 const int MAX_BANDS = 2048;
-class EqAnalyser
+
+//! Computes the spectrum shown by EqSpectrumView on an analysis worker; the
+//! audio thread only queues its frames with write()
+class EqAnalyser : public AnalysisService::Task
 {
 public:
 	EqAnalyser();
-	virtual ~EqAnalyser();
+	~EqAnalyser() override;
 
 	float m_bands[MAX_BANDS];
 	bool getInProgress();
+	//! Queue frames for analysis, to be called from the audio thread
+	void queue( const SampleFrame* buf, const fpp_t frames );
+	//! Reset the spectrum, to be called from the audio thread instead of queue()
 	void clear();
 
-	void analyze( SampleFrame* buf, const fpp_t frames );
-
 	float getEnergy() const;
 	int getSampleRate() const;
 	bool getActive() const;
 
 	void setActive(bool active);
 
+	//! \p callback is invoked on the analysis worker after each new spectrum
+	void setAnalysisCallback(std::function<void()> callback);
+
+protected:
+	void analyze(LocklessRingBufferReader<SampleFrame>& reader) override;
+
 private:
+	void reset();
+
 	fftwf_plan m_fftPlan;
 	fftwf_complex * m_specBuf;
 	float m_absSpecBuf[FFT_BUFFER_SIZE+1];
@@ -61,9 +74,12 @@ private:
 	int m_framesFilledUp;
 	float m_energy;
 	int m_sampleRate;
-	bool m_active;
-	bool m_inProgress;
+	std::atomic<bool> m_active;
+	std::atomic<bool> m_inProgress;
+	std::atomic<bool> m_clearRequested;
+	bool m_cleared;
 	float m_fftWindow[FFT_BUFFER_SIZE];
+	std::function<void()> m_analysisCallback;
 };
 
 
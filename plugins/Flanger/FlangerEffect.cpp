@@ -90,15 +90,8 @@ FlangerEffect::~FlangerEffect()
 
 
 
-bool FlangerEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
+Effect::ProcessStatus FlangerEffect::processImpl( SampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
 	const float length = m_flangerControls.m_delayTimeModel.value() * Engine::audioEngine()->outputSampleRate();
 	const float noise = m_flangerControls.m_whiteNoiseAmountModel.value();
 	float amplitude = m_flangerControls.m_lfoAmountModel.value() * Engine::audioEngine()->outputSampleRate();
@@ -107,7 +100,6 @@ bool FlangerEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 	m_lfo->setOffset( m_flangerControls.m_lfoPhaseModel.value() / 180 * D_PI );
 	m_lDelay->setFeedback( m_flangerControls.m_feedbackModel.value() );
 	m_rDelay->setFeedback( m_flangerControls.m_feedbackModel.value() );
-	auto dryS = std::array<sample_t, 2>{};
 	for( fpp_t f = 0; f < frames; ++f )
 	{
 		float leftLfo;
@@ -115,8 +107,6 @@ bool FlangerEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 
 		buf[f][0] += m_noise->tick() * noise;
 		buf[f][1] += m_noise->tick() * noise;
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
 		m_lfo->tick(&leftLfo, &rightLfo);
 		m_lDelay->setLength( ( float )length + amplitude * (leftLfo+1.0)  );
 		m_rDelay->setLength( ( float )length + amplitude * (rightLfo+1.0)  );
@@ -129,13 +119,8 @@ bool FlangerEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
 			m_lDelay->tick( &buf[f][0] );
 			m_rDelay->tick( &buf[f][1] );
 		}
-
-		buf[f][0] = ( d * dryS[0] ) + ( w * buf[f][0] );
-		buf[f][1] = ( d * dryS[1] ) + ( w * buf[f][1] );
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
 	}
-	checkGate( outSum / frames );
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -42,7 +42,7 @@ class FlangerEffect : public Effect
 public:
 	FlangerEffect( Model* parent , const Descriptor::SubPluginFeatures::Key* key );
 	~FlangerEffect() override;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 	EffectControls* controls() override
 	{
 		return &m_flangerControls;
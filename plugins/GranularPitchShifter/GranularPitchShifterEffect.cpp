@@ -24,6 +24,7 @@
 
 #include "GranularPitchShifterEffect.h"
 
+#include <algorithm>
 #include <cmath>
 #include "embed.h"
 #include "plugin_export.h"
@@ -60,13 +61,8 @@ GranularPitchShifterEffect::GranularPitchShifterEffect(Model* parent, const Desc
 }
 
 
-bool GranularPitchShifterEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
+Effect::ProcessStatus GranularPitchShifterEffect::processImpl(SampleFrame* buf, const fpp_t frames)
 {
-	if (!isEnabled() || !isRunning()) { return false; }
-
-	const float d = dryLevel();
-	const float w = wetLevel();
-	
 	const ValueBuffer* pitchBuf = m_granularpitchshifterControls.m_pitchModel.valueBuffer();
 	const ValueBuffer* pitchSpreadBuf = m_granularpitchshifterControls.m_pitchSpreadModel.valueBuffer();
 
@@ -94,149 +90,103 @@ bool GranularPitchShifterEffect::processAudioBuffer(SampleFrame* buf, const fpp_
 	const int sizeSamples = m_sampleRate / size;
 	const float waitMult = sizeSamples / (density * 2);
 
-	for (fpp_t f = 0; f < frames; ++f)
+	Chunk s;
+	for (fpp_t f = 0; f < frames;)
 	{
-		const double pitch = (pitchBuf ? pitchBuf->value(f) : m_granularpitchshifterControls.m_pitchModel.value()) * (1. / 12.);
-		const double pitchSpread = (pitchSpreadBuf ? pitchSpreadBuf->value(f) : m_granularpitchshifterControls.m_pitchSpreadModel.value()) * (1. / 24.);
-		
-		// interpolate pitch depending on glide
-		for (int i = 0; i < 2; ++i)
-		{
-			double targetVal = pitch + pitchSpread * (i ? 1. : -1.);
-			
-			if (targetVal == m_truePitch[i]) { continue; }
-			m_updatePitches = true;
-			
-			m_truePitch[i] = m_glideCoef * m_truePitch[i] + (1. - m_glideCoef) * targetVal;
-			// we crudely lock the pitch to the target value once it gets close enough, so we can save on CPU
-			if (std::abs(targetVal - m_truePitch[i]) < GlideSnagRadius) { m_truePitch[i] = targetVal; }
-		}
+		updatePitch(
+			(pitchBuf ? pitchBuf->value(f) : m_granularpitchshifterControls.m_pitchModel.value()) * (1. / 12.),
+			(pitchSpreadBuf ? pitchSpreadBuf->value(f) : m_granularpitchshifterControls.m_pitchSpreadModel.value()) * (1. / 24.));
 		
-		// this stuff is computationally expensive, so we should only do it when necessary
-		if (m_updatePitches)
+		// The grains read from the ring buffer, which the chunk writes to at the end. So a chunk
+		// mustn't be longer than the time until any grain reaches the frames it writes.
+		int chunkEnd = std::min(static_cast<int>(frames - f), GrainChunkSize);
+		for (const auto& grain : m_grains)
 		{
-			m_updatePitches = false;
-			
-			std::array<double, 2> speed = {
-				std::exp2(m_truePitch[0]),
-				std::exp2(m_truePitch[1])
-			};
-			std::array<double, 2> ratio = {
-				speed[0] / m_speed[0],
-				speed[1] / m_speed[1]
-			};
-			
-			for (int i = 0; i < m_grainCount; ++i)
+			for (int ch = 0; ch < 2; ++ch)
 			{
-				for (int j = 0; j < 2; ++j)
-				{
-					m_grains[i].grainSpeed[j] *= ratio[j];
-					
-					// we unfortunately need to do extra stuff to ensure these don't shoot past the write index...
-					if (m_grains[i].grainSpeed[j] > 1)
-					{
-						double distance = m_writePoint - m_grains[i].readPoint[j] - SafetyLatency;
-						if (distance <= 0) { distance += m_ringBufLength; }
-						double grainSpeedRequired = ((m_grains[i].grainSpeed[j] - 1.) / distance) * (1. - m_grains[i].phase);
-						m_grains[i].phaseSpeed[j] = std::max(m_grains[i].phaseSpeed[j], grainSpeedRequired);
-					}
-				}
+				double distance = m_writePoint - grain.readPoint[ch];
+				if (distance <= 0) { distance += m_ringBufLength; }
+				chunkEnd = std::min(chunkEnd, std::max(readableFrames(distance, grain.grainSpeed[ch]), 1));
 			}
-			m_speed[0] = speed[0];
-			m_speed[1] = speed[1];
-			
-			// prevent aliasing by lowpassing frequencies that the pitch shifting would push above nyquist
-			m_prefilter[0].setCoefs(m_sampleRate, std::min(m_nyquist / static_cast<float>(speed[0]), m_nyquist) * PrefilterBandwidth);
-			m_prefilter[1].setCoefs(m_sampleRate, std::min(m_nyquist / static_cast<float>(speed[1]), m_nyquist) * PrefilterBandwidth);
 		}
 		
-		std::array<float, 2> s = {0, 0};
-		std::array<float, 2> filtered = {buf[f][0], buf[f][1]};
-		
-		// spawn a new grain if it's time
-		if (++m_timeSinceLastGrain >= m_nextWaitRandomization * waitMult)
+		// spawn all grains which start during the chunk
+		int nextGrain = std::max(static_cast<int>(std::ceil(m_nextWaitRandomization * waitMult - m_timeSinceLastGrain - 1)), 0);
+		while (nextGrain < chunkEnd)
 		{
-			m_timeSinceLastGrain = 0;
-			double randThing = (fast_rand()/static_cast<double>(FAST_RAND_MAX) * 2. - 1.);
-			m_nextWaitRandomization = std::exp2(randThing * twitch);
-			double grainSpeed = 1. / std::exp2(randThing * jitter);
-
-			std::array<float, 2> sprayResult = {0, 0};
-			if (spray > 0)
-			{
-				sprayResult[0] = (fast_rand() / static_cast<float>(FAST_RAND_MAX)) * spray * m_sampleRate;
-				sprayResult[1] = linearInterpolate(
-					sprayResult[0],
-					(fast_rand() / static_cast<float>(FAST_RAND_MAX)) * spray * m_sampleRate,
-					spraySpread);
-			}
-			
-			std::array<int, 2> readPoint;
-			int latency = std::max(static_cast<int>(std::max(sizeSamples * (std::max(m_speed[0], m_speed[1]) * grainSpeed - 1.), 0.) + SafetyLatency), minLatency);
-			for (int i = 0; i < 2; ++i)
-			{
-				readPoint[i] = m_writePoint - latency - sprayResult[i];
-				if (readPoint[i] < 0) { readPoint[i] += m_ringBufLength; }
-			}
-			const double phaseInc = 1. / sizeSamples;
-			m_grains.push_back(Grain(grainSpeed * m_speed[0], grainSpeed * m_speed[1], phaseInc, phaseInc, readPoint[0], readPoint[1]));
-			++m_grainCount;
+			chunkEnd = std::min(chunkEnd, spawnGrain(nextGrain, sizeSamples, minLatency, jitter, twitch, spray, spraySpread));
+			m_timeSinceLastGrain = -nextGrain - 1;
+			nextGrain += std::max(static_cast<int>(std::ceil(m_nextWaitRandomization * waitMult)), 1);
 		}
 		
-		for (int i = 0; i < m_grainCount; ++i)
+		for (auto& channel : s)
+		{
+			std::fill(channel.begin(), channel.begin() + chunkEnd, 0.f);
+		}
+		for (int i = 0; i < static_cast<int>(m_grains.size()); ++i)
 		{
-			m_grains[i].phase += std::max(m_grains[i].phaseSpeed[0], m_grains[i].phaseSpeed[1]);
-			if (m_grains[i].phase >= 1)
+			Grain& grain = m_grains[i];
+			if (grain.delay >= chunkEnd)
+			{
+				// spawned at the first frame of the next chunk
+				grain.delay -= chunkEnd;
+				continue;
+			}
+			const bool alive = renderGrain(grain, grain.delay, chunkEnd, fadeLength, shapeK, s);
+			grain.delay = 0;
+			if (!alive)
 			{
 				// grain is done, delete it
-				std::swap(m_grains[i], m_grains[m_grainCount-1]);
+				std::swap(grain, m_grains.back());
 				m_grains.pop_back();
 				--i;
-				--m_grainCount;
-				continue;
 			}
-			
-			m_grains[i].readPoint[0] += m_grains[i].grainSpeed[0];
-			m_grains[i].readPoint[1] += m_grains[i].grainSpeed[1];
-			if (m_grains[i].readPoint[0] >= m_ringBufLength) { m_grains[i].readPoint[0] -= m_ringBufLength; }
-			if (m_grains[i].readPoint[1] >= m_ringBufLength) { m_grains[i].readPoint[1] -= m_ringBufLength; }
-			
-			const float fadePos = std::clamp((-std::abs(-2.f * static_cast<float>(m_grains[i].phase) + 1.f) + 0.5f) * fadeLength + 0.5f, 0.f, 1.f);
-			const float windowVal = cosHalfWindowApprox(fadePos, shapeK);
-			s[0] += getHermiteSample(m_grains[i].readPoint[0], 0) * windowVal;
-			s[1] += getHermiteSample(m_grains[i].readPoint[1], 1) * windowVal;
 		}
 		
-		// note that adding two signals together, when uncorrelated, results in a signal power multiplication of sqrt(2), not 2
-		s[0] *= densityInvRoot;
-		s[1] *= densityInvRoot;
-		
-		// 1-pole highpass for DC offset removal, to make feedback safer
-		s[0] -= (m_dcVal[0] = (1.f - m_dcCoeff) * s[0] + m_dcCoeff * m_dcVal[0]);
-		s[1] -= (m_dcVal[1] = (1.f - m_dcCoeff) * s[1] + m_dcCoeff * m_dcVal[1]);
+		for (int k = 0; k < chunkEnd; ++k)
+		{
+			// note that adding two signals together, when uncorrelated, results in a signal power multiplication of sqrt(2), not 2
+			s[0][k] *= densityInvRoot;
+			s[1][k] *= densityInvRoot;
+			
+			// 1-pole highpass for DC offset removal, to make feedback safer
+			s[0][k] -= (m_dcVal[0] = (1.f - m_dcCoeff) * s[0][k] + m_dcCoeff * m_dcVal[0]);
+			s[1][k] -= (m_dcVal[1] = (1.f - m_dcCoeff) * s[1][k] + m_dcCoeff * m_dcVal[1]);
+		}
 		
 		// cheap safety saturator to protect against infinite feedback
 		if (feedback > 0)
 		{
-			s[0] = safetySaturate(s[0]);
-			s[1] = safetySaturate(s[1]);
+			for (int k = 0; k < chunkEnd; ++k)
+			{
+				s[0][k] = safetySaturate(s[0][k]);
+				s[1][k] = safetySaturate(s[1][k]);
+			}
 		}
 		
-		if (++m_writePoint >= m_ringBufLength)
+		for (int k = 0; k < chunkEnd; ++k)
 		{
-			m_writePoint = 0;
-		}
-		if (prefilter)
-		{
-			filtered[0] = m_prefilter[0].process(filtered[0]);
-			filtered[1] = m_prefilter[1].process(filtered[1]);
+			if (++m_writePoint >= m_ringBufLength)
+			{
+				m_writePoint = 0;
+			}
+			std::array<float, 2> filtered = {buf[f + k][0], buf[f + k][1]};
+			if (prefilter)
+			{
+				filtered[0] = m_prefilter[0].process(filtered[0]);
+				filtered[1] = m_prefilter[1].process(filtered[1]);
+			}
+			
+			writeRing(0, m_writePoint, filtered[0] + s[0][k] * feedback);
+			writeRing(1, m_writePoint, filtered[1] + s[1][k] * feedback);
+			
+			buf[f + k][0] = s[0][k];
+			buf[f + k][1] = s[1][k];
 		}
 		
-		m_ringBuf[m_writePoint][0] = filtered[0] + s[0] * feedback;
-		m_ringBuf[m_writePoint][1] = filtered[1] + s[1] * feedback;
-			
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
+		m_timeSinceLastGrain += chunkEnd;
+		m_glideFrames = chunkEnd;
+		f += chunkEnd;
 	}
 	
 	if (m_sampleRateNeedsUpdate)
@@ -245,7 +195,179 @@ bool GranularPitchShifterEffect::processAudioBuffer(SampleFrame* buf, const fpp_
 		changeSampleRate();
 	}
 
-	return isRunning();
+	return ProcessStatus::Continue;
+}
+
+
+void GranularPitchShifterEffect::updatePitch(double pitch, double pitchSpread)
+{
+	// interpolate pitch depending on glide, over the frames since the last update
+	const double glideCoef = std::pow(m_glideCoef, m_glideFrames);
+	for (int i = 0; i < 2; ++i)
+	{
+		double targetVal = pitch + pitchSpread * (i ? 1. : -1.);
+		
+		if (targetVal == m_truePitch[i]) { continue; }
+		m_updatePitches = true;
+		
+		m_truePitch[i] = glideCoef * m_truePitch[i] + (1. - glideCoef) * targetVal;
+		// we crudely lock the pitch to the target value once it gets close enough, so we can save on CPU
+		if (std::abs(targetVal - m_truePitch[i]) < GlideSnagRadius) { m_truePitch[i] = targetVal; }
+	}
+	
+	// this stuff is computationally expensive, so we should only do it when necessary
+	if (!m_updatePitches) { return; }
+	m_updatePitches = false;
+	
+	std::array<double, 2> speed = {
+		std::exp2(m_truePitch[0]),
+		std::exp2(m_truePitch[1])
+	};
+	std::array<double, 2> ratio = {
+		speed[0] / m_speed[0],
+		speed[1] / m_speed[1]
+	};
+	
+	for (auto& grain : m_grains)
+	{
+		for (int j = 0; j < 2; ++j)
+		{
+			grain.grainSpeed[j] *= ratio[j];
+			
+			// we unfortunately need to do extra stuff to ensure these don't shoot past the write index...
+			if (grain.grainSpeed[j] > 1)
+			{
+				double distance = m_writePoint - grain.readPoint[j] - SafetyLatency;
+				if (distance <= 0) { distance += m_ringBufLength; }
+				double grainSpeedRequired = ((grain.grainSpeed[j] - 1.) / distance) * (1. - grain.phase);
+				grain.phaseSpeed[j] = std::max(grain.phaseSpeed[j], grainSpeedRequired);
+			}
+		}
+	}
+	m_speed[0] = speed[0];
+	m_speed[1] = speed[1];
+	
+	// prevent aliasing by lowpassing frequencies that the pitch shifting would push above nyquist
+	m_prefilter[0].setCoefs(m_sampleRate, std::min(m_nyquist / static_cast<float>(speed[0]), m_nyquist) * PrefilterBandwidth);
+	m_prefilter[1].setCoefs(m_sampleRate, std::min(m_nyquist / static_cast<float>(speed[1]), m_nyquist) * PrefilterBandwidth);
+}
+
+
+int GranularPitchShifterEffect::spawnGrain(int offset, int sizeSamples, int minLatency, float jitter, float twitch, float spray, float spraySpread)
+{
+	double randThing = (fast_rand()/static_cast<double>(FAST_RAND_MAX) * 2. - 1.);
+	m_nextWaitRandomization = std::exp2(randThing * twitch);
+	double grainSpeed = 1. / std::exp2(randThing * jitter);
+
+	std::array<float, 2> sprayResult = {0, 0};
+	if (spray > 0)
+	{
+		sprayResult[0] = (fast_rand() / static_cast<float>(FAST_RAND_MAX)) * spray * m_sampleRate;
+		sprayResult[1] = linearInterpolate(
+			sprayResult[0],
+			(fast_rand() / static_cast<float>(FAST_RAND_MAX)) * spray * m_sampleRate,
+			spraySpread);
+	}
+	
+	std::array<int, 2> readPoint;
+	int chunkEnd = GrainChunkSize;
+	int latency = std::max(static_cast<int>(std::max(sizeSamples * (std::max(m_speed[0], m_speed[1]) * grainSpeed - 1.), 0.) + SafetyLatency), minLatency);
+	const int writePoint = (m_writePoint + offset) % m_ringBufLength;
+	for (int i = 0; i < 2; ++i)
+	{
+		readPoint[i] = writePoint - latency - sprayResult[i];
+		// distance to what the ring buffer holds at the start of the chunk
+		const int distance = writePoint - readPoint[i] - offset;
+		if (readPoint[i] < 0) { readPoint[i] += m_ringBufLength; }
+		
+		const int readable = offset + readableFrames(distance, grainSpeed * m_speed[i]);
+		// if the grain would read from the current chunk right away, end the chunk before it starts
+		chunkEnd = std::min(chunkEnd, readable > offset ? readable : std::max(offset, 1));
+	}
+	const double phaseInc = 1. / sizeSamples;
+	m_grains.push_back(Grain(grainSpeed * m_speed[0], grainSpeed * m_speed[1], phaseInc, phaseInc, readPoint[0], readPoint[1], offset));
+	return chunkEnd;
+}
+
+
+int GranularPitchShifterEffect::readableFrames(double distance, double grainSpeed) const
+{
+	// the interpolation reads up to two frames ahead of the read point
+	return static_cast<int>(std::clamp((distance - 2.) / grainSpeed, -1., static_cast<double>(GrainChunkSize)));
+}
+
+
+bool GranularPitchShifterEffect::renderGrain(Grain& grain, int start, int end, float fadeLength, float shapeK, Chunk& out)
+{
+	const double phaseSpeed = std::max(grain.phaseSpeed[0], grain.phaseSpeed[1]);
+	// the grain is done at the first frame which would move its phase to 1
+	const int remaining = static_cast<int>(std::ceil(std::min((1. - grain.phase) / phaseSpeed, 1e9))) - 1;
+	const int frames = std::clamp(remaining, 0, end - start);
+
+	// The window, the read positions and the interpolation are computed in separate loops
+	// without branches, which the compiler can vectorize; only fetching the ring buffer
+	// frames at the read positions can't be.
+	const float phase = static_cast<float>(grain.phase);
+	const float phaseInc = static_cast<float>(phaseSpeed);
+	std::array<float, GrainChunkSize> window;
+	for (int k = 0; k < frames; ++k)
+	{
+		const float fadePos = (-std::abs(-2.f * (phase + (k + 1) * phaseInc) + 1.f) + 0.5f) * fadeLength + 0.5f;
+		window[k] = std::min(std::max(fadePos, 0.f), 1.f);
+	}
+	for (int k = 0; k < frames; ++k)
+	{
+		window[k] = cosHalfWindowApprox(window[k], shapeK);
+	}
+
+	std::array<int, GrainChunkSize> index;
+	std::array<float, GrainChunkSize> fraction;
+	std::array<std::array<float, GrainChunkSize>, 4> x;
+	for (int ch = 0; ch < 2; ++ch)
+	{
+		// double index and fraction are required for good quality
+		const double readPoint = grain.readPoint[ch];
+		const double grainSpeed = grain.grainSpeed[ch];
+		for (int k = 0; k < frames; ++k)
+		{
+			const double position = readPoint + (k + 1) * grainSpeed;
+			const int i = static_cast<int>(position);
+			fraction[k] = static_cast<float>(position - i);
+			index[k] = i >= m_ringBufLength ? i - m_ringBufLength : i;
+		}
+
+		// with the guard frame in front, this starts at the frame before the read point
+		const float* ring = m_ringBuf[ch].data();
+		for (int k = 0; k < frames; ++k)
+		{
+			x[0][k] = ring[index[k]];
+			x[1][k] = ring[index[k] + 1];
+			x[2][k] = ring[index[k] + 2];
+			x[3][k] = ring[index[k] + 3];
+		}
+
+		float* dst = out[ch].data() + start;
+		for (int k = 0; k < frames; ++k)
+		{
+			dst[k] += hermiteInterpolate(x[0][k], x[1][k], x[2][k], x[3][k], fraction[k]) * window[k];
+		}
+
+		grain.readPoint[ch] += frames * grainSpeed;
+		if (grain.readPoint[ch] >= m_ringBufLength) { grain.readPoint[ch] -= m_ringBufLength; }
+	}
+	grain.phase += frames * phaseSpeed;
+
+	return remaining > end - start;
+}
+
+
+void GranularPitchShifterEffect::writeRing(int ch, int index, float value)
+{
+	std::vector<float>& ring = m_ringBuf[ch];
+	ring[index + 1] = value;
+	// keep the guard frames in sync
+	if (index == m_ringBufLength - 1) { ring[0] = value; }
+	else if (index < 2) { ring[m_ringBufLength + 1 + index] = value; }
 }
 
 void GranularPitchShifterEffect::changeSampleRate()
@@ -257,11 +379,9 @@ void GranularPitchShifterEffect::changeSampleRate()
 	m_nyquist = m_sampleRate / 2;
 	
 	m_ringBufLength = m_sampleRate * ringBufLength;
-	m_ringBuf.resize(m_ringBufLength);
-	for (size_t i = 0; i < m_ringBufLength; ++i)
+	for (auto& ring : m_ringBuf)
 	{
-		m_ringBuf[i][0] = 0;
-		m_ringBuf[i][1] = 0;
+		ring.assign(m_ringBufLength + 3, 0.f);
 	}
 	m_writePoint = 0;
 	
@@ -270,7 +390,6 @@ void GranularPitchShifterEffect::changeSampleRate()
 	m_updatePitches = true;
 	
 	m_grains.clear();
-	m_grainCount = 0;
 	m_grains.reserve(8);// arbitrary
 	
 	m_dcCoeff = std::exp(-2.0 * F_PI * DcRemovalHz / m_sampleRate);
@@ -41,6 +41,8 @@ constexpr float RangeSeconds[5] = {5, 10, 40, 40, 120};
 constexpr float DcRemovalHz = 7.f;
 constexpr float SatuSafeVol = 16.f;
 constexpr float SatuStrength = 0.001f;
+// frames rendered at once; pitch, glide and grain spawning are handled at this rate
+constexpr int GrainChunkSize = 64;
 
 
 class GranularPitchShifterEffect : public Effect
@@ -48,40 +50,13 @@ class GranularPitchShifterEffect : public Effect
 public:
 	GranularPitchShifterEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
 	~GranularPitchShifterEffect() override = default;
-	bool processAudioBuffer(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
 
 	EffectControls* controls() override
 	{
 		return &m_granularpitchshifterControls;
 	}
 	
-	// double index and fraction are required for good quality
-	float getHermiteSample(double index, int ch)
-	{
-		const int index_floor = static_cast<int>(index);
-		const double fraction = index - index_floor;
-		
-		float v0, v1, v2, v3;
-
-		if (index_floor == 0) { v0 = m_ringBuf[m_ringBuf.size() - 1][ch]; }
-		else { v0 = m_ringBuf[index_floor - 1][ch]; }
-		
-		v1 = m_ringBuf[index_floor][ch];
-		
-		if(index_floor >= m_ringBuf.size() - 2)
-		{
-			v2 = m_ringBuf[(index_floor + 1) % m_ringBuf.size()][ch];
-			v3 = m_ringBuf[(index_floor + 2) % m_ringBuf.size()][ch];
-		}
-		else
-		{
-			v2 = m_ringBuf[index_floor + 1][ch];
-			v3 = m_ringBuf[index_floor + 2][ch];
-		}
-		
-		return hermiteInterpolate(v0, v1, v2, v3, static_cast<float>(fraction));
-	}
-	
 	// adapted from signalsmith's crossfade approximation:
 	// https://signalsmith-audio.co.uk/writing/2021/cheap-energy-crossfade
 	float cosHalfWindowApprox(float x, float k)
@@ -138,21 +113,36 @@ private:
 
 	struct Grain
 	{
-		Grain(double grainSpeedL, double grainSpeedR, double phaseSpeedL, double phaseSpeedR, double readPointL, double readPointR) :
+		Grain(double grainSpeedL, double grainSpeedR, double phaseSpeedL, double phaseSpeedR, double readPointL, double readPointR, int delay) :
 			readPoint{readPointL, readPointR},
 			phaseSpeed{phaseSpeedL, phaseSpeedR},
 			grainSpeed{grainSpeedL, grainSpeedR},
-			phase{0}
+			phase{0},
+			delay{delay}
 		{}
 		std::array<double, 2> readPoint;
 		std::array<double, 2> phaseSpeed;
 		std::array<double, 2> grainSpeed;
 		double phase;
+		// frames into the current chunk before the grain starts
+		int delay;
 	};
+
+	using Chunk = std::array<std::array<float, GrainChunkSize>, 2>;
+
+	void updatePitch(double pitch, double pitchSpread);
+	// spawns a grain starting at frame offset of the chunk, returns up to which frame the chunk can be rendered
+	int spawnGrain(int offset, int sizeSamples, int minLatency, float jitter, float twitch, float spray, float spraySpread);
+	// last frame + 1 of the chunk which can be rendered without reading from the ring buffer what the chunk writes
+	int readableFrames(double distance, double grainSpeed) const;
+	// adds frames start to end of the chunk, returns whether the grain continues afterwards
+	bool renderGrain(Grain& grain, int start, int end, float fadeLength, float shapeK, Chunk& out);
+	void writeRing(int ch, int index, float value);
 	
 	GranularPitchShifterControls m_granularpitchshifterControls;
 	
-	std::vector<std::array<float, 2>> m_ringBuf;
+	// one frame of guard in front and two behind, so interpolation doesn't need to wrap
+	std::array<std::vector<float>, 2> m_ringBuf;
 	std::vector<Grain> m_grains;
 
 	std::array<PrefilterLowpass, 2> m_prefilter;
@@ -167,8 +157,8 @@ private:
 
 	int m_ringBufLength = 0;
 	int m_writePoint = 0;
-	int m_grainCount = 0;
 	int m_timeSinceLastGrain = 999999999;
+	int m_glideFrames = 1;
 
 	double m_oldGlide = -1;
 	double m_glideCoef = 0;
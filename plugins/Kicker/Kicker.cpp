@@ -29,6 +29,7 @@
 
 #include "AudioEngine.h"
 #include "Engine.h"
+#include "InstrumentPlayHandle.h"
 #include "InstrumentTrack.h"
 #include "Knob.h"
 #include "LedCheckBox.h"
@@ -64,7 +65,7 @@ Plugin::Descriptor PLUGIN_EXPORT kicker_plugin_descriptor =
 
 
 KickerInstrument::KickerInstrument( InstrumentTrack * _instrument_track ) :
-	Instrument(_instrument_track, &kicker_plugin_descriptor, nullptr, Flag::IsNotBendable),
+	Instrument(_instrument_track, &kicker_plugin_descriptor, nullptr, Flag::IsNotBendable | Flag::RendersAllVoices),
 	m_startFreqModel( 150.0f, 5.0f, 1000.0f, 1.0f, this, tr( "Start frequency" ) ),
 	m_endFreqModel( 40.0f, 5.0f, 1000.0f, 1.0f, this, tr( "End frequency" ) ),
 	m_decayModel( 440.0f, 5.0f, 5000.0f, 1.0f, 5000.0f, this, tr( "Length" ) ),
@@ -79,6 +80,19 @@ KickerInstrument::KickerInstrument( InstrumentTrack * _instrument_track ) :
 	m_endNoteModel( false, this, tr( "End to note" ) ),
 	m_versionModel( KICKER_PRESET_VERSION, 0, KICKER_PRESET_VERSION, this, "" )
 {
+	// drum tracks play many short notes, so render all of them in one job
+	auto iph = new InstrumentPlayHandle(this, _instrument_track);
+	Engine::audioEngine()->addPlayHandle( iph );
+}
+
+
+
+
+KickerInstrument::~KickerInstrument()
+{
+	Engine::audioEngine()->removePlayHandlesOfTypes( instrumentTrack(),
+				PlayHandle::Type::NotePlayHandle
+				| PlayHandle::Type::InstrumentPlayHandle );
 }
 
 
@@ -165,7 +179,7 @@ void KickerInstrument::playNote( NotePlayHandle * _n,
 
 	if (!_n->m_pluginData)
 	{
-		_n->m_pluginData = new SweepOsc(
+		_n->m_pluginData = _n->arena().create<SweepOsc>(
 					DistFX( m_distModel.value(),
 							m_gainModel.value() ),
 					m_startNoteModel.value() ? _n->frequency() : m_startFreqModel.value(),
@@ -211,14 +225,6 @@ void KickerInstrument::playNote( NotePlayHandle * _n,
 
 
 
-void KickerInstrument::deleteNotePluginData( NotePlayHandle * _n )
-{
-	delete static_cast<SweepOsc *>( _n->m_pluginData );
-}
-
-
-
-
 gui::PluginView * KickerInstrument::instantiateView( QWidget * _parent )
 {
 	return new gui::KickerInstrumentView( this, _parent );
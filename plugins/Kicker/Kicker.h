@@ -53,11 +53,10 @@ class KickerInstrument : public Instrument
 	Q_OBJECT
 public:
 	KickerInstrument( InstrumentTrack * _instrument_track );
-	~KickerInstrument() override = default;
+	~KickerInstrument() override;
 
 	void playNote( NotePlayHandle * _n,
 						SampleFrame* _working_buffer ) override;
-	void deleteNotePluginData( NotePlayHandle * _n ) override;
 
 	void saveSettings(QDomDocument& doc, QDomElement& elem) override;
 	void loadSettings(const QDomElement& elem) override;
@@ -26,6 +26,7 @@
 
 #include "embed.h"
 #include "plugin_export.h"
+#include "ScratchArena.h"
 
 namespace lmms
 {
@@ -57,9 +58,9 @@ LOMMEffect::LOMMEffect(Model* parent, const Descriptor::SubPluginFeatures::Key*
 	m_hp2(m_sampleRate),
 	m_ap(m_sampleRate),
 	m_needsUpdate(true),
-	m_coeffPrecalc(-0.05f),
-	m_crestTimeConst(0.999f),
-	m_lookWrite(0),
+	m_levelDetector{LevelDetector{LOMM_MIN_FLOOR}, LevelDetector{LOMM_MIN_FLOOR}, LevelDetector{LOMM_MIN_FLOOR}},
+	m_envelopeFollower{EnvelopeFollower{LOMM_MIN_FLOOR}, EnvelopeFollower{LOMM_MIN_FLOOR}, EnvelopeFollower{LOMM_MIN_FLOOR}},
+	m_crestFactor(LOMM_MIN_FLOOR),
 	m_lookBufLength(2)
 {
 	autoQuitModel()->setValue(autoQuitModel()->maxValue());
@@ -79,35 +80,34 @@ void LOMMEffect::changeSampleRate()
 	m_hp2.setSampleRate(m_sampleRate);
 	m_ap.setSampleRate(m_sampleRate);
 	
-	m_coeffPrecalc = -2.2f / (m_sampleRate * 0.001f);
 	m_needsUpdate = true;
 	
-	m_crestTimeConst = exp(-1.f / (0.2f * m_sampleRate));
+	m_crestFactor.setTimeConstant(exp(-1.f / (0.2f * m_sampleRate)));
+	m_crestFactor.reset();
 	
 	m_lookBufLength = std::ceil((LOMM_MAX_LOOKAHEAD / 1000.f) * m_sampleRate) + 2;
-	for (int i = 0; i < 2; ++i)
+	for (int j = 0; j < 3; ++j)
 	{
-		for (int j = 0; j < 3; ++j)
-		{
-			m_inLookBuf[j][i].resize(m_lookBufLength);
-			m_scLookBuf[j][i].resize(m_lookBufLength, LOMM_MIN_FLOOR);
-		}
+		m_levelDetector[j].reset();
+		m_envelopeFollower[j].setSampleRate(m_sampleRate);
+		m_envelopeFollower[j].reset();
+		m_inLookahead[j].resize(m_lookBufLength, 0);
+		m_scLookahead[j].resize(m_lookBufLength, LOMM_MIN_FLOOR);
+		m_displayIn[j] = m_displayOut[j] = {LOMM_MIN_FLOOR, LOMM_MIN_FLOOR};
+		m_prevOut[j] = SampleFrame(LOMM_MIN_FLOOR);
 	}
+}
+
 
-	std::fill(m_yL.begin(), m_yL.end(), std::array<float, 2>{LOMM_MIN_FLOOR, LOMM_MIN_FLOOR});
-	m_rms = m_gainResult = m_displayIn = m_displayOut = m_prevOut = m_yL;
-	m_crestPeakVal[0] = m_crestPeakVal[1] = LOMM_MIN_FLOOR;
-	m_crestRmsVal = m_crestFactorVal = m_crestPeakVal;
+f_cnt_t LOMMEffect::processLatency() const
+{
+	// with lookahead enabled, the bands go through the whole lookahead buffer
+	return m_lommControls.m_lookaheadEnableModel.value() ? m_lookBufLength : 0;
 }
 
 
-bool LOMMEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
+Effect::ProcessStatus LOMMEffect::processImpl(SampleFrame* buf, const fpp_t frames)
 {
-	if (!isEnabled() || !isRunning())
-	{
-		return false;
-	}
-	
 	if (m_needsUpdate || m_lommControls.m_split1Model.isValueChanged())
 	{
 		m_lp1.setLowpass(m_lommControls.m_split1Model.value());
@@ -121,10 +121,6 @@ bool LOMMEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 	}
 	m_needsUpdate = false;
 
-	float outSum = 0.f;
-	const float d = dryLevel();
-	const float w = wetLevel();
-	
 	const float depth = m_lommControls.m_depthModel.value();
 	const float time = m_lommControls.m_timeModel.value();
 	const float inVol = dbfsToAmp(m_lommControls.m_inVolModel.value());
@@ -163,19 +159,11 @@ bool LOMMEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 	const float atkH = m_lommControls.m_atkHModel.value() * time;
 	const float atkM = m_lommControls.m_atkMModel.value() * time;
 	const float atkL = m_lommControls.m_atkLModel.value() * time;
-	const float atkCoefH = msToCoeff(atkH);
-	const float atkCoefM = msToCoeff(atkM);
-	const float atkCoefL = msToCoeff(atkL);
 	float atk[3] = {atkH, atkM, atkL};
-	float atkCoef[3] = {atkCoefH, atkCoefM, atkCoefL};
 	const float relH = m_lommControls.m_relHModel.value() * time;
 	const float relM = m_lommControls.m_relMModel.value() * time;
 	const float relL = m_lommControls.m_relLModel.value() * time;
-	const float relCoefH = msToCoeff(relH);
-	const float relCoefM = msToCoeff(relM);
-	const float relCoefL = msToCoeff(relL);
 	float rel[3] = {relH, relM, relL};
-	float relCoef[3] = {relCoefH, relCoefM, relCoefL};
 	const float rmsTime = m_lommControls.m_rmsTimeModel.value();
 	const float rmsTimeConst = (rmsTime == 0) ? 0 : exp(-1.f / (rmsTime * 0.001f * m_sampleRate));
 	const float knee = m_lommControls.m_kneeModel.value() * 0.5f;
@@ -194,240 +182,224 @@ bool LOMMEffect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
 	const bool feedback = m_lommControls.m_feedbackModel.value() && !lookaheadEnable;
 	const bool lowSideUpwardSuppress = m_lommControls.m_lowSideUpwardSuppressModel.value() && midside;
 	
-	for (fpp_t f = 0; f < frames; ++f)
+	const float outVolMix = linearInterpolate(1.f, outVol, mix * (depthScaling ? depth : 1));
+	
+	for (int j = 0; j < 3; ++j)// Bands
+	{
+		m_levelDetector[j].setRms(rmsTime > 0, rmsTimeConst);
+		// Calculate attack and release values depending on crest factor
+		m_envelopeFollower[j].setTimes(atk[j], rel[j]);
+		m_envelopeFollower[j].setAutoTime(autoTime, autoTime, LOMM_AUTO_TIME_ADJUST);
+	}
+	
+	auto scratch = ScratchArena::Scope{};
+	SampleFrame* crestFactor = ScratchArena::frames(frames);
+	std::array<SampleFrame*, 3> bandsDry;
+	for (auto& band : bandsDry) { band = ScratchArena::frames(frames); }
+	SampleFrame* bands = ScratchArena::frames(frames);
+	SampleFrame* gain = ScratchArena::frames(frames);
+	SampleFrame* delayed = ScratchArena::frames(frames);
+	
+	// Every stage runs over the whole block, except with feedback, where the
+	// sidechain of every frame is the output of the frame before.
+	const fpp_t blockSize = feedback ? 1 : frames;
+	for (fpp_t start = 0; start < frames; start += blockSize)
 	{
-		std::array<sample_t, 2> s = {buf[f][0], buf[f][1]};
+		SampleFrame* block = buf + start;
+		const fpp_t blockFrames = std::min(blockSize, frames - start);
 		
-		// Convert left/right to mid/side.  Side channel is intentionally made
-		// to be 6 dB louder to bring it into volume ranges comparable to the mid channel.
-		if (midside)
+		for (fpp_t f = 0; f < blockFrames; ++f)
 		{
-			float tempS0 = s[0];
-			s[0] = (s[0] + s[1]) * 0.5f;
-			s[1] = tempS0 - s[1];
+			SampleFrame s = block[f];
+			
+			// Convert left/right to mid/side.  Side channel is intentionally made
+			// to be 6 dB louder to bring it into volume ranges comparable to the mid channel.
+			if (midside)
+			{
+				float tempS0 = s[0];
+				s[0] = (s[0] + s[1]) * 0.5f;
+				s[1] = tempS0 - s[1];
+			}
+			crestFactor[f] = s;
+			
+			for (int i = 0; i < 2; ++i)// Channels
+			{
+				// Crossover filters
+				std::array<float, 3> band;
+				band[2] = m_lp2.update(s[i], i);
+				band[1] = m_hp2.update(s[i], i);
+				band[0] = m_hp1.update(band[1], i);
+				band[1] = m_lp1.update(band[1], i);
+				band[2] = m_ap.update(band[2], i);
+				
+				if (!split1Enabled)
+				{
+					band[1] += band[0];
+					band[0] = 0;
+				}
+				if (!split2Enabled)
+				{
+					band[1] += band[2];
+					band[2] = 0;
+				}
+				
+				// Mute disabled bands
+				bandsDry[0][f][i] = band[0] * band1Enabled;
+				bandsDry[1][f][i] = band[1] * band2Enabled;
+				bandsDry[2][f][i] = band[2] * band3Enabled;
+			}
 		}
 		
-		std::array<std::array<float, 2>, 3> bands = {{}};
-		std::array<std::array<float, 2>, 3> bandsDry = {{}};
+		// These values are for the Auto time knob.  Higher crest factor allows for faster attack/release.
+		m_crestFactor.process(crestFactor, crestFactor, blockFrames);
 		
-		for (int i = 0; i < 2; ++i)// Channels
+		for (int j = 0; j < 3; ++j)// Bands
 		{
-			// These values are for the Auto time knob.  Higher crest factor allows for faster attack/release.
-			float inSquared = s[i] * s[i];
-			m_crestPeakVal[i] = std::max(std::max(LOMM_MIN_FLOOR, inSquared), m_crestTimeConst * m_crestPeakVal[i] + (1 - m_crestTimeConst) * (inSquared));
-			m_crestRmsVal[i] = std::max(LOMM_MIN_FLOOR, m_crestTimeConst * m_crestRmsVal[i] + ((1 - m_crestTimeConst) * (inSquared)));
-			m_crestFactorVal[i] = m_crestPeakVal[i] / m_crestRmsVal[i];
-			float crestFactorValTemp = ((m_crestFactorVal[i] - LOMM_AUTO_TIME_ADJUST) * autoTime) + LOMM_AUTO_TIME_ADJUST;
-		
-			// Crossover filters
-			bands[2][i] = m_lp2.update(s[i], i);
-			bands[1][i] = m_hp2.update(s[i], i);
-			bands[0][i] = m_hp1.update(bands[1][i], i);
-			bands[1][i] = m_lp1.update(bands[1][i], i);
-			bands[2][i] = m_ap.update(bands[2][i], i);
+			const float bandVol = inBandVol[j] * inVol;
+			const auto bandScale = SampleFrame(bandVol * balanceAmp[0], bandVol * balanceAmp[1]);
+			for (fpp_t f = 0; f < blockFrames; ++f)
+			{
+				bands[f] = bandsDry[j][f] * bandScale;
+			}
 			
-			if (!split1Enabled)
+			if (feedback)
 			{
-				bands[1][i] += bands[0][i];
-				bands[0][i] = 0;
+				gain[0] = m_prevOut[j] * bandScale;
 			}
-			if (!split2Enabled)
+			else
 			{
-				bands[1][i] += bands[2][i];
-				bands[2][i] = 0;
+				std::copy(bands, bands + blockFrames, gain);
 			}
 			
-			// Mute disabled bands
-			bands[0][i] *= band1Enabled;
-			bands[1][i] *= band2Enabled;
-			bands[2][i] *= band3Enabled;
+			m_levelDetector[j].process(gain, gain, blockFrames);
+			m_envelopeFollower[j].process(gain, crestFactor, gain, blockFrames);
 			
-			std::array<float, 3> detect = {0, 0, 0};
-			for (int j = 0; j < 3; ++j)// Bands
+			if (lookaheadEnable)
 			{
-				bandsDry[j][i] = bands[j][i];
-				
-				if (feedback && !lookaheadEnable)
-				{
-					bands[j][i] = m_prevOut[j][i];
-				}
-				
-				bands[j][i] *= inBandVol[j] * inVol * balanceAmp[i];
-				
-				if (rmsTime > 0)// RMS
-				{
-					m_rms[j][i] = rmsTimeConst * m_rms[j][i] + ((1 - rmsTimeConst) * (bands[j][i] * bands[j][i]));
-					detect[j] = std::max(LOMM_MIN_FLOOR, std::sqrt(m_rms[j][i]));
-				}
-				else// Peak
-				{
-					detect[j] = std::max(LOMM_MIN_FLOOR, std::abs(bands[j][i]));
-				}
-				
-				if (detect[j] > m_yL[j][i])// Attack phase
+				// Lookahead is calculated by picking the largest value between
+				// the current sidechain signal and the delayed sidechain signal.
+				m_scLookahead[j].write(gain, blockFrames);
+				m_scLookahead[j].readWithLookahead(gain, blockFrames, m_lookBufLength, lookahead);
+			}
+			
+			const SampleFrame lastEnvelope = gain[blockFrames - 1];
+			for (fpp_t f = 0; f < blockFrames; ++f)
+			{
+				for (int i = 0; i < 2; ++i)// Channels
 				{
-					// Calculate attack value depending on crest factor
-					const float currentAttack = autoTime
-						? msToCoeff(LOMM_AUTO_TIME_ADJUST * atk[j] / crestFactorValTemp)
-						: atkCoef[j];
+					const float yAmp = gain[f][i];
+					const float yDbfs = ampToDbfs(yAmp);
 					
-					m_yL[j][i] = m_yL[j][i] * currentAttack + (1 - currentAttack) * detect[j];
-				}
-				else// Release phase
-				{
-					// Calculate release value depending on crest factor
-					const float currentRelease = autoTime
-						? msToCoeff(LOMM_AUTO_TIME_ADJUST * rel[j] / crestFactorValTemp)
-						: relCoef[j];
+					// Downward compression
+					float aboveGain = compressedLevel(yDbfs, aThresh[j], aRatio[j], knee);
+					if (aboveGain < yDbfs)
+					{
+						if (downward * depth <= 1)
+						{
+							aboveGain = linearInterpolate(yDbfs, aboveGain, downward * depth);
+						}
+						else
+						{
+							aboveGain = linearInterpolate(aboveGain, aThresh[j], downward * depth - 1);
+						}
+					}
 					
-					m_yL[j][i] = m_yL[j][i] * currentRelease + (1 - currentRelease) * detect[j];
-				}
-				
-				m_yL[j][i] = std::max(LOMM_MIN_FLOOR, m_yL[j][i]);
-				
-				float yAmp = m_yL[j][i];
-				if (lookaheadEnable)
-				{
-					float temp = yAmp;
-					// Lookahead is calculated by picking the largest value between
-					// the current sidechain signal and the delayed sidechain signal.
-					yAmp = std::max(m_scLookBuf[j][i][m_lookWrite], m_scLookBuf[j][i][(m_lookWrite + m_lookBufLength - lookahead) % m_lookBufLength]);
-					m_scLookBuf[j][i][m_lookWrite] = temp;
-				}
-				
-				const float yDbfs = ampToDbfs(yAmp);
-				
-				float aboveGain = 0;
-				float belowGain = 0;
-				
-				// Downward compression
-				if (yDbfs - aThresh[j] < -knee)// Below knee
-				{
-					aboveGain = yDbfs;
-				}
-				else if (yDbfs - aThresh[j] < knee)// Within knee
-				{
-					const float temp = yDbfs - aThresh[j] + knee;
-					aboveGain = yDbfs + (aRatio[j] - 1) * temp * temp / (4 * knee);
-				}
-				else// Above knee
-				{
-					aboveGain = aThresh[j] + (yDbfs - aThresh[j]) * aRatio[j];
-				}
-				if (aboveGain < yDbfs)
-				{
-					if (downward * depth <= 1)
+					// Upward compression
+					float belowGain = upwardCompressedLevel(yDbfs, bThresh[j], bRatio[j], knee);
+					if (belowGain > yDbfs)
 					{
-						aboveGain = linearInterpolate(yDbfs, aboveGain, downward * depth);
+						if (upward * depth <= 1)
+						{
+							belowGain = linearInterpolate(yDbfs, belowGain, upward * depth);
+						}
+						else
+						{
+							belowGain = linearInterpolate(belowGain, bThresh[j], upward * depth - 1);
+						}
 					}
-					else
+					
+					float gainResult = (dbfsToAmp(aboveGain) / yAmp) * (dbfsToAmp(belowGain) / yAmp);
+					if (lowSideUpwardSuppress && gainResult > 1 && j == 2 && i == 1) //undo upward compression if low side band
 					{
-						aboveGain = linearInterpolate(aboveGain, aThresh[j], downward * depth - 1);
+						gainResult = 1;
 					}
+					gain[f][i] = std::min(gainResult, rangeAmp);
 				}
-				
-				// Upward compression
-				if (yDbfs - bThresh[j] > knee)// Above knee
-				{
-					belowGain = yDbfs;
-				}
-				else if (bThresh[j] - yDbfs < knee)// Within knee
-				{
-					const float temp = bThresh[j] - yDbfs + knee;
-					belowGain = yDbfs + (1 - bRatio[j]) * temp * temp / (4 * knee);
-				}
-				else// Below knee
+			}
+			
+			// Only the last frame is shown
+			for (int i = 0; i < 2; ++i)
+			{
+				m_displayIn[j][i] = ampToDbfs(lastEnvelope[i]);
+				m_displayOut[j][i] = ampToDbfs(std::max(LOMM_MIN_FLOOR, lastEnvelope[i] * gain[blockFrames - 1][i]));
+			}
+			
+			// Apply the same gain reduction to both channels if stereo link is enabled.
+			if (stereoLink)
+			{
+				if (gain[blockFrames - 1][1] < gain[blockFrames - 1][0])
 				{
-					belowGain = bThresh[j] + (yDbfs - bThresh[j]) * bRatio[j];
+					m_displayOut[j][0] = m_displayIn[j][0] - (m_displayIn[j][1] - m_displayOut[j][1]);
 				}
-				if (belowGain > yDbfs)
+				else
 				{
-					if (upward * depth <= 1)
-					{
-						belowGain = linearInterpolate(yDbfs, belowGain, upward * depth);
-					}
-					else
-					{
-						belowGain = linearInterpolate(belowGain, bThresh[j], upward * depth - 1);
-					}
+					m_displayOut[j][1] = m_displayIn[j][1] - (m_displayIn[j][0] - m_displayOut[j][0]);
 				}
-				
-				m_displayIn[j][i] = yDbfs;
-				m_gainResult[j][i] = (dbfsToAmp(aboveGain) / yAmp) * (dbfsToAmp(belowGain) / yAmp);
-				if (lowSideUpwardSuppress && m_gainResult[j][i] > 1 && j == 2 && i == 1) //undo upward compression if low side band
+				for (fpp_t f = 0; f < blockFrames; ++f)
 				{
-					m_gainResult[j][i] = 1;
-				}
-				m_gainResult[j][i] = std::min(m_gainResult[j][i], rangeAmp);
-				m_displayOut[j][i] = ampToDbfs(std::max(LOMM_MIN_FLOOR, yAmp * m_gainResult[j][i]));
-				
-				// Apply the same gain reduction to both channels if stereo link is enabled.
-				if (stereoLink && i == 1)
-				{
-					if (m_gainResult[j][1] < m_gainResult[j][0])
-					{
-						m_gainResult[j][0] = m_gainResult[j][1];
-						m_displayOut[j][0] = m_displayIn[j][0] - (m_displayIn[j][1] - m_displayOut[j][1]);
-					}
-					else
-					{
-						m_gainResult[j][1] = m_gainResult[j][0];
-						m_displayOut[j][1] = m_displayIn[j][1] - (m_displayIn[j][0] - m_displayOut[j][0]);
-					}
+					gain[f] = SampleFrame(gain[f][1] < gain[f][0] ? gain[f][1] : gain[f][0]);
 				}
 			}
-		}
-		
-		for (int i = 0; i < 2; ++i)// Channels
-		{
-			for (int j = 0; j < 3; ++j)// Bands
+			
+			const SampleFrame* bandsWet = bands;
+			const SampleFrame* bandDry = bandsDry[j];
+			if (lookaheadEnable)
 			{
-				if (lookaheadEnable)
-				{
-					float temp = bands[j][i];
-					bands[j][i] = m_inLookBuf[j][i][m_lookWrite];
-					m_inLookBuf[j][i][m_lookWrite] = temp;
-					bandsDry[j][i] = bands[j][i];
-				}
-				else if (feedback)
-				{
-					bands[j][i] = bandsDry[j][i] * inBandVol[j] * inVol * balanceAmp[i];
-				}
+				m_inLookahead[j].write(bands, blockFrames);
+				m_inLookahead[j].read(delayed, blockFrames, m_lookBufLength);
+				bandsWet = bandDry = delayed;
+			}
 			
+			for (fpp_t f = 0; f < blockFrames; ++f)
+			{
 				// Apply gain reduction
-				bands[j][i] *= m_gainResult[j][i];
+				SampleFrame band = bandsWet[f] * gain[f];
 				
 				// Store for Feedback
-				m_prevOut[j][i] = bands[j][i];
+				m_prevOut[j] = band;
 				
-				bands[j][i] *= outBandVol[j];
+				band *= outBandVol[j];
+				band = SampleFrame(linearInterpolate(bandDry[f][0], band[0], mix), linearInterpolate(bandDry[f][1], band[1], mix));
 				
-				bands[j][i] = linearInterpolate(bandsDry[j][i], bands[j][i], mix);
+				if (j == 0)
+				{
+					block[f] = band;
+				}
+				else
+				{
+					block[f] += band;
+				}
 			}
-			
-			s[i] = bands[0][i] + bands[1][i] + bands[2][i];
-			
-			s[i] *= linearInterpolate(1.f, outVol, mix * (depthScaling ? depth : 1));
 		}
 		
-		// Convert mid/side back to left/right.
-		// Note that the side channel was intentionally made to be 6 dB louder prior to compression.
-		if (midside)
+		for (fpp_t f = 0; f < blockFrames; ++f)
 		{
-			float tempS0 = s[0];
-			s[0] = s[0] + (s[1] * 0.5f);
-			s[1] = tempS0 - (s[1] * 0.5f);
+			SampleFrame s = block[f] * outVolMix;
+			
+			// Convert mid/side back to left/right.
+			// Note that the side channel was intentionally made to be 6 dB louder prior to compression.
+			if (midside)
+			{
+				float tempS0 = s[0];
+				s[0] = s[0] + (s[1] * 0.5f);
+				s[1] = tempS0 - (s[1] * 0.5f);
+			}
+			
+			block[f] = s;
 		}
-		
-		if (--m_lookWrite < 0) { m_lookWrite = m_lookBufLength - 1; }
-
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0] + buf[f][1];
 	}
 
-	checkGate(outSum / frames);
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 extern "C"
@@ -30,6 +30,7 @@
 #include "Effect.h"
 
 #include "BasicFilters.h"
+#include "Dynamics.h"
 #include "lmms_math.h"
 
 namespace lmms
@@ -45,17 +46,14 @@ class LOMMEffect : public Effect
 public:
 	LOMMEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
 	~LOMMEffect() override = default;
-	bool processAudioBuffer(SampleFrame* buf, const fpp_t frames) override;
+	ProcessStatus processImpl(SampleFrame* buf, const fpp_t frames) override;
 
 	EffectControls* controls() override
 	{
 		return &m_lommControls;
 	}
-	
-	inline float msToCoeff(float ms)
-	{
-		return (ms == 0) ? 0 : exp(m_coeffPrecalc / ms);
-	}
+
+	f_cnt_t processLatency() const override;
 
 private slots:
 	void changeSampleRate();
@@ -74,26 +72,19 @@ private:
 	BasicFilters<2> m_ap;
 	
 	bool m_needsUpdate;
-	float m_coeffPrecalc;
 	
-	std::array<std::array<float, 2>, 3> m_yL;
-	std::array<std::array<float, 2>, 3> m_rms;
-	std::array<std::array<float, 2>, 3> m_gainResult;
+	std::array<LevelDetector, 3> m_levelDetector;
+	std::array<EnvelopeFollower, 3> m_envelopeFollower;
+	CrestFactorDetector m_crestFactor;
 	
 	std::array<std::array<float, 2>, 3> m_displayIn;
 	std::array<std::array<float, 2>, 3> m_displayOut;
 	
-	std::array<float, 2> m_crestPeakVal;
-	std::array<float, 2> m_crestRmsVal;
-	std::array<float, 2> m_crestFactorVal;
-	float m_crestTimeConst = 0.0f;
-	
-	std::array<std::array<float, 2>, 3> m_prevOut;
+	std::array<SampleFrame, 3> m_prevOut;
 	
-	std::array<std::array<std::vector<float>, 2>, 3> m_inLookBuf;
-	std::array<std::array<std::vector<float>, 2>, 3> m_scLookBuf;
+	std::array<LookaheadDelay, 3> m_inLookahead;
+	std::array<LookaheadDelay, 3> m_scLookahead;
 	
-	int m_lookWrite = 0;
 	int m_lookBufLength = 0;
 	
 	friend class LOMMControls;
@@ -24,19 +24,20 @@
  */
 
 
-#include <QVarLengthArray>
 #include <QMessageBox>
 
 #include "LadspaEffect.h"
 #include "DataFile.h"
 #include "AudioDevice.h"
 #include "AudioEngine.h"
+#include "AudioEngineWorkerThread.h"
 #include "Ladspa2LMMS.h"
 #include "LadspaBase.h"
 #include "LadspaControl.h"
 #include "LadspaSubPluginFeatures.h"
 #include "AutomationClip.h"
 #include "ValueBuffer.h"
+#include "ScratchArena.h"
 #include "Song.h"
 
 #include "embed.h"
@@ -129,25 +130,26 @@ void LadspaEffect::changeSampleRate()
 
 
 
-bool LadspaEffect::processAudioBuffer( SampleFrame* _buf,
+Effect::ProcessStatus LadspaEffect::processImpl( SampleFrame* _buf,
 							const fpp_t _frames )
 {
+	// the plugin may have been unloaded since Effect checked this
 	m_pluginMutex.lock();
-	if( !isOkay() || dontRun() || !isRunning() || !isEnabled() )
+	if( !isOkay() || dontRun() )
 	{
 		m_pluginMutex.unlock();
-		return( false );
+		return ProcessStatus::Sleep;
 	}
 
 	int frames = _frames;
 	SampleFrame* o_buf = nullptr;
-	QVarLengthArray<SampleFrame> sBuf(_frames);
+	auto scratch = ScratchArena::Scope{};
 
 	if( m_maxSampleRate < Engine::audioEngine()->outputSampleRate() )
 	{
 		o_buf = _buf;
-		_buf = sBuf.data();
-		sampleDown( o_buf, _buf, m_maxSampleRate );
+		_buf = ScratchArena::frames( _frames );
+		sampleDown( o_buf, _buf, m_maxSampleRate, _frames );
 		frames = _frames * m_maxSampleRate /
 				Engine::audioEngine()->outputSampleRate();
 	}
@@ -215,17 +217,16 @@ bool LadspaEffect::processAudioBuffer( SampleFrame* _buf,
 	}
 
 
-	// Process the buffers.
-	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+	// Process the buffers. Each processor is a job of its own, so multiple
+	// instances (one per channel for mono plugins) run in parallel.
+	for (const auto& job : m_processorJobs)
 	{
-		(m_descriptor->run)( m_handles[proc], frames );
+		job->setFrames(frames);
 	}
+	AudioEngineWorkerThread::processInParallel(m_processorJobList.data(), m_processorJobList.size());
 
 	// Copy the LADSPA output buffers to the LMMS buffer.
-	double out_sum = 0.0;
 	channel = 0;
-	const float d = dryLevel();
-	const float w = wetLevel();
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
 		for( int port = 0; port < m_portCount; ++port )
@@ -241,8 +242,7 @@ bool LadspaEffect::processAudioBuffer( SampleFrame* _buf,
 					for( fpp_t frame = 0;
 						frame < frames; ++frame )
 					{
-						_buf[frame][channel] = d * _buf[frame][channel] + w * pp->buffer[frame];
-						out_sum += _buf[frame][channel] * _buf[frame][channel];
+						_buf[frame][channel] = pp->buffer[frame];
 					}
 					++channel;
 					break;
@@ -257,15 +257,11 @@ bool LadspaEffect::processAudioBuffer( SampleFrame* _buf,
 
 	if( o_buf != nullptr )
 	{
-		sampleBack( _buf, o_buf, m_maxSampleRate );
+		sampleBack( _buf, o_buf, m_maxSampleRate, _frames );
 	}
 
-	checkGate( out_sum / frames );
-
-
-	bool is_running = isRunning();
 	m_pluginMutex.unlock();
-	return( is_running );
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -325,7 +321,7 @@ void LadspaEffect::pluginInstantiation()
 					manager->isPortInput( m_key, port ) )
 				{
 					p->rate = BufferRate::ChannelIn;
-					p->buffer = new LADSPA_Data[Engine::audioEngine()->framesPerPeriod()];
+					p->buffer = new LADSPA_Data[MAXIMUM_BLOCK_SIZE];
 					inbuf[ inputch ] = p->buffer;
 					inputch++;
 				}
@@ -340,19 +336,19 @@ void LadspaEffect::pluginInstantiation()
 					}
 					else
 					{
-						p->buffer = new LADSPA_Data[Engine::audioEngine()->framesPerPeriod()];
+						p->buffer = new LADSPA_Data[MAXIMUM_BLOCK_SIZE];
 						m_inPlaceBroken = true;
 					}
 				}
 				else if( manager->isPortInput( m_key, port ) )
 				{
 					p->rate = BufferRate::AudioRateInput;
-					p->buffer = new LADSPA_Data[Engine::audioEngine()->framesPerPeriod()];
+					p->buffer = new LADSPA_Data[MAXIMUM_BLOCK_SIZE];
 				}
 				else
 				{
 					p->rate = BufferRate::AudioRateOutput;
-					p->buffer = new LADSPA_Data[Engine::audioEngine()->framesPerPeriod()];
+					p->buffer = new LADSPA_Data[MAXIMUM_BLOCK_SIZE];
 				}
 			}
 			else
@@ -530,6 +526,8 @@ void LadspaEffect::pluginInstantiation()
 	for( ch_cnt_t proc = 0; proc < processorCount(); proc++ )
 	{
 		manager->activate( m_key, m_handles[proc] );
+		m_processorJobs.push_back(std::make_unique<ProcessorJob>(m_descriptor, m_handles[proc]));
+		m_processorJobList.push_back(m_processorJobs.back().get());
 	}
 	m_controls = new LadspaControls( this );
 }
@@ -564,6 +562,8 @@ void LadspaEffect::pluginDestruction()
 	}
 	m_ports.clear();
 	m_handles.clear();
+	m_processorJobList.clear();
+	m_processorJobs.clear();
 	m_portControls.clear();
 }
 
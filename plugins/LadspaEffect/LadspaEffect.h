@@ -26,12 +26,15 @@
 #ifndef _LADSPA_EFFECT_H
 #define _LADSPA_EFFECT_H
 
+#include <memory>
+#include <vector>
 #include <QMutex>
 
 #include "Effect.h"
 #include "ladspa.h"
 #include "LadspaControls.h"
 #include "LadspaManager.h"
+#include "ThreadableJob.h"
 
 namespace lmms
 {
@@ -47,8 +50,7 @@ public:
 			const Descriptor::SubPluginFeatures::Key * _key );
 	~LadspaEffect() override;
 
-	bool processAudioBuffer( SampleFrame* _buf,
-							const fpp_t _frames ) override;
+	ProcessStatus processImpl( SampleFrame* _buf, const fpp_t _frames ) override;
 	
 	void setControl( int _control, LADSPA_Data _data );
 
@@ -68,6 +70,25 @@ private slots:
 
 
 private:
+	//! Runs a single plugin instance, so the instances for the channels of
+	//! mono plugins can be processed in parallel
+	class ProcessorJob : public ThreadableJob
+	{
+	public:
+		ProcessorJob(const LADSPA_Descriptor* descriptor, LADSPA_Handle handle) :
+			m_descriptor(descriptor), m_handle(handle), m_frames(0) {}
+
+		bool requiresProcessing() const override { return true; }
+		void setFrames(unsigned long frames) { m_frames = frames; }
+
+	private:
+		void doProcessing() override { (m_descriptor->run)(m_handle, m_frames); }
+
+		const LADSPA_Descriptor* m_descriptor;
+		LADSPA_Handle m_handle;
+		unsigned long m_frames;
+	};
+
 	void pluginInstantiation();
 	void pluginDestruction();
 
@@ -84,6 +105,8 @@ private:
 
 	const LADSPA_Descriptor * m_descriptor;
 	QVector<LADSPA_Handle> m_handles;
+	std::vector<std::unique_ptr<ProcessorJob>> m_processorJobs;
+	std::vector<ThreadableJob*> m_processorJobList;
 
 	QVector<multi_proc_t> m_ports;
 	multi_proc_t m_portControls;
@@ -24,6 +24,7 @@
 
 #include "Lv2Effect.h"
 
+#include <algorithm>
 #include <QDebug>
 
 #include "Lv2SubPluginFeatures.h"
@@ -68,36 +69,25 @@ Lv2Effect::Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key *ke
 
 
 
-bool Lv2Effect::processAudioBuffer(SampleFrame* buf, const fpp_t frames)
+Effect::ProcessStatus Lv2Effect::processImpl(SampleFrame* buf, const fpp_t frames)
 {
-	if (!isEnabled() || !isRunning()) { return false; }
 	Q_ASSERT(frames <= static_cast<fpp_t>(m_tmpOutputSmps.size()));
 
-	m_controls.copyBuffersFromLmms(buf, frames);
 	m_controls.copyModelsFromLmms();
 
 //	m_pluginMutex.lock();
-	m_controls.run(frames);
+	m_controls.run(buf, m_tmpOutputSmps.data(), frames);
 //	m_pluginMutex.unlock();
 
 	m_controls.copyModelsToLmms();
-	m_controls.copyBuffersToLmms(m_tmpOutputSmps.data(), frames);
 
-	double outSum = .0;
-	bool corrupt = wetLevel() < 0; // #3261 - if w < 0, bash w := 0, d := 1
-	const float d = corrupt ? 1 : dryLevel();
-	const float w = corrupt ? 0 : wetLevel();
-	for(fpp_t f = 0; f < frames; ++f)
+	// #3261 - if w < 0, keep the input, which Effect mixes back to the dry signal
+	if (wetLevel() >= 0)
 	{
-		buf[f][0] = d * buf[f][0] + w * m_tmpOutputSmps[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_tmpOutputSmps[f][1];
-		auto l = static_cast<double>(buf[f][0]);
-		auto r = static_cast<double>(buf[f][1]);
-		outSum += l*l + r*r;
+		std::copy(m_tmpOutputSmps.begin(), m_tmpOutputSmps.begin() + frames, buf);
 	}
-	checkGate(outSum / frames);
 
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -191,10 +191,9 @@ void Lv2Instrument::play(SampleFrame* buf)
 
 	fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 
-	run(fpp);
+	run(nullptr, buf, fpp);
 
 	copyModelsToLmms();
-	copyBuffersToLmms(buf, fpp);
 }
 
 
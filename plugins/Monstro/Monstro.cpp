@@ -103,10 +103,10 @@ MonstroSynth::MonstroSynth( MonstroInstrument * _i, NotePlayHandle * _nph ) :
 	m_counter3l = 0;
 	m_counter3r = 0;
 
-	m_lfo[0].resize( m_parent->m_fpp );
-	m_lfo[1].resize( m_parent->m_fpp );
-	m_env[0].resize( m_parent->m_fpp );
-	m_env[1].resize( m_parent->m_fpp );
+	m_lfo[0] = _nph->arena().createArray<float>( m_parent->m_fpp );
+	m_lfo[1] = _nph->arena().createArray<float>( m_parent->m_fpp );
+	m_env[0] = _nph->arena().createArray<float>( m_parent->m_fpp );
+	m_env[1] = _nph->arena().createArray<float>( m_parent->m_fpp );
 }
 
 
@@ -343,7 +343,7 @@ void MonstroSynth::renderOutput( fpp_t _frames, SampleFrame* _buf  )
 	float sub;
 
 	// render modulators: envelopes, lfos
-	updateModulators( m_env[0].data(), m_env[1].data(), m_lfo[0].data(), m_lfo[1].data(), _frames );
+	updateModulators( m_env[0], m_env[1], m_lfo[0], m_lfo[1], _frames );
 
 	// begin for loop
 	for( f_cnt_t f = 0; f < _frames; ++f )
@@ -1069,7 +1069,7 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 
 	if (!_n->m_pluginData)
 	{
-		_n->m_pluginData = new MonstroSynth( this, _n );
+		_n->m_pluginData = _n->arena().create<MonstroSynth>( this, _n );
 	}
 
 	auto ms = static_cast<MonstroSynth*>(_n->m_pluginData);
@@ -1079,12 +1079,6 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 	//applyRelease( _working_buffer, _n ); // we have our own release
 }
 
-void MonstroInstrument::deleteNotePluginData( NotePlayHandle * _n )
-{
-	delete static_cast<MonstroSynth *>( _n->m_pluginData );
-}
-
-
 void MonstroInstrument::saveSettings( QDomDocument & _doc,
 							QDomElement & _this )
 {
@@ -26,8 +26,6 @@
 #ifndef MONSTRO_H
 #define MONSTRO_H
 
-#include <vector>
-
 #include "ComboBoxModel.h"
 #include "Instrument.h"
 #include "InstrumentView.h"
@@ -313,8 +311,9 @@ private:
 	int m_counter3l;
 	int m_counter3r;
 
-	std::vector<float> m_lfo[2];
-	std::vector<float> m_env[2];
+	// modulator buffers, allocated in the arena of the note
+	float* m_lfo[2];
+	float* m_env[2];
 };
 
 class MonstroInstrument : public Instrument
@@ -358,7 +357,6 @@ public:
 
 	void playNote( NotePlayHandle * _n,
 						SampleFrame* _working_buffer ) override;
-	void deleteNotePluginData( NotePlayHandle * _n ) override;
 
 	void saveSettings( QDomDocument & _doc,
 							QDomElement & _this ) override;
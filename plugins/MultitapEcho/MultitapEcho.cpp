@@ -27,6 +27,7 @@
 #include "embed.h"
 #include "lmms_basics.h"
 #include "plugin_export.h"
+#include "ScratchArena.h"
 
 namespace lmms
 {
@@ -59,19 +60,12 @@ MultitapEchoEffect::MultitapEchoEffect( Model* parent, const Descriptor::SubPlug
 	m_sampleRate( Engine::audioEngine()->outputSampleRate() ),
 	m_sampleRatio( 1.0f / m_sampleRate )
 {
-	m_work = new SampleFrame[Engine::audioEngine()->framesPerPeriod()];
 	m_buffer.reset();
 	m_stages = static_cast<int>( m_controls.m_stages.value() );
 	updateFilters( 0, 19 );
 }
 
 
-MultitapEchoEffect::~MultitapEchoEffect()
-{
-	delete[] m_work;
-}
-
-
 void MultitapEchoEffect::updateFilters( int begin, int end )
 {
 	for( int i = begin; i <= end; ++i )
@@ -94,17 +88,8 @@ void MultitapEchoEffect::runFilter( SampleFrame* dst, SampleFrame* src, StereoOn
 }
 
 
-bool MultitapEchoEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
+Effect::ProcessStatus MultitapEchoEffect::processImpl( SampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-	
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-
 	// get processing vars
 	const int steps = m_controls.m_steps.value();
 	const float stepLength = m_controls.m_stepLength.value();
@@ -118,6 +103,9 @@ bool MultitapEchoEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frame
 		updateFilters( 0, steps - 1 );
 	}
 	
+	auto scratch = ScratchArena::Scope{};
+	SampleFrame* work = ScratchArena::frames( frames );
+
 	// add dry buffer - never swap inputs for dry
 	m_buffer.writeAddingMultiplied(buf, f_cnt_t{0}, frames, dryGain);
 
@@ -129,9 +117,9 @@ bool MultitapEchoEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frame
 		{
 			for( int s = 0; s < m_stages; ++s )
 			{
-				runFilter( m_work, buf, m_filter[i][s], frames );
+				runFilter( work, buf, m_filter[i][s], frames );
 			}
-			m_buffer.writeSwappedAddingMultiplied( m_work, offset, frames, m_amp[i] );
+			m_buffer.writeSwappedAddingMultiplied( work, offset, frames, m_amp[i] );
 			offset += stepLength;
 		}
 	}
@@ -142,26 +130,17 @@ bool MultitapEchoEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frame
 		{
 			for( int s = 0; s < m_stages; ++s )
 			{
-				runFilter( m_work, buf, m_filter[i][s], frames );
+				runFilter( work, buf, m_filter[i][s], frames );
 			}
-			m_buffer.writeAddingMultiplied( m_work, offset, frames, m_amp[i] );
+			m_buffer.writeAddingMultiplied( work, offset, frames, m_amp[i] );
 			offset += stepLength;
 		}
 	}
 	
-	// pop the buffer and mix it into output
-	m_buffer.pop( m_work );
-
-	for( int f = 0; f < frames; ++f )
-	{
-		buf[f][0] = d * buf[f][0] + w * m_work[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_work[f][1];
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
-	}
-	
-	checkGate( outSum / frames );
+	// pop the buffer into the output
+	m_buffer.pop( buf, frames );
 
-	return isRunning();	
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
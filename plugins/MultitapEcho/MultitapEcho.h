@@ -39,8 +39,7 @@ class MultitapEchoEffect : public Effect
 {
 public:
 	MultitapEchoEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
-	~MultitapEchoEffect() override;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 
 	EffectControls* controls() override
 	{
@@ -69,8 +68,6 @@ private:
 	
 	float m_sampleRate;
 	float m_sampleRatio;
-	
-	SampleFrame* m_work;
 
 	friend class MultitapEchoControls;
 
@@ -231,7 +231,7 @@ void OrganicInstrument::playNote( NotePlayHandle * _n,
 		auto oscs_l = std::array<Oscillator*, NUM_OSCILLATORS>{};
 		auto oscs_r = std::array<Oscillator*, NUM_OSCILLATORS>{};
 
-		_n->m_pluginData = new oscPtr;
+		_n->m_pluginData = _n->arena().create<oscPtr>();
 
 		for( int i = m_numOscillators - 1; i >= 0; --i )
 		{
@@ -245,7 +245,7 @@ void OrganicInstrument::playNote( NotePlayHandle * _n,
 			if( i == m_numOscillators - 1 )
 			{
 				// create left oscillator
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -253,7 +253,7 @@ void OrganicInstrument::playNote( NotePlayHandle * _n,
 						static_cast<oscPtr *>( _n->m_pluginData )->phaseOffsetLeft[i],
 						m_osc[i]->m_volumeLeft );
 				// create right oscillator
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -264,7 +264,7 @@ void OrganicInstrument::playNote( NotePlayHandle * _n,
 			else
 			{
 				// create left oscillator
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -273,7 +273,7 @@ void OrganicInstrument::playNote( NotePlayHandle * _n,
 						m_osc[i]->m_volumeLeft,
 						oscs_l[i + 1] );
 				// create right oscillator
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -293,8 +293,7 @@ void OrganicInstrument::playNote( NotePlayHandle * _n,
 	Oscillator * osc_l = static_cast<oscPtr *>( _n->m_pluginData )->oscLeft;
 	Oscillator * osc_r = static_cast<oscPtr *>( _n->m_pluginData)->oscRight;
 
-	osc_l->update( _working_buffer + offset, frames, 0 );
-	osc_r->update( _working_buffer + offset, frames, 1 );
+	osc_l->updateStereo( osc_r, _working_buffer + offset, frames );
 
 
 	// -- fx section --
@@ -316,16 +315,6 @@ void OrganicInstrument::playNote( NotePlayHandle * _n,
 
 
 
-void OrganicInstrument::deleteNotePluginData( NotePlayHandle * _n )
-{
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscLeft );
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscRight );
-
-	delete static_cast<oscPtr *>( _n->m_pluginData );
-}
-
 /*float inline OrganicInstrument::foldback(float in, float threshold)
 {
   if (in>threshold || in<-threshold)
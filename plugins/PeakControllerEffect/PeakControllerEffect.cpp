@@ -93,18 +93,11 @@ PeakControllerEffect::~PeakControllerEffect()
 }
 
 
-bool PeakControllerEffect::processAudioBuffer( SampleFrame* _buf,
+Effect::ProcessStatus PeakControllerEffect::processImpl( SampleFrame* _buf,
 							const fpp_t _frames )
 {
 	PeakControllerEffectControls & c = m_peakControls;
 
-	// This appears to be used for determining whether or not to continue processing
-	// audio with this effect	
-	if( !isEnabled() || !isRunning() )
-	{
-		return false;
-	}
-
 	// RMS:
 	double sum = 0;
 
@@ -143,7 +136,7 @@ bool PeakControllerEffect::processAudioBuffer( SampleFrame* _buf,
 	curRMS = qAbs( curRMS ) < tres ? 0.0f : curRMS;
 	m_lastSample = qBound( 0.0f, c.m_baseModel.value() + amount * curRMS, 1.0f );
 
-	return isRunning();
+	return ProcessStatus::Continue;
 }
 
 
@@ -20,14 +20,15 @@
  *
  */
 
-#include <cmath>
 #include "ReverbSC.h"
 
+#include <algorithm>
+#include <array>
+
 #include "embed.h"
+#include "lmms_math.h"
 #include "plugin_export.h"
 
-#define DB2LIN(X) pow(10, X / 20.0f);
-
 namespace lmms
 {
 
@@ -52,7 +53,9 @@ Plugin::Descriptor PLUGIN_EXPORT reverbsc_plugin_descriptor =
 
 ReverbSCEffect::ReverbSCEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key ) :
 	Effect( &reverbsc_plugin_descriptor, parent, key ),
-	m_reverbSCControls( this )
+	m_reverbSCControls( this ),
+	m_inGain( dbfsToAmp( m_reverbSCControls.m_inputGainModel.value() ) ),
+	m_outGain( dbfsToAmp( m_reverbSCControls.m_outputGainModel.value() ) )
 {
 	sp_create(&sp);
 	sp->sr = Engine::audioEngine()->outputSampleRate();
@@ -75,58 +78,55 @@ ReverbSCEffect::~ReverbSCEffect()
 	sp_destroy(&sp);
 }
 
-bool ReverbSCEffect::processAudioBuffer( SampleFrame* buf, const fpp_t frames )
+Effect::ProcessStatus ReverbSCEffect::processImpl( SampleFrame* buf, const fpp_t frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
-
-	SPFLOAT tmpL, tmpR;
-	SPFLOAT dcblkL, dcblkR;
-
-	ValueBuffer * inGainBuf = m_reverbSCControls.m_inputGainModel.valueBuffer();
-	ValueBuffer * sizeBuf = m_reverbSCControls.m_sizeModel.valueBuffer();
-	ValueBuffer * colorBuf = m_reverbSCControls.m_colorModel.valueBuffer();
-	ValueBuffer * outGainBuf = m_reverbSCControls.m_outputGainModel.valueBuffer();
-
-	for( fpp_t f = 0; f < frames; ++f )
+	const ValueBuffer * inGainBuf = m_reverbSCControls.m_inputGainModel.valueBuffer();
+	const ValueBuffer * sizeBuf = m_reverbSCControls.m_sizeModel.valueBuffer();
+	const ValueBuffer * colorBuf = m_reverbSCControls.m_colorModel.valueBuffer();
+	const ValueBuffer * outGainBuf = m_reverbSCControls.m_outputGainModel.valueBuffer();
+
+	// The reverb runs on blocks of BlockSize frames. The parameters are read
+	// at the end of every block and ramped from their previous values, so
+	// automation stays smooth without computing gains for every frame.
+	std::array<SPFLOAT, BlockSize> left;
+	std::array<SPFLOAT, BlockSize> right;
+
+	for( fpp_t offset = 0; offset < frames; offset += BlockSize )
 	{
-		auto s = std::array{buf[f][0], buf[f][1]};
-
-		const auto inGain
-			= (SPFLOAT)DB2LIN((inGainBuf ? inGainBuf->values()[f] : m_reverbSCControls.m_inputGainModel.value()));
-		const auto outGain
-			= (SPFLOAT)DB2LIN((outGainBuf ? outGainBuf->values()[f] : m_reverbSCControls.m_outputGainModel.value()));
-
-		s[0] *= inGain;
-		s[1] *= inGain;
-		revsc->feedback = (SPFLOAT)(sizeBuf ?
-			sizeBuf->values()[f]
-			: m_reverbSCControls.m_sizeModel.value());
-
-		revsc->lpfreq = (SPFLOAT)(colorBuf ?
-			colorBuf->values()[f]
-			: m_reverbSCControls.m_colorModel.value());
-
-
-		sp_revsc_compute(sp, revsc, &s[0], &s[1], &tmpL, &tmpR);
-		sp_dcblock_compute(sp, dcblk[0], &tmpL, &dcblkL);
-		sp_dcblock_compute(sp, dcblk[1], &tmpR, &dcblkR);
-		buf[f][0] = d * buf[f][0] + w * dcblkL * outGain;
-		buf[f][1] = d * buf[f][1] + w * dcblkR * outGain;
-
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
+		const fpp_t block = std::min<fpp_t>( BlockSize, frames - offset );
+		const fpp_t last = offset + block - 1;
+		SampleFrame* frame = buf + offset;
+
+		const float inGain = dbfsToAmp( inGainBuf ? inGainBuf->value( last ) : m_reverbSCControls.m_inputGainModel.value() );
+		const float outGain = dbfsToAmp( outGainBuf ? outGainBuf->value( last ) : m_reverbSCControls.m_outputGainModel.value() );
+		const float inGainInc = ( inGain - m_inGain ) / block;
+		const float outGainInc = ( outGain - m_outGain ) / block;
+
+		revsc->feedback = sizeBuf ? sizeBuf->value( last ) : m_reverbSCControls.m_sizeModel.value();
+		revsc->lpfreq = colorBuf ? colorBuf->value( last ) : m_reverbSCControls.m_colorModel.value();
+
+		for( fpp_t f = 0; f < block; ++f )
+		{
+			m_inGain += inGainInc;
+			left[f] = frame[f][0] * m_inGain;
+			right[f] = frame[f][1] * m_inGain;
+		}
+		m_inGain = inGain;
+
+		sp_revsc_compute_block( sp, revsc, left.data(), right.data(), left.data(), right.data(), block );
+		sp_dcblock_compute_block( sp, dcblk[0], left.data(), left.data(), block );
+		sp_dcblock_compute_block( sp, dcblk[1], right.data(), right.data(), block );
+
+		for( fpp_t f = 0; f < block; ++f )
+		{
+			m_outGain += outGainInc;
+			frame[f][0] = left[f] * m_outGain;
+			frame[f][1] = right[f] * m_outGain;
+		}
+		m_outGain = outGain;
 	}
 
-
-	checkGate( outSum / frames );
-
-	return isRunning();
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 void ReverbSCEffect::changeSampleRate()
@@ -45,7 +45,7 @@ class ReverbSCEffect : public Effect
 public:
 	ReverbSCEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	~ReverbSCEffect() override;
-	bool processAudioBuffer( SampleFrame* buf, const fpp_t frames ) override;
+	ProcessStatus processImpl( SampleFrame* buf, const fpp_t frames ) override;
 
 	EffectControls* controls() override
 	{
@@ -55,7 +55,12 @@ public:
 	void changeSampleRate();
 
 private:
+	//! Number of frames processed with the same parameters
+	static constexpr fpp_t BlockSize = 64;
+
 	ReverbSCControls m_reverbSCControls;
+	float m_inGain;
+	float m_outGain;
 	sp_data *sp;
 	sp_revsc *revsc;
 	sp_dcblock *dcblk[2];
@@ -64,6 +64,7 @@ int sp_revsc_init(sp_data *sp, sp_revsc *p)
     p->iSkipInit = 0;
     p->dampFact = 1.0;
     p->prv_LPFreq = 0.0;
+    p->prv_feedback = p->feedback;
     p->initDone = 1;
     int i, nBytes = 0;
     for(i = 0; i < 8; i++){
@@ -274,3 +275,134 @@ int sp_revsc_compute(sp_data *sp, sp_revsc *p, SPFLOAT *in1, SPFLOAT *in2, SPFLO
     *out2 = aoutR * outputGain;
     return SP_OK;
 }
+
+/* Block version of sp_revsc_compute. The input buffers may be the same as
+ * the output buffers. feedback and lpfreq are read once per block; the
+ * changes since the previous block are ramped over the block, so the
+ * parameters can be updated at control rate without zipper noise.
+ *
+ * The eight delay lines are processed as lanes: first the input is written
+ * to every line and the four interpolation points are fetched, then the
+ * interpolation, feedback and lowpass filter run over all lanes in plain
+ * loops over arrays, which the compiler can vectorize. */
+
+int sp_revsc_compute_block(sp_data *sp, sp_revsc *p, const SPFLOAT *in1, const SPFLOAT *in2,
+                           SPFLOAT *out1, SPFLOAT *out2, int frames)
+{
+    SPFLOAT filterState[8], frac[8], vm1[8], v0[8], v1[8], v2[8];
+    SPFLOAT feedback, feedbackInc, dampFact, dampFactInc, ainL, ainR, junction;
+    sp_revsc_dl *lp;
+    int i, n, readPos, bufferSize;
+
+    if (p->initDone <= 0) return SP_NOT_OK;
+    if (frames <= 0) return SP_OK;
+
+    /* control rate parameters, ramped from the values of the previous block */
+
+    dampFact = p->dampFact;
+    dampFactInc = 0.0;
+    if (p->lpfreq != p->prv_LPFreq) {
+        SPFLOAT target;
+        p->prv_LPFreq = p->lpfreq;
+        target = 2.0 - cos(p->prv_LPFreq * (2 * M_PI) / p->sampleRate);
+        target = target - sqrt(target * target - 1.0);
+        dampFactInc = (target - dampFact) / frames;
+        p->dampFact = target;
+    }
+    feedback = p->prv_feedback;
+    feedbackInc = (p->feedback - feedback) / frames;
+    p->prv_feedback = p->feedback;
+
+    for (n = 0; n < 8; n++) {
+        filterState[n] = p->delayLines[n].filterState;
+    }
+
+    for (i = 0; i < frames; i++) {
+        feedback += feedbackInc;
+        dampFact += dampFactInc;
+
+        /* calculate "resultant junction pressure" and mix to input signals */
+
+        junction = 0.0;
+        for (n = 0; n < 8; n++) {
+            junction += filterState[n];
+        }
+        junction *= jpScale;
+        ainL = junction + in1[i];
+        ainR = junction + in2[i];
+
+        /* send input signal and feedback to the delay lines and fetch the
+         * samples for the interpolation */
+
+        for (n = 0; n < 8; n++) {
+            lp = &p->delayLines[n];
+            bufferSize = lp->bufferSize;
+
+            lp->buf[lp->writePos] = (n & 1 ? ainR : ainL) - filterState[n];
+            if (++lp->writePos >= bufferSize) {
+                lp->writePos -= bufferSize;
+            }
+
+            if (lp->readPosFrac >= DELAYPOS_SCALE) {
+                lp->readPos += (lp->readPosFrac >> DELAYPOS_SHIFT);
+                lp->readPosFrac &= DELAYPOS_MASK;
+            }
+            if (lp->readPos >= bufferSize)
+                lp->readPos -= bufferSize;
+            readPos = lp->readPos;
+            frac[n] = (SPFLOAT) lp->readPosFrac * (1.0 / (SPFLOAT) DELAYPOS_SCALE);
+
+            if (readPos > 0 && readPos < (bufferSize - 2)) {
+                vm1[n] = lp->buf[readPos - 1];
+                v0[n]  = lp->buf[readPos];
+                v1[n]  = lp->buf[readPos + 1];
+                v2[n]  = lp->buf[readPos + 2];
+            }
+            else {
+                /* at buffer wrap-around, need to check index */
+                if (--readPos < 0) readPos += bufferSize;
+                vm1[n] = lp->buf[readPos];
+                if (++readPos >= bufferSize) readPos -= bufferSize;
+                v0[n] = lp->buf[readPos];
+                if (++readPos >= bufferSize) readPos -= bufferSize;
+                v1[n] = lp->buf[readPos];
+                if (++readPos >= bufferSize) readPos -= bufferSize;
+                v2[n] = lp->buf[readPos];
+            }
+
+            lp->readPosFrac += lp->readPosFrac_inc;
+        }
+
+        /* cubic interpolation, feedback gain and lowpass filter of all lanes */
+
+        for (n = 0; n < 8; n++) {
+            SPFLOAT am1, a0, a1, a2, v;
+            a2 = frac[n] * frac[n]; a2 -= 1.0; a2 *= (1.f / 6.f);
+            a1 = frac[n]; a1 += 1.0; a1 *= 0.5; am1 = a1 - 1.0;
+            a0 = 3.0 * a2; a1 -= a0; am1 -= a2; a0 -= frac[n];
+            v = (am1 * vm1[n] + a0 * v0[n] + a1 * v1[n] + a2 * v2[n]) * frac[n] + v0[n];
+            v *= feedback;
+            filterState[n] = (filterState[n] - v) * dampFact + v;
+        }
+
+        /* mix to output, even lines are left and odd lines right */
+
+        out1[i] = (filterState[0] + filterState[2] + filterState[4] + filterState[6]) * outputGain;
+        out2[i] = (filterState[1] + filterState[3] + filterState[5] + filterState[7]) * outputGain;
+
+        /* start next random line segment if current one has reached endpoint */
+
+        for (n = 0; n < 8; n++) {
+            lp = &p->delayLines[n];
+            if (--(lp->randLine_cnt) <= 0) {
+                next_random_lineseg(p, lp, n);
+            }
+        }
+    }
+
+    for (n = 0; n < 8; n++) {
+        p->delayLines[n].filterState = filterState[n];
+    }
+
+    return SP_OK;
+}
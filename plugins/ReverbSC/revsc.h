@@ -17,6 +17,7 @@ typedef struct  {
     SPFLOAT sampleRate;
     SPFLOAT dampFact;
     SPFLOAT prv_LPFreq;
+    SPFLOAT prv_feedback;
     int initDone;
     sp_revsc_dl delayLines[8];
     sp_auxdata aux;
@@ -26,3 +27,5 @@ int sp_revsc_create(sp_revsc **p);
 int sp_revsc_destroy(sp_revsc **p);
 int sp_revsc_init(sp_data *sp, sp_revsc *p);
 int sp_revsc_compute(sp_data *sp, sp_revsc *p, SPFLOAT *in1, SPFLOAT *in2, SPFLOAT *out1, SPFLOAT *out2);
+int sp_revsc_compute_block(sp_data *sp, sp_revsc *p, const SPFLOAT *in1, const SPFLOAT *in2,
+                           SPFLOAT *out1, SPFLOAT *out2, int frames);
@@ -450,7 +450,7 @@ void SfxrInstrument::playNote( NotePlayHandle * _n, SampleFrame* _working_buffer
 	const f_cnt_t offset = _n->noteOffset();
 	if (!_n->m_pluginData)
 	{
-		_n->m_pluginData = new SfxrSynth( this );
+		_n->m_pluginData = _n->arena().create<SfxrSynth>( this );
 	}
 	else if( static_cast<SfxrSynth*>(_n->m_pluginData)->isPlaying() == false )
 	{
@@ -485,14 +485,6 @@ void SfxrInstrument::playNote( NotePlayHandle * _n, SampleFrame* _working_buffer
 
 
 
-void SfxrInstrument::deleteNotePluginData( NotePlayHandle * _n )
-{
-	delete static_cast<SfxrSynth *>( _n->m_pluginData );
-}
-
-
-
-
 gui::PluginView * SfxrInstrument::instantiateView( QWidget * _parent )
 {
 	return( new gui::SfxrInstrumentView( this, _parent ) );
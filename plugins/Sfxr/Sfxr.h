@@ -180,7 +180,6 @@ public:
 	~SfxrInstrument() override = default;
 
 	void playNote( NotePlayHandle * _n, SampleFrame* _working_buffer ) override;
-	void deleteNotePluginData( NotePlayHandle * _n ) override;
 
 	void saveSettings( QDomDocument & _doc,
 							QDomElement & _parent ) override;
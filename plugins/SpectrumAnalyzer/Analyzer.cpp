@@ -32,7 +32,9 @@
 	#include <iostream>
 #endif
 
+#include "AnalysisService.h"
 #include "embed.h"
+#include "Engine.h"
 #include "lmms_basics.h"
 #include "plugin_export.h"
 
@@ -58,26 +60,23 @@ extern "C" {
 
 Analyzer::Analyzer(Model *parent, const Plugin::Descriptor::SubPluginFeatures::Key *key) :
 	Effect(&analyzer_plugin_descriptor, parent, key),
-	m_processor(&m_controls),
-	m_controls(this),
-	m_processorThread(m_processor, m_inputBuffer),
 	// Buffer is sized to cover 4* the current maximum LMMS audio buffer size,
-	// so that it has some reserve space in case data processor is busy.
-	m_inputBuffer(4 * m_maxBufferSize)
+	// so that it has some reserve space in case the analysis worker is busy.
+	m_processor(&m_controls, 4 * MaxBufferSize),
+	m_controls(this)
 {
-	m_processorThread.start();
 }
 
 
 Analyzer::~Analyzer()
 {
-	m_processor.terminate();
-	m_inputBuffer.wakeAll();
-	m_processorThread.wait();
+	// stop the analysis before the controls it reads are destroyed
+	Engine::analysisService()->remove(&m_processor);
 }
 
+
 // Take audio data and pass them to the spectrum processor.
-bool Analyzer::processAudioBuffer(SampleFrame* buffer, const fpp_t frame_count)
+Effect::ProcessStatus Analyzer::processImpl(SampleFrame* buffer, const fpp_t frame_count)
 {
 	// Measure time spent in audio thread; both average and peak should be well under 1 ms.
 	#ifdef SA_DEBUG
@@ -91,14 +90,12 @@ bool Analyzer::processAudioBuffer(SampleFrame* buffer, const fpp_t frame_count)
 		}
 	#endif
 
-	if (!isEnabled() || !isRunning ()) {return false;}
-
 	// Skip processing if the controls dialog isn't visible, it would only waste CPU cycles.
 	if (m_controls.isViewVisible())
 	{
 		// To avoid processing spikes on audio thread, data are stored in
-		// a lockless ringbuffer and processed in a separate thread.
-		m_inputBuffer.write(buffer, frame_count, true);
+		// a lockless ringbuffer and processed by a shared analysis worker.
+		m_processor.write(buffer, frame_count);
 	}
 	#ifdef SA_DEBUG
 		audio_time = std::chrono::high_resolution_clock::now().time_since_epoch().count() - audio_time;
@@ -107,7 +104,7 @@ bool Analyzer::processAudioBuffer(SampleFrame* buffer, const fpp_t frame_count)
 		if (audio_time / 1000000.0 > m_max_execution) {m_max_execution = audio_time / 1000000.0;}
 	#endif
 
-	return isRunning();
+	return ProcessStatus::Continue;
 }
 
 
@@ -28,9 +28,7 @@
 #define ANALYZER_H
 
 
-#include "DataprocLauncher.h"
 #include "Effect.h"
-#include "LocklessRingBuffer.h"
 #include "SaControls.h"
 #include "SaProcessor.h"
 
@@ -45,25 +43,17 @@ public:
 	Analyzer(Model *parent, const Descriptor::SubPluginFeatures::Key *key);
 	~Analyzer() override;
 
-	bool processAudioBuffer(SampleFrame* buffer, const fpp_t frame_count) override;
+	ProcessStatus processImpl(SampleFrame* buffer, const fpp_t frame_count) override;
 	EffectControls *controls() override {return &m_controls;}
 
 	SaProcessor *getProcessor() {return &m_processor;}
 
 private:
-	SaProcessor m_processor;
-	SaControls m_controls;
-
 	// Maximum LMMS buffer size (hard coded, the actual constant is hard to get)
-	const unsigned int m_maxBufferSize = 4096;
+	static constexpr unsigned int MaxBufferSize = 4096;
 
-	// QThread::create() workaround
-	// Replace DataprocLauncher by QThread and replace initializer in constructor
-	// with the following commented line when LMMS CI starts using Qt > 5.9
-	//m_processorThread = QThread::create([=]{m_processor.analyze(m_inputBuffer);});
-	DataprocLauncher m_processorThread;
-
-	LocklessRingBuffer<SampleFrame> m_inputBuffer;
+	SaProcessor m_processor;
+	SaControls m_controls;
 
 	#ifdef SA_DEBUG
 		int m_last_dump_time;
@@ -38,7 +38,6 @@
 
 #include "fft_helpers.h"
 #include "lmms_constants.h"
-#include "LocklessRingBuffer.h"
 #include "SaControls.h"
 
 #include <cassert>
@@ -48,9 +47,9 @@ namespace lmms
 {
 
 
-SaProcessor::SaProcessor(const SaControls *controls) :
+SaProcessor::SaProcessor(const SaControls *controls, std::size_t bufferSize) :
+	AnalysisService::Task(bufferSize),
 	m_controls(controls),
-	m_terminate(false),
 	m_inBlockSize(FFT_BLOCK_SIZES[0]),
 	m_fftBlockSize(FFT_BLOCK_SIZES[0]),
 	m_sampleRate(Engine::audioEngine()->outputSampleRate()),
@@ -80,11 +79,15 @@ SaProcessor::SaProcessor(const SaControls *controls) :
 	m_waterfallHeight = 100;	// a small safe value
 	m_history_work.resize(waterfallWidth() * m_waterfallHeight * sizeof qRgb(0,0,0), 0);
 	m_history.resize(waterfallWidth() * m_waterfallHeight * sizeof qRgb(0,0,0), 0);
+
+	Engine::analysisService()->add(this);
 }
 
 
 SaProcessor::~SaProcessor()
 {
+	Engine::analysisService()->remove(this);
+
 	if (m_fftPlanL != nullptr) {fftwf_destroy_plan(m_fftPlanL);}
 	if (m_fftPlanR != nullptr) {fftwf_destroy_plan(m_fftPlanR);}
 	if (m_spectrumL != nullptr) {fftwf_free(m_spectrumL);}
@@ -98,20 +101,16 @@ SaProcessor::~SaProcessor()
 
 
 // Load data from audio thread ringbuffer and run FFT analysis if buffer is full enough.
-void SaProcessor::analyze(LocklessRingBuffer<SampleFrame> &ring_buffer)
+// Called by a worker of the shared analysis service whenever new data are available.
+void SaProcessor::analyze(LocklessRingBufferReader<SampleFrame> &reader)
 {
-	LocklessRingBufferReader<SampleFrame> reader(ring_buffer);
-
-	// Processing thread loop
-	while (!m_terminate)
+	// Consume everything that has been written so far
+	while (!reader.empty())
 	{
-		// If there is nothing to read, wait for notification from the writing side.
-		if (reader.empty()) {reader.waitForData();}
-
 		// skip waterfall render if processing can't keep up with input
-		bool overload = ring_buffer.free() < ring_buffer.capacity() / 2;
+		bool overload = free() < capacity() / 2;
 
-		auto in_buffer = reader.read_max(ring_buffer.capacity() / 4);
+		auto in_buffer = reader.read_max(capacity() / 4);
 		std::size_t frame_count = in_buffer.size();
 
 		// Process received data only if any view is visible and not paused.
@@ -314,7 +313,7 @@ void SaProcessor::analyze(LocklessRingBuffer<SampleFrame> &ring_buffer)
 				#endif
 			}	// frame filler and processing
 		}	// process if active
-	}	// thread loop end
+	}	// reader loop end
 }
 
 
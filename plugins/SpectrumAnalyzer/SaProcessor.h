@@ -33,29 +33,24 @@
 #include <QRgb>
 #include <vector>
 
+#include "AnalysisService.h"
 #include "lmms_basics.h"
 
 
 namespace lmms
 {
 
-template<class T>
-class LocklessRingBuffer;
-
 class SaControls;
-class SampleFrame;
 
 
 //! Receives audio data, runs FFT analysis and stores the result.
-class SaProcessor
+//! The analysis runs on a worker of the shared AnalysisService; use write()
+//! to pass data from the audio thread.
+class SaProcessor : public AnalysisService::Task
 {
 public:
-	explicit SaProcessor(const SaControls *controls);
-	virtual ~SaProcessor();
-
-	// analysis thread and a method to terminate it
-	void analyze(LocklessRingBuffer<SampleFrame> &ring_buffer);
-	void terminate() {m_terminate = true;}
+	SaProcessor(const SaControls *controls, std::size_t bufferSize);
+	~SaProcessor() override;
 
 	// inform processor if any processing is actually required
 	void setSpectrumActive(bool active);
@@ -112,12 +107,14 @@ public:
 	QMutex m_dataAccess;
 
 
+protected:
+	// load new data and run the FFT analysis, called by an analysis worker
+	void analyze(LocklessRingBufferReader<SampleFrame> &reader) override;
+
+
 private:
 	const SaControls *m_controls;
 
-	// thread communication and control
-	bool m_terminate;
-
 	// currently valid configuration
 	unsigned int m_zeroPadFactor = 2;		//!< use n-steps bigger FFT for given block size
 	std::atomic<unsigned int> m_inBlockSize;//!< size of input (time domain) data block
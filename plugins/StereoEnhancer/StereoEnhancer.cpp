@@ -60,6 +60,7 @@ StereoEnhancerEffect::StereoEnhancerEffect(
 	m_seFX( DspEffectLibrary::StereoEnhancer( 0.0f ) ),
 	m_delayBuffer( new SampleFrame[DEFAULT_BUFFER_SIZE] ),
 	m_currFrame( 0 ),
+	m_bufferCleared( false ),
 	m_bbControls( this )
 {
 	// TODO:  Make m_delayBuffer customizable?
@@ -82,21 +83,10 @@ StereoEnhancerEffect::~StereoEnhancerEffect()
 
 
 
-bool StereoEnhancerEffect::processAudioBuffer( SampleFrame* _buf,
+Effect::ProcessStatus StereoEnhancerEffect::processImpl( SampleFrame* _buf,
 							const fpp_t _frames )
 {
-
-	// This appears to be used for determining whether or not to continue processing
-	// audio with this effect
-	double out_sum = 0.0;
-
-	if( !isEnabled() || !isRunning() )
-	{
-		return( false );
-	}
-
-	const float d = dryLevel();
-	const float w = wetLevel();
+	m_bufferCleared = false;
 
 	for( fpp_t f = 0; f < _frames; ++f )
 	{
@@ -122,22 +112,26 @@ bool StereoEnhancerEffect::processAudioBuffer( SampleFrame* _buf,
 
 		m_seFX.nextSample( s[0], s[1] );
 
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
+		_buf[f][0] = s[0];
+		_buf[f][1] = s[1];
 
 		// Update currFrame
 		m_currFrame += 1;
 		m_currFrame %= DEFAULT_BUFFER_SIZE;
 	}
 
-	checkGate( out_sum / _frames );
-	if( !isRunning() )
+	return ProcessStatus::ContinueIfNotQuiet;
+}
+
+
+
+
+void StereoEnhancerEffect::processBypassedImpl()
+{
+	if( !m_bufferCleared )
 	{
 		clearMyBuffer();
 	}
-
-	return( isRunning() );
 }
 
 
@@ -152,6 +146,7 @@ void StereoEnhancerEffect::clearMyBuffer()
 	}
 
 	m_currFrame = 0;
+	m_bufferCleared = true;
 }
 
 
@@ -40,8 +40,8 @@ public:
 	StereoEnhancerEffect( Model * parent,
 	                      const Descriptor::SubPluginFeatures::Key * _key );
 	~StereoEnhancerEffect() override;
-	bool processAudioBuffer( SampleFrame* _buf,
-		                                          const fpp_t _frames ) override;
+	ProcessStatus processImpl( SampleFrame* _buf, const fpp_t _frames ) override;
+	void processBypassedImpl() override;
 
 	EffectControls * controls() override
 	{
@@ -56,6 +56,7 @@ private:
 	
 	SampleFrame* m_delayBuffer;
 	int m_currFrame;
+	bool m_bufferCleared;
 	
 	StereoEnhancerControls m_bbControls;
 
@@ -39,8 +39,7 @@ public:
 	StereoMatrixEffect( Model * parent, 
 	                      const Descriptor::SubPluginFeatures::Key * _key );
 	~StereoMatrixEffect() override = default;
-	bool processAudioBuffer( SampleFrame* _buf,
-		                                          const fpp_t _frames ) override;
+	ProcessStatus processImpl( SampleFrame* _buf, const fpp_t _frames ) override;
 
 	EffectControls* controls() override
 	{
@@ -320,7 +320,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 			// the last oscs needs no sub-oscs...
 			if( i == NUM_OF_OSCILLATORS - 1 )
 			{
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -328,7 +328,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 						m_osc[i]->m_phaseOffsetLeft,
 						m_osc[i]->m_volumeLeft );
 				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -339,7 +339,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 			}
 			else
 			{
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -348,7 +348,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 						m_osc[i]->m_volumeLeft,
 						oscs_l[i + 1] );
 				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = _n->arena().create<Oscillator>(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -365,10 +365,10 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 			oscs_r[i]->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
 		}
 
-		_n->m_pluginData = new oscPtr;
-		static_cast<oscPtr *>( _n->m_pluginData )->oscLeft = oscs_l[0];
-		static_cast< oscPtr *>( _n->m_pluginData )->oscRight =
-								oscs_r[0];
+		auto oscs = _n->arena().create<oscPtr>();
+		oscs->oscLeft = oscs_l[0];
+		oscs->oscRight = oscs_r[0];
+		_n->m_pluginData = oscs;
 	}
 
 	Oscillator * osc_l = static_cast<oscPtr *>( _n->m_pluginData )->oscLeft;
@@ -377,8 +377,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = _n->noteOffset();
 
-	osc_l->update( _working_buffer + offset, frames, 0 );
-	osc_r->update( _working_buffer + offset, frames, 1 );
+	osc_l->updateStereo( osc_r, _working_buffer + offset, frames );
 
 	applyFadeIn(_working_buffer, _n);
 	applyRelease( _working_buffer, _n );
@@ -387,18 +386,6 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 
 
 
-void TripleOscillator::deleteNotePluginData( NotePlayHandle * _n )
-{
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscLeft );
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscRight );
-	delete static_cast<oscPtr *>( _n->m_pluginData );
-}
-
-
-
-
 gui::PluginView* TripleOscillator::instantiateView( QWidget * _parent )
 {
 	return new gui::TripleOscillatorView( this, _parent );
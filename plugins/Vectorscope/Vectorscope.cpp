@@ -58,10 +58,8 @@ Vectorscope::Vectorscope(Model *parent, const Plugin::Descriptor::SubPluginFeatu
 
 
 // Take audio data and store them for processing and display in the GUI thread.
-bool Vectorscope::processAudioBuffer(SampleFrame* buffer, const fpp_t frame_count)
+Effect::ProcessStatus Vectorscope::processImpl(SampleFrame* buffer, const fpp_t frame_count)
 {
-	if (!isEnabled() || !isRunning ()) {return false;}
-
 	// Skip processing if the controls dialog isn't visible, it would only waste CPU cycles.
 	if (m_controls.isViewVisible())
 	{
@@ -69,7 +67,7 @@ bool Vectorscope::processAudioBuffer(SampleFrame* buffer, const fpp_t frame_coun
 		// a lockless ringbuffer and processed in a separate thread.
 		m_inputBuffer.write(buffer, frame_count);
 	}
-	return isRunning();
+	return ProcessStatus::Continue;
 }
 
 
@@ -395,6 +395,14 @@ void VestigeInstrument::loadFile( const QString & _file )
 
 
 
+f_cnt_t VestigeInstrument::latency() const
+{
+	return m_plugin != nullptr ? m_plugin->latency() : 0;
+}
+
+
+
+
 void VestigeInstrument::play( SampleFrame* _buf )
 {
 	if (!m_pluginMutex.tryLock(Engine::getSong()->isExporting() ? -1 : 0)) {return;}
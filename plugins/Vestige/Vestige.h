@@ -59,20 +59,22 @@ class VestigeInstrument : public Instrument
 	Q_OBJECT
 public:
 	VestigeInstrument( InstrumentTrack * _instrument_track );
-	virtual ~VestigeInstrument();
+	~VestigeInstrument() override;
 
-	virtual void play( SampleFrame* _working_buffer );
+	void play( SampleFrame* _working_buffer ) override;
 
-	virtual void saveSettings( QDomDocument & _doc, QDomElement & _parent );
-	virtual void loadSettings( const QDomElement & _this );
+	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
+	void loadSettings( const QDomElement & _this ) override;
 
-	virtual QString nodeName() const;
+	QString nodeName() const override;
 
-	virtual void loadFile( const QString & _file );
+	void loadFile( const QString & _file ) override;
 
-	virtual bool handleMidiEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset = 0 );
+	bool handleMidiEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset = 0 ) override;
 
-	virtual gui::PluginView* instantiateView( QWidget * _parent );
+	f_cnt_t latency() const override;
+
+	gui::PluginView* instantiateView( QWidget * _parent ) override;
 
 protected slots:
 	void setParameter( lmms::Model * action );
@@ -76,46 +76,29 @@ VstEffect::VstEffect( Model * _parent,
 
 
 
-bool VstEffect::processAudioBuffer( SampleFrame* _buf, const fpp_t _frames )
+f_cnt_t VstEffect::processLatency() const
 {
-	if( !isEnabled() || !isRunning () )
+	return m_plugin ? m_plugin->latency() : 0;
+}
+
+
+
+
+Effect::ProcessStatus VstEffect::processImpl( SampleFrame* _buf, const fpp_t _frames )
+{
+	if( !m_plugin )
 	{
-		return false;
+		return ProcessStatus::Continue;
 	}
 
-	if( m_plugin )
+	// the buffer is left unchanged if the plugin is busy
+	if (m_pluginMutex.tryLock(Engine::getSong()->isExporting() ? -1 : 0))
 	{
-		const float d = dryLevel();
-#ifdef __GNUC__
-		SampleFrame buf[_frames];
-#else
-		SampleFrame* buf = new SampleFrame[_frames];
-#endif
-		memcpy( buf, _buf, sizeof( SampleFrame ) * _frames );
-		if (m_pluginMutex.tryLock(Engine::getSong()->isExporting() ? -1 : 0))
-		{
-			m_plugin->process( buf, buf );
-			m_pluginMutex.unlock();
-		}
-
-		double out_sum = 0.0;
-		const float w = wetLevel();
-		for( fpp_t f = 0; f < _frames; ++f )
-		{
-			_buf[f][0] = w*buf[f][0] + d*_buf[f][0];
-			_buf[f][1] = w*buf[f][1] + d*_buf[f][1];
-		}
-		for( fpp_t f = 0; f < _frames; ++f )
-		{
-			out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
-		}
-#ifndef __GNUC__
-		delete[] buf;
-#endif
-
-		checkGate( out_sum / _frames );
+		m_plugin->process( _buf, _buf );
+		m_pluginMutex.unlock();
 	}
-	return isRunning();
+
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -45,8 +45,9 @@ public:
 			const Descriptor::SubPluginFeatures::Key * _key );
 	~VstEffect() override = default;
 
-	bool processAudioBuffer( SampleFrame* _buf,
-							const fpp_t _frames ) override;
+	ProcessStatus processImpl( SampleFrame* _buf, const fpp_t _frames ) override;
+
+	f_cnt_t processLatency() const override;
 
 	EffectControls * controls() override
 	{
@@ -74,8 +74,8 @@ WatsynObject::WatsynObject( float * _A1wave, float * _A2wave,
 				m_fpp( _frames ),
 				m_parent( _w )
 {
-	m_abuf = new SampleFrame[_frames];
-	m_bbuf = new SampleFrame[_frames];
+	m_abuf = _nph->arena().createArray<SampleFrame>( _frames );
+	m_bbuf = _nph->arena().createArray<SampleFrame>( _frames );
 
 	m_lphase[A1_OSC] = 0.0f;
 	m_lphase[A2_OSC] = 0.0f;
@@ -97,20 +97,8 @@ WatsynObject::WatsynObject( float * _A1wave, float * _A2wave,
 
 
 
-WatsynObject::~WatsynObject()
-{
-	delete[] m_abuf;
-	delete[] m_bbuf;
-}
-
-
 void WatsynObject::renderOutput( fpp_t _frames )
 {
-	if( m_abuf == nullptr )
-		m_abuf = new SampleFrame[m_fpp];
-	if( m_bbuf == nullptr )
-		m_bbuf = new SampleFrame[m_fpp];
-
 	for( fpp_t frame = 0; frame < _frames; frame++ )
 	{
 		// put phases of 1-series oscs into variables because phase modulation might happen
@@ -331,7 +319,7 @@ void WatsynInstrument::playNote( NotePlayHandle * _n,
 {
 	if (!_n->m_pluginData)
 	{
-		auto w = new WatsynObject(&A1_wave[0], &A2_wave[0], &B1_wave[0], &B2_wave[0], m_amod.value(), m_bmod.value(),
+		auto w = _n->arena().create<WatsynObject>(&A1_wave[0], &A2_wave[0], &B1_wave[0], &B2_wave[0], m_amod.value(), m_bmod.value(),
 			Engine::audioEngine()->outputSampleRate(), _n, Engine::audioEngine()->framesPerPeriod(), this);
 
 		_n->m_pluginData = w;
@@ -448,12 +436,6 @@ void WatsynInstrument::playNote( NotePlayHandle * _n,
 }
 
 
-void WatsynInstrument::deleteNotePluginData( NotePlayHandle * _n )
-{
-	delete static_cast<WatsynObject *>( _n->m_pluginData );
-}
-
-
 void WatsynInstrument::saveSettings( QDomDocument & _doc,
 							QDomElement & _this )
 {
@@ -92,7 +92,7 @@ public:
 					float * _B1wave, float * _B2wave,
 					int _amod, int _bmod, const sample_rate_t _samplerate, NotePlayHandle * _nph, fpp_t _frames,
 					WatsynInstrument * _w );
-	virtual ~WatsynObject();
+	virtual ~WatsynObject() = default;
 
 	void renderOutput( fpp_t _frames );
 
@@ -141,7 +141,6 @@ public:
 
 	void playNote( NotePlayHandle * _n,
 						SampleFrame* _working_buffer ) override;
-	void deleteNotePluginData( NotePlayHandle * _n ) override;
 
 
 	void saveSettings( QDomDocument & _doc,
@@ -66,20 +66,12 @@ WaveShaperEffect::WaveShaperEffect( Model * _parent,
 
 
 
-bool WaveShaperEffect::processAudioBuffer( SampleFrame* _buf,
+Effect::ProcessStatus WaveShaperEffect::processImpl( SampleFrame* _buf,
 							const fpp_t _frames )
 {
-	if( !isEnabled() || !isRunning () )
-	{
-		return( false );
-	}
-
 // variables for effect
 	int i = 0;
 
-	double out_sum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
 	float input = m_wsControls.m_inputModel.value();
 	float output = m_wsControls.m_outputModel.value();
 	const float * samples = m_wsControls.m_wavegraphModel.samples();
@@ -137,18 +129,14 @@ bool WaveShaperEffect::processAudioBuffer( SampleFrame* _buf,
 		s[0] *= *outputPtr;
 		s[1] *= *outputPtr;
 
-// mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-		out_sum += _buf[f][0] * _buf[f][0] + _buf[f][1] * _buf[f][1];
+		_buf[f][0] = s[0];
+		_buf[f][1] = s[1];
 
 		outputPtr += outputInc;
 		inputPtr += inputInc;
 	}
 
-	checkGate( out_sum / _frames );
-
-	return( isRunning() );
+	return ProcessStatus::ContinueIfNotQuiet;
 }
 
 
@@ -328,6 +328,14 @@ QString ZynAddSubFxInstrument::nodeName() const
 
 
 
+f_cnt_t ZynAddSubFxInstrument::latency() const
+{
+	return m_remotePlugin != nullptr ? m_remotePlugin->latency() : 0;
+}
+
+
+
+
 void ZynAddSubFxInstrument::play( SampleFrame* _buf )
 {
 	if (!m_pluginMutex.tryLock(Engine::getSong()->isExporting() ? -1 : 0)) {return;}
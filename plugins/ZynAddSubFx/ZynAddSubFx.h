@@ -76,6 +76,8 @@ public:
 
 	void play( SampleFrame* _working_buffer ) override;
 
+	f_cnt_t latency() const override;
+
 	bool handleMidiEvent( const MidiEvent& event, const TimePos& time = TimePos(), f_cnt_t offset = 0 ) override;
 
 	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
@@ -0,0 +1,191 @@
+/*
+ * AnalysisService.cpp - shared worker threads for visualization analysis
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AnalysisService.h"
+
+#include <algorithm>
+#include <functional>
+#include <QThread>
+
+#include "Engine.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+class AnalysisWorker : public QThread
+{
+public:
+	explicit AnalysisWorker(std::function<void()> run) :
+		m_run(std::move(run))
+	{
+	}
+
+private:
+	void run() override
+	{
+		m_run();
+	}
+
+	std::function<void()> m_run;
+};
+
+} // namespace
+
+
+
+
+AnalysisService::Task::Task(std::size_t capacity) :
+	m_buffer(capacity),
+	m_reader(m_buffer),
+	m_pending(false),
+	m_running(false)
+{
+}
+
+
+
+
+void AnalysisService::Task::write(const SampleFrame* buffer, fpp_t frames)
+{
+	m_buffer.write(buffer, frames);
+	wake();
+}
+
+
+
+
+void AnalysisService::Task::wake()
+{
+	// only wake a worker once until the task has been picked up
+	if (!m_pending.exchange(true, std::memory_order_acq_rel))
+	{
+		Engine::analysisService()->m_wakeUp.post();
+	}
+}
+
+
+
+
+AnalysisService::AnalysisService() :
+	m_wakeUp(0),
+	m_quit(false)
+{
+	// the displays are refreshed at a few dozen fps, one or two threads
+	// easily keep up with that and leave the other cores to the audio
+	const int count = std::clamp(QThread::idealThreadCount() / 4, 1, MaxWorkers);
+	for (int i = 0; i < count; ++i)
+	{
+		auto worker = new AnalysisWorker([this] { run(); });
+		worker->start(QThread::LowPriority);
+		m_workers.push_back(worker);
+	}
+}
+
+
+
+
+AnalysisService::~AnalysisService()
+{
+	m_quit = true;
+	for (std::size_t i = 0; i < m_workers.size(); ++i)
+	{
+		m_wakeUp.post();
+	}
+	for (auto worker : m_workers)
+	{
+		worker->wait();
+		delete worker;
+	}
+}
+
+
+
+
+void AnalysisService::add(Task* task)
+{
+	const auto lock = std::unique_lock{m_tasksMutex};
+	m_tasks.push_back(task);
+
+	// data may have been written before the task was added
+	if (task->m_pending.load(std::memory_order_acquire))
+	{
+		m_wakeUp.post();
+	}
+}
+
+
+
+
+void AnalysisService::remove(Task* task)
+{
+	auto lock = std::unique_lock{m_tasksMutex};
+	m_taskFinished.wait(lock, [task] { return !task->m_running; });
+	m_tasks.erase(std::remove(m_tasks.begin(), m_tasks.end(), task), m_tasks.end());
+}
+
+
+
+
+void AnalysisService::run()
+{
+	while (true)
+	{
+		m_wakeUp.wait();
+		if (m_quit) { break; }
+
+		// A task which is being analyzed by another worker is skipped; that
+		// worker looks for pending tasks again when it is done.
+		while (Task* task = takePendingTask())
+		{
+			task->analyze(task->m_reader);
+
+			const auto lock = std::unique_lock{m_tasksMutex};
+			task->m_running = false;
+			m_taskFinished.notify_all();
+		}
+	}
+}
+
+
+
+
+AnalysisService::Task* AnalysisService::takePendingTask()
+{
+	const auto lock = std::unique_lock{m_tasksMutex};
+	for (auto task : m_tasks)
+	{
+		if (!task->m_running && task->m_pending.exchange(false, std::memory_order_acq_rel))
+		{
+			task->m_running = true;
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+
+} // namespace lmms
@@ -37,6 +37,7 @@
 #include "NotePlayHandle.h"
 #include "ConfigManager.h"
 #include "SamplePlayHandle.h"
+#include "ScratchArena.h"
 
 // platform-specific audio-interface-classes
 #include "AudioAlsa.h"
@@ -60,6 +61,10 @@
 #include "MidiDummy.h"
 
 #include "BufferManager.h"
+#include "MidiPort.h"
+
+#include <algorithm>
+#include <chrono>
 
 namespace lmms
 {
@@ -68,6 +73,9 @@ using LocklessListElement = LocklessList<PlayHandle*>::Element;
 
 static thread_local bool s_renderingThread = false;
 
+//! Maximum number of MIDI ports with queued input events in a single period
+static constexpr std::size_t MaxMidiInputPorts = 1024;
+
 
 
 
@@ -81,12 +89,21 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	m_workers(),
 	m_numWorkers( QThread::idealThreadCount()-1 ),
 	m_newPlayHandles( PlayHandle::MaxNumber ),
+	m_newPlayHandleCount(0),
 	m_qualitySettings(qualitySettings::Interpolation::Linear),
 	m_masterGain( 1.0f ),
 	m_audioDev( nullptr ),
 	m_oldAudioDev( nullptr ),
 	m_audioDevStartFailed( false ),
+	m_midiInputPorts( MaxMidiInputPorts ),
+	m_midiInputBegin( 0 ),
+	m_midiInputEnd( 0 ),
+	m_measureMidiInputLatency( false ),
+	m_midiInputEvents( 0 ),
+	m_midiInputMinLatency( 0 ),
+	m_midiInputMaxLatency( 0 ),
 	m_profiler(),
+	m_overloadManager(),
 	m_metronomeActive(false),
 	m_clearSignal(false)
 {
@@ -119,13 +136,13 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 
 			m_framesPerPeriod = DEFAULT_BUFFER_SIZE;
 		}
-		// lmms works with chunks of size DEFAULT_BUFFER_SIZE (256) and only the final mix will use the actual
-		// buffer size. Plugins don't see a larger buffer size than 256. If m_framesPerPeriod is larger than
-		// DEFAULT_BUFFER_SIZE, it's set to DEFAULT_BUFFER_SIZE and the rest is handled by an increased fifoSize.
-		else if( m_framesPerPeriod > DEFAULT_BUFFER_SIZE )
+		// lmms works with chunks of at most MAXIMUM_BLOCK_SIZE (256) frames and only the final mix will use
+		// the actual buffer size. Plugins don't see a larger buffer size than that. If m_framesPerPeriod is
+		// larger, it's set to MAXIMUM_BLOCK_SIZE and the rest is handled by an increased fifoSize.
+		else if( m_framesPerPeriod > MAXIMUM_BLOCK_SIZE )
 		{
-			fifoSize = m_framesPerPeriod / DEFAULT_BUFFER_SIZE;
-			m_framesPerPeriod = DEFAULT_BUFFER_SIZE;
+			fifoSize = m_framesPerPeriod / MAXIMUM_BLOCK_SIZE;
+			m_framesPerPeriod = MAXIMUM_BLOCK_SIZE;
 		}
 	}
 
@@ -139,15 +156,26 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	m_outputBufferWrite = std::make_unique<SampleFrame[]>(m_framesPerPeriod);
 
 
+	// with heavy mixer channels bound to worker threads, also keep the
+	// threads on their cores, so the channels' state stays in the cache
+	const bool pinWorkers = ConfigManager::inst()->value( "audioengine", "busaffinity", "0" ).toInt();
+	const int cores = QThread::idealThreadCount();
+
 	for( int i = 0; i < m_numWorkers+1; ++i )
 	{
 		auto wt = new AudioEngineWorkerThread(this);
 		if( i < m_numWorkers )
 		{
+			if( pinWorkers && cores > 1 )
+			{
+				wt->setCore( ( i + 1 ) % cores );
+			}
 			wt->start( QThread::TimeCriticalPriority );
 		}
 		m_workers.push_back( wt );
 	}
+
+	loadFlightRecorderSettings();
 }
 
 
@@ -307,6 +335,16 @@ void AudioEngine::pushInputFrames( SampleFrame* _ab, const f_cnt_t _frames )
 
 
 
+void AudioEngine::loadFlightRecorderSettings()
+{
+	const auto config = ConfigManager::inst();
+	m_profiler.setFlightRecorderDirectory(config->value("audioengine", "flightrecorder", "1").toInt()
+		? config->workingDir() + "flightrecorder"
+		: QString{});
+}
+
+
+
 void AudioEngine::renderStageNoteSetup()
 {
 	AudioEngineProfiler::Probe profilerProbe(m_profiler, AudioEngineProfiler::DetailType::NoteSetup);
@@ -347,17 +385,26 @@ void AudioEngine::renderStageNoteSetup()
 
 	handleMetronome();
 
+	// pass the events received from MIDI devices since the last period, the
+	// notes they start are added together with the ones of the song below
+	processMidiInput();
+
 	// create play-handles for new notes, samples etc.
 	Engine::getSong()->processNextBuffer();
 
 	// add all play-handles that have to be added
+	m_newPlayHandleCount = 0;
 	for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
 	{
 		m_playHandles += e->value;
+		++m_newPlayHandleCount;
 		LocklessListElement * next = e->next;
 		m_newPlayHandles.free( e );
 		e = next;
 	}
+
+	// fade out voices exceeding the polyphony budgets
+	m_overloadManager.enforcePolyphony(m_playHandles);
 }
 
 
@@ -430,9 +477,11 @@ void AudioEngine::renderStageMix()
 
 const SampleFrame* AudioEngine::renderNextBuffer()
 {
+	MicroTimer lockTimer;
 	const auto lock = std::lock_guard{m_changeMutex};
 
-	m_profiler.startPeriod();
+	m_profiler.startPeriod(lockTimer.elapsed());
+	m_overloadManager.update(Engine::getSong()->isExporting() ? 0 : cpuLoad());
 	s_renderingThread = true;
 
 	renderStageNoteSetup();     // STAGE 0: clear old play handles and buffers, setup new play handles
@@ -441,7 +490,14 @@ const SampleFrame* AudioEngine::renderNextBuffer()
 	renderStageMix();           // STAGE 3: do master mix in mixer
 
 	s_renderingThread = false;
-	m_profiler.finishPeriod(outputSampleRate(), m_framesPerPeriod);
+	m_profiler.finishPeriod(outputSampleRate(), m_framesPerPeriod, {
+		AudioEngineWorkerThread::takeJobCount(),
+		AudioEngineWorkerThread::takeBusyTime(),
+		m_numWorkers + 1,
+		m_playHandles.size(),
+		m_newPlayHandleCount,
+		!Engine::getSong()->isExporting()
+	});
 
 	return m_outputBufferRead.get();
 }
@@ -462,6 +518,125 @@ void AudioEngine::swapBuffers()
 
 
 
+void AudioEngine::processMidiInput()
+{
+	m_midiInputBegin = m_midiInputEnd;
+	m_midiInputEnd = midiInputTime();
+
+	for( LocklessList<MidiPort *>::Element * e = m_midiInputPorts.popList(); e; )
+	{
+		e->value->processQueuedInEvents();
+		LocklessList<MidiPort *>::Element * next = e->next;
+		m_midiInputPorts.free( e );
+		e = next;
+	}
+}
+
+
+
+
+std::int64_t AudioEngine::midiInputTime()
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>( steady_clock::now().time_since_epoch() ).count();
+}
+
+
+
+
+void AudioEngine::queueMidiInput( MidiPort* port )
+{
+	m_midiInputPorts.push( port );
+}
+
+
+
+
+void AudioEngine::dequeueMidiInput( MidiPort* port )
+{
+	requestChangeInModel();
+	for( LocklessList<MidiPort *>::Element * e = m_midiInputPorts.popList(); e; )
+	{
+		MidiPort * queued = e->value;
+		LocklessList<MidiPort *>::Element * next = e->next;
+		m_midiInputPorts.free( e );
+		if( queued != port )
+		{
+			m_midiInputPorts.push( queued );
+		}
+		e = next;
+	}
+	doneChangeInModel();
+}
+
+
+
+
+f_cnt_t AudioEngine::midiInputOffset( std::int64_t time )
+{
+	// place the event at the position it had in the time span between the
+	// beginning of the last and of the current period
+	const std::int64_t span = m_midiInputEnd - m_midiInputBegin;
+	f_cnt_t offset = 0;
+	if( span > 0 && time > m_midiInputBegin )
+	{
+		offset = static_cast<f_cnt_t>( std::min<std::int64_t>( m_framesPerPeriod - 1,
+			( time - m_midiInputBegin ) * m_framesPerPeriod / span ) );
+	}
+
+	if( !m_measureMidiInputLatency.load( std::memory_order_relaxed ) )
+	{
+		return offset;
+	}
+
+	const auto latency = static_cast<int>( m_midiInputEnd - time
+		+ static_cast<std::int64_t>( offset ) * 1000000 / outputSampleRate() );
+	if( m_midiInputEvents.fetch_add( 1, std::memory_order_relaxed ) == 0 )
+	{
+		m_midiInputMinLatency.store( latency, std::memory_order_relaxed );
+		m_midiInputMaxLatency.store( latency, std::memory_order_relaxed );
+	}
+	else
+	{
+		m_midiInputMinLatency.store( std::min( latency, m_midiInputMinLatency.load( std::memory_order_relaxed ) ),
+			std::memory_order_relaxed );
+		m_midiInputMaxLatency.store( std::max( latency, m_midiInputMaxLatency.load( std::memory_order_relaxed ) ),
+			std::memory_order_relaxed );
+	}
+
+	return offset;
+}
+
+
+
+
+void AudioEngine::startMidiInputLatencyMeasurement()
+{
+	m_midiInputEvents.store( 0, std::memory_order_relaxed );
+	m_measureMidiInputLatency.store( true, std::memory_order_relaxed );
+}
+
+
+
+
+void AudioEngine::stopMidiInputLatencyMeasurement()
+{
+	m_measureMidiInputLatency.store( false, std::memory_order_relaxed );
+}
+
+
+
+
+AudioEngine::MidiInputLatency AudioEngine::midiInputLatency() const
+{
+	return { m_midiInputEvents.load( std::memory_order_relaxed ),
+		m_midiInputMinLatency.load( std::memory_order_relaxed ),
+		m_midiInputMaxLatency.load( std::memory_order_relaxed ) };
+}
+
+
+
+
 void AudioEngine::handleMetronome()
 {
 	static tick_t lastMetroTicks = -1;
@@ -651,9 +826,9 @@ void AudioEngine::removeAudioPort(AudioPort * port)
 bool AudioEngine::addPlayHandle( PlayHandle* handle )
 {
 	// Only add play handles if we have the CPU capacity to process them.
-	// Instrument play handles are not added during playback, but when the
-	// associated instrument is created, so add those unconditionally.
-	if (handle->type() == PlayHandle::Type::InstrumentPlayHandle || !criticalXRuns())
+	// The overload manager decides whether to drop the new handle or to
+	// make room by stealing voices later on.
+	if (!m_overloadManager.shouldDrop(handle))
 	{
 		m_newPlayHandles.push( handle );
 		handle->audioPort()->addPlayHandle( handle );
@@ -662,6 +837,7 @@ bool AudioEngine::addPlayHandle( PlayHandle* handle )
 
 	if( handle->type() == PlayHandle::Type::NotePlayHandle )
 	{
+		m_overloadManager.countDroppedVoice();
 		NotePlayHandleManager::release( (NotePlayHandle*)handle );
 	}
 	else delete handle;
@@ -1182,6 +1358,7 @@ void AudioEngine::fifoWriter::finish()
 void AudioEngine::fifoWriter::run()
 {
 	disable_denormals();
+	ScratchArena::reserve();
 
 #if 0
 #if defined(LMMS_BUILD_LINUX) || defined(LMMS_BUILD_FREEBSD)
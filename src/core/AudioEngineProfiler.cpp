@@ -24,21 +24,80 @@
 
 #include "AudioEngineProfiler.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
+#include <utility>
+#include <QDateTime>
+#include <QDir>
+#include <QTextStream>
+
+#include "AudioEngineWorkerThread.h"
 
 namespace lmms
 {
 
+namespace
+{
+
+//! Interval in which the collector thread drains the event rings
+constexpr auto CollectInterval = std::chrono::milliseconds(100);
+//! Number of collector runs after which the peak values are reset
+constexpr int PeakRuns = 10;
+//! Capacity of the ring between the audio thread and the flight recorder
+constexpr std::size_t PeriodRingSize = 4096;
+//! Number of periods kept by the flight recorder, enough for FlightRecorderLength
+//! at common settings, the dump is cut off at FlightRecorderLength anyway
+constexpr std::size_t FlightRecorderSize = 16384;
+
+template<class Duration>
+std::int64_t toMicroseconds(Duration duration)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace
+
 AudioEngineProfiler::AudioEngineProfiler() :
 	m_periodTimer(),
 	m_cpuLoad( 0 ),
-	m_outputFile()
+	m_outputFile(),
+	m_epoch(Clock::now()),
+	m_periodStart(m_epoch),
+	m_lockWait(0),
+	m_periodLength(0),
+	m_periodRing(PeriodRingSize),
+	m_periodReader(m_periodRing),
+	m_sourceProfiling(false),
+	m_tracing(false),
+	m_lostEvents(0),
+	m_collectorQuit(false),
+	m_collectedPeriods(0),
+	m_collectorRuns(0),
+	m_flightRecorder(FlightRecorderSize),
+	m_flightRecorderPos(0),
+	m_dumpPending(false),
+	m_lastDump()
 {
+	m_collector = std::thread{&AudioEngineProfiler::collectorLoop, this};
 }
 
 
 
-void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod )
+
+AudioEngineProfiler::~AudioEngineProfiler()
+{
+	{
+		const auto lock = std::lock_guard{m_collectorMutex};
+		m_collectorQuit = true;
+	}
+	m_collectorCondition.notify_one();
+	m_collector.join();
+}
+
+
+
+void AudioEngineProfiler::finishPeriod(sample_rate_t sampleRate, fpp_t framesPerPeriod, const PeriodCounters& counters)
 {
 	// Time taken to process all data and fill the audio buffer.
 	const unsigned int periodElapsed = m_periodTimer.elapsed();
@@ -59,19 +118,336 @@ void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPe
 		m_detailLoad[i].store(newLoad * 0.05f + oldLoad * 0.95f, std::memory_order_relaxed);
 	}
 
-	if( m_outputFile.isOpen() )
-	{
-		m_outputFile.write( QString( "%1\n" ).arg( periodElapsed ).toLatin1() );
-	}
+	m_periodLength.store(timeLimit, std::memory_order_relaxed);
+
+	// Hand the period over to the flight recorder. Everything else, including
+	// writing the output file, is done by the collector thread.
+	auto record = PeriodRecord{};
+	record.start = toMicroseconds(m_periodStart - m_epoch);
+	record.elapsed = periodElapsed;
+	record.budget = static_cast<std::uint32_t>(timeLimit);
+	record.lockWait = static_cast<std::uint32_t>(m_lockWait);
+	std::copy(m_detailTime.begin(), m_detailTime.end(), record.detail.begin());
+	record.workerBusy = static_cast<std::uint32_t>(counters.workerBusy);
+	record.jobs = static_cast<std::uint16_t>(counters.jobs);
+	record.workers = static_cast<std::uint16_t>(counters.workers);
+	record.playHandles = static_cast<std::uint16_t>(counters.playHandles);
+	record.newPlayHandles = static_cast<std::uint16_t>(counters.newPlayHandles);
+	record.realtime = counters.realtime;
+	m_periodRing.write(&record, 1);
 }
 
 
 
 void AudioEngineProfiler::setOutputFile( const QString& outputFile )
 {
+	const auto lock = std::lock_guard{m_collectorMutex};
 	m_outputFile.close();
 	m_outputFile.setFileName( outputFile );
 	m_outputFile.open( QFile::WriteOnly | QFile::Truncate );
 }
 
+
+
+
+void AudioEngineProfiler::setFlightRecorderDirectory(const QString& directory)
+{
+	const auto lock = std::lock_guard{m_collectorMutex};
+	m_flightRecorderDirectory = directory;
+}
+
+
+
+
+void AudioEngineProfiler::setSourceProfiling(bool enabled)
+{
+	if (enabled) { allocateRings(); }
+	m_sourceProfiling.store(enabled, std::memory_order_release);
+
+	if (!enabled)
+	{
+		const auto lock = std::lock_guard{m_statisticsMutex};
+		m_statistics.clear();
+	}
+}
+
+
+
+
+std::vector<AudioEngineProfiler::SourceStatistics> AudioEngineProfiler::sourceStatistics() const
+{
+	const auto lock = std::lock_guard{m_statisticsMutex};
+
+	auto statistics = std::vector<SourceStatistics>{};
+	statistics.reserve(m_statistics.size());
+	for (const auto& entry : m_statistics)
+	{
+		statistics.push_back(entry.second);
+	}
+	return statistics;
+}
+
+
+
+
+void AudioEngineProfiler::removeSource(const void* source)
+{
+	const auto lock = std::lock_guard{m_statisticsMutex};
+	m_statistics.erase(source);
+	// the accumulators are dropped by the collector, after it drained the rings
+	m_removedSources.push_back(source);
+}
+
+
+
+
+void AudioEngineProfiler::startTrace()
+{
+	const auto lock = std::lock_guard{m_statisticsMutex};
+	m_trace.clear();
+	m_tracing.store(true, std::memory_order_relaxed);
+}
+
+
+
+
+std::vector<AudioEngineProfiler::SourceEvent> AudioEngineProfiler::stopTrace()
+{
+	const auto lock = std::lock_guard{m_statisticsMutex};
+	m_tracing.store(false, std::memory_order_relaxed);
+	return std::exchange(m_trace, {});
+}
+
+
+
+
+void AudioEngineProfiler::recordSource(SourceType type, const void* source, Clock::time_point start)
+{
+	const auto end = Clock::now();
+	pushEvent({source, toMicroseconds(start - m_epoch), static_cast<std::uint32_t>(toMicroseconds(end - start)), type, 0});
+}
+
+
+
+
+void AudioEngineProfiler::pushEvent(const SourceEvent& event)
+{
+	// Every thread processing jobs writes to the ring of its index, so each ring
+	// has exactly one writer. Index 0 is whichever thread renders the periods,
+	// which only changes while processing is stopped.
+	const auto thread = static_cast<std::size_t>(AudioEngineWorkerThread::currentThread());
+	if (thread >= MaxThreads)
+	{
+		m_lostEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	auto threadEvent = event;
+	threadEvent.thread = static_cast<std::uint8_t>(thread);
+	if (m_rings[thread]->write(&threadEvent, 1) != 1)
+	{
+		m_lostEvents.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+
+
+
+void AudioEngineProfiler::allocateRings()
+{
+	const auto lock = std::lock_guard{m_collectorMutex};
+	if (m_rings[0]) { return; }
+
+	// Allocate all rings up front, so the audio threads never have to
+	for (std::size_t i = 0; i < MaxThreads; ++i)
+	{
+		m_rings[i] = std::make_unique<LocklessRingBuffer<SourceEvent>>(EventsPerThread);
+		m_readers[i] = std::make_unique<LocklessRingBufferReader<SourceEvent>>(*m_rings[i]);
+	}
+}
+
+
+
+
+void AudioEngineProfiler::collectorLoop()
+{
+	auto lock = std::unique_lock{m_collectorMutex};
+	while (true)
+	{
+		m_collectorCondition.wait_for(lock, CollectInterval);
+		collect();
+		if (m_collectorQuit) { break; }
+	}
+}
+
+
+
+
+void AudioEngineProfiler::collect()
+{
+	const auto statisticsLock = std::lock_guard{m_statisticsMutex};
+	const bool tracing = m_tracing.load(std::memory_order_relaxed);
+
+	while (!m_periodReader.empty())
+	{
+		const auto records = m_periodReader.read_max(PeriodRingSize);
+		for (std::size_t i = 0; i < records.size(); ++i)
+		{
+			const auto& record = records[i];
+
+			m_flightRecorder[m_flightRecorderPos] = record;
+			m_flightRecorderPos = (m_flightRecorderPos + 1) % m_flightRecorder.size();
+			if (record.realtime && record.elapsed > record.budget) { m_dumpPending = true; }
+
+			if (m_outputFile.isOpen())
+			{
+				m_outputFile.write(QString("%1\n").arg(record.elapsed).toLatin1());
+			}
+			if (tracing && m_trace.size() < MaxTraceEvents)
+			{
+				m_trace.push_back({nullptr, record.start, record.elapsed, SourceType::Period, MaxThreads});
+			}
+			++m_collectedPeriods;
+		}
+	}
+
+	if (m_outputFile.isOpen()) { m_outputFile.flush(); }
+
+	if (m_dumpPending && !m_flightRecorderDirectory.isEmpty()
+		&& (m_lastDump == Clock::time_point{} || Clock::now() - m_lastDump >= FlightRecorderDumpInterval))
+	{
+		dumpFlightRecorder();
+		m_lastDump = Clock::now();
+	}
+	m_dumpPending = false;
+
+	for (auto& reader : m_readers)
+	{
+		if (!reader) { break; }
+
+		while (!reader->empty())
+		{
+			const auto events = reader->read_max(EventsPerThread);
+			for (std::size_t i = 0; i < events.size(); ++i)
+			{
+				const auto& event = events[i];
+				if (tracing && m_trace.size() < MaxTraceEvents) { m_trace.push_back(event); }
+
+				auto& accumulator = m_accumulators[event.source];
+				accumulator.type = event.type;
+				accumulator.time += event.duration;
+				accumulator.peak = std::max(accumulator.peak, static_cast<int>(event.duration));
+				++accumulator.calls;
+			}
+		}
+	}
+
+	if (!m_removedSources.empty())
+	{
+		auto isRemoved = [this](const void* source)
+		{
+			return std::find(m_removedSources.begin(), m_removedSources.end(), source) != m_removedSources.end();
+		};
+		for (const auto source : m_removedSources)
+		{
+			m_accumulators.erase(source);
+			m_statistics.erase(source);
+		}
+		// the names are looked up when the trace is saved, a new source must not take them over
+		for (auto& event : m_trace)
+		{
+			if (event.type != SourceType::Period && isRemoved(event.source)) { event.source = nullptr; }
+		}
+		m_removedSources.clear();
+	}
+
+	const auto periodLength = m_periodLength.load(std::memory_order_relaxed);
+	if (m_collectedPeriods == 0 || periodLength == 0) { return; }
+
+	const bool resetPeaks = ++m_collectorRuns % PeakRuns == 0;
+	const auto budget = static_cast<float>(m_collectedPeriods * periodLength);
+
+	// Sources which did not run since the last collection fade out of the statistics
+	for (auto it = m_statistics.begin(); it != m_statistics.end();)
+	{
+		if (m_accumulators.find(it->first) != m_accumulators.end()) { ++it; continue; }
+
+		it->second.load *= 0.7f;
+		it->second.callsPerPeriod = 0;
+		if (resetPeaks) { it->second.peak = 0; }
+		it = it->second.load < 0.01f ? m_statistics.erase(it) : std::next(it);
+	}
+
+	for (const auto& [source, accumulator] : m_accumulators)
+	{
+		const auto newLoad = 100.f * accumulator.time / budget;
+		const auto calls = (accumulator.calls + m_collectedPeriods / 2) / m_collectedPeriods;
+
+		auto it = m_statistics.find(source);
+		if (it == m_statistics.end())
+		{
+			m_statistics.emplace(source, SourceStatistics{source, accumulator.type, newLoad, accumulator.peak, calls});
+			continue;
+		}
+
+		auto& statistics = it->second;
+		statistics.type = accumulator.type;
+		statistics.load = newLoad * 0.3f + statistics.load * 0.7f;
+		statistics.peak = resetPeaks ? accumulator.peak : std::max(statistics.peak, accumulator.peak);
+		statistics.callsPerPeriod = calls;
+	}
+
+	m_accumulators.clear();
+	m_collectedPeriods = 0;
+}
+
+
+
+
+void AudioEngineProfiler::dumpFlightRecorder()
+{
+	QDir directory(m_flightRecorderDirectory);
+	if (!directory.exists() && !directory.mkpath(".")) { return; }
+
+	// Only keep the most recent dumps
+	const auto nameFilter = QStringList{"xrun-*.csv"};
+	auto dumps = directory.entryList(nameFilter, QDir::Files, QDir::Name);
+	while (dumps.size() >= FlightRecorderMaxDumps)
+	{
+		directory.remove(dumps.takeFirst());
+	}
+
+	QFile file(directory.filePath(
+		QString("xrun-%1.csv").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz"))));
+	if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) { return; }
+
+	// The newest record is right before the write position
+	const auto size = m_flightRecorder.size();
+	const auto& newest = m_flightRecorder[(m_flightRecorderPos + size - 1) % size];
+	const auto historyStart = newest.start - toMicroseconds(FlightRecorderLength);
+
+	QTextStream out(&file);
+	out << "start_us,elapsed_us,budget_us,lock_wait_us,"
+		"note_setup_us,instruments_us,effects_us,mixing_us,"
+		"jobs,worker_busy_us,workers,worker_utilization,play_handles,new_play_handles,missed\n";
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		const auto& record = m_flightRecorder[(m_flightRecorderPos + i) % size];
+		// skip unused slots and everything older than the requested history
+		if (record.budget == 0 || record.start < historyStart) { continue; }
+
+		const auto utilization = record.elapsed > 0 && record.workers > 0
+			? static_cast<float>(record.workerBusy) / (record.elapsed * record.workers)
+			: 0.f;
+
+		out << record.start << ',' << record.elapsed << ',' << record.budget << ',' << record.lockWait;
+		for (const auto detail : record.detail) { out << ',' << detail; }
+		out << ',' << record.jobs << ',' << record.workerBusy << ',' << record.workers
+			<< ',' << QString::number(utilization, 'f', 3)
+			<< ',' << record.playHandles << ',' << record.newPlayHandles
+			<< ',' << (record.realtime && record.elapsed > record.budget ? 1 : 0) << '\n';
+	}
+}
+
 } // namespace lmms
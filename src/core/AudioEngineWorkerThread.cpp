@@ -29,25 +29,45 @@
 #include <QWaitCondition>
 
 #include "denormals.h"
+#include "lmmsconfig.h"
 #include "AudioEngine.h"
+#include "MicroTimer.h"
+#include "ScratchArena.h"
 #include "ThreadableJob.h"
 
 #if __SSE__
 #include <xmmintrin.h>
 #endif
 
+#if defined(LMMS_BUILD_LINUX) || defined(LMMS_BUILD_FREEBSD)
+#ifdef LMMS_HAVE_SCHED_H
+#include <sched.h>
+#endif
+#endif
+
 namespace lmms
 {
 
 AudioEngineWorkerThread::JobQueue AudioEngineWorkerThread::globalJobQueue;
 QWaitCondition * AudioEngineWorkerThread::queueReadyWaitCond = nullptr;
 QList<AudioEngineWorkerThread *> AudioEngineWorkerThread::workerThreads;
+std::atomic_int AudioEngineWorkerThread::s_jobCount{0};
+std::atomic_int AudioEngineWorkerThread::s_busyTime{0};
+thread_local int AudioEngineWorkerThread::s_currentThread = 0;
 
 // implementation of internal JobQueue
 void AudioEngineWorkerThread::JobQueue::reset( OperationMode _opMode )
 {
 	m_writeIndex = 0;
+	m_readIndex = 0;
+	m_itemsQueued = 0;
 	m_itemsDone = 0;
+	for( auto& queue : m_affineQueues )
+	{
+		queue.writeIndex = 0;
+		queue.readIndex = 0;
+	}
+	m_affineJobs = 0;
 	m_opMode = _opMode;
 }
 
@@ -60,11 +80,22 @@ void AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 	{
 		// update job state
 		_job->queue();
-		// actually queue the job via atomic operations
-		auto index = m_writeIndex++;
-		if (index < JOB_QUEUE_SIZE) {
-			m_items[index] = _job;
-		} else {
+		// count the job before it can be taken, so the queue can't be done
+		// before it is
+		++m_itemsQueued;
+
+		// jobs bound to a thread go to its own queue, falling back to the
+		// global one if that is full
+		const int affinity = _job->affinity();
+		if( affinity >= 0 )
+		{
+			++m_affineJobs;
+			if( push( affineQueue( affinity ), _job ) ) { return; }
+			--m_affineJobs;
+		}
+
+		if( !push( globalQueue(), _job ) )
+		{
 			qWarning() << "Job queue is full!";
 			++m_itemsDone;
 		}
@@ -73,24 +104,125 @@ void AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 
 
 
-void AudioEngineWorkerThread::JobQueue::run()
+
+bool AudioEngineWorkerThread::JobQueue::push( Queue queue, ThreadableJob * job )
+{
+	int index = queue.writeIndex.load();
+	do
+	{
+		if( index >= static_cast<int>( queue.size ) ) { return false; }
+	}
+	while( !queue.writeIndex.compare_exchange_weak( index, index + 1 ) );
+
+	queue.items[index] = job;
+	return true;
+}
+
+
+
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::take( Queue queue )
+{
+	int index = queue.readIndex.load();
+	do
+	{
+		if( index >= queue.writeIndex ) { return nullptr; }
+	}
+	while( !queue.readIndex.compare_exchange_weak( index, index + 1 ) );
+
+	// the slot is reserved, but the job may not be stored yet
+	ThreadableJob * job;
+	while( ( job = queue.items[index].exchange( nullptr ) ) == nullptr )
+	{
+#ifdef __SSE__
+		_mm_pause();
+#endif
+	}
+	return job;
+}
+
+
+
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::take()
 {
-	bool processedJob = true;
-	while (processedJob && m_itemsDone < m_writeIndex)
+	const int thread = currentThread();
+
+	// jobs bound to this thread first, so they are not stolen needlessly
+	if( m_affineJobs > 0 )
 	{
-		processedJob = false;
-		for( int i = 0; i < m_writeIndex && i < JOB_QUEUE_SIZE; ++i )
+		if( auto job = take( affineQueue( thread ) ) )
 		{
-			ThreadableJob * job = m_items[i].exchange(nullptr);
-			if( job )
+			--m_affineJobs;
+			return job;
+		}
+	}
+
+	if( auto job = take( globalQueue() ) ) { return job; }
+
+	// help out with the jobs of other threads rather than idling, they might
+	// be busy or even asleep
+	if( m_affineJobs > 0 )
+	{
+		for( int i = 1; i < MAX_AFFINE_THREADS; ++i )
+		{
+			if( auto job = take( affineQueue( thread + i ) ) )
 			{
-				job->process();
-				processedJob = true;
-				++m_itemsDone;
+				--m_affineJobs;
+				return job;
 			}
 		}
-		// always exit loop if we're not in dynamic mode
-		processedJob = processedJob && ( m_opMode == OperationMode::Dynamic );
+	}
+
+	return nullptr;
+}
+
+
+
+
+bool AudioEngineWorkerThread::JobQueue::runOne()
+{
+	ThreadableJob * job = take();
+	if( job == nullptr ) { return false; }
+
+	job->process();
+	++m_itemsDone;
+	return true;
+}
+
+
+
+
+void AudioEngineWorkerThread::JobQueue::run()
+{
+	MicroTimer timer;
+	int jobs = 0;
+
+	while( m_itemsDone < m_itemsQueued )
+	{
+		if( runOne() )
+		{
+			++jobs;
+		}
+		// without a job ready, the static queue is done for this thread,
+		// while in dynamic mode running jobs can still add new ones
+		else if( m_opMode == OperationMode::Static )
+		{
+			break;
+		}
+		else
+		{
+#ifdef __SSE__
+			_mm_pause();
+#endif
+		}
+	}
+
+	// statistics for the flight recorder of AudioEngineProfiler
+	if (jobs > 0)
+	{
+		s_jobCount.fetch_add(jobs, std::memory_order_relaxed);
+		s_busyTime.fetch_add(timer.elapsed(), std::memory_order_relaxed);
 	}
 }
 
@@ -99,7 +231,7 @@ void AudioEngineWorkerThread::JobQueue::run()
 
 void AudioEngineWorkerThread::JobQueue::wait()
 {
-	while (m_itemsDone < m_writeIndex)
+	while (m_itemsDone < m_itemsQueued)
 	{
 #ifdef __SSE__
 		_mm_pause();
@@ -115,7 +247,9 @@ void AudioEngineWorkerThread::JobQueue::wait()
 
 AudioEngineWorkerThread::AudioEngineWorkerThread( AudioEngine* audioEngine ) :
 	QThread( audioEngine ),
-	m_quit( false )
+	m_quit( false ),
+	m_index( workerThreads.size() + 1 ),
+	m_core( -1 )
 {
 	// initialize global static data
 	if( queueReadyWaitCond == nullptr )
@@ -151,6 +285,16 @@ void AudioEngineWorkerThread::quit()
 
 
 
+int AudioEngineWorkerThread::threadCount()
+{
+	// the last worker thread is never started, but the audio engine thread
+	// processes jobs as well
+	return workerThreads.size();
+}
+
+
+
+
 void AudioEngineWorkerThread::startAndWaitForJobs()
 {
 	queueReadyWaitCond->wakeAll();
@@ -164,9 +308,62 @@ void AudioEngineWorkerThread::startAndWaitForJobs()
 
 
 
+void AudioEngineWorkerThread::processInParallel(ThreadableJob* const* jobs, std::size_t count)
+{
+	if (count == 0) { return; }
+
+	// Hand all jobs but the first one over to the other threads. This is safe
+	// in both operation modes, as the stage can not end before the calling
+	// job is done, and the added jobs are part of what the stage waits for.
+	for (std::size_t i = 1; i < count; ++i)
+	{
+		addJob(jobs[i]);
+	}
+	if (count > 1) { queueReadyWaitCond->wakeAll(); }
+
+	jobs[0]->queue();
+	jobs[0]->process();
+	if (count == 1) { return; }
+
+	for (std::size_t i = 1; i < count; ++i)
+	{
+		// Jobs which did not fit into the full queue are still queued
+		jobs[i]->process();
+		while (jobs[i]->state() != ThreadableJob::ProcessingState::Done)
+		{
+			// Help with whatever else is queued instead of just waiting.
+			// We must not wait for the whole queue, as it contains the job
+			// which called us.
+			if (!globalJobQueue.runOne())
+			{
+#ifdef __SSE__
+				_mm_pause();
+#endif
+			}
+		}
+	}
+}
+
+
+
+
 void AudioEngineWorkerThread::run()
 {
 	disable_denormals();
+	s_currentThread = m_index;
+	ScratchArena::reserve();
+
+#if defined(LMMS_BUILD_LINUX) || defined(LMMS_BUILD_FREEBSD)
+#ifdef LMMS_HAVE_SCHED_H
+	if( m_core >= 0 )
+	{
+		cpu_set_t mask;
+		CPU_ZERO( &mask );
+		CPU_SET( m_core, &mask );
+		sched_setaffinity( 0, sizeof( mask ), &mask );
+	}
+#endif
+#endif
 
 	QMutex m;
 	while( m_quit == false )
@@ -0,0 +1,530 @@
+/*
+ * Convolver.cpp - zero latency partitioned convolution with impulse responses
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Convolver.h"
+
+#include <fftw3.h>
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <map>
+#include <mutex>
+
+#include "AudioResampler.h"
+#include "PathUtil.h"
+#include "SampleBuffer.h"
+#include "SampleLoader.h"
+#include "ThreadPool.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+// the stages add their output up to the largest partition size ahead
+constexpr f_cnt_t OutputSize = 2 * ImpulseResponse::PartitionSize.back();
+
+// zeros after the response, so the resampler doesn't hold back its end
+constexpr f_cnt_t ResamplerPadding = 4096;
+
+std::vector<SampleFrame> resample(const SampleBuffer& buffer, sample_rate_t sampleRate)
+{
+	const double ratio = static_cast<double>(sampleRate) / buffer.sampleRate();
+	auto input = std::vector<SampleFrame>(buffer.begin(), buffer.end());
+	input.resize(input.size() + ResamplerPadding);
+	auto output = std::vector<SampleFrame>(static_cast<std::size_t>(std::ceil(buffer.size() * ratio)));
+
+	auto resampler = AudioResampler{SRC_SINC_MEDIUM_QUALITY, DEFAULT_CHANNELS};
+	resampler.resample(&input[0][0], input.size(), &output[0][0], output.size(), ratio);
+	return output;
+}
+
+} // namespace
+
+
+
+
+std::shared_ptr<const ImpulseResponse> ImpulseResponse::load(const QString& file, sample_rate_t sampleRate)
+{
+	// the responses are only kept while a convolver uses them
+	static auto s_mutex = std::mutex{};
+	static auto s_cache = std::map<std::pair<QString, sample_rate_t>, std::weak_ptr<const ImpulseResponse>>{};
+
+	const auto lock = std::lock_guard{s_mutex};
+	const auto key = std::pair{PathUtil::toAbsolute(file), sampleRate};
+	if (const auto it = s_cache.find(key); it != s_cache.end())
+	{
+		if (auto ir = it->second.lock()) { return ir; }
+	}
+
+	const auto buffer = gui::SampleLoader::createBufferFromFile(file);
+	if (buffer->empty()) { return nullptr; }
+
+	auto ir = std::make_shared<const ImpulseResponse>(*buffer, sampleRate);
+	for (auto it = s_cache.begin(); it != s_cache.end();)
+	{
+		it = it->second.expired() ? s_cache.erase(it) : std::next(it);
+	}
+	s_cache[key] = ir;
+	return ir;
+}
+
+
+
+
+ImpulseResponse::ImpulseResponse(const SampleBuffer& buffer, sample_rate_t sampleRate) :
+	m_file(buffer.audioFile())
+{
+	const auto data = buffer.sampleRate() == sampleRate
+		? std::vector<SampleFrame>(buffer.begin(), buffer.end())
+		: resample(buffer, sampleRate);
+	m_length = data.size();
+
+	auto energy = std::array<float, DEFAULT_CHANNELS>{};
+	for (const auto& frame : data)
+	{
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			energy[ch] += frame[ch] * frame[ch];
+		}
+	}
+	const float maxEnergy = std::max(energy[0], energy[1]);
+	m_normalization = maxEnergy > 0.f ? 1.f / std::sqrt(maxEnergy) : 1.f;
+
+	for (f_cnt_t t = 0; t < std::min(HeadLength, m_length); ++t)
+	{
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			m_head[ch][HeadLength - 1 - t] = data[t][ch];
+		}
+	}
+
+	for (int s = 0; s < StageCount; ++s)
+	{
+		const f_cnt_t size = PartitionSize[s];
+		const f_cnt_t begin = StageOffset[s];
+		const f_cnt_t end = s + 1 < StageCount ? std::min(StageOffset[s + 1], m_length) : m_length;
+		if (end <= begin) { break; }
+
+		auto& spectra = m_spectra[s];
+		spectra.partitions = (end - begin + size - 1) / size;
+		const f_cnt_t bins = size + 1;
+
+		float* time = fftwf_alloc_real(2 * size);
+		fftwf_complex* freq = fftwf_alloc_complex(bins);
+		const auto plan = fftwf_plan_dft_r2c_1d(2 * size, time, freq, FFTW_MEASURE);
+		// FFTW doesn't normalize, so the inverse transform of the convolver is scaled here
+		const float scale = 1.f / (2 * size);
+
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			spectra.real[ch].resize(spectra.partitions * bins);
+			spectra.imag[ch].resize(spectra.partitions * bins);
+			for (f_cnt_t p = 0; p < spectra.partitions; ++p)
+			{
+				// the second half stays zero for overlap-save
+				std::fill(time, time + 2 * size, 0.f);
+				const f_cnt_t first = begin + p * size;
+				for (f_cnt_t f = 0; f < size && first + f < end; ++f)
+				{
+					time[f] = data[first + f][ch] * scale;
+				}
+				fftwf_execute(plan);
+				for (f_cnt_t b = 0; b < bins; ++b)
+				{
+					spectra.real[ch][p * bins + b] = freq[b][0];
+					spectra.imag[ch][p * bins + b] = freq[b][1];
+				}
+			}
+		}
+
+		fftwf_destroy_plan(plan);
+		fftwf_free(time);
+		fftwf_free(freq);
+	}
+}
+
+
+
+
+//! Uniformly partitioned overlap-save convolution with the partitions of one stage
+class Convolver::Stage
+{
+public:
+	Stage(const ImpulseResponse::Spectra& spectra, f_cnt_t partitionSize, f_cnt_t offset,
+		bool async, bool useThreadPool);
+	~Stage();
+
+	f_cnt_t partitionSize() const
+	{
+		return m_partitionSize;
+	}
+
+	bool isAsync() const
+	{
+		return m_async;
+	}
+
+	//! Whether the output of a started block hasn't been taken by finish() yet
+	bool isPending() const
+	{
+		return m_pending;
+	}
+
+	//! Collect \p frames frames of the next block from \p position on
+	void write(const SampleFrame* in, fpp_t frames, f_cnt_t position)
+	{
+		std::copy(in, in + frames, m_input.begin() + position);
+	}
+
+	//! Start convolving the collected block, which is complete \p time frames into the signal
+	void start(f_cnt_t time);
+
+	//! Wait for the block started last and return its output
+	const std::vector<SampleFrame>& finish();
+
+	//! When the output of the block started last is due
+	f_cnt_t target() const
+	{
+		return m_target;
+	}
+
+	void reset();
+
+private:
+	void convolve();
+
+	const ImpulseResponse::Spectra& m_spectra;
+	const f_cnt_t m_partitionSize;
+	const f_cnt_t m_offset;
+	//! The output is only due a block after start()
+	const bool m_async;
+	const bool m_useThreadPool;
+
+	//! Written by the audio thread while the job works on m_block
+	std::vector<SampleFrame> m_input;
+	std::vector<SampleFrame> m_block;
+	std::vector<SampleFrame> m_output;
+	std::array<std::vector<float>, DEFAULT_CHANNELS> m_previousBlock;
+
+	//! Spectra of the last blocks, one per partition, the newest one at m_position
+	std::array<std::vector<float>, DEFAULT_CHANNELS> m_inputReal;
+	std::array<std::vector<float>, DEFAULT_CHANNELS> m_inputImag;
+	f_cnt_t m_position = 0;
+	std::vector<float> m_sumReal;
+	std::vector<float> m_sumImag;
+
+	float* m_fftTime;
+	fftwf_complex* m_fftFreq;
+	fftwf_plan m_forward;
+	fftwf_plan m_backward;
+
+	f_cnt_t m_target = 0;
+	bool m_pending = false;
+	std::future<void> m_job;
+} ;
+
+
+
+
+Convolver::Stage::Stage(const ImpulseResponse::Spectra& spectra, f_cnt_t partitionSize, f_cnt_t offset,
+		bool async, bool useThreadPool) :
+	m_spectra(spectra),
+	m_partitionSize(partitionSize),
+	m_offset(offset),
+	m_async(async),
+	m_useThreadPool(useThreadPool),
+	m_input(partitionSize),
+	m_block(partitionSize),
+	m_output(partitionSize),
+	m_sumReal(partitionSize + 1),
+	m_sumImag(partitionSize + 1),
+	m_fftTime(fftwf_alloc_real(2 * partitionSize)),
+	m_fftFreq(fftwf_alloc_complex(partitionSize + 1))
+{
+	const f_cnt_t bins = partitionSize + 1;
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		m_previousBlock[ch].resize(partitionSize);
+		m_inputReal[ch].resize(spectra.partitions * bins);
+		m_inputImag[ch].resize(spectra.partitions * bins);
+	}
+	m_forward = fftwf_plan_dft_r2c_1d(2 * partitionSize, m_fftTime, m_fftFreq, FFTW_MEASURE);
+	m_backward = fftwf_plan_dft_c2r_1d(2 * partitionSize, m_fftFreq, m_fftTime, FFTW_MEASURE);
+}
+
+
+
+
+Convolver::Stage::~Stage()
+{
+	if (m_job.valid()) { m_job.wait(); }
+	fftwf_destroy_plan(m_forward);
+	fftwf_destroy_plan(m_backward);
+	fftwf_free(m_fftTime);
+	fftwf_free(m_fftFreq);
+}
+
+
+
+
+void Convolver::Stage::start(f_cnt_t time)
+{
+	std::swap(m_input, m_block);
+	m_target = time - m_partitionSize + m_offset;
+	m_pending = true;
+
+	if (m_async && m_useThreadPool && ThreadPool::instance().numWorkers() > 0)
+	{
+		m_job = ThreadPool::instance().enqueue([this] { convolve(); });
+	}
+	else
+	{
+		convolve();
+	}
+}
+
+
+
+
+const std::vector<SampleFrame>& Convolver::Stage::finish()
+{
+	if (m_job.valid()) { m_job.get(); }
+	m_pending = false;
+	return m_output;
+}
+
+
+
+
+void Convolver::Stage::reset()
+{
+	if (m_job.valid()) { m_job.get(); }
+	m_pending = false;
+	m_position = 0;
+	std::fill(m_input.begin(), m_input.end(), SampleFrame{});
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		std::fill(m_previousBlock[ch].begin(), m_previousBlock[ch].end(), 0.f);
+		std::fill(m_inputReal[ch].begin(), m_inputReal[ch].end(), 0.f);
+		std::fill(m_inputImag[ch].begin(), m_inputImag[ch].end(), 0.f);
+	}
+}
+
+
+
+
+void Convolver::Stage::convolve()
+{
+	const f_cnt_t size = m_partitionSize;
+	const f_cnt_t bins = size + 1;
+	const f_cnt_t partitions = m_spectra.partitions;
+	m_position = (m_position + 1) % partitions;
+
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		// overlap-save: transform the new block with the previous one in front
+		float* previous = m_previousBlock[ch].data();
+		std::copy(previous, previous + size, m_fftTime);
+		for (f_cnt_t f = 0; f < size; ++f)
+		{
+			m_fftTime[size + f] = m_block[f][ch];
+			previous[f] = m_block[f][ch];
+		}
+		fftwf_execute(m_forward);
+
+		float* newReal = m_inputReal[ch].data() + m_position * bins;
+		float* newImag = m_inputImag[ch].data() + m_position * bins;
+		for (f_cnt_t b = 0; b < bins; ++b)
+		{
+			newReal[b] = m_fftFreq[b][0];
+			newImag[b] = m_fftFreq[b][1];
+		}
+
+		// the block that came p blocks ago goes with partition p
+		float* sumReal = m_sumReal.data();
+		float* sumImag = m_sumImag.data();
+		std::fill(sumReal, sumReal + bins, 0.f);
+		std::fill(sumImag, sumImag + bins, 0.f);
+		for (f_cnt_t p = 0; p < partitions; ++p)
+		{
+			const f_cnt_t slot = (m_position + partitions - p) % partitions;
+			const float* xReal = m_inputReal[ch].data() + slot * bins;
+			const float* xImag = m_inputImag[ch].data() + slot * bins;
+			const float* hReal = m_spectra.real[ch].data() + p * bins;
+			const float* hImag = m_spectra.imag[ch].data() + p * bins;
+			for (f_cnt_t b = 0; b < bins; ++b)
+			{
+				sumReal[b] += xReal[b] * hReal[b] - xImag[b] * hImag[b];
+				sumImag[b] += xReal[b] * hImag[b] + xImag[b] * hReal[b];
+			}
+		}
+
+		for (f_cnt_t b = 0; b < bins; ++b)
+		{
+			m_fftFreq[b][0] = sumReal[b];
+			m_fftFreq[b][1] = sumImag[b];
+		}
+		fftwf_execute(m_backward);
+
+		// the first half wrapped around and is discarded
+		for (f_cnt_t f = 0; f < size; ++f)
+		{
+			m_output[f][ch] = m_fftTime[size + f];
+		}
+	}
+}
+
+
+
+
+Convolver::Convolver(std::shared_ptr<const ImpulseResponse> ir, bool useThreadPool) :
+	m_ir(std::move(ir)),
+	m_output(OutputSize)
+{
+	for (auto& input : m_headInput)
+	{
+		input.assign(2 * ImpulseResponse::HeadLength - 1, 0.f);
+	}
+
+	for (int s = 0; s < ImpulseResponse::StageCount; ++s)
+	{
+		const auto& spectra = m_ir->spectra(s);
+		if (spectra.partitions == 0) { break; }
+		// only the first stage is too small to be worth a job
+		m_stages.push_back(std::make_unique<Stage>(spectra,
+			ImpulseResponse::PartitionSize[s], ImpulseResponse::StageOffset[s], s > 0, useThreadPool));
+	}
+}
+
+
+
+
+Convolver::~Convolver() = default;
+
+
+
+
+void Convolver::process(const SampleFrame* in, SampleFrame* out, fpp_t frames)
+{
+	constexpr f_cnt_t Head = ImpulseResponse::HeadLength;
+	for (fpp_t offset = 0; offset < frames;)
+	{
+		const fpp_t chunk = std::min<fpp_t>(frames - offset, Head - m_time % Head);
+		processChunk(in + offset, out + offset, chunk);
+		offset += chunk;
+		if (m_time % Head == 0) { runStages(); }
+	}
+}
+
+
+
+
+void Convolver::reset()
+{
+	for (auto& stage : m_stages)
+	{
+		stage->reset();
+	}
+	for (auto& input : m_headInput)
+	{
+		std::fill(input.begin(), input.end(), 0.f);
+	}
+	std::fill(m_output.begin(), m_output.end(), SampleFrame{});
+	m_time = 0;
+}
+
+
+
+
+void Convolver::processChunk(const SampleFrame* in, SampleFrame* out, fpp_t frames)
+{
+	constexpr f_cnt_t Head = ImpulseResponse::HeadLength;
+	constexpr f_cnt_t History = Head - 1;
+
+	for (auto& stage : m_stages)
+	{
+		stage->write(in, frames, m_time % stage->partitionSize());
+	}
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			m_headInput[ch][History + f] = in[f][ch];
+		}
+	}
+
+	// everything needed from the input is copied now, so it may be overwritten
+	const f_cnt_t mask = m_output.size() - 1;
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		const float* taps = m_ir->head()[ch].data();
+		float* x = m_headInput[ch].data();
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			float sum = 0.f;
+			for (f_cnt_t t = 0; t < Head; ++t)
+			{
+				sum += taps[t] * x[f + t];
+			}
+			auto& tail = m_output[(m_time + f) & mask];
+			out[f][ch] = sum + tail[ch];
+			tail[ch] = 0.f;
+		}
+		std::copy(x + frames, x + frames + History, x);
+	}
+	m_time += frames;
+}
+
+
+
+
+void Convolver::runStages()
+{
+	for (auto& stage : m_stages)
+	{
+		if (m_time % stage->partitionSize() != 0) { continue; }
+
+		// a job had the time of this block to finish, its output is due now
+		if (stage->isPending()) { addToOutput(stage->finish(), stage->target()); }
+		stage->start(m_time);
+		if (!stage->isAsync()) { addToOutput(stage->finish(), stage->target()); }
+	}
+}
+
+
+
+
+void Convolver::addToOutput(const std::vector<SampleFrame>& block, f_cnt_t time)
+{
+	const f_cnt_t mask = m_output.size() - 1;
+	for (f_cnt_t f = 0; f < block.size(); ++f)
+	{
+		m_output[(time + f) & mask] += block[f];
+	}
+}
+
+
+} // namespace lmms
@@ -0,0 +1,325 @@
+/*
+ * Dynamics.cpp - building blocks for compressors and limiters
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Dynamics.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "AudioEngine.h"
+#include "lmms_math.h"
+#include "ScratchArena.h"
+
+namespace lmms
+{
+
+
+LevelDetector::LevelDetector(float floor) :
+	m_floor(floor)
+{
+}
+
+
+
+
+void LevelDetector::setRms(bool rms, float timeConstant)
+{
+	m_rms = rms;
+	m_timeConstant = timeConstant;
+}
+
+
+
+
+void LevelDetector::process(const SampleFrame* in, SampleFrame* out, fpp_t frames)
+{
+	// the mean square is always kept up to date, so switching to RMS doesn't start from an old value
+	const float c = m_timeConstant;
+	auto meanSquare = m_meanSquare;
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			const float input = in[f][ch];
+			meanSquare[ch] = c * meanSquare[ch] + (1 - c) * (input * input);
+			out[f][ch] = std::max(m_floor, m_rms ? std::sqrt(meanSquare[ch]) : std::abs(input));
+		}
+	}
+	m_meanSquare = meanSquare;
+}
+
+
+
+
+void LevelDetector::reset()
+{
+	m_meanSquare = {};
+}
+
+
+
+
+CrestFactorDetector::CrestFactorDetector(float floor) :
+	m_floor(floor)
+{
+	reset();
+}
+
+
+
+
+void CrestFactorDetector::process(const SampleFrame* in, SampleFrame* out, fpp_t frames)
+{
+	const float c = m_timeConstant;
+	auto peak = m_peak;
+	auto meanSquare = m_meanSquare;
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			const float square = in[f][ch] * in[f][ch];
+			peak[ch] = std::max(std::max(m_floor, square), c * peak[ch] + (1 - c) * square);
+			meanSquare[ch] = std::max(m_floor, c * meanSquare[ch] + (1 - c) * square);
+			out[f][ch] = peak[ch] / meanSquare[ch];
+		}
+	}
+	m_peak = peak;
+	m_meanSquare = meanSquare;
+}
+
+
+
+
+void CrestFactorDetector::reset()
+{
+	m_peak = {m_floor, m_floor};
+	m_meanSquare = {m_floor, m_floor};
+}
+
+
+
+
+EnvelopeFollower::EnvelopeFollower(float floor) :
+	m_floor(floor)
+{
+	reset();
+}
+
+
+
+
+void EnvelopeFollower::setSampleRate(float sampleRate)
+{
+	// a time constant reaches about 90 % of a step after the given time
+	m_coefficientPrecalc = -2.2f / (sampleRate * 0.001f);
+	setTimes(m_attack, m_release);
+}
+
+
+
+
+void EnvelopeFollower::setTimes(float attack, float release)
+{
+	m_attack = attack;
+	m_release = release;
+	m_attackCoefficient = coefficient(attack);
+	m_releaseCoefficient = coefficient(release);
+}
+
+
+
+
+void EnvelopeFollower::setAutoTime(float attackAmount, float releaseAmount, float neutralCrestFactor)
+{
+	m_autoAttack = attackAmount;
+	m_autoRelease = releaseAmount;
+	m_neutralCrestFactor = neutralCrestFactor;
+}
+
+
+
+
+void EnvelopeFollower::setHold(f_cnt_t frames)
+{
+	m_holdLength = frames;
+	m_hold = {};
+}
+
+
+
+
+void EnvelopeFollower::process(const SampleFrame* level, const SampleFrame* crestFactor, SampleFrame* out, fpp_t frames)
+{
+	const float neutral = m_neutralCrestFactor;
+	for (int ch = 0; ch < 2; ++ch)
+	{
+		float envelope = m_envelope[ch];
+		f_cnt_t hold = m_hold[ch];
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			const float input = level[f][ch];
+			if (input > envelope)
+			{
+				// only the crest factor's deviation from the neutral one is scaled by the amount
+				const float coeff = m_autoAttack != 0
+					? coefficient(neutral * m_attack / ((crestFactor[f][ch] - neutral) * m_autoAttack + neutral))
+					: m_attackCoefficient;
+				envelope = envelope * coeff + (1 - coeff) * input;
+				hold = m_holdLength;
+			}
+			else if (hold > 0)
+			{
+				--hold;
+			}
+			else
+			{
+				const float coeff = m_autoRelease != 0
+					? coefficient(neutral * m_release / ((crestFactor[f][ch] - neutral) * m_autoRelease + neutral))
+					: m_releaseCoefficient;
+				envelope = envelope * coeff + (1 - coeff) * input;
+			}
+			envelope = std::max(m_floor, envelope);
+			out[f][ch] = envelope;
+		}
+		m_envelope[ch] = envelope;
+		m_hold[ch] = hold;
+	}
+}
+
+
+
+
+void EnvelopeFollower::reset()
+{
+	m_envelope = {m_floor, m_floor};
+	m_hold = {};
+}
+
+
+
+
+void LookaheadDelay::resize(f_cnt_t maxDelay, float value)
+{
+	// a whole block is written before it is read
+	m_buffer.assign(maxDelay + MAXIMUM_BLOCK_SIZE, SampleFrame(value));
+	m_buffer.shrink_to_fit();
+	m_position = 0;
+}
+
+
+
+
+void LookaheadDelay::fill(float value)
+{
+	std::fill(m_buffer.begin(), m_buffer.end(), SampleFrame(value));
+}
+
+
+
+
+void LookaheadDelay::write(const SampleFrame* in, fpp_t frames)
+{
+	assert(frames <= MAXIMUM_BLOCK_SIZE);
+
+	const f_cnt_t size = m_buffer.size();
+	const f_cnt_t first = std::min<f_cnt_t>(frames, size - m_position);
+	std::copy(in, in + first, m_buffer.begin() + m_position);
+	std::copy(in + first, in + frames, m_buffer.begin());
+	m_position = (m_position + frames) % size;
+}
+
+
+
+
+void LookaheadDelay::read(SampleFrame* out, fpp_t frames, f_cnt_t delay) const
+{
+	const f_cnt_t size = m_buffer.size();
+	assert(frames + delay <= size);
+
+	const f_cnt_t start = (m_position + size - frames - delay) % size;
+	const f_cnt_t first = std::min<f_cnt_t>(frames, size - start);
+	std::copy(m_buffer.begin() + start, m_buffer.begin() + start + first, out);
+	std::copy(m_buffer.begin(), m_buffer.begin() + (frames - first), out + first);
+}
+
+
+
+
+void LookaheadDelay::readWithLookahead(SampleFrame* out, fpp_t frames, f_cnt_t delay, f_cnt_t lookahead) const
+{
+	read(out, frames, delay);
+	if (lookahead == 0) { return; }
+
+	auto scratch = ScratchArena::Scope{};
+	SampleFrame* ahead = ScratchArena::frames(frames);
+	read(ahead, frames, delay - lookahead);
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			out[f][ch] = std::max(out[f][ch], ahead[f][ch]);
+		}
+	}
+}
+
+
+
+
+
+
+void CompressorGain::setCurve(float threshold, float ratio, float knee)
+{
+	m_threshold = threshold;
+	m_ratio = ratio;
+	m_knee = knee;
+	m_kneeStart = dbfsToAmp(threshold - knee);
+	m_kneeEnd = dbfsToAmp(threshold + knee);
+	// above the knee, the output level threshold + (level - threshold) * ratio in dB
+	// is the level to the power of ratio, scaled by this
+	m_scale = dbfsToAmp(threshold * (1 - ratio));
+}
+
+
+
+
+float CompressorGain::gain(float level) const
+{
+	if (level < m_kneeStart) { return 1.f; }
+	if (level >= m_kneeEnd) { return m_scale * std::pow(level, m_ratio - 1); }
+	return dbfsToAmp(compressedLevel(ampToDbfs(level), m_threshold, m_ratio, m_knee)) / level;
+}
+
+
+
+
+void CompressorGain::process(const SampleFrame* envelope, SampleFrame* out, fpp_t frames) const
+{
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		out[f] = SampleFrame(gain(envelope[f][0]), gain(envelope[f][1]));
+	}
+}
+
+
+} // namespace lmms
@@ -31,7 +31,9 @@
 #include "EffectView.h"
 
 #include "ConfigManager.h"
+#include "Mixer.h"
 #include "SampleFrame.h"
+#include "ScratchArena.h"
 
 namespace lmms
 {
@@ -46,12 +48,15 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	m_okay( true ),
 	m_noRun( false ),
 	m_running( false ),
-	m_bufferCount( 0 ),
+	m_quietFrames( 0 ),
 	m_enabledModel( true, this, tr( "Effect enabled" ) ),
+	m_expendableModel(false, this, tr("Expendable under CPU overload")),
 	m_wetDryModel( 1.0f, -1.0f, 1.0f, 0.01f, this, tr( "Wet/Dry mix" ) ),
 	m_gateModel( 0.0f, 0.0f, 1.0f, 0.01f, this, tr( "Gate" ) ),
 	m_autoQuitModel( 1.0f, 1.0f, 8000.0f, 100.0f, 1.0f, this, tr( "Decay" ) ),
-	m_autoQuitDisabled( false )
+	m_autoQuitDisabled( false ),
+	m_dryDelayPending( false ),
+	m_dryDelayUsed( false )
 {
 	m_wetDryModel.setCenterValue(0);
 
@@ -66,6 +71,15 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	// Call the virtual method onEnabledChanged so that effects can react to changes,
 	// e.g. by resetting state.
 	connect(&m_enabledModel, &BoolModel::dataChanged, [this] { onEnabledChanged(); });
+
+	// the latency of a chain only counts enabled effects
+	connect(&m_enabledModel, &BoolModel::dataChanged, [] {
+		if (Mixer* mixer = Engine::mixer()) { mixer->invalidateLatencyCompensation(); }
+	});
+
+	// the dry delay must not be resized while the audio engine is running,
+	// so the audio thread only detects the need for an update
+	connect(this, &Effect::dryDelayOutdated, this, &Effect::updateDryDelay, Qt::QueuedConnection);
 }
 
 
@@ -80,6 +94,11 @@ Effect::~Effect()
 			src_delete(state);
 		}
 	}
+
+	if (AudioEngine* audioEngine = Engine::audioEngine())
+	{
+		audioEngine->profiler().removeSource(this);
+	}
 }
 
 
@@ -88,6 +107,7 @@ Effect::~Effect()
 void Effect::saveSettings( QDomDocument & _doc, QDomElement & _this )
 {
 	m_enabledModel.saveSettings( _doc, _this, "on" );
+	m_expendableModel.saveSettings(_doc, _this, "expendable");
 	m_wetDryModel.saveSettings( _doc, _this, "wet" );
 	m_autoQuitModel.saveSettings( _doc, _this, "autoquit" );
 	m_gateModel.saveSettings( _doc, _this, "gate" );
@@ -100,6 +120,7 @@ void Effect::saveSettings( QDomDocument & _doc, QDomElement & _this )
 void Effect::loadSettings( const QDomElement & _this )
 {
 	m_enabledModel.loadSettings( _this, "on" );
+	m_expendableModel.loadSettings(_this, "expendable");
 	m_wetDryModel.loadSettings( _this, "wet" );
 	m_autoQuitModel.loadSettings( _this, "autoquit" );
 	m_gateModel.loadSettings( _this, "gate" );
@@ -145,7 +166,75 @@ Effect * Effect::instantiate( const QString& pluginName,
 
 
 
-void Effect::checkGate( double _out_sum )
+bool Effect::processAudioBuffer( SampleFrame* _buf, const fpp_t _frames )
+{
+	if( !isOkay() || dontRun() || !isEnabled() || !isRunning() )
+	{
+		processBypassedImpl();
+		return false;
+	}
+
+	if( !m_dryDelayPending && m_dryDelay.delay() != latency() )
+	{
+		m_dryDelayPending = true;
+		emit dryDelayOutdated();
+	}
+
+	// keep the input only if it is mixed into the output
+	const float d = dryLevel();
+	const float w = wetLevel();
+	auto scratch = ScratchArena::Scope{};
+	SampleFrame* dryBuf = nullptr;
+	if( d != 0.0f )
+	{
+		if( !m_dryDelayUsed )
+		{
+			// don't output what was left from the last time
+			m_dryDelay.clear();
+		}
+		dryBuf = ScratchArena::frames( _frames );
+		m_dryDelay.process( _buf, dryBuf, _frames );
+	}
+	m_dryDelayUsed = dryBuf != nullptr;
+
+	const ProcessStatus status = processImpl( _buf, _frames );
+	if( status == ProcessStatus::Sleep )
+	{
+		return false;
+	}
+
+	if( dryBuf )
+	{
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			_buf[f] = dryBuf[f] * d + _buf[f] * w;
+		}
+	}
+	else if( w != 1.0f )
+	{
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			_buf[f] *= w;
+		}
+	}
+
+	if( status == ProcessStatus::ContinueIfNotQuiet )
+	{
+		double outSum = 0.0;
+		for( fpp_t f = 0; f < _frames; ++f )
+		{
+			outSum += _buf[f].sumOfSquaredAmplitudes();
+		}
+		checkGate( outSum / _frames, _frames );
+	}
+
+	return isRunning();
+}
+
+
+
+
+void Effect::checkGate( double _out_sum, const fpp_t _frames )
 {
 	if( m_autoQuitDisabled )
 	{
@@ -156,16 +245,16 @@ void Effect::checkGate( double _out_sum )
 	// counter if the threshold has been exceeded.
 	if( _out_sum - gate() <= typeInfo<float>::minEps() )
 	{
-		incrementBufferCount();
-		if( bufferCount() > timeout() )
+		addQuietFrames( _frames );
+		if( quietFrames() > timeout() )
 		{
 			stopRunning();
-			resetBufferCount();
+			resetQuietFrames();
 		}
 	}
 	else
 	{
-		resetBufferCount();
+		resetQuietFrames();
 	}
 }
 
@@ -180,6 +269,34 @@ gui::PluginView * Effect::instantiateView( QWidget * _parent )
 	
 
 
+void Effect::setOversampling( int factor )
+{
+	Engine::audioEngine()->requestChangeInModel();
+	m_oversampler.setFactor( factor, MAXIMUM_BLOCK_SIZE );
+	m_dryDelay.setDelay( latency() );
+	Engine::audioEngine()->doneChangeInModel();
+}
+
+
+
+
+void Effect::updateDryDelay()
+{
+	Engine::audioEngine()->requestChangeInModel();
+	m_dryDelay.setDelay( latency() );
+	m_dryDelayPending = false;
+	Engine::audioEngine()->doneChangeInModel();
+
+	// the latency of the chain has changed as well
+	if( Mixer* mixer = Engine::mixer() )
+	{
+		mixer->invalidateLatencyCompensation();
+	}
+}
+
+
+
+
 void Effect::reinitSRC()
 {
 	for (auto& state : m_srcState)
@@ -203,14 +320,14 @@ void Effect::reinitSRC()
 void Effect::resample( int _i, const SampleFrame* _src_buf,
 							sample_rate_t _src_sr,
 				SampleFrame* _dst_buf, sample_rate_t _dst_sr,
-								f_cnt_t _frames )
+								f_cnt_t _frames, f_cnt_t _maxOutputFrames )
 {
 	if( m_srcState[_i] == nullptr )
 	{
 		return;
 	}
 	m_srcData[_i].input_frames = _frames;
-	m_srcData[_i].output_frames = Engine::audioEngine()->framesPerPeriod();
+	m_srcData[_i].output_frames = _maxOutputFrames;
 	m_srcData[_i].data_in = const_cast<float*>(_src_buf[0].data());
 	m_srcData[_i].data_out = _dst_buf[0].data ();
 	m_srcData[_i].src_ratio = (double) _dst_sr / _src_sr;
@@ -30,6 +30,7 @@
 #include "EffectChain.h"
 #include "Effect.h"
 #include "DummyEffect.h"
+#include "Mixer.h"
 #include "MixHelpers.h"
 
 namespace lmms
@@ -41,6 +42,7 @@ EffectChain::EffectChain( Model * _parent ) :
 	SerializingObject(),
 	m_enabledModel( false, nullptr, tr( "Effects enabled" ) )
 {
+	connect(&m_enabledModel, &BoolModel::dataChanged, this, &EffectChain::invalidateLatency);
 }
 
 
@@ -124,6 +126,7 @@ void EffectChain::appendEffect( Effect * _effect )
 	Engine::audioEngine()->requestChangeInModel();
 	m_effects.push_back(_effect);
 	Engine::audioEngine()->doneChangeInModel();
+	invalidateLatency();
 
 	m_enabledModel.setValue( true );
 
@@ -146,6 +149,7 @@ void EffectChain::removeEffect( Effect * _effect )
 	m_effects.erase( found );
 
 	Engine::audioEngine()->doneChangeInModel();
+	invalidateLatency();
 
 	if (m_effects.empty())
 	{
@@ -193,11 +197,17 @@ bool EffectChain::processAudioBuffer( SampleFrame* _buf, const fpp_t _frames, bo
 
 	MixHelpers::sanitize( _buf, _frames );
 
+	auto& profiler = Engine::audioEngine()->profiler();
+	const bool bypassExpendable = Engine::audioEngine()->overloadManager().bypassExpendableEffects();
+
 	bool moreEffects = false;
 	for (const auto& effect : m_effects)
 	{
+		if (bypassExpendable && effect->isExpendable()) { continue; }
+
 		if (hasInputNoise || effect->isRunning())
 		{
+			AudioEngineProfiler::SourceProbe profilerProbe(profiler, AudioEngineProfiler::SourceType::Effect, effect);
 			moreEffects |= effect->processAudioBuffer(_buf, _frames);
 			MixHelpers::sanitize(_buf, _frames);
 		}
@@ -225,6 +235,38 @@ void EffectChain::startRunning()
 
 
 
+void EffectChain::invalidateLatency()
+{
+	if( Mixer* mixer = Engine::mixer() )
+	{
+		mixer->invalidateLatencyCompensation();
+	}
+}
+
+
+
+
+f_cnt_t EffectChain::latency() const
+{
+	if( m_enabledModel.value() == false )
+	{
+		return 0;
+	}
+
+	f_cnt_t latency = 0;
+	for (const auto& effect : m_effects)
+	{
+		if (effect->isEnabled() && effect->isOkay() && !effect->dontRun())
+		{
+			latency += effect->latency();
+		}
+	}
+	return latency;
+}
+
+
+
+
 void EffectChain::clear()
 {
 	emit aboutToClear();
@@ -239,6 +281,7 @@ void EffectChain::clear()
 	}
 
 	Engine::audioEngine()->doneChangeInModel();
+	invalidateLatency();
 
 	m_enabledModel.setValue( false );
 }
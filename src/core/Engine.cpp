@@ -24,6 +24,7 @@
 
 
 #include "Engine.h"
+#include "AnalysisService.h"
 #include "AudioEngine.h"
 #include "ConfigManager.h"
 #include "Mixer.h"
@@ -46,6 +47,7 @@ Mixer * Engine::s_mixer = nullptr;
 PatternStore * Engine::s_patternStore = nullptr;
 Song * Engine::s_song = nullptr;
 ProjectJournal * Engine::s_projectJournal = nullptr;
+AnalysisService * Engine::s_analysisService = nullptr;
 #ifdef LMMS_HAVE_LV2
 Lv2Manager * Engine::s_lv2Manager = nullptr;
 #endif
@@ -67,6 +69,7 @@ void Engine::init( bool renderOnly )
 
 	emit engine->initProgress(tr("Initializing data structures"));
 	s_projectJournal = new ProjectJournal;
+	s_analysisService = new AnalysisService;
 	s_audioEngine = new AudioEngine( renderOnly );
 	s_song = new Song;
 	s_mixer = new Mixer;
@@ -116,6 +119,9 @@ void Engine::destroy()
 
 	deleteHelper( &s_song );
 
+	// after all effects which could still have analysis tasks are gone
+	deleteHelper( &s_analysisService );
+
 	delete ConfigManager::inst();
 
 	// The oscillator FFT plans remain throughout the application lifecycle
@@ -26,8 +26,11 @@
 
 #include <QDomElement>
 #include <QFileInfo>
+#include <algorithm>
+#include <array>
 
 #include "AudioEngine.h"
+#include "ConfigManager.h"
 #include "Engine.h"
 #include "Oscillator.h"
 #include "PathUtil.h"
@@ -43,11 +46,28 @@ extern const float SECS_PER_ENV_SEGMENT = 5.0f;
 extern const float SECS_PER_LFO_OSCILLATION = 20.0f;
 // minimum number of frames for ENV/LFO stages that mustn't be '0'
 const f_cnt_t minimumFrames = 1;
+// rate at which the levels are evaluated when the control interval is automatic
+const float AUTOMATIC_CONTROL_RATE = 3000.0f;
 
 
 EnvelopeAndLfoParameters::LfoInstances * EnvelopeAndLfoParameters::s_lfoInstances = nullptr;
 
 
+namespace
+{
+
+fpp_t configuredControlInterval()
+{
+	// 1 (the default) evaluates every frame, 0 chooses the interval from the sample rate
+	const int interval = ConfigManager::inst()->value( "audioengine", "envcontrolinterval", "1" ).toInt();
+	return interval > 0
+		? static_cast<fpp_t>( interval )
+		: std::max<fpp_t>( 1, static_cast<fpp_t>( Engine::audioEngine()->outputSampleRate() / AUTOMATIC_CONTROL_RATE ) );
+}
+
+} // namespace
+
+
 void EnvelopeAndLfoParameters::LfoInstances::trigger()
 {
 	QMutexLocker m( &m_lfoListMutex );
@@ -61,6 +81,19 @@ void EnvelopeAndLfoParameters::LfoInstances::trigger()
 
 
 
+void EnvelopeAndLfoParameters::LfoInstances::updateControlInterval()
+{
+	QMutexLocker m( &m_lfoListMutex );
+	const fpp_t interval = configuredControlInterval();
+	for (const auto& lfo : m_lfos)
+	{
+		lfo->m_controlInterval = interval;
+	}
+}
+
+
+
+
 void EnvelopeAndLfoParameters::LfoInstances::reset()
 {
 	QMutexLocker m( &m_lfoListMutex );
@@ -107,10 +140,13 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 	m_valueForZeroAmount( _value_for_zero_amount ),
 	m_pahdFrames( 0 ),
 	m_rFrames( 0 ),
-	m_pahdEnv( nullptr ),
-	m_rEnv( nullptr ),
-	m_pahdBufSize( 0 ),
-	m_rBufSize( 0 ),
+	m_predelayFrames( 0 ),
+	m_attackFrames( 0 ),
+	m_holdFrames( 0 ),
+	m_attackStep( 0 ),
+	m_decayStep( 0 ),
+	m_releaseStep( 0 ),
+	m_controlInterval( 1 ),
 	m_lfoPredelayModel(0.f, 0.f, 1.f, 0.001f, this, tr("LFO pre-delay")),
 	m_lfoAttackModel(0.f, 0.f, 1.f, 0.001f, this, tr("LFO attack")),
 	m_lfoSpeedModel(0.1f, 0.001f, 1.f, 0.0001f,
@@ -191,8 +227,6 @@ EnvelopeAndLfoParameters::~EnvelopeAndLfoParameters()
 	m_lfoWaveModel.disconnect( this );
 	m_x100Model.disconnect( this );
 
-	delete[] m_pahdEnv;
-	delete[] m_rEnv;
 	delete[] m_lfoShapeData;
 
 	instances()->remove( this );
@@ -304,38 +338,187 @@ void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 		return;
 	}
 
-	fillLfoLevel( _buf, _frame, _frames );
-
-	for( fpp_t offset = 0; offset < _frames; ++offset, ++_buf, ++_frame )
+	const fpp_t interval = m_controlInterval;
+	if( interval > 1 && _frames > 1 )
 	{
-		float env_level;
-		if( _frame < _release_begin )
+		// evaluate the level at the control points and at the last frame,
+		// and interpolate in between
+		fillControlPoints( _buf, _frame, _release_begin, _frames, interval, true );
+		const fpp_t last = _frames - 1;
+		for( fpp_t begin = 0; begin < last; begin += interval )
 		{
-			if( _frame < m_pahdFrames )
+			const fpp_t end = std::min<fpp_t>( begin + interval, last );
+			const float start = _buf[begin];
+			const float step = ( _buf[end] - start ) / ( end - begin );
+			for( fpp_t i = 1; i < end - begin; ++i )
 			{
-				env_level = m_pahdEnv[_frame];
+				_buf[begin + i] = start + i * step;
 			}
-			else
+		}
+		return;
+	}
+
+	fillLfoLevel( _buf, _frame, _frames );
+
+	const bool modulateAmount = m_controlEnvAmountModel.value();
+	constexpr fpp_t chunk = 64;
+	for( fpp_t offset = 0; offset < _frames; offset += chunk )
+	{
+		const fpp_t frames = std::min<fpp_t>( chunk, _frames - offset );
+		std::array<float, chunk> env;
+		fillEnvelope( env.data(), _frame + offset, _release_begin, frames );
+
+		// at this point, _buf is the LFO level
+		float * buf = _buf + offset;
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			buf[f] = modulateAmount ? env[f] * ( 0.5f + buf[f] ) : env[f] + buf[f];
+		}
+	}
+}
+
+
+
+
+void EnvelopeAndLfoParameters::fillControlLevel( float * buf, f_cnt_t frame,
+						const f_cnt_t releaseBegin,
+						const fpp_t frames, const fpp_t interval )
+{
+	QMutexLocker m(&m_paramMutex);
+
+	if( frame < 0 || releaseBegin < 0 )
+	{
+		return;
+	}
+
+	fillControlPoints( buf, frame, releaseBegin, frames, interval, false );
+}
+
+
+
+
+void EnvelopeAndLfoParameters::fillControlPoints( float * buf, const f_cnt_t frame,
+						const f_cnt_t releaseBegin, const fpp_t frames,
+						const fpp_t interval, const bool withLastFrame )
+{
+	// like in fillLfoLevel(), the LFO pre-delay is only checked at the
+	// beginning of the period
+	const bool lfoActive = !m_lfoAmountIsZero && frame > m_lfoPredelayFrames;
+	if( lfoActive && m_bad_lfoShapeData )
+	{
+		updateLfoShapeData();
+	}
+	const float lafI = 1.0f / std::max( minimumFrames, m_lfoAttackFrames );
+	const bool modulateAmount = m_controlEnvAmountModel.value();
+
+	auto evaluate = [&]( fpp_t offset )
+	{
+		float level;
+		fillEnvelope( &level, frame + offset, releaseBegin, 1 );
+
+		float lfoLevel = 0.0f;
+		if( lfoActive )
+		{
+			const f_cnt_t lfoFrame = frame - m_lfoPredelayFrames + offset;
+			lfoLevel = lfoFrame < m_lfoAttackFrames
+				? m_lfoShapeData[offset] * lfoFrame * lafI
+				: m_lfoShapeData[offset];
+		}
+		buf[offset] = modulateAmount ? level * ( 0.5f + lfoLevel ) : level + lfoLevel;
+	};
+
+	for( fpp_t offset = 0; offset < frames; offset += interval )
+	{
+		evaluate( offset );
+	}
+	if( withLastFrame && ( frames - 1 ) % interval != 0 )
+	{
+		evaluate( frames - 1 );
+	}
+}
+
+
+
+
+void EnvelopeAndLfoParameters::fillEnvelope( float * buf, f_cnt_t frame,
+						const f_cnt_t releaseBegin, const fpp_t frames ) const
+{
+	for( fpp_t offset = 0; offset < frames; )
+	{
+		const f_cnt_t left = frames - offset;
+		f_cnt_t filled;
+		if( frame < releaseBegin )
+		{
+			filled = fillPahd( buf + offset, frame, std::min( left, releaseBegin - frame ) );
+		}
+		else if( frame - releaseBegin < m_rFrames )
+		{
+			const f_cnt_t released = frame - releaseBegin;
+			float releaseLevel;
+			fillPahd( &releaseLevel, releaseBegin, 1 );
+			filled = std::min( left, m_rFrames - released );
+			for( f_cnt_t i = 0; i < filled; ++i )
 			{
-				env_level = m_sustainLevel;
+				buf[offset + i] = static_cast<float>( m_rFrames - ( released + i ) ) * m_releaseStep * releaseLevel;
 			}
 		}
-		else if( ( _frame - _release_begin ) < m_rFrames )
+		else
 		{
-			env_level = m_rEnv[_frame - _release_begin] *
-				( ( _release_begin < m_pahdFrames ) ?
-				m_pahdEnv[_release_begin] : m_sustainLevel );
+			filled = left;
+			std::fill_n( buf + offset, filled, 0.0f );
 		}
-		else
+		offset += filled;
+		frame += filled;
+	}
+}
+
+
+
+
+// fills at most \p frames frames with the current segment of the
+// pre-delay/attack/hold/decay/sustain envelope, returns the number of frames
+f_cnt_t EnvelopeAndLfoParameters::fillPahd( float * buf, f_cnt_t frame, const f_cnt_t frames ) const
+{
+	if( frame >= m_pahdFrames )
+	{
+		std::fill_n( buf, frames, m_sustainLevel );
+		return frames;
+	}
+
+	if( frame < m_predelayFrames )
+	{
+		const f_cnt_t n = std::min( frames, m_predelayFrames - frame );
+		std::fill_n( buf, n, m_amountAdd );
+		return n;
+	}
+	frame -= m_predelayFrames;
+
+	if( frame < m_attackFrames )
+	{
+		const f_cnt_t n = std::min( frames, m_attackFrames - frame );
+		for( f_cnt_t i = 0; i < n; ++i )
 		{
-			env_level = 0.0f;
+			buf[i] = ( frame + i ) * m_attackStep + m_amountAdd;
 		}
+		return n;
+	}
+	frame -= m_attackFrames;
+
+	const float amsum = m_amount + m_amountAdd;
+	if( frame < m_holdFrames )
+	{
+		const f_cnt_t n = std::min( frames, m_holdFrames - frame );
+		std::fill_n( buf, n, amsum );
+		return n;
+	}
+	frame -= m_holdFrames;
 
-		// at this point, *_buf is LFO level
-		*_buf = m_controlEnvAmountModel.value() ?
-			env_level * ( 0.5f + *_buf ) :
-			env_level + *_buf;
+	const f_cnt_t n = std::min( frames, m_pahdFrames - m_predelayFrames - m_attackFrames - m_holdFrames - frame );
+	for( f_cnt_t i = 0; i < n; ++i )
+	{
+		buf[i] = amsum + ( frame + i ) * m_decayStep;
 	}
+	return n;
 }
 
 
@@ -448,61 +631,12 @@ void EnvelopeAndLfoParameters::updateSampleVars()
 		m_rFrames = minimumFrames;
 	}
 
-	// if the buffers are too small, make bigger ones - so we only alloc new memory when necessary
-	if( m_pahdBufSize < m_pahdFrames )
-	{
-		sample_t * tmp = m_pahdEnv;
-		m_pahdEnv = new sample_t[m_pahdFrames];
-		delete[] tmp;
-		m_pahdBufSize = m_pahdFrames;
-	}
-	if( m_rBufSize < m_rFrames )
-	{
-		sample_t * tmp = m_rEnv;
-		m_rEnv = new sample_t[m_rFrames];
-		delete[] tmp;
-		m_rBufSize = m_rFrames;
-	}
-
-	const float aa = m_amountAdd;
-	for( f_cnt_t i = 0; i < predelay_frames; ++i )
-	{
-		m_pahdEnv[i] = aa;
-	}
-
-	f_cnt_t add = predelay_frames;
-
-	const float afI = ( 1.0f / attack_frames ) * m_amount;
-	for( f_cnt_t i = 0; i < attack_frames; ++i )
-	{
-		m_pahdEnv[add+i] = i * afI + aa;
-	}
-
-	add += attack_frames;
-	const float amsum = m_amount + m_amountAdd;
-	for( f_cnt_t i = 0; i < hold_frames; ++i )
-	{
-		m_pahdEnv[add + i] = amsum;
-	}
-
-	add += hold_frames;
-	const float dfI = ( 1.0 / decay_frames ) * ( m_sustainLevel -1 ) * m_amount;
-	for( f_cnt_t i = 0; i < decay_frames; ++i )
-	{
-/*
-		m_pahdEnv[add + i] = ( m_sustainLevel + ( 1.0f -
-						(float)i / decay_frames ) *
-						( 1.0f - m_sustainLevel ) ) *
-							m_amount + m_amountAdd;
-*/
-		m_pahdEnv[add + i] = amsum + i*dfI;
-	}
-
-	const float rfI = ( 1.0f / m_rFrames ) * m_amount;
-	for( f_cnt_t i = 0; i < m_rFrames; ++i )
-	{
-		m_rEnv[i] = (float)( m_rFrames - i ) * rfI;
-	}
+	m_predelayFrames = predelay_frames;
+	m_attackFrames = attack_frames;
+	m_holdFrames = hold_frames;
+	m_attackStep = ( 1.0f / attack_frames ) * m_amount;
+	m_decayStep = ( 1.0 / decay_frames ) * ( m_sustainLevel -1 ) * m_amount;
+	m_releaseStep = ( 1.0f / m_rFrames ) * m_amount;
 
 	// save this calculation in real-time-part
 	m_sustainLevel = m_sustainLevel * m_amount + m_amountAdd;
@@ -539,6 +673,8 @@ void EnvelopeAndLfoParameters::updateSampleVars()
 
 	m_bad_lfoShapeData = true;
 
+	m_controlInterval = configuredControlInterval();
+
 	emit dataChanged();
 
 }
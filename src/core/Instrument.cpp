@@ -26,10 +26,15 @@
 
 #include <cmath>
 
+#include "AudioEngine.h"
 #include "DummyInstrument.h"
+#include "Engine.h"
 #include "InstrumentTrack.h"
 #include "lmms_basics.h"
 #include "lmms_constants.h"
+#include "MixHelpers.h"
+#include "NotePlayHandle.h"
+#include "ScratchArena.h"
 
 
 namespace lmms
@@ -53,6 +58,30 @@ void Instrument::play( SampleFrame* )
 
 
 
+void Instrument::playNotes( NotePlayHandle* const* _notes, std::size_t _count, SampleFrame* _working_buffer )
+{
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+	auto scratch = ScratchArena::Scope{};
+	SampleFrame* buf = ScratchArena::frames( fpp );
+
+	for( std::size_t i = 0; i < _count; ++i )
+	{
+		NotePlayHandle* n = _notes[i];
+		const fpp_t frames = n->framesLeftForCurrentPeriod();
+		const f_cnt_t offset = n->noteOffset();
+
+		zeroSampleFrames( buf, fpp );
+		playNote( n, buf );
+		instrumentTrack()->processAudioBuffer( buf, frames + offset, n );
+		n->applyStealFade( buf, frames );
+
+		MixHelpers::add( _working_buffer + offset, buf + offset, frames );
+	}
+}
+
+
+
+
 void Instrument::deleteNotePluginData( NotePlayHandle * )
 {
 }
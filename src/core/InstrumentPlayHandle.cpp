@@ -44,23 +44,30 @@ void InstrumentPlayHandle::play(SampleFrame* working_buffer)
 {
 	InstrumentTrack * instrumentTrack = m_instrument->instrumentTrack();
 
-	// ensure that all our nph's have been processed first
-	auto nphv = NotePlayHandle::nphsOfInstrumentTrack(instrumentTrack, true);
-
-	bool nphsLeft;
-	do
+	if (m_instrument->rendersAllVoices())
+	{
+		instrumentTrack->playVoices(working_buffer);
+	}
+	else
 	{
-		nphsLeft = false;
-		for (const auto& handle : nphv)
+		// ensure that all our nph's have been processed first
+		auto nphv = NotePlayHandle::nphsOfInstrumentTrack(instrumentTrack, true);
+
+		bool nphsLeft;
+		do
 		{
-			if (handle->state() != ThreadableJob::ProcessingState::Done && !handle->isFinished())
+			nphsLeft = false;
+			for (const auto& handle : nphv)
 			{
-				nphsLeft = true;
-				const_cast<NotePlayHandle*>(handle)->process();
+				if (handle->state() != ThreadableJob::ProcessingState::Done && !handle->isFinished())
+				{
+					nphsLeft = true;
+					const_cast<NotePlayHandle*>(handle)->process();
+				}
 			}
 		}
+		while (nphsLeft);
 	}
-	while (nphsLeft);
 
 	m_instrument->play(working_buffer);
 
@@ -22,6 +22,8 @@
  *
  */
 
+#include <algorithm>
+#include <array>
 #include <QVarLengthArray>
 #include <QDomElement>
 
@@ -40,7 +42,6 @@ namespace lmms
 
 const float CUT_FREQ_MULTIPLIER = 6000.0f;
 const float RES_MULTIPLIER = 2.0f;
-const float RES_PRECISION = 1000.0f;
 
 
 // names for env- and lfo-targets - first is name being displayed to user
@@ -131,116 +132,168 @@ void InstrumentSoundShaping::processAudioBuffer( SampleFrame* buffer,
 							const fpp_t frames,
 							NotePlayHandle* n )
 {
-	const f_cnt_t envTotalFrames = n->totalFramesPlayed();
-	f_cnt_t envReleaseBegin = envTotalFrames - n->releaseFramesDone() + n->framesBeforeRelease();
+	f_cnt_t envTotalFrames;
+	f_cnt_t envReleaseBegin;
+	envelopePosition( n, frames, envTotalFrames, envReleaseBegin );
 
-	if( !n->isReleased() || ( n->instrumentTrack()->isSustainPedalPressed() &&
-		!n->isReleaseStarted() ) )
+	// only use filter, if it is really needed
+
+	if( m_filterEnabledModel.value() )
 	{
-		envReleaseBegin += frames;
+		processFilter( buffer, frames, n, envTotalFrames, envReleaseBegin );
 	}
 
-	// because of optimizations, there's special code for several cases:
-	// 	- cut- and res-lfo/envelope active
-	// 	- cut-lfo/envelope active
-	// 	- res-lfo/envelope active
-	//	- no lfo/envelope active but filter is used
+	processVolume( buffer, frames, envTotalFrames, envReleaseBegin );
+}
 
-	// only use filter, if it is really needed
 
-	if( m_filterEnabledModel.value() )
+
+
+bool InstrumentSoundShaping::deferAudioBuffer( const f_cnt_t offset, const fpp_t frames, NotePlayHandle* n )
+{
+	const auto type = static_cast<BasicFilters<>::FilterType>( m_filterModel.value() );
+	if( !m_filterEnabledModel.value() || frames <= 0 ||
+		!( BasicFilters<>::isBiQuad( type ) || type == BasicFilters<>::FilterType::DoubleLowPass ) )
 	{
-		QVarLengthArray<float> cutBuffer(frames);
-		QVarLengthArray<float> resBuffer(frames);
+		return false;
+	}
+
+	prepareFilter( n );
 
-		int old_filter_cut = 0;
-		int old_filter_res = 0;
+	auto& deferred = n->m_deferredShaping;
+	deferred.offset = offset;
+	deferred.frames = frames;
+	envelopePosition( n, frames, deferred.envTotalFrames, deferred.envReleaseBegin );
+	deferred.pending = true;
+
+	return true;
+}
 
-		if( n->m_filter == nullptr )
+
+
+
+void InstrumentSoundShaping::processBatch( const PlayHandleList& playHandles )
+{
+	std::array<NotePlayHandle*, BatchVoices> voices;
+	int count = 0;
+
+	for( PlayHandle* playHandle : playHandles )
+	{
+		if( playHandle->type() != PlayHandle::Type::NotePlayHandle )
 		{
-			n->m_filter = std::make_unique<BasicFilters<>>( Engine::audioEngine()->outputSampleRate() );
+			continue;
 		}
-		n->m_filter->setFilterType( static_cast<BasicFilters<>::FilterType>(m_filterModel.value()) );
 
-		if( m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed() )
+		const auto n = static_cast<NotePlayHandle*>( playHandle );
+		if( !n->m_deferredShaping.pending || n->buffer() == nullptr )
 		{
-			m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->fillLevel( cutBuffer.data(), envTotalFrames, envReleaseBegin, frames );
+			continue;
 		}
-		if( m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed() )
+		n->m_deferredShaping.pending = false;
+
+		voices[count++] = n;
+		if( count == BatchVoices )
 		{
-			m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->fillLevel( resBuffer.data(), envTotalFrames, envReleaseBegin, frames );
+			processVoices( voices.data(), count );
+			count = 0;
 		}
+	}
 
-		const float fcv = m_filterCutModel.value();
-		const float frv = m_filterResModel.value();
+	if( count > 0 )
+	{
+		processVoices( voices.data(), count );
+	}
+}
 
-		if( m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed() &&
-			m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed() )
-		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				const float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
 
-				const float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
 
-				if( static_cast<int>( new_cut_val ) != old_filter_cut ||
-					static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
-				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, new_res_val );
-					old_filter_cut = static_cast<int>( new_cut_val );
-					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
-				}
 
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else if( m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed() )
-		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
+void InstrumentSoundShaping::envelopePosition( const NotePlayHandle* n, const fpp_t frames,
+						f_cnt_t& envTotalFrames, f_cnt_t& envReleaseBegin ) const
+{
+	envTotalFrames = n->totalFramesPlayed();
+	envReleaseBegin = envTotalFrames - n->releaseFramesDone() + n->framesBeforeRelease();
 
-				if( static_cast<int>( new_cut_val ) != old_filter_cut )
-				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, frv );
-					old_filter_cut = static_cast<int>( new_cut_val );
-				}
+	if( !n->isReleased() || ( n->instrumentTrack()->isSustainPedalPressed() &&
+		!n->isReleaseStarted() ) )
+	{
+		envReleaseBegin += frames;
+	}
+}
 
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else if( m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed() )
-		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
 
-				if( static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
-				{
-					n->m_filter->calcFilterCoeffs( fcv, new_res_val );
-					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
-				}
 
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else
-		{
-			n->m_filter->calcFilterCoeffs( fcv, frv );
 
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
+void InstrumentSoundShaping::prepareFilter( NotePlayHandle* n )
+{
+	if( n->m_filter == nullptr )
+	{
+		n->m_filter = n->arena().create<BasicFilters<>>( Engine::audioEngine()->outputSampleRate() );
 	}
+	n->m_filter->setFilterType( static_cast<BasicFilters<>::FilterType>(m_filterModel.value()) );
+}
 
+
+
+
+void InstrumentSoundShaping::filterParameters( float* freq, float* q, const fpp_t frames,
+						const f_cnt_t envTotalFrames, const f_cnt_t envReleaseBegin )
+{
+	const float fcv = m_filterCutModel.value();
+	const float frv = m_filterResModel.value();
+
+	const bool cutUsed = m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed();
+	const bool resUsed = m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed();
+
+	// the filter only evaluates the modulation at its control rate
+	constexpr fpp_t interval = BasicFilters<>::ControlInterval;
+	if( cutUsed )
+	{
+		m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->fillControlLevel( freq, envTotalFrames, envReleaseBegin, frames, interval );
+	}
+	if( resUsed )
+	{
+		m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->fillControlLevel( q, envTotalFrames, envReleaseBegin, frames, interval );
+	}
+
+	for( fpp_t frame = 0; frame < frames; frame += interval )
+	{
+		freq[frame] = cutUsed
+			? EnvelopeAndLfoParameters::expKnobVal( freq[frame] ) * CUT_FREQ_MULTIPLIER + fcv
+			: fcv;
+		q[frame] = resUsed ? frv + RES_MULTIPLIER * q[frame] : frv;
+	}
+}
+
+
+
+
+void InstrumentSoundShaping::processFilter( SampleFrame* buffer, const fpp_t frames, NotePlayHandle* n,
+						const f_cnt_t envTotalFrames, const f_cnt_t envReleaseBegin )
+{
+	prepareFilter( n );
+
+	if( m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed() ||
+		m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed() )
+	{
+		QVarLengthArray<float> cutBuffer(frames);
+		QVarLengthArray<float> resBuffer(frames);
+		filterParameters( cutBuffer.data(), resBuffer.data(), frames, envTotalFrames, envReleaseBegin );
+		n->m_filter->processBlock( buffer, frames, cutBuffer.data(), resBuffer.data() );
+	}
+	else
+	{
+		n->m_filter->calcFilterCoeffs( m_filterCutModel.value(), m_filterResModel.value() );
+		n->m_filter->processBlock( buffer, frames );
+	}
+}
+
+
+
+
+void InstrumentSoundShaping::processVolume( SampleFrame* buffer, const fpp_t frames,
+						const f_cnt_t envTotalFrames, const f_cnt_t envReleaseBegin )
+{
 	if( m_envLfoParameters[static_cast<std::size_t>(Target::Volume)]->isUsed() )
 	{
 		QVarLengthArray<float> volBuffer(frames);
@@ -273,6 +326,115 @@ void InstrumentSoundShaping::processAudioBuffer( SampleFrame* buffer,
 
 
 
+void InstrumentSoundShaping::processVoice( NotePlayHandle* n )
+{
+	const auto& deferred = n->m_deferredShaping;
+	SampleFrame* buffer = n->buffer() + deferred.offset;
+
+	processFilter( buffer, deferred.frames, n, deferred.envTotalFrames, deferred.envReleaseBegin );
+	processVolume( buffer, deferred.frames, deferred.envTotalFrames, deferred.envReleaseBegin );
+	m_instrumentTrack->applyNoteVolume( buffer, deferred.frames, n );
+}
+
+
+
+
+void InstrumentSoundShaping::processVoices( NotePlayHandle** voices, const int count )
+{
+	using Batch = BiQuadBatch<BatchVoices>;
+	constexpr fpp_t interval = BasicFilters<>::ControlInterval;
+
+	if( count == 1 )
+	{
+		processVoice( voices[0] );
+		return;
+	}
+
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+	const int chunks = ( fpp + interval - 1 ) / interval;
+
+	// filter parameters of all voices at the control points of the period
+	QVarLengthArray<float> freq( chunks * BatchVoices );
+	QVarLengthArray<float> q( chunks * BatchVoices );
+	QVarLengthArray<float> voiceFreq( fpp );
+	QVarLengthArray<float> voiceQ( fpp );
+
+	Batch batch;
+	int batched = 0;
+	for( int v = 0; v < count; ++v )
+	{
+		if( !batch.add( voices[v]->m_filter ) )
+		{
+			// the filter type has been changed while the voices were played
+			processVoice( voices[v] );
+			continue;
+		}
+		voices[batched] = voices[v];
+
+		const auto& deferred = voices[v]->m_deferredShaping;
+		filterParameters( voiceFreq.data(), voiceQ.data(), deferred.frames,
+					deferred.envTotalFrames, deferred.envReleaseBegin );
+		for( int chunk = 0; chunk < chunks; ++chunk )
+		{
+			// the voice may start or end within the period, so use the
+			// nearest control point of the voice itself
+			const auto frame = static_cast<fpp_t>( std::clamp( static_cast<int>( chunk * interval ) -
+				static_cast<int>( deferred.offset ), 0, static_cast<int>( deferred.frames ) - 1 ) );
+			freq[chunk * BatchVoices + batched] = voiceFreq[frame / interval * interval];
+			q[chunk * BatchVoices + batched] = voiceQ[frame / interval * interval];
+		}
+		++batched;
+	}
+
+	for( int chunk = 0; chunk < chunks; ++chunk )
+	{
+		const fpp_t start = chunk * interval;
+		const fpp_t frames = std::min<fpp_t>( interval, fpp - start );
+
+		std::array<Batch::Frame, interval> buffer = {};
+		for( int v = 0; v < batched; ++v )
+		{
+			const auto& deferred = voices[v]->m_deferredShaping;
+			const SampleFrame* in = voices[v]->buffer();
+			const fpp_t begin = std::clamp( deferred.offset, start, start + frames ) - start;
+			const fpp_t end = std::clamp( deferred.offset + deferred.frames, start, start + frames ) - start;
+			for( fpp_t f = begin; f < end; ++f )
+			{
+				buffer[f][v * DEFAULT_CHANNELS + 0] = in[start + f][0];
+				buffer[f][v * DEFAULT_CHANNELS + 1] = in[start + f][1];
+			}
+		}
+
+		batch.process( buffer.data(), frames, &freq[chunk * BatchVoices], &q[chunk * BatchVoices] );
+
+		for( int v = 0; v < batched; ++v )
+		{
+			const auto& deferred = voices[v]->m_deferredShaping;
+			SampleFrame* out = voices[v]->buffer();
+			const fpp_t begin = std::clamp( deferred.offset, start, start + frames ) - start;
+			const fpp_t end = std::clamp( deferred.offset + deferred.frames, start, start + frames ) - start;
+			for( fpp_t f = begin; f < end; ++f )
+			{
+				out[start + f][0] = buffer[f][v * DEFAULT_CHANNELS + 0];
+				out[start + f][1] = buffer[f][v * DEFAULT_CHANNELS + 1];
+			}
+		}
+	}
+
+	batch.store();
+
+	for( int v = 0; v < batched; ++v )
+	{
+		const auto& deferred = voices[v]->m_deferredShaping;
+		SampleFrame* buffer = voices[v]->buffer() + deferred.offset;
+		processVolume( buffer, deferred.frames, deferred.envTotalFrames, deferred.envReleaseBegin );
+		m_instrumentTrack->applyNoteVolume( buffer, deferred.frames, voices[v] );
+	}
+}
+
+
+
+
 f_cnt_t InstrumentSoundShaping::envFrames( const bool _only_vol ) const
 {
 	f_cnt_t ret_val = m_envLfoParameters[static_cast<std::size_t>(Target::Volume)]->PAHD_Frames();
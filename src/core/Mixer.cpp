@@ -23,10 +23,14 @@
  */
 
 #include <QDomElement>
+#include <algorithm>
 
 #include "AudioEngine.h"
 #include "AudioEngineWorkerThread.h"
+#include "AudioPort.h"
 #include "BufferManager.h"
+#include "ConfigManager.h"
+#include "MicroTimer.h"
 #include "Mixer.h"
 #include "MixHelpers.h"
 #include "Song.h"
@@ -65,6 +69,7 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_peakLeft( 0.0f ),
 	m_peakRight( 0.0f ),
 	m_buffer( new SampleFrame[Engine::audioEngine()->framesPerPeriod()] ),
+	m_compensationBuffer( new SampleFrame[Engine::audioEngine()->framesPerPeriod()] ),
 	m_muteModel( false, _parent ),
 	m_soloModel( false, _parent ),
 	m_volumeModel(1.f, 0.f, 2.f, 0.001f, _parent),
@@ -72,6 +77,7 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_lock(),
 	m_channelIndex( idx ),
 	m_queued( false ),
+	m_processingTime( 0.0f ),
 	m_dependenciesMet(0)
 {
 	zeroSampleFrames(m_buffer, Engine::audioEngine()->framesPerPeriod());
@@ -83,6 +89,12 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 MixerChannel::~MixerChannel()
 {
 	delete[] m_buffer;
+	delete[] m_compensationBuffer;
+
+	if( AudioEngine* audioEngine = Engine::audioEngine() )
+	{
+		audioEngine->profiler().removeSource( this );
+	}
 }
 
 
@@ -117,6 +129,10 @@ void MixerChannel::unmuteForSolo()
 
 void MixerChannel::doProcessing()
 {
+	AudioEngineProfiler::SourceProbe profilerProbe(Engine::audioEngine()->profiler(),
+		AudioEngineProfiler::SourceType::MixerChannel, this);
+	MicroTimer timer;
+
 	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 
 	if( m_muted == false )
@@ -127,7 +143,9 @@ void MixerChannel::doProcessing()
 			FloatModel * sendModel = senderRoute->amount();
 			if( ! sendModel ) qFatal( "Error: no send model found from %d to %d", senderRoute->senderIndex(), m_channelIndex );
 
-			if( sender->m_hasInput || sender->m_stillRunning )
+			CompensationDelay& compensation = senderRoute->compensation();
+			const bool senderActive = sender->m_hasInput || sender->m_stillRunning;
+			if( senderActive || compensation.hasTail() )
 			{
 				// figure out if we're getting sample-exact input
 				ValueBuffer * sendBuf = sendModel->valueBuffer();
@@ -136,6 +154,20 @@ void MixerChannel::doProcessing()
 				// mix it's output with this one's output
 				SampleFrame* ch_buf = sender->m_buffer;
 
+				// delay it if other inputs of this channel have more latency
+				if( compensation.delay() > 0 )
+				{
+					if( senderActive )
+					{
+						compensation.process( ch_buf, m_compensationBuffer, fpp );
+					}
+					else
+					{
+						compensation.drain( m_compensationBuffer, fpp );
+					}
+					ch_buf = m_compensationBuffer;
+				}
+
 				// use sample-exact mixing if sample-exact values are available
 				if( ! volBuf && ! sendBuf ) // neither volume nor send has sample-exact data...
 				{
@@ -169,15 +201,21 @@ void MixerChannel::doProcessing()
 			m_fxChain.startRunning();
 		}
 
+		// every effect of the chain is measured on its own
+		profilerProbe.stop();
 		m_stillRunning = m_fxChain.processAudioBuffer( m_buffer, fpp, m_hasInput );
 
 		SampleFrame peakSamples = getAbsPeakValues(m_buffer, fpp);
 		m_peakLeft = std::max(m_peakLeft, peakSamples[0] * v);
 		m_peakRight = std::max(m_peakRight, peakSamples[1] * v);
+
+		m_processingTime += ( timer.elapsed() - m_processingTime ) * 0.1f;
 	}
 	else
 	{
 		m_peakLeft = m_peakRight = 0.0f;
+		// a silent channel takes no time, let the average follow
+		m_processingTime -= m_processingTime * 0.1f;
 	}
 
 	// increment dependency counter of all receivers
@@ -190,8 +228,17 @@ Mixer::Mixer() :
 	Model( nullptr ),
 	JournallingObject(),
 	m_mixerChannels(),
-	m_lastSoloed(-1)
+	m_lastSoloed(-1),
+	m_busAffinity(ConfigManager::inst()->value("audioengine", "busaffinity", "0").toInt()),
+	m_nextAffineThread(0),
+	m_latency(0),
+	m_compensationPending(false)
 {
+	// the delay lines must not be resized while the audio engine is running,
+	// so changes seen by the audio thread only schedule an update
+	connect(this, &Mixer::latencyCompensationOutdated,
+		this, &Mixer::updateLatencyCompensation, Qt::QueuedConnection);
+
 	// create master channel
 	createChannel();
 }
@@ -219,6 +266,7 @@ int Mixer::createChannel()
 	const int index = m_mixerChannels.size();
 	// create new channel
 	m_mixerChannels.push_back( new MixerChannel( index, this ) );
+	invalidateLatencyCompensation();
 
 	// reset channel state
 	clearChannel( index );
@@ -354,6 +402,7 @@ void Mixer::deleteChannel( int index )
 	// actually delete the channel
 	m_mixerChannels.erase(m_mixerChannels.begin() + index);
 	delete ch;
+	invalidateLatencyCompensation();
 
 	for( int i = index; i < m_mixerChannels.size(); ++i )
 	{
@@ -435,6 +484,8 @@ void Mixer::moveChannelLeft( int index )
 	// Update m_channelIndex of both channels
 	m_mixerChannels[index]->m_channelIndex = index;
 	m_mixerChannels[index - 1]->m_channelIndex = index -1;
+
+	invalidateLatencyCompensation();
 }
 
 
@@ -486,6 +537,7 @@ MixerRoute * Mixer::createRoute( MixerChannel * from, MixerChannel * to, float a
 
 	// add us to mixer's list
 	Engine::mixer()->m_mixerRoutes.push_back(route);
+	invalidateLatencyCompensation();
 	Engine::audioEngine()->doneChangeInModel();
 
 	return route;
@@ -531,6 +583,7 @@ void Mixer::deleteChannelSend( MixerRoute * route )
 	removeFromMixerRoute(Engine::mixer()->m_mixerRoutes);
 
 	delete route;
+	invalidateLatencyCompensation();
 	Engine::audioEngine()->doneChangeInModel();
 }
 
@@ -617,6 +670,95 @@ void Mixer::prepareMasterMix()
 
 
 
+
+void Mixer::invalidateLatencyCompensation()
+{
+	if (!m_compensationPending.exchange(true))
+	{
+		emit latencyCompensationOutdated();
+	}
+}
+
+
+
+
+void Mixer::updateLatencyCompensation()
+{
+	Engine::audioEngine()->requestChangeInModel();
+	// changes from now on need another update
+	m_compensationPending = false;
+
+	m_portLatencies.resize(numChannels());
+	m_inputLatencies.resize(numChannels());
+	computeLatencies();
+
+	for (AudioPort* port : Engine::audioEngine()->audioPorts())
+	{
+		const mix_ch_t channel = port->nextMixerChannel();
+		port->compensation().setDelay(channel < numChannels()
+			? inputLatency(channel) - port->latency()
+			: 0);
+	}
+
+	for (MixerRoute* route : m_mixerRoutes)
+	{
+		route->compensation().setDelay(
+			inputLatency(route->receiverIndex()) - outputLatency(route->senderIndex()));
+	}
+
+	m_latency = outputLatency(0);
+
+	Engine::audioEngine()->doneChangeInModel();
+}
+
+
+
+
+void Mixer::computeLatencies()
+{
+	std::fill(m_portLatencies.begin(), m_portLatencies.end(), 0);
+	std::fill(m_inputLatencies.begin(), m_inputLatencies.end(), std::nullopt);
+
+	for (const AudioPort* port : Engine::audioEngine()->audioPorts())
+	{
+		const mix_ch_t channel = port->nextMixerChannel();
+		if (channel < numChannels())
+		{
+			m_portLatencies[channel] = std::max(m_portLatencies[channel], port->latency());
+		}
+	}
+}
+
+
+
+
+f_cnt_t Mixer::inputLatency(mix_ch_t channel)
+{
+	// the mixer graph has no loops, so this recursion terminates
+	auto& latency = m_inputLatencies[channel];
+	if (!latency)
+	{
+		f_cnt_t slowest = m_portLatencies[channel];
+		for (const MixerRoute* route : m_mixerChannels[channel]->m_receives)
+		{
+			slowest = std::max(slowest, outputLatency(route->senderIndex()));
+		}
+		latency = slowest;
+	}
+	return *latency;
+}
+
+
+
+
+f_cnt_t Mixer::outputLatency(mix_ch_t channel)
+{
+	return inputLatency(channel) + m_mixerChannels[channel]->m_fxChain.latency();
+}
+
+
+
+
 void Mixer::masterMix( SampleFrame* _buf )
 {
 	const int fpp = Engine::audioEngine()->framesPerPeriod();
@@ -628,6 +770,8 @@ void Mixer::masterMix( SampleFrame* _buf )
 	// also instantly add all muted channels as they don't need to care
 	// about their senders, and can just increment the deps of their
 	// recipients right away.
+	if (m_busAffinity) { updateAffinities(); }
+
 	AudioEngineWorkerThread::resetJobQueue( AudioEngineWorkerThread::JobQueue::OperationMode::Dynamic );
 	for( MixerChannel * ch : m_mixerChannels )
 	{
@@ -643,25 +787,10 @@ void Mixer::masterMix( SampleFrame* _buf )
 			AudioEngineWorkerThread::addJob( ch );
 		}
 	}
-	while (m_mixerChannels[0]->state() != ThreadableJob::ProcessingState::Done)
-	{
-		bool found = false;
-		for( MixerChannel * ch : m_mixerChannels )
-		{
-			const auto s = ch->state();
-			if (s == ThreadableJob::ProcessingState::Queued
-				|| s == ThreadableJob::ProcessingState::InProgress)
-			{
-				found = true;
-				break;
-			}
-		}
-		if( !found )
-		{
-			break;
-		}
-		AudioEngineWorkerThread::startAndWaitForJobs();
-	}
+	// channels queue their receivers when they are done (see processed()),
+	// before they count as done themselves, so the queue only runs empty
+	// once every channel has been processed
+	AudioEngineWorkerThread::startAndWaitForJobs();
 
 	// handle sample-exact data in master volume fader
 	ValueBuffer * volBuf = m_mixerChannels[0]->m_volumeModel.valueBuffer();
@@ -696,6 +825,34 @@ void Mixer::masterMix( SampleFrame* _buf )
 
 
 
+void Mixer::updateAffinities()
+{
+	const int threads = AudioEngineWorkerThread::threadCount();
+	if (threads < 2) { return; }
+
+	const auto engine = Engine::audioEngine();
+	const float periodTime = 1000000.f * engine->framesPerPeriod() / engine->outputSampleRate();
+
+	// bind heavy channels to threads in turn and release them again when they
+	// got a lot lighter, so the assignment stays stable across periods
+	for (MixerChannel* ch : m_mixerChannels)
+	{
+		const float load = ch->m_processingTime / periodTime;
+		if (ch->affinity() < 0 && load > HeavyChannelLoad)
+		{
+			ch->setAffinity(m_nextAffineThread);
+			m_nextAffineThread = (m_nextAffineThread + 1) % threads;
+		}
+		else if (ch->affinity() >= 0 && load < HeavyChannelLoad / 2)
+		{
+			ch->setAffinity(-1);
+		}
+	}
+}
+
+
+
+
 void Mixer::clear()
 {
 	while( m_mixerChannels.size() > 1 )
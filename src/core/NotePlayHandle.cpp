@@ -46,7 +46,8 @@ NotePlayHandle::BaseDetuning::BaseDetuning( DetuningHelper *detuning ) :
 
 
 
-NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
+NotePlayHandle::NotePlayHandle( NoteArena& arena,
+								InstrumentTrack* instrumentTrack,
 								const f_cnt_t _offset,
 								const f_cnt_t _frames,
 								const Note& n,
@@ -56,6 +57,7 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	PlayHandle( PlayHandle::Type::NotePlayHandle, _offset ),
 	Note( n.length(), n.pos(), n.key(), n.getVolume(), n.getPanning(), n.detuning() ),
 	m_pluginData( nullptr ),
+	m_filter( nullptr ),
 	m_instrumentTrack( instrumentTrack ),
 	m_frames( 0 ),
 	m_totalFramesPlayed( 0 ),
@@ -79,12 +81,18 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	m_songGlobalParentOffset( 0 ),
 	m_midiChannel( midiEventChannel >= 0 ? midiEventChannel : instrumentTrack->midiPort()->realOutputChannel() ),
 	m_origin( origin ),
-	m_frequencyNeedsUpdate( false )
+	m_frequencyNeedsUpdate( false ),
+	m_stealFrames( 0 ),
+	m_stealFramesDone( 0 ),
+	m_framesThisPeriod( 0 ),
+	m_framesToPlay( 0 ),
+	m_playedByInstrument( false ),
+	m_arena( &arena )
 {
 	lock();
 	if( hasParent() == false )
 	{
-		m_baseDetuning = new BaseDetuning( detuning() );
+		m_baseDetuning = m_arena->create<BaseDetuning>( detuning() );
 		m_instrumentTrack->m_processHandles.push_back( this );
 	}
 	else
@@ -113,6 +121,11 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	{
 		setUsesBuffer( false );
 	}
+	else if (m_instrumentTrack->instrument() && m_instrumentTrack->instrument()->rendersAllVoices())
+	{
+		setUsesBuffer( false );
+		m_playedByInstrument = true;
+	}
 
 	setAudioPort( instrumentTrack->audioPort() );
 
@@ -127,7 +140,6 @@ NotePlayHandle::~NotePlayHandle()
 
 	if( hasParent() == false )
 	{
-		delete m_baseDetuning;
 		m_instrumentTrack->m_processHandles.removeAll( this );
 	}
 	else
@@ -140,6 +152,9 @@ NotePlayHandle::~NotePlayHandle()
 		m_instrumentTrack->deleteNotePluginData( this );
 	}
 
+	// destroys the base detuning, the filter and the instrument's note data
+	m_arena->reset();
+
 	if( m_instrumentTrack->m_notes[key()] == this )
 	{
 		m_instrumentTrack->m_notes[key()] = nullptr;
@@ -185,16 +200,40 @@ int NotePlayHandle::midiKey() const
 
 void NotePlayHandle::play( SampleFrame* _working_buffer )
 {
-	if (m_muted)
+	if( !beginPeriod() )
 	{
 		return;
 	}
 
+	// under some circumstances we're called even if there's nothing to play
+	// therefore do an additional check which fixes crash e.g. when
+	// decreasing release of an instrument-track while the note is active
+	if( m_framesToPlay > 0 )
+	{
+		// play note!
+		m_instrumentTrack->playNote( this, _working_buffer );
+
+		applyStealFade( _working_buffer, m_framesToPlay );
+	}
+
+	endPeriod();
+}
+
+
+
+
+bool NotePlayHandle::beginPeriod()
+{
+	if (m_muted)
+	{
+		return false;
+	}
+
 	// if the note offset falls over to next period, then don't start playback yet
 	if( offset() >= Engine::audioEngine()->framesPerPeriod() )
 	{
 		setOffset( offset() - Engine::audioEngine()->framesPerPeriod() );
-		return;
+		return false;
 	}
 
 	lock();
@@ -211,7 +250,7 @@ void NotePlayHandle::play( SampleFrame* _working_buffer )
 		if (m_totalFramesPlayed == 0)
 		{
 			unlock();
-			return;
+			return false;
 		}
 	}
 
@@ -240,29 +279,37 @@ void NotePlayHandle::play( SampleFrame* _working_buffer )
 	}
 
 	// number of frames that can be played this period
-	f_cnt_t framesThisPeriod = m_totalFramesPlayed == 0
+	m_framesThisPeriod = m_totalFramesPlayed == 0
 		? Engine::audioEngine()->framesPerPeriod() - offset()
 		: Engine::audioEngine()->framesPerPeriod();
 
 	// check if we start release during this period
 	if( m_released == false &&
 		instrumentTrack()->isSustainPedalPressed() == false &&
-		m_totalFramesPlayed + framesThisPeriod > m_frames )
+		m_totalFramesPlayed + m_framesThisPeriod > m_frames )
 	{
 		noteOff( m_totalFramesPlayed == 0
 			? ( m_frames + offset() ) // if we have noteon and noteoff during the same period, take offset in account for release frame
 			: ( m_frames - m_totalFramesPlayed ) ); // otherwise, the offset is already negated and can be ignored
 	}
 
-	// under some circumstances we're called even if there's nothing to play
-	// therefore do an additional check which fixes crash e.g. when
-	// decreasing release of an instrument-track while the note is active
-	if( framesLeft() > 0 )
+	m_framesToPlay = framesLeft() > 0 ? framesLeftForCurrentPeriod() : 0;
+
+	return true;
+}
+
+
+
+
+void NotePlayHandle::endPeriod()
+{
+	if( isStolen() )
 	{
-		// play note!
-		m_instrumentTrack->playNote( this, _working_buffer );
+		m_stealFramesDone = std::min<f_cnt_t>( m_stealFrames, m_stealFramesDone + m_framesToPlay );
 	}
 
+	const f_cnt_t framesThisPeriod = m_framesThisPeriod;
+
 	if( m_released && (!instrumentTrack()->isSustainPedalPressed() ||
 		m_releaseStarted) )
 	{
@@ -328,7 +375,11 @@ void NotePlayHandle::play( SampleFrame* _working_buffer )
 
 f_cnt_t NotePlayHandle::framesLeft() const
 {
-	if( instrumentTrack()->isSustainPedalPressed() )
+	if( isStolen() )
+	{
+		return m_stealFrames - m_stealFramesDone;
+	}
+	else if( instrumentTrack()->isSustainPedalPressed() )
 	{
 		return 4 * Engine::audioEngine()->framesPerPeriod();
 	}
@@ -411,6 +462,40 @@ void NotePlayHandle::noteOff( const f_cnt_t _s )
 
 
 
+void NotePlayHandle::steal( const f_cnt_t fadeFrames )
+{
+	if( isStolen() )
+	{
+		return;
+	}
+
+	noteOff( 0 );
+	// never make the note longer than it would have been anyway
+	m_stealFrames = std::max<f_cnt_t>( 1, std::min( fadeFrames, framesLeft() ) );
+	m_stealFramesDone = 0;
+}
+
+
+
+
+void NotePlayHandle::applyStealFade( SampleFrame* buffer, const fpp_t frames ) const
+{
+	if( !isStolen() || buffer == nullptr )
+	{
+		return;
+	}
+
+	buffer += noteOffset();
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		const float gain = std::max( 0.f, 1.f - static_cast<float>( m_stealFramesDone + f ) / m_stealFrames );
+		buffer[f] *= gain;
+	}
+}
+
+
+
+
 f_cnt_t NotePlayHandle::actualReleaseFramesToDo() const
 {
 	return m_instrumentTrack->m_soundShaping.releaseFrames();
@@ -602,7 +687,8 @@ void NotePlayHandle::resize( const bpm_t _new_tempo )
 }
 
 
-NotePlayHandle ** NotePlayHandleManager::s_available;
+NotePlayHandleManager::Slot * NotePlayHandleManager::s_available;
+std::vector<std::unique_ptr<NoteArena[]>> NotePlayHandleManager::s_arenas;
 QReadWriteLock NotePlayHandleManager::s_mutex;
 std::atomic_int NotePlayHandleManager::s_availableIndex;
 int NotePlayHandleManager::s_size;
@@ -610,14 +696,17 @@ int NotePlayHandleManager::s_size;
 
 void NotePlayHandleManager::init()
 {
-	s_available = new NotePlayHandle*[INITIAL_NPH_CACHE];
+	s_available = new Slot[INITIAL_NPH_CACHE];
 
 	auto n = static_cast<NotePlayHandle *>(std::malloc(sizeof(NotePlayHandle) * INITIAL_NPH_CACHE));
+	s_arenas.emplace_back(new NoteArena[INITIAL_NPH_CACHE]);
+	NoteArena* arena = s_arenas.back().get();
 
 	for( int i=0; i < INITIAL_NPH_CACHE; ++i )
 	{
-		s_available[ i ] = n;
+		s_available[ i ] = { n, arena };
 		++n;
+		++arena;
 	}
 	s_availableIndex = INITIAL_NPH_CACHE - 1;
 	s_size = INITIAL_NPH_CACHE;
@@ -635,19 +724,20 @@ NotePlayHandle * NotePlayHandleManager::acquire( InstrumentTrack* instrumentTrac
 	// TODO: use some lockless data structures
 	s_mutex.lockForWrite();
 	if (s_availableIndex < 0) { extend(NPH_CACHE_INCREMENT); }
-	NotePlayHandle * nph = s_available[s_availableIndex--];
+	const Slot slot = s_available[s_availableIndex--];
 	s_mutex.unlock();
 
-	new( (void*)nph ) NotePlayHandle( instrumentTrack, offset, frames, noteToPlay, parent, midiEventChannel, origin );
-	return nph;
+	new( (void*)slot.handle ) NotePlayHandle( *slot.arena, instrumentTrack, offset, frames, noteToPlay, parent, midiEventChannel, origin );
+	return slot.handle;
 }
 
 
 void NotePlayHandleManager::release( NotePlayHandle * nph )
 {
+	NoteArena* arena = nph->m_arena;
 	nph->NotePlayHandle::~NotePlayHandle();
 	s_mutex.lockForRead();
-	s_available[++s_availableIndex] = nph;
+	s_available[++s_availableIndex] = { nph, arena };
 	s_mutex.unlock();
 }
 
@@ -655,22 +745,26 @@ void NotePlayHandleManager::release( NotePlayHandle * nph )
 void NotePlayHandleManager::extend( int c )
 {
 	s_size += c;
-	auto tmp = new NotePlayHandle*[s_size];
+	auto tmp = new Slot[s_size];
 	delete[] s_available;
 	s_available = tmp;
 
 	auto n = static_cast<NotePlayHandle *>(std::malloc(sizeof(NotePlayHandle) * c));
+	s_arenas.emplace_back(new NoteArena[c]);
+	NoteArena* arena = s_arenas.back().get();
 
 	for( int i=0; i < c; ++i )
 	{
-		s_available[++s_availableIndex] = n;
+		s_available[++s_availableIndex] = { n, arena };
 		++n;
+		++arena;
 	}
 }
 
 void NotePlayHandleManager::free()
 {
 	delete[] s_available;
+	s_arenas.clear();
 }
 
 
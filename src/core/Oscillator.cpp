@@ -26,6 +26,7 @@
 #include "Oscillator.h"
 
 #include <algorithm>
+#include <type_traits>
 #if !defined(__MINGW32__) && !defined(__MINGW64__)
 	#include <thread>
 #endif
@@ -70,7 +71,8 @@ Oscillator::Oscillator(const IntModel *wave_shape_model,
 	m_phase(phase_offset),
 	m_userWave(nullptr),
 	m_useWaveTable(false),
-	m_isModulator(false)
+	m_isModulator(false),
+	m_band(1)
 {
 }
 
@@ -88,6 +90,7 @@ void Oscillator::update(SampleFrame* ab, const fpp_t frames, const ch_cnt_t chnl
 	// The sampling functions will check this variable and avoid using band-limited
 	// wavetables, since they contain ringing that would lead to unexpected results.
 	m_isModulator = modulator;
+	recalcBand();
 	if (m_subOsc != nullptr)
 	{
 		switch (static_cast<ModulationAlgo>(m_modulationAlgoModel->value()))
@@ -116,6 +119,127 @@ void Oscillator::update(SampleFrame* ab, const fpp_t frames, const ch_cnt_t chnl
 }
 
 
+
+
+void Oscillator::updateStereo(Oscillator* right, SampleFrame* ab, const fpp_t frames, bool modulator)
+{
+	if (!isStereoPair(right))
+	{
+		update(ab, frames, 0, modulator);
+		right->update(ab, frames, 1, modulator);
+		return;
+	}
+	if (m_freq >= Engine::audioEngine()->outputSampleRate() / 2)
+	{
+		zeroSampleFrames(ab, frames);
+		return;
+	}
+	m_isModulator = right->m_isModulator = modulator;
+	recalcBand();
+	right->recalcBand();
+
+	const auto algo = m_subOsc != nullptr
+		? static_cast<ModulationAlgo>(m_modulationAlgoModel->value())
+		: NoSubOsc;
+	dispatchWaveShape([&](auto shape)
+	{
+		constexpr auto W = decltype(shape)::value;
+		switch (algo)
+		{
+			case ModulationAlgo::PhaseModulation:
+				updateStereo<ModulationAlgo::PhaseModulation, W>(right, ab, frames);
+				break;
+			case ModulationAlgo::AmplitudeModulation:
+				updateStereo<ModulationAlgo::AmplitudeModulation, W>(right, ab, frames);
+				break;
+			case ModulationAlgo::SignalMix:
+			default:
+				updateStereo<ModulationAlgo::SignalMix, W>(right, ab, frames);
+				break;
+			case ModulationAlgo::SynchronizedBySubOsc:
+				updateStereo<ModulationAlgo::SynchronizedBySubOsc, W>(right, ab, frames);
+				break;
+			case ModulationAlgo::FrequencyModulation:
+				updateStereo<ModulationAlgo::FrequencyModulation, W>(right, ab, frames);
+				break;
+			case NoSubOsc:
+				updateStereo<NoSubOsc, W>(right, ab, frames);
+				break;
+		}
+	});
+}
+
+
+
+
+bool Oscillator::isStereoPair(const Oscillator* right) const
+{
+	const Oscillator* left = this;
+	for (; left != nullptr && right != nullptr; left = left->m_subOsc, right = right->m_subOsc)
+	{
+		if (left->m_waveShapeModel->value() != right->m_waveShapeModel->value()
+			|| (left->m_subOsc == nullptr) != (right->m_subOsc == nullptr)
+			|| (left->m_subOsc != nullptr
+				&& left->m_modulationAlgoModel->value() != right->m_modulationAlgoModel->value()))
+		{
+			return false;
+		}
+	}
+	return left == right;
+}
+
+
+
+
+// whether both channels produce the same waveform, which is the case when
+// the stereo phase detuning is zero
+bool Oscillator::sharesWaveform(const Oscillator* right) const
+{
+	return m_phase == right->m_phase
+		&& m_freq * m_detuning_div_samplerate == right->m_freq * right->m_detuning_div_samplerate
+		&& m_useWaveTable == right->m_useWaveTable
+		&& m_band == right->m_band
+		&& m_userWave == right->m_userWave
+		&& m_userAntiAliasWaveTable == right->m_userAntiAliasWaveTable;
+}
+
+
+
+
+template<class F>
+void Oscillator::dispatchWaveShape(F&& f) const
+{
+	switch (static_cast<WaveShape>(m_waveShapeModel->value()))
+	{
+		case WaveShape::Sine:
+		default:
+			f(std::integral_constant<WaveShape, WaveShape::Sine>{});
+			break;
+		case WaveShape::Triangle:
+			f(std::integral_constant<WaveShape, WaveShape::Triangle>{});
+			break;
+		case WaveShape::Saw:
+			f(std::integral_constant<WaveShape, WaveShape::Saw>{});
+			break;
+		case WaveShape::Square:
+			f(std::integral_constant<WaveShape, WaveShape::Square>{});
+			break;
+		case WaveShape::MoogSaw:
+			f(std::integral_constant<WaveShape, WaveShape::MoogSaw>{});
+			break;
+		case WaveShape::Exponential:
+			f(std::integral_constant<WaveShape, WaveShape::Exponential>{});
+			break;
+		case WaveShape::WhiteNoise:
+			f(std::integral_constant<WaveShape, WaveShape::WhiteNoise>{});
+			break;
+		case WaveShape::UserDefined:
+			f(std::integral_constant<WaveShape, WaveShape::UserDefined>{});
+			break;
+	}
+}
+
+
 void Oscillator::generateSawWaveTable(int bands, sample_t* table, int firstBand)
 {
 	// sawtooth wave contain both even and odd harmonics
@@ -547,6 +671,15 @@ inline void Oscillator::recalcPhase()
 
 
 
+inline void Oscillator::recalcBand()
+{
+	m_band = waveTableBandFromFreq(
+		m_freq * m_detuning_div_samplerate * Engine::audioEngine()->outputSampleRate());
+}
+
+
+
+
 inline bool Oscillator::syncOk( float _osc_coeff )
 {
 	const float v1 = m_phase;
@@ -572,6 +705,115 @@ float Oscillator::syncInit( SampleFrame* _ab, const fpp_t _frames,
 
 
 
+std::array<float, 2> Oscillator::syncInitStereo(Oscillator* right, SampleFrame* ab, const fpp_t frames)
+{
+	if (m_subOsc != nullptr)
+	{
+		m_subOsc->updateStereo(right->m_subOsc, ab, frames);
+	}
+	recalcPhase();
+	right->recalcPhase();
+	return { m_freq * m_detuning_div_samplerate, right->m_freq * right->m_detuning_div_samplerate };
+}
+
+
+
+
+// both channels in one pass, the sub oscillators have been checked by
+// isStereoPair() already
+template<Oscillator::ModulationAlgo A, Oscillator::WaveShape W>
+void Oscillator::updateStereo(Oscillator* right, SampleFrame* ab, const fpp_t frames)
+{
+	std::array<float, 2> subCoeff = {};
+	if constexpr (A == ModulationAlgo::SynchronizedBySubOsc)
+	{
+		subCoeff = m_subOsc->syncInitStereo(right->m_subOsc, ab, frames);
+	}
+	else if constexpr (A != NoSubOsc)
+	{
+		constexpr bool modulator = A == ModulationAlgo::PhaseModulation
+			|| A == ModulationAlgo::FrequencyModulation;
+		m_subOsc->updateStereo(right->m_subOsc, ab, frames, modulator);
+	}
+	recalcPhase();
+	right->recalcPhase();
+
+	const std::array<Oscillator*, 2> osc = { this, right };
+	const std::array<float, 2> coeff = {
+		m_freq * m_detuning_div_samplerate,
+		right->m_freq * right->m_detuning_div_samplerate
+	};
+	const std::array<float, 2> volume = { m_volume, right->m_volume };
+
+	// the phase of the modulated algorithms depends on the channel, and
+	// noise has to stay uncorrelated
+	constexpr bool canShare = W != WaveShape::WhiteNoise && (A == NoSubOsc
+		|| A == ModulationAlgo::AmplitudeModulation || A == ModulationAlgo::SignalMix);
+	if constexpr (canShare)
+	{
+		if (sharesWaveform(right))
+		{
+			for (fpp_t frame = 0; frame < frames; ++frame)
+			{
+				const sample_t sample = getSample<W>(m_phase);
+				for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+				{
+					if constexpr (A == ModulationAlgo::AmplitudeModulation) { ab[frame][ch] *= sample * volume[ch]; }
+					else if constexpr (A == ModulationAlgo::SignalMix) { ab[frame][ch] += sample * volume[ch]; }
+					else { ab[frame][ch] = sample * volume[ch]; }
+				}
+				m_phase += coeff[0];
+			}
+			right->m_phase = m_phase;
+			return;
+		}
+	}
+
+	[[maybe_unused]] const float sampleRateCorrection = 44100.0f / Engine::audioEngine()->outputSampleRate();
+
+	for (fpp_t frame = 0; frame < frames; ++frame)
+	{
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			Oscillator* o = osc[ch];
+			sample_t& out = ab[frame][ch];
+			if constexpr (A == ModulationAlgo::PhaseModulation)
+			{
+				out = o->getSample<W>(o->m_phase + out) * volume[ch];
+			}
+			else if constexpr (A == ModulationAlgo::AmplitudeModulation)
+			{
+				out *= o->getSample<W>(o->m_phase) * volume[ch];
+			}
+			else if constexpr (A == ModulationAlgo::SignalMix)
+			{
+				out += o->getSample<W>(o->m_phase) * volume[ch];
+			}
+			else if constexpr (A == ModulationAlgo::SynchronizedBySubOsc)
+			{
+				if (o->m_subOsc->syncOk(subCoeff[ch]))
+				{
+					o->m_phase = o->m_phaseOffset;
+				}
+				out = o->getSample<W>(o->m_phase) * volume[ch];
+			}
+			else if constexpr (A == ModulationAlgo::FrequencyModulation)
+			{
+				o->m_phase += out * sampleRateCorrection;
+				out = o->getSample<W>(o->m_phase) * volume[ch];
+			}
+			else
+			{
+				out = o->getSample<W>(o->m_phase) * volume[ch];
+			}
+			o->m_phase += coeff[ch];
+		}
+	}
+}
+
+
+
+
 // if we have no sub-osc, we can't do any modulation... just get our samples
 template<Oscillator::WaveShape W>
 void Oscillator::updateNoSub( SampleFrame* _ab, const fpp_t _frames,
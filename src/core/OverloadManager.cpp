@@ -0,0 +1,242 @@
+/*
+ * OverloadManager.cpp - graceful handling of CPU overload in the AudioEngine
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "OverloadManager.h"
+
+#include <algorithm>
+#include <samplerate.h>
+
+#include "AudioEngine.h"
+#include "ConfigManager.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "NotePlayHandle.h"
+
+namespace lmms
+{
+
+
+OverloadManager::OverloadManager() :
+	m_stealVoices(false),
+	m_maxVoices(0),
+	m_stealMode(StealMode::Oldest),
+	m_fadeOutMs(DefaultFadeOutMs),
+	m_degradeSamples(false),
+	m_bypassExpendableEffects(false),
+	m_level(Level::Normal),
+	m_periodsSinceShed(0),
+	m_stolenVoices(0),
+	m_droppedVoices(0)
+{
+	m_voices.reserve(PlayHandle::MaxNumber);
+	loadSettings();
+}
+
+
+
+
+void OverloadManager::loadSettings()
+{
+	const auto config = ConfigManager::inst();
+
+	m_stealVoices = config->value("audioengine", "stealvoices", "0").toInt();
+	m_maxVoices = std::max(0, config->value("audioengine", "maxvoices", "0").toInt());
+	m_stealMode = config->value("audioengine", "stealmode") == "quietest"
+		? StealMode::Quietest
+		: StealMode::Oldest;
+	m_fadeOutMs = std::max(1.f, config->value("audioengine", "stealfadeout",
+		QString::number(DefaultFadeOutMs)).toFloat());
+	m_degradeSamples = config->value("audioengine", "degradesamples", "0").toInt();
+	m_bypassExpendableEffects = config->value("audioengine", "bypassexpendable", "0").toInt();
+}
+
+
+
+
+void OverloadManager::update(int cpuLoad)
+{
+	switch (m_level)
+	{
+		case Level::Normal:
+			if (cpuLoad >= CriticalLoad) { m_level = Level::Critical; }
+			else if (cpuLoad >= HighLoad) { m_level = Level::High; }
+			break;
+		case Level::High:
+			if (cpuLoad >= CriticalLoad) { m_level = Level::Critical; }
+			else if (cpuLoad < RecoveredLoad) { m_level = Level::Normal; }
+			break;
+		case Level::Critical:
+			// stay critical until the load has really calmed down, otherwise we
+			// would toggle between stealing and accepting voices every period
+			if (cpuLoad < RecoveredLoad) { m_level = Level::Normal; }
+			else if (cpuLoad < HighLoad) { m_level = Level::High; }
+			break;
+	}
+
+	++m_periodsSinceShed;
+}
+
+
+
+
+bool OverloadManager::shouldDrop(const PlayHandle* handle) const
+{
+	// Instrument play handles are not added during playback, but when the
+	// associated instrument is created, so never drop those.
+	if (handle->type() == PlayHandle::Type::InstrumentPlayHandle) { return false; }
+
+	// When stealing voices, the budget is enforced in enforcePolyphony()
+	if (m_stealVoices && handle->type() == PlayHandle::Type::NotePlayHandle) { return false; }
+
+	return Engine::audioEngine()->criticalXRuns();
+}
+
+
+
+
+void OverloadManager::enforcePolyphony(const PlayHandleList& playHandles)
+{
+	m_voices.clear();
+	for (const auto& playHandle : playHandles)
+	{
+		if (playHandle->type() != PlayHandle::Type::NotePlayHandle) { continue; }
+
+		const auto n = static_cast<NotePlayHandle*>(playHandle);
+		// master notes of chords and arpeggios don't produce sound themselves
+		if (n->isMasterNote() || n->isStolen() || n->isMuted() || n->isFinished()) { continue; }
+		m_voices.push_back(n);
+	}
+
+	if (m_voices.empty()) { return; }
+
+	// group the voices by track, best victims first within each group
+	std::sort(m_voices.begin(), m_voices.end(), [this](const NotePlayHandle* a, const NotePlayHandle* b)
+	{
+		if (a->instrumentTrack() != b->instrumentTrack()) { return a->instrumentTrack() < b->instrumentTrack(); }
+		return isBetterVictim(a, b);
+	});
+
+	// per instrument track budgets
+	auto groupBegin = m_voices.begin();
+	while (groupBegin != m_voices.end())
+	{
+		const auto track = (*groupBegin)->instrumentTrack();
+		const auto groupEnd = std::find_if(groupBegin, m_voices.end(),
+			[track](const NotePlayHandle* n) { return n->instrumentTrack() != track; });
+
+		const auto budget = track->maxVoices();
+		const auto voices = static_cast<int>(std::distance(groupBegin, groupEnd));
+		if (budget > 0 && voices > budget)
+		{
+			std::for_each(groupBegin, groupBegin + (voices - budget), [this](NotePlayHandle*& n)
+			{
+				steal(n);
+				n = nullptr;
+			});
+		}
+		groupBegin = groupEnd;
+	}
+
+	m_voices.erase(std::remove(m_voices.begin(), m_voices.end(), nullptr), m_voices.end());
+
+	// global budget, lowered step by step while we are overloaded
+	auto budget = m_maxVoices > 0 ? m_maxVoices : static_cast<int>(m_voices.size());
+	if (m_stealVoices && m_level == Level::Critical && m_periodsSinceShed >= ShedInterval)
+	{
+		const auto voices = static_cast<int>(m_voices.size());
+		budget = std::min(budget, std::max(1, voices - std::max(1, voices / 8)));
+		m_periodsSinceShed = 0;
+	}
+
+	const auto excess = static_cast<int>(m_voices.size()) - budget;
+	if (excess <= 0) { return; }
+
+	std::partial_sort(m_voices.begin(), m_voices.begin() + excess, m_voices.end(),
+		[this](const NotePlayHandle* a, const NotePlayHandle* b) { return isBetterVictim(a, b); });
+	std::for_each(m_voices.begin(), m_voices.begin() + excess, [this](NotePlayHandle* n) { steal(n); });
+}
+
+
+
+
+int OverloadManager::interpolationMode(int requested) const
+{
+	if (!m_degradeSamples || !isDegraded()) { return requested; }
+
+	switch (requested)
+	{
+		case SRC_SINC_BEST_QUALITY:
+		case SRC_SINC_MEDIUM_QUALITY:
+			return m_level == Level::Critical ? SRC_LINEAR : SRC_SINC_FASTEST;
+		case SRC_SINC_FASTEST:
+			return SRC_LINEAR;
+		default:
+			return requested;
+	}
+}
+
+
+
+
+void OverloadManager::resetCounters()
+{
+	m_stolenVoices.store(0, std::memory_order_relaxed);
+	m_droppedVoices.store(0, std::memory_order_relaxed);
+}
+
+
+
+
+bool OverloadManager::isBetterVictim(const NotePlayHandle* a, const NotePlayHandle* b) const
+{
+	// voices which are already fading out are the cheapest to lose
+	if (a->isReleased() != b->isReleased()) { return a->isReleased(); }
+
+	if (m_stealMode == StealMode::Quietest)
+	{
+		const auto levelA = a->getVolume() * a->instrumentTrack()->getVolume();
+		const auto levelB = b->getVolume() * b->instrumentTrack()->getVolume();
+		if (levelA != levelB) { return levelA < levelB; }
+	}
+
+	return a->totalFramesPlayed() > b->totalFramesPlayed();
+}
+
+
+
+
+void OverloadManager::steal(NotePlayHandle* n)
+{
+	const auto fadeFrames = static_cast<f_cnt_t>(
+		m_fadeOutMs * Engine::audioEngine()->outputSampleRate() / 1000.f);
+
+	n->lock();
+	n->steal(std::max<f_cnt_t>(1, fadeFrames));
+	n->unlock();
+
+	m_stolenVoices.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+} // namespace lmms
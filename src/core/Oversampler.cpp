@@ -0,0 +1,339 @@
+/*
+ * Oversampler.cpp - polyphase half-band up- and downsampling
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Oversampler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+#include "lmms_constants.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+// The first stage has to keep the audible range and needs a steep filter.
+// The following stages only have to keep the lower quarter of their band.
+constexpr int FirstStageHalfLength = 12;
+constexpr int StageHalfLength = 6;
+constexpr double KaiserBeta = 8.0;
+
+double besselI0( double x )
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for( int k = 1; k < 32; ++k )
+	{
+		term *= ( x / ( 2.0 * k ) ) * ( x / ( 2.0 * k ) );
+		sum += term;
+	}
+	return sum;
+}
+
+} // namespace
+
+
+
+
+Oversampler::HalfBand::HalfBand( int halfLength, fpp_t maxFrames ) :
+	m_halfLength( halfLength ),
+	m_taps( 2 * halfLength )
+{
+	// Kaiser windowed sinc with the cutoff at a quarter of the higher rate.
+	// With 4 * halfLength - 1 taps, every second tap besides the center one
+	// is zero, the remaining ones are stored in m_taps.
+	const int length = 4 * halfLength - 1;
+	const int center = length / 2;
+	for( int m = 0; m < 2 * halfLength; ++m )
+	{
+		const int n = 2 * m - center;
+		const double x = static_cast<double>( 2 * m ) / ( length - 1 ) * 2.0 - 1.0;
+		const double window = besselI0( KaiserBeta * std::sqrt( 1.0 - x * x ) ) / besselI0( KaiserBeta );
+		const double sinc = std::sin( D_PI * n / 2.0 ) / ( D_PI * n / 2.0 );
+		// reversed, so the convolution runs forward through the input
+		m_taps[2 * halfLength - 1 - m] = static_cast<float>( 0.5 * sinc * window );
+	}
+
+	// each polyphase branch has to have a gain of 0.5
+	const float sum = std::accumulate( m_taps.begin(), m_taps.end(), 0.0f );
+	for( auto& tap : m_taps )
+	{
+		tap *= 0.5f / sum;
+	}
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		m_upInput[ch].resize( 2 * halfLength - 1 + maxFrames );
+		m_downEven[ch].resize( 2 * halfLength - 1 + maxFrames );
+		m_downOdd[ch].resize( halfLength + maxFrames );
+	}
+}
+
+
+
+
+void Oversampler::HalfBand::upsample( const SampleFrame* in, SampleFrame* out, fpp_t frames )
+{
+	const int taps = 2 * m_halfLength;
+	const int history = taps - 1;
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		float* x = m_upInput[ch].data();
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			x[history + f] = in[f][ch];
+		}
+
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			// the zeros inserted between the input frames halve the gain
+			float sum = 0.f;
+			for( int t = 0; t < taps; ++t )
+			{
+				sum += m_taps[t] * x[f + t];
+			}
+			out[2 * f][ch] = 2.f * sum;
+			// the other branch only has the center tap
+			out[2 * f + 1][ch] = x[f + m_halfLength];
+		}
+
+		std::copy( x + frames, x + frames + history, x );
+	}
+}
+
+
+
+
+void Oversampler::HalfBand::downsample( const SampleFrame* in, SampleFrame* out, fpp_t frames )
+{
+	const int taps = 2 * m_halfLength;
+	const int history = taps - 1;
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		float* even = m_downEven[ch].data();
+		float* odd = m_downOdd[ch].data();
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			even[history + f] = in[2 * f][ch];
+			odd[m_halfLength + f] = in[2 * f + 1][ch];
+		}
+
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			float sum = 0.5f * odd[f];
+			for( int t = 0; t < taps; ++t )
+			{
+				sum += m_taps[t] * even[f + t];
+			}
+			out[f][ch] = sum;
+		}
+
+		std::copy( even + frames, even + frames + history, even );
+		std::copy( odd + frames, odd + frames + m_halfLength, odd );
+	}
+}
+
+
+
+
+void Oversampler::HalfBand::reset()
+{
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		std::fill( m_upInput[ch].begin(), m_upInput[ch].end(), 0.f );
+		std::fill( m_downEven[ch].begin(), m_downEven[ch].end(), 0.f );
+		std::fill( m_downOdd[ch].begin(), m_downOdd[ch].end(), 0.f );
+	}
+}
+
+
+
+
+Oversampler::Oversampler( int factor, fpp_t maxFrames ) :
+	m_factor( 1 ),
+	m_alignment( 0 ),
+	m_output( nullptr )
+{
+	setFactor( factor, maxFrames );
+}
+
+
+
+
+void Oversampler::setFactor( int factor, fpp_t maxFrames )
+{
+	assert( factor == 1 || factor == 2 || factor == 4 || factor == 8 );
+
+	m_factor = factor;
+	m_stages.clear();
+	fpp_t frames = maxFrames;
+	for( int f = factor; f > 1; f /= 2 )
+	{
+		m_stages.emplace_back( m_stages.empty() ? FirstStageHalfLength : StageHalfLength, frames );
+		frames *= 2;
+	}
+
+	for( auto& buffer : m_buffers )
+	{
+		buffer.assign( factor > 1 ? static_cast<std::size_t>( maxFrames ) * factor : 0, SampleFrame() );
+		buffer.shrink_to_fit();
+	}
+	m_output = m_buffers[0].data();
+
+	// Each stage delays on the way up and down at its higher rate. The later
+	// stages add fractions of frames at the original rate, so pad the delay
+	// at the highest rate to a whole number of frames.
+	int delay = 0;
+	int rate = 2;
+	for( const auto& stage : m_stages )
+	{
+		delay += 2 * stage.delay() * ( factor / rate );
+		rate *= 2;
+	}
+	m_alignment = ( factor - delay % factor ) % factor;
+	for( auto& history : m_alignmentHistory )
+	{
+		history.assign( m_alignment, 0.f );
+	}
+	m_alignmentTemp.assign( m_alignment, 0.f );
+}
+
+
+
+
+f_cnt_t Oversampler::latency() const
+{
+	int delay = m_alignment;
+	int rate = 2;
+	for( const auto& stage : m_stages )
+	{
+		delay += 2 * stage.delay() * ( m_factor / rate );
+		rate *= 2;
+	}
+	return delay / m_factor;
+}
+
+
+
+
+SampleFrame* Oversampler::upsample( const SampleFrame* in, fpp_t frames )
+{
+	if( m_stages.empty() )
+	{
+		// nothing to do, but the caller still gets a buffer to work on
+		m_output = const_cast<SampleFrame*>( in );
+		return m_output;
+	}
+
+	const auto stages = m_stages.size();
+	const SampleFrame* src = in;
+	for( std::size_t s = 0; s < stages; ++s )
+	{
+		// the last stage writes to the first buffer
+		SampleFrame* dst = m_buffers[( stages - 1 - s ) % 2].data();
+		m_stages[s].upsample( src, dst, frames );
+		src = dst;
+		frames *= 2;
+	}
+	m_output = m_buffers[0].data();
+	return m_output;
+}
+
+
+
+
+void Oversampler::downsample( SampleFrame* out, fpp_t frames )
+{
+	if( m_stages.empty() )
+	{
+		if( m_output != out )
+		{
+			std::copy( m_output, m_output + frames, out );
+		}
+		return;
+	}
+
+	align( m_buffers[0].data(), static_cast<f_cnt_t>( frames ) * m_factor );
+
+	const auto stages = m_stages.size();
+	const SampleFrame* src = m_buffers[0].data();
+	for( std::size_t s = stages; s-- > 0; )
+	{
+		SampleFrame* dst = s == 0 ? out : m_buffers[( stages - s ) % 2].data();
+		m_stages[s].downsample( src, dst, frames << s );
+		src = dst;
+	}
+}
+
+
+
+
+void Oversampler::reset()
+{
+	for( auto& stage : m_stages )
+	{
+		stage.reset();
+	}
+	for( auto& history : m_alignmentHistory )
+	{
+		std::fill( history.begin(), history.end(), 0.f );
+	}
+}
+
+
+
+
+void Oversampler::align( SampleFrame* buf, f_cnt_t frames )
+{
+	// the alignment is smaller than the factor, so it always fits
+	const f_cnt_t delay = m_alignment;
+	if( delay == 0 ) { return; }
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		auto& history = m_alignmentHistory[ch];
+		for( f_cnt_t f = 0; f < delay; ++f )
+		{
+			m_alignmentTemp[f] = buf[frames - delay + f][ch];
+		}
+		for( f_cnt_t f = frames - 1; f >= delay; --f )
+		{
+			buf[f][ch] = buf[f - delay][ch];
+		}
+		for( f_cnt_t f = 0; f < delay; ++f )
+		{
+			buf[f][ch] = history[f];
+		}
+		history.swap( m_alignmentTemp );
+	}
+}
+
+
+} // namespace lmms
@@ -52,6 +52,9 @@ PlayHandle::~PlayHandle()
 
 void PlayHandle::doProcessing()
 {
+	AudioEngineProfiler::SourceProbe profilerProbe(Engine::audioEngine()->profiler(),
+		AudioEngineProfiler::SourceType::Instrument, m_audioPort);
+
 	if( m_usesBuffer )
 	{
 		m_bufferReleased = false;
@@ -35,6 +35,7 @@
 
 #include "BufferManager.h"
 #include "AudioEngine.h"
+#include "ConfigManager.h"
 #include "Engine.h"
 #include "Song.h"
 
@@ -145,7 +146,10 @@ RemotePlugin::RemotePlugin() :
 	m_splitChannels( false ),
 	m_audioBufferSize( 0 ),
 	m_inputCount( DEFAULT_CHANNELS ),
-	m_outputCount( DEFAULT_CHANNELS )
+	m_outputCount( DEFAULT_CHANNELS ),
+	m_pipelined(ConfigManager::inst()->value("audioengine", "remotepipelined", "0").toInt()),
+	m_pendingProcessing(0),
+	m_outputPending(false)
 {
 #ifndef SYNC_WITH_SHM_FIFO
 	struct sockaddr_un sa;
@@ -357,43 +361,39 @@ bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
 		return false;
 	}
 
-	memset( m_audioBuffer.get(), 0, m_audioBufferSize );
-
-	ch_cnt_t inputs = std::min<ch_cnt_t>(m_inputCount, DEFAULT_CHANNELS);
-
-	if( _in_buf != nullptr && inputs > 0 )
+	if( m_pipelined && _out_buf != nullptr && m_outputCount > 0 )
 	{
-		if( m_splitChannels )
-		{
-			for( ch_cnt_t ch = 0; ch < inputs; ++ch )
-			{
-				for( fpp_t frame = 0; frame < frames; ++frame )
-				{
-					m_audioBuffer[ch * frames + frame] =
-							_in_buf[frame][ch];
-				}
-			}
-		}
-		else if( inputs == DEFAULT_CHANNELS )
+		lock();
+		// collect the output of the previous period, the remote process had
+		// a whole period to compute it, so usually there's no waiting here
+		// another thread may have taken the reply already, but the output
+		// is still in the shared memory then
+		if( m_outputPending && waitForProcessingDone() )
 		{
-			auto target = m_audioBuffer.get();
-			copyFromSampleFrames(target, _in_buf, frames);
+			copyOutputFromSharedMemory( _out_buf, frames );
 		}
 		else
 		{
-			auto o = (SampleFrame*)m_audioBuffer.get();
-			for( ch_cnt_t ch = 0; ch < inputs; ++ch )
-			{
-				for( fpp_t frame = 0; frame < frames; ++frame )
-				{
-					o[frame][ch] = _in_buf[frame][ch];
-				}
-			}
+			zeroSampleFrames( _out_buf, frames );
 		}
+		m_outputPending = false;
+
+		copyInputToSharedMemory( _in_buf, frames );
+		sendMessage( IdStartProcessing );
+		++m_pendingProcessing;
+		m_outputPending = true;
+		unlock();
+		return true;
 	}
 
 	lock();
+	// in case we just left the pipelined mode
+	waitForProcessingDone();
+	m_outputPending = false;
+
+	copyInputToSharedMemory( _in_buf, frames );
 	sendMessage( IdStartProcessing );
+	++m_pendingProcessing;
 
 	if( m_failed || _out_buf == nullptr || m_outputCount == 0 )
 	{
@@ -401,9 +401,93 @@ bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
 		return false;
 	}
 
-	waitForMessage( IdProcessingDone );
+	const bool done = waitForProcessingDone();
 	unlock();
 
+	if( !done )
+	{
+		zeroSampleFrames( _out_buf, frames );
+		return false;
+	}
+
+	copyOutputFromSharedMemory( _out_buf, frames );
+
+	return true;
+}
+
+
+
+
+f_cnt_t RemotePlugin::latency() const
+{
+	return m_pipelined ? Engine::audioEngine()->framesPerPeriod() : 0;
+}
+
+
+
+
+bool RemotePlugin::waitForProcessingDone()
+{
+	while( m_pendingProcessing > 0 )
+	{
+		// processMessage() decrements the counter
+		if( waitForMessage( IdProcessingDone ).id != IdProcessingDone )
+		{
+			m_pendingProcessing = 0;
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+
+void RemotePlugin::copyInputToSharedMemory( const SampleFrame* _in_buf, fpp_t frames )
+{
+	memset( m_audioBuffer.get(), 0, m_audioBufferSize );
+
+	ch_cnt_t inputs = std::min<ch_cnt_t>(m_inputCount, DEFAULT_CHANNELS);
+
+	if( _in_buf == nullptr || inputs == 0 )
+	{
+		return;
+	}
+
+	if( m_splitChannels )
+	{
+		for( ch_cnt_t ch = 0; ch < inputs; ++ch )
+		{
+			for( fpp_t frame = 0; frame < frames; ++frame )
+			{
+				m_audioBuffer[ch * frames + frame] =
+						_in_buf[frame][ch];
+			}
+		}
+	}
+	else if( inputs == DEFAULT_CHANNELS )
+	{
+		auto target = m_audioBuffer.get();
+		copyFromSampleFrames(target, _in_buf, frames);
+	}
+	else
+	{
+		auto o = (SampleFrame*)m_audioBuffer.get();
+		for( ch_cnt_t ch = 0; ch < inputs; ++ch )
+		{
+			for( fpp_t frame = 0; frame < frames; ++frame )
+			{
+				o[frame][ch] = _in_buf[frame][ch];
+			}
+		}
+	}
+}
+
+
+
+
+void RemotePlugin::copyOutputFromSharedMemory( SampleFrame* _out_buf, fpp_t frames )
+{
 	const ch_cnt_t outputs = std::min<ch_cnt_t>(m_outputCount,
 							DEFAULT_CHANNELS);
 	if( m_splitChannels )
@@ -437,8 +521,6 @@ bool RemotePlugin::process( const SampleFrame* _in_buf, SampleFrame* _out_buf )
 			}
 		}
 	}
-
-	return true;
 }
 
 
@@ -566,6 +648,9 @@ bool RemotePlugin::processMessage( const message & _m )
 			break;
 
 		case IdProcessingDone:
+			m_pendingProcessing = std::max(0, m_pendingProcessing - 1);
+			break;
+
 		case IdQuit:
 		default:
 			break;
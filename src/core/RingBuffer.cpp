@@ -120,15 +120,21 @@ void RingBuffer::movePosition( float amount )
 
 void RingBuffer::pop( SampleFrame* dst )
 {
-	if( m_position + m_fpp <= m_size ) // we won't go over the edge so we can just memcpy here
+	pop( dst, m_fpp );
+}
+
+
+void RingBuffer::pop( SampleFrame* dst, f_cnt_t frames )
+{
+	if( m_position + frames <= m_size ) // we won't go over the edge so we can just memcpy here
 	{
-		memcpy( dst, & m_buffer [ m_position ], m_fpp * sizeof( SampleFrame ) );
-		zeroSampleFrames(&m_buffer[m_position], m_fpp);
+		memcpy( dst, & m_buffer [ m_position ], frames * sizeof( SampleFrame ) );
+		zeroSampleFrames(&m_buffer[m_position], frames);
 	}
 	else
 	{
 		f_cnt_t first = m_size - m_position;
-		f_cnt_t second = m_fpp - first;
+		f_cnt_t second = frames - first;
 		
 		memcpy( dst, & m_buffer [ m_position ], first * sizeof( SampleFrame ) );
 		zeroSampleFrames(&m_buffer[m_position], first);
@@ -137,7 +143,7 @@ void RingBuffer::pop( SampleFrame* dst )
 		zeroSampleFrames(m_buffer, second);
 	}
 	
-	m_position = ( m_position + m_fpp ) % m_size;
+	m_position = ( m_position + frames ) % m_size;
 }
 
 
@@ -0,0 +1,121 @@
+/*
+ * ScratchArena.cpp - per-thread temporary buffers for audio processing
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace lmms
+{
+
+namespace
+{
+
+struct Chunk
+{
+	std::unique_ptr<SampleFrame[]> frames;
+	std::size_t size;
+} ;
+
+struct Arena
+{
+	std::vector<Chunk> chunks;
+	std::size_t chunk = 0;
+	std::size_t offset = 0;
+} ;
+
+thread_local Arena t_arena;
+
+} // namespace
+
+
+
+
+ScratchArena::Scope::Scope() :
+	m_chunk( t_arena.chunk ),
+	m_offset( t_arena.offset )
+{
+}
+
+
+
+
+ScratchArena::Scope::~Scope()
+{
+	t_arena.chunk = m_chunk;
+	t_arena.offset = m_offset;
+}
+
+
+
+
+SampleFrame* ScratchArena::frames( std::size_t count )
+{
+	Arena& arena = t_arena;
+	while( arena.chunk < arena.chunks.size() )
+	{
+		Chunk& chunk = arena.chunks[arena.chunk];
+		if( arena.offset + count <= chunk.size )
+		{
+			SampleFrame* buffer = chunk.frames.get() + arena.offset;
+			arena.offset += count;
+			return buffer;
+		}
+		// the rest of this chunk stays unused until the scope ends
+		++arena.chunk;
+		arena.offset = 0;
+	}
+
+	// only happens until the thread has seen its largest demand
+	const std::size_t size = std::max( count, ChunkFrames );
+	arena.chunks.push_back( Chunk{ std::make_unique<SampleFrame[]>( size ), size } );
+	arena.chunk = arena.chunks.size() - 1;
+	arena.offset = count;
+	return arena.chunks.back().frames.get();
+}
+
+
+
+
+void ScratchArena::reserve()
+{
+	Arena& arena = t_arena;
+	if( arena.chunks.empty() )
+	{
+		arena.chunks.push_back( Chunk{ std::make_unique<SampleFrame[]>( ChunkFrames ), ChunkFrames } );
+	}
+}
+
+
+
+
+std::size_t ScratchArena::chunkCount()
+{
+	return t_arena.chunks.size();
+}
+
+
+} // namespace lmms
@@ -30,6 +30,7 @@
 #include "Engine.h"
 #include "MixHelpers.h"
 #include "BufferManager.h"
+#include "Plugin.h"
 
 namespace lmms
 {
@@ -43,12 +44,20 @@ AudioPort::AudioPort( const QString & _name, bool _has_effect_chain,
 	m_nextMixerChannel( 0 ),
 	m_name( "unnamed port" ),
 	m_effects( _has_effect_chain ? new EffectChain( nullptr ) : nullptr ),
+	m_batchProcessor( nullptr ),
+	m_source( nullptr ),
+	m_sourceLatency( 0 ),
 	m_volumeModel( volumeModel ),
 	m_panningModel( panningModel ),
 	m_mutedModel( mutedModel )
 {
 	Engine::audioEngine()->addAudioPort( this );
 	setExtOutputEnabled( true );
+
+	if( Mixer* mixer = Engine::mixer() )
+	{
+		mixer->invalidateLatencyCompensation();
+	}
 }
 
 
@@ -58,7 +67,13 @@ AudioPort::~AudioPort()
 {
 	setExtOutputEnabled( false );
 	Engine::audioEngine()->removeAudioPort( this );
+	Engine::audioEngine()->profiler().removeSource( this );
 	BufferManager::release( m_portBuffer );
+
+	if( Mixer* mixer = Engine::mixer() )
+	{
+		mixer->invalidateLatencyCompensation();
+	}
 }
 
 
@@ -92,6 +107,51 @@ void AudioPort::setName( const QString & _name )
 
 
 
+void AudioPort::setNextMixerChannel( const mix_ch_t _chnl )
+{
+	if( _chnl == m_nextMixerChannel )
+	{
+		return;
+	}
+	m_nextMixerChannel = _chnl;
+
+	if( Mixer* mixer = Engine::mixer() )
+	{
+		mixer->invalidateLatencyCompensation();
+	}
+}
+
+
+
+
+void AudioPort::setSource( const Plugin* source )
+{
+	// the audio thread must be done with the old source before it may be deleted
+	const auto guard = Engine::audioEngine()->requestChangesGuard();
+	m_source = source;
+
+	if( Mixer* mixer = Engine::mixer() )
+	{
+		mixer->invalidateLatencyCompensation();
+	}
+}
+
+
+
+
+f_cnt_t AudioPort::latency() const
+{
+	f_cnt_t latency = m_source ? m_source->latency() : 0;
+	if( m_effects )
+	{
+		latency += m_effects->latency();
+	}
+	return latency;
+}
+
+
+
+
 bool AudioPort::processEffects()
 {
 	if( m_effects )
@@ -105,6 +165,22 @@ bool AudioPort::processEffects()
 
 void AudioPort::doProcessing()
 {
+	// plugins may change their latency at any time, the delays are only
+	// updated outside of the audio thread
+	const f_cnt_t sourceLatency = m_source ? m_source->latency() : 0;
+	if( sourceLatency != m_sourceLatency )
+	{
+		m_sourceLatency = sourceLatency;
+		Engine::mixer()->invalidateLatencyCompensation();
+	}
+
+	// the voices have been rendered even if the port is muted, so their
+	// deferred filters have to advance like the ones of the other voices
+	if( m_batchProcessor )
+	{
+		m_batchProcessor->processBatch( m_playHandles );
+	}
+
 	if( m_mutedModel && m_mutedModel->value() )
 	{
 		return;
@@ -224,10 +300,17 @@ void AudioPort::doProcessing()
 	const bool me = processEffects();
 	if( me || m_bufferUsage )
 	{
+		m_compensation.process( m_portBuffer, m_portBuffer, fpp );
 		Engine::mixer()->mixToChannel( m_portBuffer, m_nextMixerChannel ); 	// send output to mixer
 																			// TODO: improve the flow here - convert to pull model
 		m_bufferUsage = false;
 	}
+	else if( m_compensation.hasTail() )
+	{
+		// the port became silent, but its delayed audio still has to go out
+		m_compensation.drain( m_portBuffer, fpp );
+		Engine::mixer()->mixToChannel( m_portBuffer, m_nextMixerChannel );
+	}
 }
 
 
@@ -30,6 +30,7 @@
 #include <QDebug>
 #include <QtGlobal>
 
+#include "AudioEngineWorkerThread.h"
 #include "Engine.h"
 #include "Lv2Manager.h"
 #include "Lv2Proc.h"
@@ -84,6 +85,15 @@ void Lv2ControlBase::init(Model* meAsModel)
 		m_procs.push_back(std::move(newOne));
 	}
 	m_channelsPerProc = DEFAULT_CHANNELS / m_procs.size();
+
+	unsigned firstChan = 0;
+	for (const auto& c : m_procs)
+	{
+		m_jobs.push_back(std::make_unique<ProcJob>(c.get(), firstChan, m_channelsPerProc));
+		m_jobList.push_back(m_jobs.back().get());
+		firstChan += m_channelsPerProc;
+	}
+
 	linkAllModels();
 }
 
@@ -137,31 +147,26 @@ void Lv2ControlBase::copyModelsToLmms() const
 
 
 
-void Lv2ControlBase::copyBuffersFromLmms(const SampleFrame* buf, fpp_t frames) {
-	unsigned firstChan = 0; // tell the procs which channels they shall read from
-	for (const auto& c : m_procs) 
+void Lv2ControlBase::run(const SampleFrame* in, SampleFrame* out, fpp_t frames)
+{
+	for (const auto& job : m_jobs)
 	{
-		c->copyBuffersFromCore(buf, firstChan, m_channelsPerProc, frames);
-		firstChan += m_channelsPerProc;
+		job->m_in = in;
+		job->m_out = out;
+		job->m_frames = frames;
 	}
-}
-
-
-
 
-void Lv2ControlBase::copyBuffersToLmms(SampleFrame* buf, fpp_t frames) const {
-	unsigned firstChan = 0; // tell the procs which channels they shall write to
-	for (const auto& c : m_procs) {
-		c->copyBuffersToCore(buf, firstChan, m_channelsPerProc, frames);
-		firstChan += m_channelsPerProc;
-	}
+	AudioEngineWorkerThread::processInParallel(m_jobList.data(), m_jobList.size());
 }
 
 
 
 
-void Lv2ControlBase::run(fpp_t frames) {
-	for (const auto& c : m_procs) { c->run(frames); }
+void Lv2ControlBase::ProcJob::doProcessing()
+{
+	if (m_in) { m_proc->copyBuffersFromCore(m_in, m_firstChan, m_channels, m_frames); }
+	m_proc->run(m_frames);
+	m_proc->copyBuffersToCore(m_out, m_firstChan, m_channels, m_frames);
 }
 
 
@@ -213,6 +218,17 @@ bool Lv2ControlBase::hasNoteInput() const
 
 
 
+f_cnt_t Lv2ControlBase::latency() const
+{
+	// the procs run in parallel, the slowest one delays the output
+	f_cnt_t res = 0;
+	for (const auto& c : m_procs) { res = std::max(res, c->latency()); }
+	return res;
+}
+
+
+
+
 void Lv2ControlBase::handleMidiInputEvent(const MidiEvent &event,
 	const TimePos &time, f_cnt_t offset)
 {
@@ -26,6 +26,7 @@
 
 #ifdef LMMS_HAVE_LV2
 
+#include <algorithm>
 #include <cmath>
 #include <lv2/midi/midi.h>
 #include <lv2/atom/atom.h>
@@ -279,12 +280,17 @@ void Lv2Proc::copyModelsFromCore()
 	if(m_midiIn)
 	{
 		LV2_Evbuf_Iterator iter = lv2_evbuf_begin(m_midiIn->m_buf.get());
+		const auto lastFrame = static_cast<uint32_t>(Engine::audioEngine()->framesPerPeriod() - 1);
+		uint32_t lastStamp = 0;
 		// MIDI events waiting to go to the plugin?
 		while(m_midiInputReader.read_space() > 0)
 		{
 			const MidiInputEvent ev = m_midiInputReader.read(1)[0];
-			uint32_t atomStamp =
-				ev.time.frames(Engine::framesPerTick()) + ev.offset;
+			// the offset is the position in the current period (the time
+			// is the same position in ticks); atom sequences must be sorted
+			const uint32_t atomStamp = std::max(lastStamp,
+				std::min(static_cast<uint32_t>(ev.offset), lastFrame));
+			lastStamp = atomStamp;
 			uint32_t type = Engine::getLv2Manager()->
 				uridCache()[Lv2UridCache::Id::midi_MidiEvent];
 			auto buf = std::array<uint8_t, 4>{};
@@ -497,6 +503,17 @@ bool Lv2Proc::hasNoteInput() const
 
 
 
+f_cnt_t Lv2Proc::latency() const
+{
+	// the plugin writes the value when it runs
+	return m_latencyPort
+		? static_cast<f_cnt_t>(std::max(0.f, m_latencyPort->m_val))
+		: 0;
+}
+
+
+
+
 void Lv2Proc::initMOptions()
 {
 	/*
@@ -738,6 +755,12 @@ void Lv2Proc::createPorts()
 					amo);
 				m_proc->addModel(amo, ctrl.uri());
 			}
+			else if (ctrl.m_flow == Lv2Ports::Flow::Output &&
+				lilv_port_has_property(m_proc->m_plugin, ctrl.m_port,
+					uri(LV2_CORE__reportsLatency).get()))
+			{
+				m_proc->m_latencyPort = &ctrl;
+			}
 		}
 
 		void visit(Lv2Ports::Audio& audio) override
@@ -23,11 +23,15 @@
  */
 
 #include "MidiAlsaSeq.h"
+#include "AudioEngine.h"
 #include "ConfigManager.h"
 #include "Engine.h"
 #include "Song.h"
 #include "MidiPort.h"
 
+#include <algorithm>
+#include <cstdint>
+
 
 #ifdef LMMS_HAVE_ALSA
 
@@ -275,6 +279,22 @@ void MidiAlsaSeq::applyPortMode( MidiPort * _port )
 							caps[i],
 						SND_SEQ_PORT_TYPE_MIDI_GENERIC |
 						SND_SEQ_PORT_TYPE_APPLICATION );
+
+				// let the sequencer stamp incoming events with the
+				// real time of our queue, see eventTimestamp()
+				if( i == 0 && m_portIDs[_port][i] >= 0 )
+				{
+					snd_seq_port_info_t * port_info;
+					snd_seq_port_info_malloc( &port_info );
+					snd_seq_get_port_info( m_seqHandle, m_portIDs[_port][i],
+									port_info );
+					snd_seq_port_info_set_timestamping( port_info, 1 );
+					snd_seq_port_info_set_timestamp_real( port_info, 1 );
+					snd_seq_port_info_set_timestamp_queue( port_info, m_queueID );
+					snd_seq_set_port_info( m_seqHandle, m_portIDs[_port][i],
+									port_info );
+					snd_seq_port_info_free( port_info );
+				}
 				continue;
 			}
 			snd_seq_port_info_t * port_info;
@@ -501,8 +521,15 @@ void MidiAlsaSeq::run()
 				qCritical( "error while fetching MIDI event from sequencer" );
 				break;
 			}
+			const std::int64_t timestamp = eventTimestamp( ev );
 			m_seqMutex.unlock();
 
+			const auto stamped = [timestamp]( MidiEvent event )
+			{
+				event.setTimestamp( timestamp );
+				return event;
+			};
+
 			snd_seq_addr_t * source = nullptr;
 			MidiPort * dest = nullptr;
 			for( int i = 0; i < m_portIDs.size(); ++i )
@@ -527,66 +554,66 @@ void MidiAlsaSeq::run()
 			switch( ev->type )
 			{
 				case SND_SEQ_EVENT_NOTEON:
-					dest->processInEvent( MidiEvent( MidiNoteOn,
+					dest->processInEvent( stamped( MidiEvent( MidiNoteOn,
 								ev->data.note.channel,
 								ev->data.note.note,
 								ev->data.note.velocity,
 								source
-								),
-							TimePos( ev->time.tick ) );
+								) ),
+							TimePos() );
 					break;
 
 				case SND_SEQ_EVENT_NOTEOFF:
-					dest->processInEvent( MidiEvent( MidiNoteOff,
+					dest->processInEvent( stamped( MidiEvent( MidiNoteOff,
 								ev->data.note.channel,
 								ev->data.note.note,
 								ev->data.note.velocity,
 								source
-								),
-							TimePos( ev->time.tick) );
+								) ),
+							TimePos() );
 					break;
 
 				case SND_SEQ_EVENT_KEYPRESS:
-					dest->processInEvent( MidiEvent(
+					dest->processInEvent( stamped( MidiEvent(
 									MidiKeyPressure,
 								ev->data.note.channel,
 								ev->data.note.note,
 								ev->data.note.velocity,
 								source
-								), TimePos() );
+								) ), TimePos() );
 					break;
 
 				case SND_SEQ_EVENT_CONTROLLER:
-					dest->processInEvent( MidiEvent(
+					dest->processInEvent( stamped( MidiEvent(
 							MidiControlChange,
 							ev->data.control.channel,
 							ev->data.control.param,
-							ev->data.control.value, source ),
+							ev->data.control.value, source ) ),
 									TimePos() );
 					break;
 
 				case SND_SEQ_EVENT_PGMCHANGE:
-					dest->processInEvent( MidiEvent(
+					dest->processInEvent( stamped( MidiEvent(
 							MidiProgramChange,
 							ev->data.control.channel,
 							ev->data.control.value,	0,
-							source ),
+							source ) ),
 								TimePos() );
 					break;
 
 				case SND_SEQ_EVENT_CHANPRESS:
-					dest->processInEvent( MidiEvent(
+					dest->processInEvent( stamped( MidiEvent(
 								MidiChannelPressure,
 							ev->data.control.channel,
 							ev->data.control.param,
-							ev->data.control.value, source ),
+							ev->data.control.value, source ) ),
 									TimePos() );
 					break;
 
 				case SND_SEQ_EVENT_PITCHBEND:
-					dest->processInEvent( MidiEvent( MidiPitchBend,
+					dest->processInEvent( stamped( MidiEvent( MidiPitchBend,
 							ev->data.control.channel,
-							ev->data.control.value + 8192, 0, source ),
+							ev->data.control.value + 8192, 0, source ) ),
 									TimePos() );
 					break;
 
@@ -615,6 +642,32 @@ void MidiAlsaSeq::run()
 
 
 
+std::int64_t MidiAlsaSeq::eventTimestamp( const snd_seq_event_t * _ev )
+{
+	if( ( _ev->flags & SND_SEQ_TIME_STAMP_MASK ) != SND_SEQ_TIME_STAMP_REAL )
+	{
+		return 0;
+	}
+
+	// the age of the event is the difference to the current real time of
+	// the queue, which is independent of the clock used by the audio engine
+	snd_seq_queue_status_t * status;
+	snd_seq_queue_status_alloca( &status );
+	if( snd_seq_get_queue_status( m_seqHandle, m_queueID, status ) < 0 )
+	{
+		return 0;
+	}
+	const snd_seq_real_time_t * now = snd_seq_queue_status_get_real_time( status );
+	const std::int64_t age =
+		( static_cast<std::int64_t>( now->tv_sec ) - _ev->time.time.tv_sec ) * 1000000 +
+		( static_cast<std::int64_t>( now->tv_nsec ) - _ev->time.time.tv_nsec ) / 1000;
+
+	return AudioEngine::midiInputTime() - std::max<std::int64_t>( 0, age );
+}
+
+
+
+
 void MidiAlsaSeq::changeQueueTempo( bpm_t _bpm )
 {
 	m_seqMutex.lock();
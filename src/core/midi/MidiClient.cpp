@@ -238,6 +238,7 @@ void MidiClientRaw::parseData( const unsigned char c )
 
 void MidiClientRaw::processParsedEvent()
 {
+	m_midiParseData.m_midiEvent.setTimestamp(m_timestamp);
 	for (const auto& midiPort : m_midiPorts)
 	{
 		midiPort->processInEvent(m_midiParseData.m_midiEvent);
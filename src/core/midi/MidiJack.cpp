@@ -27,6 +27,7 @@
 #ifdef LMMS_HAVE_JACK
 
 #include <QMessageBox>
+#include <algorithm>
 
 #include "AudioEngine.h"
 #include "AudioJack.h"
@@ -184,6 +185,12 @@ void MidiJack::JackMidiRead(jack_nframes_t nframes)
 	jack_nframes_t event_index = 0;
 	jack_nframes_t event_count = jack_midi_get_event_count(port_buf);
 
+	// the events of this cycle have been received during the previous one,
+	// convert their frame times to the clock of the audio engine
+	const jack_nframes_t cycleStart = jack_last_frame_time(jackClient());
+	const jack_time_t jackNow = jack_get_time();
+	const std::int64_t now = AudioEngine::midiInputTime();
+
 	int rval = jack_midi_event_get(&in_event, port_buf, 0);
 	if (rval == 0 /* 0 = success */)
 	{
@@ -191,6 +198,9 @@ void MidiJack::JackMidiRead(jack_nframes_t nframes)
 		{
 			while((in_event.time == i) && (event_index < event_count))
 			{
+				const jack_time_t received = jack_frames_to_time(jackClient(), cycleStart + in_event.time - nframes);
+				setTimestamp(now - std::max<std::int64_t>(0, static_cast<std::int64_t>(jackNow - received)));
+
 				// lmms is setup to parse bytes coming from a device
 				// parse it byte by byte as it expects
 				for (unsigned int b = 0; b < in_event.size; b++)
@@ -26,6 +26,8 @@
 #include <QDomElement>
 
 #include "MidiPort.h"
+#include "AudioEngine.h"
+#include "Engine.h"
 #include "MidiClient.h"
 #include "MidiDummy.h"
 #include "MidiEventProcessor.h"
@@ -63,7 +65,8 @@ MidiPort::MidiPort( const QString& name,
 	m_outputProgramModel( 1, 1, MidiProgramCount, this, tr( "Output MIDI program" ) ),
 	m_baseVelocityModel( MidiMaxVelocity/2, 1, MidiMaxVelocity, this, tr( "Base velocity" ) ),
 	m_readableModel( false, this, tr( "Receive MIDI-events" ) ),
-	m_writableModel( false, this, tr( "Send MIDI-events" ) )
+	m_writableModel( false, this, tr( "Send MIDI-events" ) ),
+	m_inputPending( false )
 {
 	m_midiClient->addPort( this );
 
@@ -104,6 +107,11 @@ MidiPort::~MidiPort()
 
 	// and finally unregister ourself
 	m_midiClient->removePort( this );
+
+	if( m_inputPending )
+	{
+		Engine::audioEngine()->dequeueMidiInput( this );
+	}
 }
 
 
@@ -149,6 +157,24 @@ void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
 			}
 		}
 
+		// system exclusive data is owned by the MIDI client, so it can't be queued
+		if( m_inputQueue && inEvent.type() != MidiSysEx )
+		{
+			// prefer the time at which the MIDI client received the event
+			const auto arrival = inEvent.timestamp() != 0 ? inEvent.timestamp() : AudioEngine::midiInputTime();
+			const auto queued = QueuedInEvent{ inEvent, time, arrival };
+			if( m_inputQueue->write( &queued, 1 ) != 1 )
+			{
+				qWarning( "MidiPort: input queue is full, dropping MIDI event" );
+				return;
+			}
+			if( !m_inputPending.exchange( true ) )
+			{
+				Engine::audioEngine()->queueMidiInput( this );
+			}
+			return;
+		}
+
 		m_midiEventProcessor->processInEvent( inEvent, time );
 	}
 }
@@ -156,6 +182,39 @@ void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
 
 
 
+void MidiPort::enableInputQueue()
+{
+	if( !m_inputQueue )
+	{
+		m_inputQueue = std::make_unique<LocklessRingBuffer<QueuedInEvent>>( InputQueueSize );
+		m_inputQueueReader = std::make_unique<LocklessRingBufferReader<QueuedInEvent>>( *m_inputQueue );
+	}
+}
+
+
+
+
+void MidiPort::processQueuedInEvents()
+{
+	// events queued from now on have to queue the port again
+	m_inputPending = false;
+
+	AudioEngine* audioEngine = Engine::audioEngine();
+	while( !m_inputQueueReader->empty() )
+	{
+		const auto events = m_inputQueueReader->read_max( InputQueueSize );
+		for( std::size_t i = 0; i < events.size(); ++i )
+		{
+			const QueuedInEvent& queued = events[i];
+			m_midiEventProcessor->processInEvent( queued.event, queued.time,
+								audioEngine->midiInputOffset( queued.arrival ) );
+		}
+	}
+}
+
+
+
+
 void MidiPort::processOutEvent( const MidiEvent& event, const TimePos& time )
 {
 	// When output is enabled, route midi events if the selected channel matches
@@ -30,9 +30,11 @@
 #include <QPainter>
 
 #include "EffectView.h"
+#include "AudioEngine.h"
 #include "DummyEffect.h"
 #include "CaptionMenu.h"
 #include "embed.h"
+#include "Engine.h"
 #include "GuiApplication.h"
 #include "gui_templates.h"
 #include "Knob.h"
@@ -205,6 +207,16 @@ void EffectView::contextMenuEvent( QContextMenuEvent * )
 						tr( "Move &down" ),
 						this, SLOT(moveDown()));
 	contextMenu->addSeparator();
+	QAction* expendableAction = contextMenu->addAction(tr("&Expendable under CPU overload"));
+	expendableAction->setCheckable(true);
+	expendableAction->setChecked(effect()->m_expendableModel.value());
+	connect(expendableAction, &QAction::toggled, [this](bool checked) { effect()->m_expendableModel.setValue(checked); });
+	if (const auto latency = effect()->latency(); latency > 0)
+	{
+		const auto ms = 1000.f * latency / Engine::audioEngine()->outputSampleRate();
+		contextMenu->addAction(tr("Latency: %1 frames (%2 ms)").arg(latency).arg(ms, 0, 'f', 1))->setEnabled(false);
+	}
+	contextMenu->addSeparator();
 	contextMenu->addAction( embed::getIconPixmap( "cancel" ),
 						tr( "&Remove this plugin" ),
 						this, SLOT(deletePlugin()));
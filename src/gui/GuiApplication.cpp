@@ -37,6 +37,7 @@
 #include "MicrotunerConfig.h"
 #include "PatternEditor.h"
 #include "PianoRoll.h"
+#include "ProfilerView.h"
 #include "ProjectNotes.h"
 #include "SongEditor.h"
 
@@ -163,6 +164,10 @@ GuiApplication::GuiApplication()
 	m_microtunerConfig = new MicrotunerConfig;
 	connect(m_microtunerConfig, SIGNAL(destroyed(QObject*)), this, SLOT(childDestroyed(QObject*)));
 
+	displayInitProgress(tr("Preparing CPU profiler"));
+	m_profilerView = new ProfilerView;
+	connect(m_profilerView, SIGNAL(destroyed(QObject*)), this, SLOT(childDestroyed(QObject*)));
+
 	displayInitProgress(tr("Preparing pattern editor"));
 	m_patternEditor = new PatternEditorWindow(Engine::patternStore());
 	connect(m_patternEditor, SIGNAL(destroyed(QObject*)), this, SLOT(childDestroyed(QObject*)));
@@ -233,6 +238,10 @@ void GuiApplication::childDestroyed(QObject *obj)
 	{
 		m_microtunerConfig = nullptr;
 	}
+	else if (obj == m_profilerView)
+	{
+		m_profilerView = nullptr;
+	}
 	else if (obj == m_controllerRackView)
 	{
 		m_controllerRackView = nullptr;
@@ -55,6 +55,7 @@
 #include "PluginBrowser.h"
 #include "PluginFactory.h"
 #include "PluginView.h"
+#include "ProfilerView.h"
 #include "ProjectJournal.h"
 #include "ProjectNotes.h"
 #include "ProjectRenderer.h"
@@ -1053,6 +1054,13 @@ void MainWindow::toggleMicrotunerWin()
 
 
 
+void MainWindow::toggleProfilerWin()
+{
+	toggleWindow(getGUI()->profilerView());
+}
+
+
+
 
 void MainWindow::updateViewMenu()
 {
@@ -1089,6 +1097,10 @@ void MainWindow::updateViewMenu()
 			      tr( "Project Notes" ) + "\tCtrl+7",
 			      this, SLOT(toggleProjectNotesWin())
 		);
+	m_viewMenu->addAction(embed::getIconPixmap("setup_performance"),
+				tr("CPU Profiler"),
+				this, SLOT(toggleProfilerWin())
+		);
 
 	m_viewMenu->addSeparator();
 	
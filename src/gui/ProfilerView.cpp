@@ -0,0 +1,335 @@
+/*
+ * ProfilerView.cpp - window showing the DSP load of single tracks, effects and
+ *                    mixer channels
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ProfilerView.h"
+
+#include <cmath>
+#include <QCloseEvent>
+#include <QFile>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMdiSubWindow>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSet>
+#include <QTableWidget>
+#include <QTextStream>
+#include <QVBoxLayout>
+
+#include "AudioEngine.h"
+#include "Effect.h"
+#include "EffectChain.h"
+#include "embed.h"
+#include "Engine.h"
+#include "FileDialog.h"
+#include "GuiApplication.h"
+#include "InstrumentTrack.h"
+#include "MainWindow.h"
+#include "Mixer.h"
+#include "PatternStore.h"
+#include "SampleTrack.h"
+#include "Song.h"
+
+namespace lmms::gui
+{
+
+namespace
+{
+
+enum Column
+{
+	SourceColumn,
+	TypeColumn,
+	LoadColumn,
+	PeakColumn,
+	CallsColumn,
+	ColumnCount
+};
+
+QString escapeJson(const QString& text)
+{
+	auto escaped = QString{};
+	escaped.reserve(text.size());
+	for (const auto c : text)
+	{
+		if (c == QLatin1Char('"') || c == QLatin1Char('\\')) { escaped += QLatin1Char('\\'); escaped += c; }
+		else if (c.unicode() < 0x20) { escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')); }
+		else { escaped += c; }
+	}
+	return escaped;
+}
+
+} // namespace
+
+
+ProfilerView::ProfilerView() :
+	QWidget(),
+	m_table(new QTableWidget(0, ColumnCount, this)),
+	m_statusLabel(new QLabel(this)),
+	m_traceButton(new QPushButton(tr("Record trace"), this)),
+	m_updateTimer(this)
+{
+	setWindowIcon(embed::getIconPixmap("setup_performance"));
+	setWindowTitle(tr("CPU Profiler"));
+
+	m_table->setHorizontalHeaderLabels({tr("Source"), tr("Type"), tr("DSP %"), tr("Peak (µs)"), tr("Calls")});
+	m_table->horizontalHeader()->setSectionResizeMode(SourceColumn, QHeaderView::Stretch);
+	m_table->verticalHeader()->hide();
+	m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+	m_table->setSortingEnabled(true);
+	m_table->sortByColumn(LoadColumn, Qt::DescendingOrder);
+
+	m_traceButton->setToolTip(tr("Record the timing of every single job and save it "
+		"as trace file, which can be opened in chrome://tracing or Perfetto"));
+	connect(m_traceButton, SIGNAL(clicked()), this, SLOT(toggleTrace()));
+
+	auto bottomLayout = new QHBoxLayout;
+	bottomLayout->addWidget(m_statusLabel, 1);
+	bottomLayout->addWidget(m_traceButton);
+
+	auto layout = new QVBoxLayout(this);
+	layout->addWidget(m_table);
+	layout->addLayout(bottomLayout);
+
+	connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+
+	QMdiSubWindow* subWin = getGUI()->mainWindow()->addWindowedWidget(this);
+	subWin->setAttribute(Qt::WA_DeleteOnClose, false);
+	subWin->setMinimumSize(300, 200);
+	subWin->hide();
+}
+
+
+
+
+void ProfilerView::showEvent(QShowEvent* se)
+{
+	Engine::audioEngine()->profiler().setSourceProfiling(true);
+	m_updateTimer.start(500);
+	QWidget::showEvent(se);
+}
+
+
+
+
+void ProfilerView::hideEvent(QHideEvent* he)
+{
+	auto& profiler = Engine::audioEngine()->profiler();
+	// keep measuring while a trace is being recorded
+	if (!profiler.isTracing()) { profiler.setSourceProfiling(false); }
+	m_updateTimer.stop();
+	QWidget::hideEvent(he);
+}
+
+
+
+
+void ProfilerView::closeEvent(QCloseEvent* ce)
+{
+	if (parentWidget()) { parentWidget()->hide(); }
+	else { hide(); }
+	ce->ignore();
+}
+
+
+
+
+void ProfilerView::updateStatistics()
+{
+	const auto& profiler = Engine::audioEngine()->profiler();
+	const auto statistics = profiler.sourceStatistics();
+	const auto names = sourceNames();
+
+	m_table->setSortingEnabled(false);
+	m_table->setRowCount(0);
+	for (const auto& entry : statistics)
+	{
+		// sources which have been deleted in the meantime
+		const auto name = names.find(entry.source);
+		if (name == names.end()) { continue; }
+
+		const auto row = m_table->rowCount();
+		m_table->insertRow(row);
+
+		auto setItem = [this, row](int column, const QVariant& value)
+		{
+			auto item = new QTableWidgetItem;
+			item->setData(Qt::DisplayRole, value);
+			m_table->setItem(row, column, item);
+		};
+		setItem(SourceColumn, *name);
+		setItem(TypeColumn, typeName(entry.type));
+		setItem(LoadColumn, std::round(entry.load * 10.f) / 10.f);
+		setItem(PeakColumn, entry.peak);
+		setItem(CallsColumn, entry.callsPerPeriod);
+	}
+	m_table->setSortingEnabled(true);
+
+	auto status = tr("DSP total: %1%").arg(Engine::audioEngine()->cpuLoad());
+	if (profiler.lostEvents() > 0) { status += " - " + tr("Lost events: %1").arg(profiler.lostEvents()); }
+	m_statusLabel->setText(status);
+}
+
+
+
+
+void ProfilerView::toggleTrace()
+{
+	auto& profiler = Engine::audioEngine()->profiler();
+	if (!profiler.isTracing())
+	{
+		profiler.setSourceProfiling(true);
+		profiler.startTrace();
+		m_traceButton->setText(tr("Stop and save trace"));
+		return;
+	}
+
+	const auto events = profiler.stopTrace();
+	if (!isVisible()) { profiler.setSourceProfiling(false); }
+	m_traceButton->setText(tr("Record trace"));
+
+	const auto fileName = FileDialog::getSaveFileName(this, tr("Save trace"), QString{},
+		tr("Trace files (*.json)"));
+	if (fileName.isEmpty()) { return; }
+
+	if (!exportTrace(events, fileName))
+	{
+		QMessageBox::warning(this, tr("Could not save trace"),
+			tr("Could not open %1 for writing.").arg(fileName));
+	}
+}
+
+
+
+
+QHash<const void*, QString> ProfilerView::sourceNames() const
+{
+	auto names = QHash<const void*, QString>{};
+
+	auto addEffects = [&names](const EffectChain* chain, const QString& owner)
+	{
+		for (const auto effect : chain->effects())
+		{
+			names.insert(effect, owner + " > " + effect->displayName());
+		}
+	};
+
+	auto addTracks = [&](const TrackContainer::TrackList& tracks)
+	{
+		for (const auto track : tracks)
+		{
+			if (const auto instrumentTrack = dynamic_cast<InstrumentTrack*>(track))
+			{
+				names.insert(instrumentTrack->audioPort(),
+					QString("%1 (%2)").arg(track->name(), instrumentTrack->instrumentName()));
+				addEffects(instrumentTrack->audioPort()->effects(), track->name());
+			}
+			else if (const auto sampleTrack = dynamic_cast<SampleTrack*>(track))
+			{
+				names.insert(sampleTrack->audioPort(), track->name());
+				addEffects(sampleTrack->audioPort()->effects(), track->name());
+			}
+		}
+	};
+
+	addTracks(Engine::getSong()->tracks());
+	addTracks(Engine::patternStore()->tracks());
+
+	const auto mixer = Engine::mixer();
+	for (mix_ch_t i = 0; i < mixer->numChannels(); ++i)
+	{
+		const auto channel = mixer->mixerChannel(i);
+		const auto name = i == 0
+			? tr("Master")
+			: channel->m_name.isEmpty() ? tr("Channel %1").arg(i) : channel->m_name;
+		names.insert(channel, name);
+		addEffects(&channel->m_fxChain, name);
+	}
+
+	return names;
+}
+
+
+
+
+QString ProfilerView::typeName(AudioEngineProfiler::SourceType type)
+{
+	switch (type)
+	{
+		case AudioEngineProfiler::SourceType::Period: return tr("Period");
+		case AudioEngineProfiler::SourceType::Instrument: return tr("Instrument");
+		case AudioEngineProfiler::SourceType::Effect: return tr("Effect");
+		case AudioEngineProfiler::SourceType::MixerChannel: return tr("Mixer channel");
+	}
+	return QString{};
+}
+
+
+
+
+bool ProfilerView::exportTrace(const std::vector<AudioEngineProfiler::SourceEvent>& events,
+	const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) { return false; }
+
+	auto names = sourceNames();
+	for (auto& name : names) { name = escapeJson(name); }
+
+	// Trace Event Format, understood by chrome://tracing and Perfetto
+	QTextStream out(&file);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	auto threads = QSet<int>{};
+	for (const auto& event : events)
+	{
+		threads.insert(event.thread);
+
+		const auto name = names.value(event.source);
+		out << "{\"name\":\"" << (event.type == AudioEngineProfiler::SourceType::Period
+				? QStringLiteral("Period")
+				: name.isEmpty() ? tr("Deleted %1").arg(typeName(event.type)) : name)
+			<< "\",\"cat\":\"" << typeName(event.type)
+			<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+			<< ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "},\n";
+	}
+
+	for (const auto thread : threads)
+	{
+		const auto threadName = static_cast<std::size_t>(thread) == AudioEngineProfiler::MaxThreads
+			? tr("Periods")
+			: tr("Audio thread %1").arg(thread);
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+			<< ",\"args\":{\"name\":\"" << threadName << "\"}},\n";
+	}
+
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"LMMS\"}}\n]}\n";
+	return out.status() == QTextStream::Ok;
+}
+
+
+} // namespace lmms::gui
@@ -196,18 +196,31 @@ InstrumentTrackWindow::InstrumentTrackWindow( InstrumentTrackView * _itv ) :
 	basicControlsLayout->setAlignment( m_pitchRangeLabel, labelAlignment );
 
 
-	basicControlsLayout->setColumnStretch(5, 1);
+	// set up spinbox for the polyphony budget
+	m_maxVoicesSpinBox = new LcdSpinBox(3, nullptr, tr("Maximum voices"));
+	m_maxVoicesSpinBox->setToolTip(tr("Maximum number of voices of this track (0 = unlimited)"));
+
+	basicControlsLayout->addWidget(m_maxVoicesSpinBox, 0, 5);
+	basicControlsLayout->setAlignment(m_maxVoicesSpinBox, widgetAlignment);
+
+	label = new QLabel(tr("VOICES"), this);
+	label->setStyleSheet(labelStyleSheet);
+	basicControlsLayout->addWidget(label, 1, 5);
+	basicControlsLayout->setAlignment(label, labelAlignment);
+
+
+	basicControlsLayout->setColumnStretch(6, 1);
 
 
 	// setup spinbox for selecting Mixer-channel
 	m_mixerChannelNumber = new MixerChannelLcdSpinBox(2, nullptr, tr("Mixer channel"), m_itv);
 
-	basicControlsLayout->addWidget( m_mixerChannelNumber, 0, 6 );
+	basicControlsLayout->addWidget( m_mixerChannelNumber, 0, 7 );
 	basicControlsLayout->setAlignment( m_mixerChannelNumber, widgetAlignment );
 
 	label = new QLabel( tr( "CHANNEL" ), this );
 	label->setStyleSheet( labelStyleSheet );
-	basicControlsLayout->addWidget( label, 1, 6);
+	basicControlsLayout->addWidget( label, 1, 7);
 	basicControlsLayout->setAlignment( label, labelAlignment );
 
 	auto saveSettingsBtn = new QPushButton(embed::getIconPixmap("project_save"), QString());
@@ -217,11 +230,11 @@ InstrumentTrackWindow::InstrumentTrackWindow( InstrumentTrackView * _itv ) :
 
 	saveSettingsBtn->setToolTip(tr("Save current instrument track settings in a preset file"));
 
-	basicControlsLayout->addWidget( saveSettingsBtn, 0, 7 );
+	basicControlsLayout->addWidget( saveSettingsBtn, 0, 8 );
 
 	label = new QLabel( tr( "SAVE" ), this );
 	label->setStyleSheet( labelStyleSheet );
-	basicControlsLayout->addWidget( label, 1, 7);
+	basicControlsLayout->addWidget( label, 1, 8);
 	basicControlsLayout->setAlignment( label, labelAlignment );
 
 	generalSettingsLayout->addLayout( basicControlsLayout );
@@ -348,6 +361,7 @@ void InstrumentTrackWindow::modelChanged()
 	m_volumeKnob->setModel( &m_track->m_volumeModel );
 	m_panningKnob->setModel( &m_track->m_panningModel );
 	m_mixerChannelNumber->setModel( &m_track->m_mixerChannelModel );
+	m_maxVoicesSpinBox->setModel(&m_track->m_maxVoicesModel);
 	m_pianoView->setModel( &m_track->m_piano );
 
 	if (m_track->instrument() && m_track->instrument()->isBendable())
@@ -31,11 +31,13 @@
 #include <QLayout>
 #include <QLineEdit>
 #include <QScrollArea>
+#include <QSpinBox>
 
 #include "AudioEngine.h"
 #include "debug.h"
 #include "embed.h"
 #include "Engine.h"
+#include "EnvelopeAndLfoParameters.h"
 #include "FileDialog.h"
 #include "MainWindow.h"
 #include "MidiSetupWidget.h"
@@ -140,6 +142,24 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 			"ui", "vstalwaysontop").toInt()),
 	m_disableAutoQuit(ConfigManager::inst()->value(
 			"ui", "disableautoquit", "1").toInt()),
+	m_remotePipelined(ConfigManager::inst()->value(
+			"audioengine", "remotepipelined", "0").toInt()),
+	m_busAffinity(ConfigManager::inst()->value(
+			"audioengine", "busaffinity", "0").toInt()),
+	m_envControlInterval(ConfigManager::inst()->value(
+			"audioengine", "envcontrolinterval", "1").toInt()),
+	m_stealVoices(ConfigManager::inst()->value(
+			"audioengine", "stealvoices", "0").toInt()),
+	m_stealQuietest(ConfigManager::inst()->value(
+			"audioengine", "stealmode") == "quietest"),
+	m_maxVoices(ConfigManager::inst()->value(
+			"audioengine", "maxvoices", "0").toInt()),
+	m_degradeSamples(ConfigManager::inst()->value(
+			"audioengine", "degradesamples", "0").toInt()),
+	m_bypassExpendable(ConfigManager::inst()->value(
+			"audioengine", "bypassexpendable", "0").toInt()),
+	m_flightRecorder(ConfigManager::inst()->value(
+			"audioengine", "flightrecorder", "1").toInt()),
 	m_NaNHandler(ConfigManager::inst()->value(
 			"app", "nanhandler", "1").toInt()),
 	m_bufferSize(ConfigManager::inst()->value(
@@ -448,11 +468,54 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 	addCheckBox(tr("Keep effects running even without input"), pluginsBox, pluginsLayout,
 		m_disableAutoQuit, SLOT(toggleDisableAutoQuit(bool)), false);
 
+	addCheckBox(tr("Run VST and ZynAddSubFX plugins pipelined (adds one buffer of latency)"), pluginsBox, pluginsLayout,
+		m_remotePipelined, SLOT(toggleRemotePipelined(bool)), false);
+
+	addCheckBox(tr("Keep heavy mixer channels on the same CPU core (requires restart)"), pluginsBox, pluginsLayout,
+		m_busAffinity, SLOT(toggleBusAffinity(bool)), false);
+
+	auto envControlIntervalLayout = new QHBoxLayout();
+	envControlIntervalLayout->addWidget(new QLabel(tr("Envelope and LFO control interval (frames):"), pluginsBox));
+	auto envControlIntervalSpinBox = new QSpinBox(pluginsBox);
+	envControlIntervalSpinBox->setRange(0, 256);
+	envControlIntervalSpinBox->setSpecialValueText(tr("Automatic"));
+	envControlIntervalSpinBox->setValue(m_envControlInterval);
+	connect(envControlIntervalSpinBox, SIGNAL(valueChanged(int)), this, SLOT(setEnvControlInterval(int)));
+	envControlIntervalLayout->addWidget(envControlIntervalSpinBox);
+	pluginsLayout->addLayout(envControlIntervalLayout);
+
+
+	// CPU overload group
+	QGroupBox * overloadBox = new QGroupBox(tr("CPU overload"), performance_w);
+	QVBoxLayout * overloadLayout = new QVBoxLayout(overloadBox);
+
+	addCheckBox(tr("Steal voices instead of dropping new notes"), overloadBox, overloadLayout,
+		m_stealVoices, SLOT(toggleStealVoices(bool)), false);
+	addCheckBox(tr("Steal the quietest instead of the oldest voices"), overloadBox, overloadLayout,
+		m_stealQuietest, SLOT(toggleStealQuietest(bool)), false);
+	addCheckBox(tr("Lower sample interpolation quality under load"), overloadBox, overloadLayout,
+		m_degradeSamples, SLOT(toggleDegradeSamples(bool)), false);
+	addCheckBox(tr("Bypass expendable effects under load"), overloadBox, overloadLayout,
+		m_bypassExpendable, SLOT(toggleBypassExpendable(bool)), false);
+	addCheckBox(tr("Save engine timings to the working directory on buffer underruns"), overloadBox, overloadLayout,
+		m_flightRecorder, SLOT(toggleFlightRecorder(bool)), false);
+
+	auto maxVoicesLayout = new QHBoxLayout();
+	maxVoicesLayout->addWidget(new QLabel(tr("Maximum number of voices:"), overloadBox));
+	auto maxVoicesSpinBox = new QSpinBox(overloadBox);
+	maxVoicesSpinBox->setRange(0, static_cast<int>(PlayHandle::MaxNumber));
+	maxVoicesSpinBox->setSpecialValueText(tr("Unlimited"));
+	maxVoicesSpinBox->setValue(m_maxVoices);
+	connect(maxVoicesSpinBox, SIGNAL(valueChanged(int)), this, SLOT(setMaxVoices(int)));
+	maxVoicesLayout->addWidget(maxVoicesSpinBox);
+	overloadLayout->addLayout(maxVoicesLayout);
+
 
 	// Performance layout ordering.
 	performance_layout->addWidget(autoSaveBox);
 	performance_layout->addWidget(uiFxBox);
 	performance_layout->addWidget(pluginsBox);
+	performance_layout->addWidget(overloadBox);
 	performance_layout->addStretch();
 
 
@@ -959,6 +1022,24 @@ void SetupDialog::accept()
 					QString::number(m_vstAlwaysOnTop));
 	ConfigManager::inst()->setValue("ui", "disableautoquit",
 					QString::number(m_disableAutoQuit));
+	ConfigManager::inst()->setValue("audioengine", "remotepipelined",
+					QString::number(m_remotePipelined));
+	ConfigManager::inst()->setValue("audioengine", "busaffinity",
+					QString::number(m_busAffinity));
+	ConfigManager::inst()->setValue("audioengine", "envcontrolinterval",
+					QString::number(m_envControlInterval));
+	ConfigManager::inst()->setValue("audioengine", "stealvoices",
+					QString::number(m_stealVoices));
+	ConfigManager::inst()->setValue("audioengine", "stealmode",
+					m_stealQuietest ? "quietest" : "oldest");
+	ConfigManager::inst()->setValue("audioengine", "maxvoices",
+					QString::number(m_maxVoices));
+	ConfigManager::inst()->setValue("audioengine", "degradesamples",
+					QString::number(m_degradeSamples));
+	ConfigManager::inst()->setValue("audioengine", "bypassexpendable",
+					QString::number(m_bypassExpendable));
+	ConfigManager::inst()->setValue("audioengine", "flightrecorder",
+					QString::number(m_flightRecorder));
 	ConfigManager::inst()->setValue("audioengine", "audiodev",
 					m_audioIfaceNames[m_audioInterfaces->currentText()]);
 	ConfigManager::inst()->setValue("app", "nanhandler",
@@ -996,6 +1077,14 @@ void SetupDialog::accept()
 		it.value()->saveSettings();
 	}
 	ConfigManager::inst()->saveConfigFile();
+
+	// The overload and envelope settings don't require a restart
+	{
+		const auto guard = Engine::audioEngine()->requestChangesGuard();
+		Engine::audioEngine()->overloadManager().loadSettings();
+		if (const auto lfos = EnvelopeAndLfoParameters::instances()) { lfos->updateControlInterval(); }
+	}
+	Engine::audioEngine()->loadFlightRecorderSettings();
 }
 
 
@@ -1165,6 +1254,60 @@ void SetupDialog::toggleDisableAutoQuit(bool enabled)
 	m_disableAutoQuit = enabled;
 }
 
+
+void SetupDialog::toggleRemotePipelined(bool enabled)
+{
+	m_remotePipelined = enabled;
+}
+
+
+void SetupDialog::toggleBusAffinity(bool enabled)
+{
+	m_busAffinity = enabled;
+}
+
+
+void SetupDialog::setEnvControlInterval(int frames)
+{
+	m_envControlInterval = frames;
+}
+
+
+void SetupDialog::toggleStealVoices(bool enabled)
+{
+	m_stealVoices = enabled;
+}
+
+
+void SetupDialog::toggleStealQuietest(bool enabled)
+{
+	m_stealQuietest = enabled;
+}
+
+
+void SetupDialog::setMaxVoices(int voices)
+{
+	m_maxVoices = voices;
+}
+
+
+void SetupDialog::toggleDegradeSamples(bool enabled)
+{
+	m_degradeSamples = enabled;
+}
+
+
+void SetupDialog::toggleBypassExpendable(bool enabled)
+{
+	m_bypassExpendable = enabled;
+}
+
+
+void SetupDialog::toggleFlightRecorder(bool enabled)
+{
+	m_flightRecorder = enabled;
+}
+
 void SetupDialog::audioInterfaceChanged(const QString & iface)
 {
 	for(AswMap::iterator it = m_audioIfaceSetupWidgets.begin();
@@ -104,7 +104,9 @@ void CPULoadWidget::updateCpuLoad()
 			+ tr(" - Notes and setup: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::NoteSetup)) + "\n"
 			+ tr(" - Instruments: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Instruments)) + "\n"
 			+ tr(" - Effects: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Effects)) + "\n"
-			+ tr(" - Mixing: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Mixing))
+			+ tr(" - Mixing: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Mixing)) + "\n"
+			+ tr("Stolen voices: %1").arg(engine->overloadManager().stolenVoices()) + "\n"
+			+ tr("Dropped voices: %1").arg(engine->overloadManager().droppedVoices())
 		);
 		m_currentLoad = new_load;
 		m_changed = true;
@@ -66,6 +66,7 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_pitchRangeModel( 1, 1, 60, this, tr( "Pitch range" ) ),
 	m_mixerChannelModel( 0, 0, 0, this, tr( "Mixer channel" ) ),
 	m_useMasterPitchModel( true, this, tr( "Master pitch") ),
+	m_maxVoicesModel(0, 0, MaxVoices, this, tr("Maximum voices")),
 	m_instrument( nullptr ),
 	m_soundShaping( this ),
 	m_arpeggio( this ),
@@ -82,6 +83,15 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 
 	m_mixerChannelModel.setRange( 0, Engine::mixer()->numChannels()-1, 1);
 
+	m_audioPort.setBatchProcessor( &m_soundShaping );
+
+	m_periodNotes.reserve( PlayHandle::MaxNumber );
+	m_voices.reserve( PlayHandle::MaxNumber );
+
+	// starting notes from the MIDI thread would contend with the audio
+	// thread, so let the audio engine pass us the events of MIDI devices
+	m_midiPort.enableInputQueue();
+
 	for( int i = 0; i < NumKeys; ++i )
 	{
 		m_notes[i] = nullptr;
@@ -214,6 +224,7 @@ InstrumentTrack::~InstrumentTrack()
 	silenceAllNotes( true );
 
 	// now we're save deleting the instrument
+	m_audioPort.setSource( nullptr );
 	if( m_instrument ) delete m_instrument;
 }
 
@@ -253,7 +264,6 @@ void InstrumentTrack::processAudioBuffer( SampleFrame* buf, const fpp_t frames,
 	m_audioPort.effects()->startRunning();
 
 	// get volume knob data
-	static const float DefaultVolumeRatio = 1.0f / DefaultVolume;
 	/*ValueBuffer * volBuf = m_volumeModel.valueBuffer();
 	float v_scale = volBuf
 		? 1.0f
@@ -265,16 +275,35 @@ void InstrumentTrack::processAudioBuffer( SampleFrame* buf, const fpp_t frames,
 	if (!m_instrument->isSingleStreamed() && n != nullptr)
 	{
 		const f_cnt_t offset = n->noteOffset();
+
+		// voices of filters which can be batched are finished together with the
+		// other voices of this track before they get mixed, see
+		// InstrumentSoundShaping::processBatch(). This requires the voices to
+		// have buffers of their own.
+		if( n->usesBuffer() && m_soundShaping.deferAudioBuffer( offset, frames - offset, n ) )
+		{
+			return;
+		}
+
 		m_soundShaping.processAudioBuffer( buf + offset, frames - offset, n );
-		const float vol = ( (float) n->getVolume() * DefaultVolumeRatio );
-		const panning_t pan = std::clamp(n->getPanning(), PanningLeft, PanningRight);
-		StereoVolumeVector vv = panningToVolumeVector( pan, vol );
-		for( f_cnt_t f = offset; f < frames; ++f )
+		applyNoteVolume( buf + offset, frames - offset, n );
+	}
+}
+
+
+
+
+void InstrumentTrack::applyNoteVolume( SampleFrame* buf, const fpp_t frames, const NotePlayHandle* n )
+{
+	static const float DefaultVolumeRatio = 1.0f / DefaultVolume;
+	const float vol = ( (float) n->getVolume() * DefaultVolumeRatio );
+	const panning_t pan = std::clamp(n->getPanning(), PanningLeft, PanningRight);
+	StereoVolumeVector vv = panningToVolumeVector( pan, vol );
+	for( f_cnt_t f = 0; f < frames; ++f )
+	{
+		for( int c = 0; c < 2; ++c )
 		{
-			for( int c = 0; c < 2; ++c )
-			{
-				buf[f][c] *= vv.vol[c];
-			}
+			buf[f][c] *= vv.vol[c];
 		}
 	}
 }
@@ -580,6 +609,12 @@ void InstrumentTrack::playNote( NotePlayHandle* n, SampleFrame* workingBuffer )
 
 	if( n->isMasterNote() == false && m_instrument != nullptr )
 	{
+		// instruments rendering all voices at once are called by playVoices()
+		if( m_instrument->rendersAllVoices() )
+		{
+			return;
+		}
+
 		// all is done, so now lets play the note!
 		m_instrument->playNote( n, workingBuffer );
 
@@ -597,6 +632,51 @@ void InstrumentTrack::playNote( NotePlayHandle* n, SampleFrame* workingBuffer )
 
 
 
+void InstrumentTrack::playVoices( SampleFrame* buffer )
+{
+	m_periodNotes.clear();
+	m_voices.clear();
+
+	// the notes are no jobs of their own (see NotePlayHandle::requiresProcessing()),
+	// so advance all of them here and collect the ones producing sound
+	for( const auto& playHandle : Engine::audioEngine()->playHandles() )
+	{
+		if( playHandle->type() != PlayHandle::Type::NotePlayHandle )
+		{
+			continue;
+		}
+
+		const auto n = static_cast<NotePlayHandle*>( playHandle );
+		if( n->m_instrumentTrack != this || n->isFinished() || !n->beginPeriod() )
+		{
+			continue;
+		}
+		m_periodNotes.push_back( n );
+
+		if( n->m_framesToPlay > 0 )
+		{
+			playNote( n, nullptr );
+			if( !n->isMasterNote() )
+			{
+				m_voices.push_back( n );
+			}
+		}
+	}
+
+	if( !m_voices.empty() )
+	{
+		m_instrument->playNotes( m_voices.data(), m_voices.size(), buffer );
+	}
+
+	for( const auto& n : m_periodNotes )
+	{
+		n->endPeriod();
+	}
+}
+
+
+
+
 QString InstrumentTrack::instrumentName() const
 {
 	if( m_instrument != nullptr )
@@ -833,6 +913,7 @@ void InstrumentTrack::saveTrackSpecificSettings( QDomDocument& doc, QDomElement
 	m_firstKeyModel.saveSettings(doc, thisElement, "firstkey");
 	m_lastKeyModel.saveSettings(doc, thisElement, "lastkey");
 	m_useMasterPitchModel.saveSettings( doc, thisElement, "usemasterpitch");
+	m_maxVoicesModel.saveSettings(doc, thisElement, "maxvoices");
 	m_microtuner.saveSettings(doc, thisElement);
 
 	// Save MIDI CC stuff
@@ -902,6 +983,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 	m_firstKeyModel.loadSettings(thisElement, "firstkey");
 	m_lastKeyModel.loadSettings(thisElement, "lastkey");
 	m_useMasterPitchModel.loadSettings( thisElement, "usemasterpitch");
+	m_maxVoicesModel.loadSettings(thisElement, "maxvoices");
 	m_microtuner.loadSettings(thisElement);
 
 	// clear effect-chain just in case we load an old preset without FX-data
@@ -947,10 +1029,12 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 				}
 				else
 				{
+					m_audioPort.setSource(nullptr);
 					delete m_instrument;
 					m_instrument = nullptr;
 					m_instrument = Instrument::instantiate(
 						node.toElement().attribute("name"), this, &key);
+					m_audioPort.setSource(m_instrument);
 					m_instrument->restoreState(node.firstChildElement());
 					emit instrumentChanged();
 				}
@@ -969,10 +1053,12 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 					ControllerConnection::classNodeName() != node.nodeName() &&
 					!node.toElement().hasAttribute( "id" ))
 			{
+				m_audioPort.setSource(nullptr);
 				delete m_instrument;
 				m_instrument = nullptr;
 				m_instrument = Instrument::instantiate(
 					node.nodeName(), this, nullptr, true);
+				m_audioPort.setSource(m_instrument);
 				if (m_instrument->nodeName() == node.nodeName())
 				{
 					m_instrument->restoreState(node.toElement());
@@ -1049,9 +1135,11 @@ Instrument * InstrumentTrack::loadInstrument(const QString & _plugin_name,
 	silenceAllNotes( true );
 
 	lock();
+	m_audioPort.setSource( nullptr );
 	delete m_instrument;
 	m_instrument = Instrument::instantiate(_plugin_name, this,
 					key, keyFromDnd);
+	m_audioPort.setSource( m_instrument );
 	unlock();
 	setName(m_instrument->displayName());
 
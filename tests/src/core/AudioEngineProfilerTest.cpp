@@ -0,0 +1,77 @@
+/*
+ * AudioEngineProfilerTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AudioEngineProfiler.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <array>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+using lmms::AudioEngineProfiler;
+
+class AudioEngineProfilerTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void ShortLivedThreadsKeepRecordingTest()
+	{
+		// every export and device change renders on a new thread, so there
+		// have to be more of them over time than there are rings
+		constexpr std::size_t Threads = 2 * AudioEngineProfiler::MaxThreads;
+		auto sources = std::array<int, Threads>{};
+
+		auto profiler = AudioEngineProfiler{};
+		profiler.setSourceProfiling(true);
+		profiler.startTrace();
+		for (const auto& source : sources)
+		{
+			auto thread = std::thread{[&profiler, &source] {
+				const auto probe = AudioEngineProfiler::SourceProbe{
+					profiler, AudioEngineProfiler::SourceType::Effect, &source};
+			}};
+			thread.join();
+		}
+
+		// the collector thread drains the rings every 100 ms
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		const auto events = profiler.stopTrace();
+
+		QCOMPARE(profiler.lostEvents(), 0);
+		auto recorded = std::set<const void*>{};
+		for (const auto& event : events)
+		{
+			if (event.type != AudioEngineProfiler::SourceType::Effect) { continue; }
+			QCOMPARE(event.thread, std::uint8_t{0});
+			recorded.insert(event.source);
+		}
+		QCOMPARE(recorded.size(), Threads);
+	}
+};
+
+QTEST_GUILESS_MAIN(AudioEngineProfilerTest)
+#include "AudioEngineProfilerTest.moc"
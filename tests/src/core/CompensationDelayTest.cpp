@@ -0,0 +1,87 @@
+/*
+ * CompensationDelayTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "CompensationDelay.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <vector>
+
+using lmms::CompensationDelay;
+using lmms::SampleFrame;
+
+class CompensationDelayTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void ZeroDelayTest()
+	{
+		auto delay = CompensationDelay{};
+		auto in = std::vector<SampleFrame>{SampleFrame(1.f, -1.f), SampleFrame(2.f, -2.f)};
+		auto out = std::vector<SampleFrame>(2);
+		delay.process(in.data(), out.data(), 2);
+		QCOMPARE(out[1].left(), 2.f);
+		QCOMPARE(out[1].right(), -2.f);
+		QVERIFY(!delay.hasTail());
+	}
+
+	void DelaysAcrossPeriodsTest()
+	{
+		constexpr int Frames = 4;
+		auto delay = CompensationDelay{};
+		delay.setDelay(6);
+
+		// an impulse at frame 1 has to come out at frame 7, i.e. in the second period
+		auto buffer = std::vector<SampleFrame>(Frames);
+		buffer[1] = SampleFrame(1.f);
+		delay.process(buffer.data(), buffer.data(), Frames);
+		for (const auto& frame : buffer) { QCOMPARE(frame.left(), 0.f); }
+		QVERIFY(delay.hasTail());
+
+		delay.drain(buffer.data(), Frames);
+		for (int f = 0; f < Frames; ++f) { QCOMPARE(buffer[f].left(), f == 3 ? 1.f : 0.f); }
+
+		delay.drain(buffer.data(), Frames);
+		for (const auto& frame : buffer) { QCOMPARE(frame.left(), 0.f); }
+		QVERIFY(!delay.hasTail());
+	}
+
+	void SetDelayClearsTest()
+	{
+		auto delay = CompensationDelay{};
+		delay.setDelay(2);
+		auto buffer = std::vector<SampleFrame>(2, SampleFrame(1.f));
+		delay.process(buffer.data(), buffer.data(), 2);
+
+		delay.setDelay(3);
+		QCOMPARE(delay.delay(), lmms::f_cnt_t{3});
+		QVERIFY(!delay.hasTail());
+		delay.drain(buffer.data(), 2);
+		QCOMPARE(buffer[0].left(), 0.f);
+		QCOMPARE(buffer[1].left(), 0.f);
+	}
+};
+
+QTEST_GUILESS_MAIN(CompensationDelayTest)
+#include "CompensationDelayTest.moc"
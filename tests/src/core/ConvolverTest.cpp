@@ -0,0 +1,171 @@
+/*
+ * ConvolverTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Convolver.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "SampleBuffer.h"
+
+using lmms::Convolver;
+using lmms::f_cnt_t;
+using lmms::ImpulseResponse;
+using lmms::SampleBuffer;
+using lmms::SampleFrame;
+
+namespace
+{
+
+constexpr int SampleRate = 44100;
+
+std::shared_ptr<const ImpulseResponse> makeResponse(std::vector<SampleFrame> taps)
+{
+	return std::make_shared<const ImpulseResponse>(SampleBuffer{std::move(taps), SampleRate}, SampleRate);
+}
+
+//! Run \p input through \p convolver in blocks of random size, as an effect chain may
+std::vector<SampleFrame> convolveInRandomBlocks(Convolver& convolver, const std::vector<SampleFrame>& input)
+{
+	auto random = std::mt19937{1};
+	auto blockSize = std::uniform_int_distribution<std::size_t>{1, 256};
+	auto output = std::vector<SampleFrame>(input.size());
+	for (std::size_t f = 0; f < input.size();)
+	{
+		const auto frames = std::min(blockSize(random), input.size() - f);
+		convolver.process(&input[f], &output[f], frames);
+		f += frames;
+	}
+	return output;
+}
+
+} // namespace
+
+class ConvolverTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void StagesFollowEachOtherTest()
+	{
+		// the head is convolved directly, the first stage follows right after it
+		QCOMPARE(ImpulseResponse::StageOffset[0], ImpulseResponse::HeadLength);
+		QCOMPARE(ImpulseResponse::PartitionSize[0], ImpulseResponse::HeadLength);
+		for (int s = 1; s < ImpulseResponse::StageCount; ++s)
+		{
+			// an asynchronous stage needs a whole block of headroom for its job
+			QCOMPARE(ImpulseResponse::StageOffset[s], 2 * ImpulseResponse::PartitionSize[s]);
+			// the stage before ends with a whole partition where this one begins
+			const f_cnt_t span = ImpulseResponse::StageOffset[s] - ImpulseResponse::StageOffset[s - 1];
+			QCOMPARE(span % ImpulseResponse::PartitionSize[s - 1], f_cnt_t{0});
+		}
+	}
+
+	void ImpulsesAreDelayedByTheirTapTest()
+	{
+		// both ends of the head and of every stage, and the second partition of the last one
+		constexpr f_cnt_t Length = 13001;
+		const auto taps = {0, 1, 62, 63, 64, 65, 1023, 1024, 1025, 8191, 8192, 12287, 12288, 13000};
+		constexpr f_cnt_t Frames = Length + 4096;
+
+		for (bool useThreadPool : {false, true})
+		{
+			for (const f_cnt_t tap : taps)
+			{
+				// the right channel has its impulse elsewhere, so the channels can't get mixed up
+				const f_cnt_t rightTap = Length - 1 - tap;
+				auto response = std::vector<SampleFrame>(Length);
+				response[tap][0] = 1.f;
+				response[rightTap][1] = 0.5f;
+
+				auto convolver = Convolver{makeResponse(std::move(response)), useThreadPool};
+				auto input = std::vector<SampleFrame>(Frames);
+				input[0] = SampleFrame(1.f, 1.f);
+				const auto output = convolveInRandomBlocks(convolver, input);
+
+				for (f_cnt_t f = 0; f < Frames; ++f)
+				{
+					QVERIFY(std::abs(output[f].left() - (f == tap ? 1.f : 0.f)) < 1e-4f);
+					QVERIFY(std::abs(output[f].right() - (f == rightTap ? 0.5f : 0.f)) < 1e-4f);
+				}
+			}
+		}
+	}
+
+	void MatchesDirectConvolutionTest()
+	{
+		constexpr f_cnt_t Length = 20000;
+		constexpr f_cnt_t Frames = 40000;
+
+		// dense up to the second stage, sparse after it to keep the reference cheap
+		auto random = std::mt19937{2};
+		auto value = std::uniform_real_distribution<float>{-1.f, 1.f};
+		auto response = std::vector<SampleFrame>(Length);
+		auto nonZeroTaps = std::vector<f_cnt_t>{};
+		for (f_cnt_t t = 0; t < Length; t += t < 1024 ? 1 : 29)
+		{
+			response[t] = SampleFrame(value(random), value(random)) * 0.1f;
+			nonZeroTaps.push_back(t);
+		}
+		auto input = std::vector<SampleFrame>(Frames);
+		for (auto& frame : input)
+		{
+			frame = SampleFrame(value(random), value(random));
+		}
+
+		auto expected = std::vector<SampleFrame>(Frames);
+		for (f_cnt_t f = 0; f < Frames; ++f)
+		{
+			for (const f_cnt_t t : nonZeroTaps)
+			{
+				if (t > f) { break; }
+				expected[f][0] += response[t][0] * input[f - t][0];
+				expected[f][1] += response[t][1] * input[f - t][1];
+			}
+		}
+
+		const auto ir = makeResponse(response);
+		for (bool useThreadPool : {false, true})
+		{
+			auto convolver = Convolver{ir, useThreadPool};
+			for (int pass = 0; pass < 2; ++pass)
+			{
+				const auto output = convolveInRandomBlocks(convolver, input);
+				for (f_cnt_t f = 0; f < Frames; ++f)
+				{
+					QVERIFY(std::abs(output[f].left() - expected[f].left()) < 1e-3f);
+					QVERIFY(std::abs(output[f].right() - expected[f].right()) < 1e-3f);
+				}
+				// after a reset, the same input has to give the same output again
+				convolver.reset();
+			}
+		}
+	}
+} ;
+
+QTEST_GUILESS_MAIN(ConvolverTest)
+#include "ConvolverTest.moc"
@@ -0,0 +1,113 @@
+/*
+ * DynamicsTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Dynamics.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <cmath>
+#include <vector>
+
+#include "lmms_math.h"
+
+using lmms::CompressorGain;
+using lmms::EnvelopeFollower;
+using lmms::LookaheadDelay;
+using lmms::SampleFrame;
+
+class DynamicsTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void LookaheadDelayWrapsTest()
+	{
+		// blocks of odd sizes make the ring wrap inside of a block
+		constexpr int Delay = 7;
+		auto delay = LookaheadDelay{};
+		delay.resize(Delay, 0.f);
+
+		int written = 0;
+		for (int frames : {5, 256, 3, 100, 256, 1, 200})
+		{
+			auto in = std::vector<SampleFrame>(frames);
+			for (int f = 0; f < frames; ++f) { in[f] = SampleFrame(written + f + 1.f); }
+			delay.write(in.data(), frames);
+
+			auto out = std::vector<SampleFrame>(frames);
+			delay.read(out.data(), frames, Delay);
+			for (int f = 0; f < frames; ++f)
+			{
+				const int t = written + f - Delay;
+				QCOMPARE(out[f].left(), t < 0 ? 0.f : t + 1.f);
+			}
+
+			// the lookahead tap is later in the signal, which only rises here
+			delay.readWithLookahead(out.data(), frames, Delay, 3);
+			for (int f = 0; f < frames; ++f)
+			{
+				const int t = written + f - Delay + 3;
+				QCOMPARE(out[f].right(), t < 0 ? 0.f : t + 1.f);
+			}
+			written += frames;
+		}
+	}
+
+	void EnvelopeFollowerHoldTest()
+	{
+		constexpr int Hold = 4;
+		auto follower = EnvelopeFollower{0.f};
+		follower.setSampleRate(44100);
+		follower.setTimes(0.f, 10.f);
+		follower.setHold(Hold);
+
+		auto level = std::vector<SampleFrame>(Hold + 2);
+		level[0] = SampleFrame(1.f);
+		auto out = std::vector<SampleFrame>(level.size());
+		follower.process(level.data(), nullptr, out.data(), level.size());
+
+		// no attack time jumps to the level, which is then held before it releases
+		for (int f = 0; f <= Hold; ++f) { QCOMPARE(out[f].left(), 1.f); }
+		QVERIFY(out[Hold + 1].left() < 1.f);
+		QVERIFY(out[Hold + 1].left() > 0.9f);
+	}
+
+	void CompressorGainMatchesCurveTest()
+	{
+		constexpr float Threshold = -20.f;
+		constexpr float Ratio = 0.25f;
+		constexpr float Knee = 6.f;
+		auto gain = CompressorGain{};
+		gain.setCurve(Threshold, Ratio, Knee);
+
+		for (float db = -60.f; db < 12.f; db += 0.5f)
+		{
+			const float level = lmms::dbfsToAmp(db);
+			const float expected = lmms::dbfsToAmp(lmms::compressedLevel(db, Threshold, Ratio, Knee)) / level;
+			QVERIFY(std::abs(gain.gain(level) - expected) < 1e-5f * expected);
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(DynamicsTest)
+#include "DynamicsTest.moc"
@@ -0,0 +1,113 @@
+/*
+ * MidiInputLatencyTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "MidiEventProcessor.h"
+#include "MidiPort.h"
+
+using lmms::AudioEngine;
+using lmms::Engine;
+using lmms::MidiEvent;
+using lmms::MidiPort;
+
+namespace
+{
+
+//! Stands in for an instrument track, counting the note-ons the audio thread passes it
+class NoteOnCounter : public lmms::MidiEventProcessor
+{
+public:
+	void processInEvent(const MidiEvent& event, const lmms::TimePos&, lmms::f_cnt_t) override
+	{
+		if (event.type() == lmms::MidiNoteOn) { ++m_noteOns; }
+	}
+
+	void processOutEvent(const MidiEvent&, const lmms::TimePos&, lmms::f_cnt_t) override {}
+
+	int noteOns() const
+	{
+		return m_noteOns;
+	}
+
+private:
+	std::atomic<int> m_noteOns = 0;
+} ;
+
+} // namespace
+
+class MidiInputLatencyTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void initTestCase()
+	{
+		// renders in real time with AudioDummy, MIDI comes from MidiDummy
+		Engine::init(true);
+	}
+
+	void cleanupTestCase()
+	{
+		Engine::destroy();
+	}
+
+	void NoteOnLoopbackTest()
+	{
+		constexpr int NoteOns = 200;
+		// not a multiple of any period size, so the events land everywhere in a period
+		constexpr auto Interval = std::chrono::microseconds{1700};
+
+		AudioEngine* audioEngine = Engine::audioEngine();
+		auto counter = NoteOnCounter{};
+		auto port = MidiPort{"loopback", audioEngine->midiClient(), &counter, nullptr, MidiPort::Mode::Input};
+		port.enableInputQueue();
+
+		// this thread plays the MIDI client, like MidiDummy's ports would
+		audioEngine->startMidiInputLatencyMeasurement();
+		for (int i = 0; i < NoteOns; ++i)
+		{
+			port.processInEvent(MidiEvent{lmms::MidiNoteOn, 0, 60, 100});
+			std::this_thread::sleep_for(Interval);
+		}
+		QTRY_COMPARE_WITH_TIMEOUT(counter.noteOns(), NoteOns, 1000);
+		audioEngine->stopMidiInputLatencyMeasurement();
+
+		const auto latency = audioEngine->midiInputLatency();
+		qInfo("MIDI input latency of %d note-ons at %d frames per period: %d to %d us, jitter %d us",
+			latency.events, static_cast<int>(audioEngine->framesPerPeriod()), latency.minimum, latency.maximum,
+			latency.maximum - latency.minimum);
+
+		QCOMPARE(latency.events, NoteOns);
+		QVERIFY(latency.minimum <= latency.maximum);
+	}
+} ;
+
+QTEST_GUILESS_MAIN(MidiInputLatencyTest)
+#include "MidiInputLatencyTest.moc"
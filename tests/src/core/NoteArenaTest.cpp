@@ -0,0 +1,174 @@
+/*
+ * NoteArenaTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "NoteArena.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+using lmms::NoteArena;
+
+namespace
+{
+
+std::atomic<int> s_allocations{0};
+
+struct DestructionOrder
+{
+	DestructionOrder(std::vector<int>* order, int id) : order{order}, id{id} {}
+	~DestructionOrder() { order->push_back(id); }
+	std::vector<int>* order;
+	int id;
+};
+
+struct alignas(32) Aligned
+{
+	float values[8];
+};
+
+//! Stands in for the state of a typical instrument voice
+struct Voice
+{
+	Voice(NoteArena& arena, int frames) :
+		left{arena.createArray<float>(frames)},
+		right{arena.createArray<float>(frames)}
+	{
+	}
+	~Voice() { ++destroyed; }
+
+	float* left;
+	float* right;
+	std::array<double, 16> state{};
+	static inline int destroyed = 0;
+};
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+	++s_allocations;
+	if (void* p = std::malloc(size ? size : 1)) { return p; }
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+class NoteArenaTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void DestroysInReverseOrderTest()
+	{
+		auto order = std::vector<int>{};
+		order.reserve(3);
+
+		auto arena = NoteArena{};
+		arena.create<DestructionOrder>(&order, 1);
+		arena.create<DestructionOrder>(&order, 2);
+		arena.create<DestructionOrder>(&order, 3);
+		QVERIFY(order.empty());
+
+		arena.reset();
+		QCOMPARE(order, (std::vector<int>{3, 2, 1}));
+
+		// nothing is destroyed twice
+		arena.reset();
+		QCOMPARE(order.size(), std::size_t{3});
+	}
+
+	void AlignmentTest()
+	{
+		auto arena = NoteArena{};
+		arena.createArray<char>(3);
+		const auto aligned = arena.create<Aligned>();
+		QCOMPARE(reinterpret_cast<std::uintptr_t>(aligned) % alignof(Aligned), std::uintptr_t{0});
+
+		arena.createArray<char>(1);
+		const auto d = arena.createArray<double>(4);
+		QCOMPARE(reinterpret_cast<std::uintptr_t>(d) % alignof(double), std::uintptr_t{0});
+		QCOMPARE(d[3], 0.0);
+	}
+
+	void NoAllocationsAfterWarmUpTest()
+	{
+		constexpr int Frames = 256;
+		auto arena = NoteArena{};
+
+		// the first note may have to grow the arena
+		arena.create<Voice>(arena, Frames);
+		arena.createArray<float>(NoteArena::InitialSize);
+		arena.reset();
+		const auto capacity = arena.capacity();
+
+		Voice::destroyed = 0;
+		const int before = s_allocations;
+		for (int note = 0; note < 10000; ++note)
+		{
+			const auto voice = arena.create<Voice>(arena, Frames);
+			voice->left[Frames - 1] = 1.f;
+			arena.createArray<float>(note % NoteArena::InitialSize);
+			arena.reset();
+		}
+		const int after = s_allocations;
+
+		QCOMPARE(after - before, 0);
+		QCOMPARE(Voice::destroyed, 10000);
+		QCOMPARE(arena.capacity(), capacity);
+	}
+
+	void GrowthAndRetentionTest()
+	{
+		auto arena = NoteArena{};
+		QCOMPARE(arena.capacity(), NoteArena::InitialSize);
+
+		// a large allocation grows the arena and is kept for the next notes
+		arena.createArray<char>(2 * NoteArena::InitialSize);
+		QCOMPARE(arena.growths(), 1);
+		arena.reset();
+		arena.createArray<char>(2 * NoteArena::InitialSize);
+		QCOMPARE(arena.growths(), 1);
+		arena.reset();
+
+		// memory beyond the limit is released again
+		arena.createArray<char>(2 * NoteArena::MaxRetainedSize);
+		arena.reset();
+		QVERIFY(arena.capacity() <= NoteArena::MaxRetainedSize);
+	}
+};
+
+QTEST_GUILESS_MAIN(NoteArenaTest)
+#include "NoteArenaTest.moc"
@@ -0,0 +1,86 @@
+/*
+ * OversamplerTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Oversampler.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <cmath>
+#include <vector>
+
+using lmms::Oversampler;
+using lmms::SampleFrame;
+
+class OversamplerTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void NoOversamplingTest()
+	{
+		auto oversampler = Oversampler{1, 2};
+		auto buffer = std::vector<SampleFrame>{SampleFrame(1.f, -1.f), SampleFrame(2.f, -2.f)};
+		QCOMPARE(oversampler.upsample(buffer.data(), 2), buffer.data());
+		oversampler.downsample(buffer.data(), 2);
+		QCOMPARE(buffer[1].left(), 2.f);
+		QCOMPARE(buffer[1].right(), -2.f);
+		QCOMPARE(oversampler.latency(), lmms::f_cnt_t{0});
+	}
+
+	void SineIsDelayedByLatencyTest()
+	{
+		constexpr int Frames = 64;
+		constexpr int Periods = 16;
+		const auto input = [](int f, int ch) { return std::sin(0.1f * f + ch); };
+
+		for (int factor : {2, 4, 8})
+		{
+			auto oversampler = Oversampler{factor, Frames};
+			const auto latency = static_cast<int>(oversampler.latency());
+			QVERIFY(latency > 0 && latency < Frames);
+
+			auto buffer = std::vector<SampleFrame>(Frames);
+			for (int p = 0; p < Periods; ++p)
+			{
+				for (int f = 0; f < Frames; ++f)
+				{
+					buffer[f] = SampleFrame(input(p * Frames + f, 0), input(p * Frames + f, 1));
+				}
+				oversampler.upsample(buffer.data(), Frames);
+				oversampler.downsample(buffer.data(), Frames);
+
+				// skip the filters settling in
+				if (p < 2) { continue; }
+				for (int f = 0; f < Frames; ++f)
+				{
+					const int t = p * Frames + f - latency;
+					QVERIFY(std::abs(buffer[f].left() - input(t, 0)) < 1e-3f);
+					QVERIFY(std::abs(buffer[f].right() - input(t, 1)) < 1e-3f);
+				}
+			}
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(OversamplerTest)
+#include "OversamplerTest.moc"
@@ -0,0 +1,76 @@
+/*
+ * ScratchArenaTest.cpp
+ *
+ * Copyright (c) 2026 The LMMS team
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ScratchArena.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+using lmms::ScratchArena;
+using lmms::SampleFrame;
+
+class ScratchArenaTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void ScopeGivesBackBuffersTest()
+	{
+		SampleFrame* first = nullptr;
+		{
+			auto scope = ScratchArena::Scope{};
+			first = ScratchArena::frames(64);
+		}
+		auto scope = ScratchArena::Scope{};
+		QCOMPARE(ScratchArena::frames(64), first);
+	}
+
+	void NestedBuffersDontOverlapTest()
+	{
+		auto outer = ScratchArena::Scope{};
+		SampleFrame* a = ScratchArena::frames(32);
+		SampleFrame* b = nullptr;
+		{
+			auto inner = ScratchArena::Scope{};
+			b = ScratchArena::frames(32);
+			QVERIFY(b >= a + 32 || b + 32 <= a);
+		}
+		QCOMPARE(ScratchArena::frames(32), b);
+	}
+
+	void GrowsOnlyOnceTest()
+	{
+		ScratchArena::reserve();
+		const auto chunks = ScratchArena::chunkCount();
+		for (int i = 0; i < 3; ++i)
+		{
+			auto scope = ScratchArena::Scope{};
+			auto buffer = ScratchArena::frames(ScratchArena::ChunkFrames + 1);
+			buffer[ScratchArena::ChunkFrames] = SampleFrame(1.f);
+			QCOMPARE(ScratchArena::chunkCount(), chunks + 1);
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(ScratchArenaTest)
+#include "ScratchArenaTest.moc"